@@ -0,0 +1,167 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "DatagramPort.h"
+
+// ===================== 强制门户快速通道 =====================
+// 手机刚连上热点时会连续发出联网检测请求（generate_204、hotspot-detect、ncsi等），
+// 通配DNS把它们全部引到本机。这里对已知检测URL直接回固定的小响应（系统据此认为网络可用，
+// 不再重试），DNS应答受预算限制，避免检测风暴挤占WebSocket控制帧的处理时间。
+
+// 已知检测URL及其期望的响应
+struct CaptiveProbe {
+  const char* uri;
+  int code;
+  const char* contentType;
+  const char* body;
+};
+
+const CaptiveProbe CAPTIVE_PROBES[] = {
+  { "/generate_204", 204, "text/plain", "" },                      // Android / Chrome
+  { "/gen_204", 204, "text/plain", "" },
+  { "/hotspot-detect.html", 200, "text/html",                       // Apple
+    "<HTML><HEAD><TITLE>Success</TITLE></HEAD><BODY>Success</BODY></HTML>" },
+  { "/library/test/success.html", 200, "text/html",
+    "<HTML><HEAD><TITLE>Success</TITLE></HEAD><BODY>Success</BODY></HTML>" },
+  { "/ncsi.txt", 200, "text/plain", "Microsoft NCSI" },             // Windows
+  { "/connecttest.txt", 200, "text/plain", "Microsoft Connect Test" },
+  { "/success.txt", 200, "text/plain", "success\n" },               // Firefox
+};
+
+const int CAPTIVE_PROBE_COUNT = sizeof(CAPTIVE_PROBES) / sizeof(CAPTIVE_PROBES[0]);
+
+// DNS应答预算：每个时间窗最多应答maxPerWindow个请求，超出的请求留在套接字里推迟到下个窗口。
+// 只在确有待处理的请求时调用allow()，预算按请求数扣除而不是按轮询次数；
+// 真正取出并处理了一个数据报后调用answered()。推迟数为被预算挡下的队首请求数（同一请求只计一次）。
+class DnsBudget {
+ public:
+  DnsBudget(uint32_t maxPerWindow, uint32_t windowMs)
+      : maxPerWindow_(maxPerWindow), windowMs_(windowMs) {}
+
+  bool allow(uint32_t nowMs) {
+    if (nowMs - windowStart_ >= windowMs_) {
+      windowStart_ = nowMs;
+      used_ = 0;
+    }
+    if (used_ >= maxPerWindow_) {
+      if (!waiting_) deferred_++;
+      waiting_ = true;
+      return false;
+    }
+    used_++;
+    waiting_ = false;
+    return true;
+  }
+
+  void answered() { answers_++; }
+
+  uint32_t answers() const { return answers_; }
+  uint32_t deferred() const { return deferred_; }
+
+ private:
+  uint32_t maxPerWindow_;
+  uint32_t windowMs_;
+  uint32_t windowStart_ = 0;
+  uint32_t used_ = 0;
+  bool waiting_ = false;
+  uint32_t answers_ = 0;
+  uint32_t deferred_ = 0;
+};
+
+// 通配DNS应答：只有一个问题的标准查询才应答，A记录（及ANY）回答本机地址，
+// 其他类型（如AAAA）回答“无记录”，手机不会再等IPv6超时。
+// 应答只带原问题，查询里的附加记录（EDNS等）丢弃。返回应答长度，不应答时返回0
+const size_t DNS_HEADER_SIZE = 12;
+const size_t DNS_MAX_PACKET = 512;   // 不带EDNS的UDP报文上限
+const size_t DNS_ANSWER_SIZE = 16;   // 名称指针2 + 类型2 + 类2 + TTL4 + 长度2 + 地址4
+
+inline size_t buildDnsReply(const uint8_t* query, size_t length, uint32_t ip, uint32_t ttl,
+                            uint8_t* out, size_t capacity) {
+  if (length < DNS_HEADER_SIZE) return 0;
+  uint16_t flags = (uint16_t)(query[2] << 8 | query[3]);
+  uint16_t questions = (uint16_t)(query[4] << 8 | query[5]);
+  if ((flags & 0x8000) != 0 || (flags & 0x7800) != 0 || questions != 1) return 0;
+
+  // 问题：以0结尾的标签序列（查询中不应出现压缩指针），之后是类型和类
+  size_t pos = DNS_HEADER_SIZE;
+  for (;;) {
+    if (pos >= length) return 0;
+    uint8_t label = query[pos];
+    if (label == 0) break;
+    if ((label & 0xC0) != 0) return 0;
+    pos += 1 + label;
+  }
+  pos++;
+  if (pos + 4 > length) return 0;
+  uint16_t type = (uint16_t)(query[pos] << 8 | query[pos + 1]);
+  uint16_t cls = (uint16_t)(query[pos + 2] << 8 | query[pos + 3]);
+  pos += 4;
+  bool answer = (type == 1 || type == 255) && cls == 1;
+  size_t total = pos + (answer ? DNS_ANSWER_SIZE : 0);
+  if (total > capacity) return 0;
+
+  memcpy(out, query, pos);
+  out[2] = (uint8_t)(0x84 | (query[2] & 0x01));   // QR=1、AA=1，保留RD
+  out[3] = 0x00;                                   // RA=0、RCODE=0
+  out[6] = 0;
+  out[7] = answer ? 1 : 0;
+  memset(out + 8, 0, 4);                           // 无授权/附加记录
+  if (answer) {
+    const uint8_t record[DNS_ANSWER_SIZE] = {
+      0xC0, 0x0C, 0x00, 0x01, 0x00, 0x01,
+      (uint8_t)(ttl >> 24), (uint8_t)(ttl >> 16), (uint8_t)(ttl >> 8), (uint8_t)ttl,
+      0x00, 0x04,
+      (uint8_t)(ip >> 24), (uint8_t)(ip >> 16), (uint8_t)(ip >> 8), (uint8_t)ip,
+    };
+    memcpy(out + pos, record, DNS_ANSWER_SIZE);
+  }
+  return total;
+}
+
+// 强制门户DNS：代替Arduino的DNSServer。DNSServer::processNextRequest()不返回是否处理了请求，
+// 预算只能按轮询计数；这里先看套接字里有没有请求（pending()），有且预算允许时才取出应答（answer()）。
+// 收发缓冲是成员，不占网络任务的栈。主机上端口从不绑定（仿真中没有DNS请求）
+class CaptiveDns {
+ public:
+  CaptiveDns() : port_(false) {}
+
+  // ip为主机字节序的IPv4地址
+  bool start(uint16_t port, uint32_t ip, uint32_t ttl) {
+    ip_ = ip;
+    ttl_ = ttl;
+    return port_.begin(port);
+  }
+
+  bool pending() { return port_.pending(); }
+
+  // 取出一个请求并应答，没有请求时返回false（格式不对的请求取出后丢弃，同样返回true）
+  bool answer() {
+    uint32_t sourceIp;
+    uint16_t sourcePort;
+    int n = port_.receive(query_, sizeof(query_), sourceIp, sourcePort);
+    if (n <= 0) return false;
+    size_t length = buildDnsReply(query_, (size_t)n, ip_, ttl_, reply_, sizeof(reply_));
+    if (length > 0) {
+      port_.send(sourceIp, sourcePort, reply_, length);
+    } else {
+      dropped_++;
+    }
+    return true;
+  }
+
+  uint32_t dropped() const { return dropped_; }
+
+ private:
+  DatagramPort port_;
+  uint32_t ip_ = 0;
+  uint32_t ttl_ = 0;
+  uint32_t dropped_ = 0;
+  uint8_t query_[DNS_MAX_PACKET];
+  uint8_t reply_[DNS_MAX_PACKET + DNS_ANSWER_SIZE];
+};
+
+// 门户HTTP计数
+struct PortalStats {
+  uint32_t probes;       // 已知检测URL（直接回固定响应）
+  uint32_t redirects;    // 其他未知URL（重定向到控制页面）
+};
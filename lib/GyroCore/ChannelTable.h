@@ -0,0 +1,137 @@
+#pragma once
+#include <stdint.h>
+#include "MotionFilter.h"
+
+// ===================== 数据驱动的舵机通道表 =====================
+// 通道按连续数组存放，下标即LEDC通道号（ESP32共16个）。每个通道选择一个输入轴，
+// 映射与PWM更新都是对数组的一次线性循环，新增舵机只需增加表项，不再复制代码。
+// 映射在0.01°整数域内完成（二进制帧本身就是0.01°），每通道的定点系数只在配置变化时重算。
+// 每通道带滞回死区：手机静止时的传感器噪声不会改变映射结果，mapChannels()返回变化掩码，
+// 没有任何通道变化时调用方跳过后续的PWM投递与遥测。
+
+const int MAX_SERVO_CHANNELS = 16;   // ESP32 LEDC通道数
+const int INPUT_AXES = 3;            // 手机姿态输入轴数
+const int SERVO_CENTER_PULSE = 1500; // 中位脉宽（us）
+const int32_t MAPPED_LIMIT_CENTI = 18000; // 映射角度范围±180°（0.01°）
+const float DEFAULT_DEADBAND = 0.2f; // 默认死区（°），约为手机静止时的姿态噪声
+
+enum InputAxis {
+  AXIS_PITCH = 0,
+  AXIS_ROLL = 1,
+  AXIS_YAW = 2
+};
+
+// 通道配置结构体
+typedef struct {
+  int32_t rawCenti;        // 原始传感器值（0.01°，所选输入轴）
+  int32_t mappedCenti;     // 映射后的值（0.01°）
+  float rate;              // 感度倍率（增益，us/°）
+  float offset;            // 姿态归零偏移量（°）
+  int pulseWidth;          // 当前脉宽
+  int minPulse;            // 最小脉宽
+  int maxPulse;            // 最大脉宽
+  int pin;                 // GPIO引脚（-1表示未启用）
+  int axis;                // 输入轴（InputAxis）
+  FilterConfig filter;     // 平滑滤波配置
+  int32_t offsetCenti;     // 预计算：偏移量（0.01°）
+  int32_t pulsePerCentiQ16; // 预计算：每0.01°对应的脉宽（Q16）
+  float deadband;          // 死区（°），输入变化不超过该值时保持上次映射结果
+  int32_t deadbandCenti;   // 预计算：死区（0.01°）
+  bool tracking;           // 运行状态：上一帧越过死区（跟随中，阈值减半）
+} ChannelConfig;
+
+// 映射结果：各通道是否变化（位掩码，位i对应通道i）
+typedef struct {
+  uint16_t mappedChanged;  // 映射角度变化
+  uint16_t pulseChanged;   // 脉宽变化
+} MapResult;
+
+// 角度（°）与0.01°整数之间的换算（四舍五入）
+inline int32_t degreesToCenti(float degrees) {
+  float centi = degrees * 100.0f;
+  return (int32_t)(centi >= 0 ? centi + 0.5f : centi - 0.5f);
+}
+
+inline float centiToDegrees(int32_t centi) {
+  return centi * 0.01f;
+}
+
+// 由rate/offset重算定点系数（配置变化时调用）
+inline void prepareChannel(ChannelConfig& ch) {
+  ch.offsetCenti = degreesToCenti(ch.offset);
+  float q16 = ch.rate * (65536.0f / 100.0f);
+  ch.pulsePerCentiQ16 = (int32_t)(q16 >= 0 ? q16 + 0.5f : q16 - 0.5f);
+  ch.deadbandCenti = ch.deadband > 0 ? degreesToCenti(ch.deadband) : 0;
+}
+
+inline ChannelConfig defaultChannelConfig(int pin, int axis) {
+  ChannelConfig ch;
+  ch.rawCenti = 0;
+  ch.mappedCenti = 0;
+  ch.rate = 5.55f;                     // 默认感度倍率
+  ch.offset = 0.0f;
+  ch.pulseWidth = SERVO_CENTER_PULSE;  // 中心位置
+  ch.minPulse = 500;                   // 最小脉宽
+  ch.maxPulse = 2500;                  // 最大脉宽
+  ch.pin = pin;
+  ch.axis = axis;
+  ch.filter = defaultFilterConfig();   // 默认不滤波
+  ch.deadband = DEFAULT_DEADBAND;
+  ch.tracking = false;
+  prepareChannel(ch);
+  return ch;
+}
+
+// 校正非法配置（输入轴越界、上下限颠倒），并重算定点系数
+inline void sanitizeChannel(ChannelConfig& ch) {
+  if (ch.axis < 0 || ch.axis >= INPUT_AXES) ch.axis = AXIS_PITCH;
+  if (ch.minPulse > ch.maxPulse) {
+    int t = ch.minPulse;
+    ch.minPulse = ch.maxPulse;
+    ch.maxPulse = t;
+  }
+  prepareChannel(ch);
+}
+
+// 映射内核（整数）：原始角度 -> 映射角度（扣除偏移，限制在±180°）-> 脉宽（限制在上下限内）
+// 输出脉宽 = 1500 + floor(映射角度 * rate)；updatePulse为false时只更新角度（控制未启用）
+// 死区带滞回：静止时变化超过deadband才更新映射角度，跟随中阈值降为一半，
+// 一旦某帧未越过阈值即回到静止状态。force为true时忽略死区（姿态归零后立即生效）。
+// 脉宽每次都由当前映射角度重算，配置（rate、上下限）变化在下一帧即生效。
+inline MapResult mapChannels(ChannelConfig* channels, int count, const int32_t* axisCenti,
+                             bool updatePulse, bool force = false) {
+  MapResult result = { 0, 0 };
+  for (int i = 0; i < count; i++) {
+    ChannelConfig& ch = channels[i];
+    int32_t raw = axisCenti[ch.axis];
+    int32_t mapped = raw - ch.offsetCenti;
+    if (mapped < -MAPPED_LIMIT_CENTI) mapped = -MAPPED_LIMIT_CENTI;
+    else if (mapped > MAPPED_LIMIT_CENTI) mapped = MAPPED_LIMIT_CENTI;
+    ch.rawCenti = raw;
+
+    int32_t delta = mapped - ch.mappedCenti;
+    if (delta < 0) delta = -delta;
+    int32_t threshold = ch.tracking ? ch.deadbandCenti / 2 : ch.deadbandCenti;
+    if (force || (delta > 0 && delta >= threshold)) {
+      ch.tracking = !force && delta > 0;
+      if (delta > 0) {
+        ch.mappedCenti = mapped;
+        result.mappedChanged |= (uint16_t)(1u << i);
+      }
+    } else {
+      ch.tracking = false;
+    }
+
+    if (updatePulse) {
+      int32_t offset = (int32_t)(((int64_t)ch.mappedCenti * ch.pulsePerCentiQ16) >> 16);
+      int pulse = SERVO_CENTER_PULSE + offset;
+      if (pulse < ch.minPulse) pulse = ch.minPulse;
+      else if (pulse > ch.maxPulse) pulse = ch.maxPulse;
+      if (pulse != ch.pulseWidth) {
+        ch.pulseWidth = pulse;
+        result.pulseChanged |= (uint16_t)(1u << i);
+      }
+    }
+  }
+  return result;
+}
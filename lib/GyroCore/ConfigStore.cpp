@@ -0,0 +1,56 @@
+#include "ConfigStore.h"
+
+#if defined(ARDUINO)
+#include <Preferences.h>
+
+namespace {
+const char* const CONFIG_NAMESPACE = "gyro";
+}
+
+bool readConfigBlob(const char* key, uint8_t* out, size_t capacity, size_t& length) {
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_NAMESPACE, true)) return false;
+  length = prefs.getBytesLength(key);
+  bool ok = length > 0;
+  if (ok && length <= capacity) {
+    ok = prefs.getBytes(key, out, length) == length;
+  }
+  prefs.end();
+  return ok;
+}
+
+bool writeConfigBlob(const char* key, const uint8_t* data, size_t length) {
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_NAMESPACE, false)) return false;
+  bool ok = prefs.putBytes(key, data, length) == length;
+  prefs.end();
+  return ok;
+}
+
+#else
+#include <map>
+#include <string>
+#include <vector>
+
+// 主机：进程内存储（仿真中模拟掉电重启时可保留）
+namespace {
+std::map<std::string, std::vector<uint8_t>>& configBlobs() {
+  static std::map<std::string, std::vector<uint8_t>> blobs;
+  return blobs;
+}
+}  // namespace
+
+bool readConfigBlob(const char* key, uint8_t* out, size_t capacity, size_t& length) {
+  auto it = configBlobs().find(key);
+  if (it == configBlobs().end()) return false;
+  length = it->second.size();
+  if (length > 0 && length <= capacity) memcpy(out, it->second.data(), length);
+  return true;
+}
+
+bool writeConfigBlob(const char* key, const uint8_t* data, size_t length) {
+  configBlobs()[key].assign(data, data + length);
+  return true;
+}
+
+#endif
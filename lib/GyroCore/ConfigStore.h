@@ -0,0 +1,147 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ===================== 持久化配置 =====================
+// 配置按二进制块存入NVS（Preferences）：头部含魔数、版本号、长度和CRC32，
+// 任一项不符即视为无效并回退到默认配置。结构体布局变化时提升版本号，旧数据自动作废。
+// 写入经过防抖：配置连续稳定一段时间后才提交一次，流式更新不会反复擦写flash。
+// 编解码与防抖不依赖硬件，可在主机上测试；存储后端在ESP32上为Preferences，主机上为内存。
+
+const uint32_t CONFIG_BLOB_MAGIC = 0x47464347;  // "GCFG"
+
+struct ConfigBlobHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;      // 负载字节数
+  uint32_t crc;       // 负载CRC32
+};
+
+enum ConfigLoadResult : uint8_t {
+  CONFIG_LOADED,
+  CONFIG_MISSING,
+  CONFIG_BAD_MAGIC,
+  CONFIG_BAD_VERSION,
+  CONFIG_BAD_SIZE,
+  CONFIG_BAD_CRC
+};
+
+// CRC-32（IEEE 802.3，逐位计算；只在加载和提交时运行）
+inline uint32_t configCrc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+// 负载已位于blob + sizeof(ConfigBlobHeader)时原地写入头部（变长数据用），返回总字节数
+inline size_t sealConfigBlob(uint8_t* blob, uint16_t size, uint16_t version) {
+  ConfigBlobHeader header = { CONFIG_BLOB_MAGIC, version, size,
+                              configCrc32(blob + sizeof(ConfigBlobHeader), size) };
+  memcpy(blob, &header, sizeof(header));
+  return sizeof(header) + size;
+}
+
+// 编码：返回写入的字节数，空间不足返回0
+inline size_t encodeConfigBlob(const void* payload, uint16_t size, uint16_t version,
+                               uint8_t* out, size_t capacity) {
+  if (capacity < sizeof(ConfigBlobHeader) + size) return 0;
+  memcpy(out + sizeof(ConfigBlobHeader), payload, size);
+  return sealConfigBlob(out, size, version);
+}
+
+// 解码：校验通过才写入payload
+inline ConfigLoadResult decodeConfigBlob(const uint8_t* blob, size_t length, uint16_t version,
+                                         void* payload, uint16_t size) {
+  if (length == 0) return CONFIG_MISSING;
+  if (length < sizeof(ConfigBlobHeader)) return CONFIG_BAD_SIZE;
+  ConfigBlobHeader header;
+  memcpy(&header, blob, sizeof(header));
+  if (header.magic != CONFIG_BLOB_MAGIC) return CONFIG_BAD_MAGIC;
+  if (header.version != version) return CONFIG_BAD_VERSION;
+  if (header.size != size || length != sizeof(header) + size) return CONFIG_BAD_SIZE;
+  if (configCrc32(blob + sizeof(header), size) != header.crc) return CONFIG_BAD_CRC;
+  memcpy(payload, blob + sizeof(header), size);
+  return CONFIG_LOADED;
+}
+
+// 变长解码：校验整块，通过后负载位于blob + sizeof(ConfigBlobHeader)，长度写入size
+inline ConfigLoadResult openConfigBlob(const uint8_t* blob, size_t length, uint16_t version, uint16_t& size) {
+  if (length == 0) return CONFIG_MISSING;
+  if (length < sizeof(ConfigBlobHeader)) return CONFIG_BAD_SIZE;
+  ConfigBlobHeader header;
+  memcpy(&header, blob, sizeof(header));
+  if (header.magic != CONFIG_BLOB_MAGIC) return CONFIG_BAD_MAGIC;
+  if (header.version != version) return CONFIG_BAD_VERSION;
+  if (length != sizeof(header) + header.size) return CONFIG_BAD_SIZE;
+  if (configCrc32(blob + sizeof(header), header.size) != header.crc) return CONFIG_BAD_CRC;
+  size = header.size;
+  return CONFIG_LOADED;
+}
+
+inline const char* configLoadResultName(ConfigLoadResult result) {
+  switch (result) {
+    case CONFIG_LOADED: return "loaded";
+    case CONFIG_MISSING: return "missing";
+    case CONFIG_BAD_MAGIC: return "bad magic";
+    case CONFIG_BAD_VERSION: return "version mismatch";
+    case CONFIG_BAD_SIZE: return "bad size";
+    case CONFIG_BAD_CRC: return "bad crc";
+  }
+  return "unknown";
+}
+
+// 写入防抖：markDirty()后配置需保持quietMs不变，due()才返回一次true
+class ConfigDebouncer {
+ public:
+  explicit ConfigDebouncer(uint32_t quietMs) : quietMs_(quietMs) {}
+
+  void markDirty(uint32_t nowMs) {
+    dirty_ = true;
+    lastChangeMs_ = nowMs;
+  }
+
+  bool due(uint32_t nowMs) {
+    if (!dirty_ || nowMs - lastChangeMs_ < quietMs_) return false;
+    dirty_ = false;
+    commits_++;
+    return true;
+  }
+
+  bool dirty() const { return dirty_; }
+  uint32_t commits() const { return commits_; }
+
+ private:
+  uint32_t quietMs_;
+  uint32_t lastChangeMs_ = 0;
+  bool dirty_ = false;
+  uint32_t commits_ = 0;
+};
+
+// 存储后端（ConfigStore.cpp）；块比capacity长时只返回长度，不拷贝
+bool readConfigBlob(const char* key, uint8_t* out, size_t capacity, size_t& length);
+bool writeConfigBlob(const char* key, const uint8_t* data, size_t length);
+
+// 读取并校验配置，失败时out保持不变
+template <typename T>
+ConfigLoadResult loadStoredConfig(const char* key, uint16_t version, T& out) {
+  uint8_t blob[sizeof(ConfigBlobHeader) + sizeof(T)];
+  size_t length = 0;
+  if (!readConfigBlob(key, blob, sizeof(blob), length)) return CONFIG_MISSING;
+  if (length > sizeof(blob)) return CONFIG_BAD_SIZE;
+  return decodeConfigBlob(blob, length, version, &out, sizeof(T));
+}
+
+// 编码并写入配置
+template <typename T>
+bool storeConfig(const char* key, uint16_t version, const T& in) {
+  static_assert(sizeof(T) <= 0xFFFF, "config blob too large");
+  uint8_t blob[sizeof(ConfigBlobHeader) + sizeof(T)];
+  size_t length = encodeConfigBlob(&in, sizeof(T), version, blob, sizeof(blob));
+  return length > 0 && writeConfigBlob(key, blob, length);
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <stdint.h>
+
+// ===================== 固定频率控制环 =====================
+// 网络回调只把最新目标投递到单槽邮箱；控制环按固定频率（默认与50Hz PWM帧对齐）取出
+// 最新目标，并且仅在占空比变化时才写ledc，避免一个PWM周期内的重复写入。
+// 输入没有带来任何变化时整条下游（投递、PWM、遥测）都跳过，由SuppressionStats计数。
+
+// 单槽邮箱：只保留最新值，未被取走就被覆盖的输入计为合并（coalesced）。
+// 不带同步，投递与取出须在同一任务（控制侧内部）；跨核传递用SpscRing/IngressQueue
+template <typename T>
+class Mailbox {
+ public:
+  void post(const T& value) {
+    if (pending_) coalesced_++;
+    value_ = value;
+    pending_ = true;
+    posted_++;
+  }
+
+  bool take(T& out) {
+    if (!pending_) return false;
+    out = value_;
+    pending_ = false;
+    return true;
+  }
+
+  uint32_t posted() const { return posted_; }
+  uint32_t coalesced() const { return coalesced_; }
+
+ private:
+  T value_{};
+  bool pending_ = false;
+  uint32_t posted_ = 0;
+  uint32_t coalesced_ = 0;
+};
+
+// 固定频率节拍：due()在到期时返回true，落后超过一个周期时直接对齐到当前时间并计入overruns
+class FixedRateTicker {
+ public:
+  explicit FixedRateTicker(uint32_t rateHz) { setRate(rateHz); }
+
+  void setRate(uint32_t rateHz) {
+    periodUs_ = rateHz > 0 ? 1000000UL / rateHz : 1000000UL;
+  }
+
+  bool due(uint32_t nowUs) {
+    if (!started_) {
+      started_ = true;
+      nextUs_ = nowUs + periodUs_;
+      ticks_++;
+      return true;
+    }
+    if ((int32_t)(nowUs - nextUs_) < 0) return false;
+    nextUs_ += periodUs_;
+    if ((int32_t)(nowUs - nextUs_) >= 0) {
+      overruns_++;
+      nextUs_ = nowUs + periodUs_;
+    }
+    ticks_++;
+    return true;
+  }
+
+  uint32_t periodUs() const { return periodUs_; }
+  uint32_t nextUs() const { return nextUs_; }  // 下一个节拍的时刻
+  uint32_t ticks() const { return ticks_; }
+  uint32_t overruns() const { return overruns_; }
+
+ private:
+  uint32_t periodUs_ = 20000;
+  uint32_t nextUs_ = 0;
+  bool started_ = false;
+  uint32_t ticks_ = 0;
+  uint32_t overruns_ = 0;
+};
+
+// 占空比缓存：记录每通道上次写入的值，未变化时跳过写入
+template <int N>
+class DutyCache {
+ public:
+  DutyCache() { invalidate(); }
+
+  // 返回true表示需要写入（并记下新值）
+  bool update(int channel, uint32_t duty) {
+    if (channel < 0 || channel >= N) return false;
+    if (valid_[channel] && last_[channel] == duty) {
+      skipped_++;
+      return false;
+    }
+    last_[channel] = duty;
+    valid_[channel] = true;
+    written_++;
+    return true;
+  }
+
+  void invalidate() {
+    for (int i = 0; i < N; i++) valid_[i] = false;
+  }
+
+  uint32_t written() const { return written_; }
+  uint32_t skipped() const { return skipped_; }
+
+ private:
+  uint32_t last_[N];
+  bool valid_[N];
+  uint32_t written_ = 0;
+  uint32_t skipped_ = 0;
+};
+
+// 变化抑制计数：每个输入帧/节拍记一次，未产生变化（下游被跳过）的计入suppressed
+class SuppressionStats {
+ public:
+  void record(bool changed) {
+    total_++;
+    if (!changed) suppressed_++;
+  }
+
+  uint32_t total() const { return total_; }
+  uint32_t suppressed() const { return suppressed_; }
+
+  // 抑制比例（千分比），用于打印
+  uint32_t permille() const {
+    return total_ > 0 ? (uint32_t)((uint64_t)suppressed_ * 1000 / total_) : 0;
+  }
+
+ private:
+  uint32_t total_ = 0;
+  uint32_t suppressed_ = 0;
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "ChannelTable.h"
+#include "GyroFrame.h"
+#include "GyroText.h"
+#include "ServoOutput.h"
+
+// ===================== 控制流水线（编译期特化） =====================
+// 输入解码 -> 映射 -> 输出级，三段都是模板策略，由各固件与PlatformIO环境的编译开关选定，
+// 热路径上不再有“这条消息是什么格式/这个固件怎么映射”的运行时字符串判断：
+// - 输入策略：把一条消息解码成本固件的输入并分类，调用方按ControlInputKind分派；
+//   AngleInput（V1）：二进制姿态帧、IMU批量帧；JSON文本一遍扫描，按顶层键分为姿态或配置消息；
+//   PulseInput（V2）：二进制脉宽帧。V2的JSON消息里通道数组、滤波键和轨迹可以任意组合，
+//   仍由ArduinoJson整体解析，decodeText()不认领；
+// - 映射策略：输入 -> 各通道目标脉宽；
+//   ChannelTableMapping（V1）：设备端按通道表映射（mapChannels：偏移、死区、限幅）；
+//   ClientPulseMapping（V2）：浏览器已算好脉宽，帧内各通道的引脚/脉宽原样成为指令；
+// - 输出级：ServoOutput（通道数、滤波策略、写入函数）。
+// 固件按 -D INPUT_MODE 选定输入与映射（见 src/main.cpp），同一份main.cpp编译出两种固件。
+// 解码与映射是无状态的静态函数（解码在网络侧调用，映射在各固件原来的位置调用），
+// 输出级在控制侧节拍内运行。纯逻辑，主机基准测试 tools/pipeline_bench.cpp 用同一组类型。
+
+enum ControlInputKind : uint8_t {
+  CONTROL_INPUT_NONE,       // 无法解码或不是本固件的控制消息
+  CONTROL_INPUT_ANGLE,      // 姿态帧（二进制或JSON），Message::frame
+  CONTROL_INPUT_IMU_BATCH,  // IMU批量帧，Message::batch
+  CONTROL_INPUT_PULSE,      // 脉宽帧，Message::frame
+  CONTROL_INPUT_CONFIG      // JSON配置消息（只分类，字段表在固件中，由调用方解析）
+};
+
+// V1：姿态输入
+struct AngleInput {
+  struct Message {
+    GyroFrame frame;
+    ImuBatch batch;
+  };
+  static const size_t maxBinarySize = IMU_BATCH_MAX_SIZE;
+
+  // 帧序号（UDP序号闸门按它过滤迟到/重复的数据报）
+  static uint16_t sequence(const Message& in, ControlInputKind kind) {
+    return kind == CONTROL_INPUT_IMU_BATCH ? in.batch.seq : in.frame.seq;
+  }
+
+  static ControlInputKind decodeBinary(const uint8_t* payload, size_t length, Message& out) {
+    if (decodeGyroFrame(payload, length, out.frame) && out.frame.kind == GYRO_FRAME_ANGLE) return CONTROL_INPUT_ANGLE;
+    if (decodeImuBatch(payload, length, out.batch)) return CONTROL_INPUT_IMU_BATCH;
+    return CONTROL_INPUT_NONE;
+  }
+
+  // 姿态消息在分类的同一遍扫描中解出，配置消息不再重复分类
+  static ControlInputKind decodeText(const uint8_t* payload, size_t length, Message& out) {
+    GyroTextMessage text;
+    scanGyroText(payload, length, text);
+    switch (gyroTextKind(text)) {
+      case GYRO_TEXT_ANGLE:
+        gyroTextToFrame(text, out.frame);
+        return CONTROL_INPUT_ANGLE;
+      case GYRO_TEXT_CONFIG:
+        return CONTROL_INPUT_CONFIG;
+      default:
+        return CONTROL_INPUT_NONE;
+    }
+  }
+};
+
+// V2：脉宽输入
+struct PulseInput {
+  struct Message {
+    GyroFrame frame;
+  };
+  static const size_t maxBinarySize = GYRO_FRAME_SIZE;
+
+  static uint16_t sequence(const Message& in, ControlInputKind) { return in.frame.seq; }
+
+  static ControlInputKind decodeBinary(const uint8_t* payload, size_t length, Message& out) {
+    return decodeGyroFrame(payload, length, out.frame) && out.frame.kind == GYRO_FRAME_PULSE ? CONTROL_INPUT_PULSE
+                                                                                            : CONTROL_INPUT_NONE;
+  }
+
+  static ControlInputKind decodeText(const uint8_t*, size_t, Message&) { return CONTROL_INPUT_NONE; }
+};
+
+// V1：设备端按通道表映射三轴姿态（0.01°）；updatePulse为false时只更新映射角度
+struct ChannelTableMapping {
+  static MapResult map(ChannelConfig* channels, int count, const int32_t* axisCenti, bool updatePulse,
+                       bool force = false) {
+    return mapChannels(channels, count, axisCenti, updatePulse, force);
+  }
+};
+
+// V2：帧内第i项即PWM通道i的引脚与脉宽（引脚为-1的通道不更新）。
+// Command须有 pin[]/pulseUs[] 两个数组，帧之外的通道由调用方预先置为不更新
+struct ClientPulseMapping {
+  template <typename Command>
+  static void map(const GyroFrame& frame, Command& cmd) {
+    for (int i = 0; i < GYRO_FRAME_AXES; i++) {
+      cmd.pin[i] = frame.pin[i];
+      cmd.pulseUs[i] = frame.value[i];
+    }
+  }
+};
+
+template <typename InputPolicy, typename MappingPolicy, typename OutputStage>
+class ControlPipeline {
+ public:
+  typedef InputPolicy Input;
+  typedef MappingPolicy Mapping;
+  typedef OutputStage Output;
+  typedef typename InputPolicy::Message Message;
+  static constexpr int channels = OutputStage::channels;
+
+  ControlPipeline(int resolutionBits, uint32_t periodUs) : output_(resolutionBits, periodUs) {}
+
+  // 网络侧：解码并分类
+  static ControlInputKind decodeBinary(const uint8_t* payload, size_t length, Message& out) {
+    return Input::decodeBinary(payload, length, out);
+  }
+  static ControlInputKind decodeText(const uint8_t* payload, size_t length, Message& out) {
+    return Input::decodeText(payload, length, out);
+  }
+
+  // 控制侧：输出级
+  Output& output() { return output_; }
+  const Output& output() const { return output_; }
+
+ private:
+  Output output_;
+};
@@ -0,0 +1,355 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <strings.h>
+#include <Arduino.h>
+#include <WebServer.h>
+#include <WebSocketsServer.h>
+#include "CaptivePortal.h"
+#include "ControlPipeline.h"
+#include "ControllerLease.h"
+#include "DatagramPort.h"
+#include "HeapMonitor.h"
+#include "IngressQueue.h"
+#include "LatencyProbe.h"
+#include "SequenceGate.h"
+#include "TextWriter.h"
+
+// ===================== 网络侧公共部分 =====================
+// 姿态角输入与脉宽输入两种固件共用的网络侧：强制门户（限额DNS、联网检测快速响应、未知URL重定向）、
+// 控制页面（flash中的gzip页面与ETag协商）、/metrics、控制权租约、入口背压通知、堆健康，
+// 以及UDP控制通道（序号闸门、来源IP对应到WebSocket连接）。
+// 消息怎么解码、解码后交给谁由固件决定：UDP数据报按编译期选定的控制流水线解码后回调固件。
+// 只在网络侧调用（单核模式下即loop()，双核模式下为核0上的网络任务）。
+
+#ifndef UDP_CONTROL
+#define UDP_CONTROL 0
+#endif
+
+// 主机字节序的IPv4地址（与DatagramPort的来源地址一致）
+inline uint32_t ipKey(const IPAddress& ip) {
+  return ((uint32_t)ip[0] << 24) | ((uint32_t)ip[1] << 16) | ((uint32_t)ip[2] << 8) | ip[3];
+}
+
+inline uint32_t readFreeHeap() {
+  return ESP.getFreeHeap();
+}
+
+inline HeapReading readHeap() {
+  HeapReading reading = { ESP.getFreeHeap(), ESP.getMaxAllocHeap(), ESP.getMinFreeHeap() };
+  return reading;
+}
+
+// 堆健康（JSON片段，不含外层括号）
+#define HEAP_STATS_FORMAT \
+  "\"heap\":{\"free\":%u,\"largestBlock\":%u,\"lowestLargestBlock\":%u,\"minFree\":%u," \
+  "\"fragmentationPermille\":%u,\"frames\":%u,\"changedFrames\":%u,\"maxFrameDrop\":%u}"
+
+// 构建时压缩进flash的控制页面（tools/embed_html.py生成的index_html_gz.h）
+struct EmbeddedPage {
+  const uint8_t* gz;
+  size_t length;
+  const char* etag;
+};
+
+struct ControlServerConfig {
+  uint32_t apIp;                  // 热点地址（主机字节序），通配DNS的应答地址
+  uint16_t dnsPort;
+  uint32_t dnsTtlSeconds;         // TTL较长，客户端缓存解析结果、减少重复查询
+  uint32_t dnsAnswersPerWindow;   // DNS应答按时间窗限额
+  uint32_t dnsWindowMs;
+  const char* portalUrl;          // 未知URL重定向到的控制页面
+  uint32_t leaseTimeoutMs;        // 持有者超过该时间无控制帧则其他客户端可接管
+  uint16_t udpPort;
+  uint32_t udpSourceIdleMs;       // 当前发送端静默超过该时间才接受新的发送端
+  int udpPollBudget;              // 每轮最多处理的数据报数
+  uint32_t statsIntervalMs;       // 门户/UDP统计（有新请求时才打印）
+  uint32_t heapReportIntervalMs;  // 堆健康定期打印
+};
+
+// WebServer的uri()/header()按值返回String，header()还先把请求头名构造成String，每个请求都在堆上复制；
+// 这里直接读当前请求已收集的请求头，按引用与常量比较
+class PortalWebServer : public WebServer {
+ public:
+  explicit PortalWebServer(int port) : WebServer(port) {}
+
+  // collectHeaders()登记过的请求头（请求中没有该头时值为空串；未登记返回nullptr）
+  const String* requestHeader(const char* name) const {
+    for (int i = 0; i < _headerKeysCount; i++) {
+      if (strcasecmp(_currentHeaders[i].key.c_str(), name) == 0) return &_currentHeaders[i].value;
+    }
+    return nullptr;
+  }
+};
+
+// clients为WebSocket连接数；独立UDP发送端（来源IP没有WebSocket连接）使用槽位/租约号clients
+class ControlServer {
+ public:
+  static const uint8_t UDP_CLIENT = WEBSOCKETS_SERVER_CLIENT_MAX;
+
+  ControlServer(PortalWebServer& http, WebSocketsServer& ws, const ControlServerConfig& config)
+      : http_(http), ws_(ws), config_(config), dnsBudget_(config.dnsAnswersPerWindow, config.dnsWindowMs),
+        lease_(config.leaseTimeoutMs)
+#if UDP_CONTROL
+        , udpGate_(config.udpSourceIdleMs)
+#endif
+  {}
+
+  // 启动DNS、HTTP、WebSocket（以及UDP控制通道），并记录堆健康基线
+  void begin(const EmbeddedPage& page, WebSocketsServer::WebSocketServerEvent onEvent) {
+    page_ = page;
+    dns_.start(config_.dnsPort, config_.apIp, config_.dnsTtlSeconds);
+    Serial.println("[DNS服务器] 已启动，所有域名重定向到ESP32");
+
+    // 需要读取的请求头（用于ETag协商）
+    static const char* headerKeys[] = { "If-None-Match" };
+    http_.collectHeaders(headerKeys, 1);
+    http_.on("/", [this]() { handleRoot(); });
+    // 每个检测URL单独登记，处理时不必再取请求URL查表
+    for (int i = 0; i < CAPTIVE_PROBE_COUNT; i++) {
+      const CaptiveProbe* probe = &CAPTIVE_PROBES[i];
+      http_.on(probe->uri, [this, probe]() { handleCaptiveProbe(*probe); });
+    }
+    http_.onNotFound([this]() { handleNotFound(); });
+#if LATENCY_PROBES
+    http_.on("/metrics", [this]() { handleMetrics(); });
+#endif
+    http_.begin();
+    Serial.println("[Web服务器] 已启动");
+
+    ws_.begin();
+    ws_.onEvent(onEvent);
+    Serial.println("[WebSocket服务器] 已启动");
+
+#if UDP_CONTROL
+    if (udp_.begin(config_.udpPort)) {
+      Serial.printf("[UDP控制] 已启动，端口: %d\n", config_.udpPort);
+    } else {
+      Serial.printf("[UDP控制] 端口%d绑定失败\n", config_.udpPort);
+    }
+#endif
+
+    // 堆健康基线（此后的下降即运行期间的分配和碎片）
+    heap_.sample(readHeap());
+    printHeapHealth();
+  }
+
+  // DNS（受应答预算限制）、HTTP、WebSocket，再处理UDP控制数据报。
+  // UDP数据报通过序号闸门和租约后调用 onDatagram(客户端号, 消息类型, 解码结果)
+  template <typename Pipeline, typename Handler>
+  void poll(Handler onDatagram) {
+    if (dns_.pending() && dnsBudget_.allow(millis())) {
+      PROBE_SCOPE(PROBE_DNS);
+      if (dns_.answer()) dnsBudget_.answered();
+    }
+    http_.handleClient();
+    ws_.loop();
+#if UDP_CONTROL
+    pollUdp<Pipeline>(onDatagram);
+#else
+    (void)onDatagram;
+#endif
+  }
+
+  // 定期统计，返回本轮是否到了统计间隔（固件可在同一节奏打印自己的统计）
+  bool report(uint32_t nowMs) {
+    bool due = nowMs - lastStatsMs_ >= config_.statsIntervalMs;
+    if (due) {
+      uint32_t total = portal_.probes + portal_.redirects;
+      if (total != lastPortalTotal_) {
+        Serial.printf("[门户] 检测: %u, 重定向: %u, DNS应答: %u, DNS推迟: %u\n",
+                      portal_.probes, portal_.redirects, dnsBudget_.answers(), dnsBudget_.deferred());
+        lastPortalTotal_ = total;
+      }
+#if UDP_CONTROL
+      uint32_t udpTotal = udpGate_.accepted() + udpGate_.late() + udpGate_.foreign();
+      if (udpTotal != lastUdpTotal_) {
+        Serial.printf("[UDP控制] 接受: %u, 迟到丢弃: %u, 缺号: %u, 其他发送端: %u\n",
+                      udpGate_.accepted(), udpGate_.late(), udpGate_.gaps(), udpGate_.foreign());
+        lastUdpTotal_ = udpTotal;
+      }
+#endif
+      heap_.sample(readHeap());
+      lastStatsMs_ = nowMs;
+    }
+    if (nowMs - lastHeapReportMs_ >= config_.heapReportIntervalMs) {
+      printHeapHealth();
+      lastHeapReportMs_ = nowMs;
+    }
+    return due;
+  }
+
+  // 控制帧准入检查（在解析之前调用），非持有者只收到一次忙碌提示
+  bool admitControl(uint8_t num) {
+    if (!lease_.admit(num, millis())) {
+      if (lease_.shouldNotify(num)) {
+        ws_.sendTXT(num, "Controller busy");
+        Serial.printf("[租约] 客户端 #%u 的控制帧被拒绝（持有者 #%d）\n", num, lease_.holder());
+      }
+      return false;
+    }
+    if (lease_.isNewHolder(num)) {
+      lease_.ackGranted();
+      ws_.sendTXT(num, "Controller lease granted");
+      Serial.printf("[租约] 客户端 #%u 获得控制权\n", num);
+    }
+    return true;
+  }
+
+  // 姿态/脉宽帧投递到入口队列之后调用：合并比例越过阈值时通知客户端调整发送频率（独立UDP发送端不通知）
+  template <typename Ingress>
+  void notifyBackpressure(Ingress& ingress, uint8_t num) {
+    BackpressureSignal signal = ingress.pollBackpressure(num, millis());
+    if (signal == BACKPRESSURE_NONE || num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+    char message[80];
+    if (signal == BACKPRESSURE_ON) {
+      snprintf(message, sizeof(message), "{\"backpressure\":1,\"dropPermille\":%u,\"suggestHz\":%u}",
+               (unsigned)ingress.dropPermille(num), (unsigned)ingress.suggestedHz(num));
+    } else {
+      snprintf(message, sizeof(message), "{\"backpressure\":0}");
+    }
+    ws_.sendTXT(num, message);
+    Serial.printf("[入口] 客户端 #%u %s（合并比例 %u‰）\n", num,
+                  signal == BACKPRESSURE_ON ? "过载，请求降频" : "恢复", (unsigned)ingress.dropPermille(num));
+  }
+
+  // 堆健康：空闲/最大连续块/历史最低，以及控制帧期间空闲堆发生变化的帧数（应为0）
+  void printHeapHealth() {
+    const HeapReading& heap = heap_.last();
+    Serial.printf("[堆] 空闲: %u, 最大块: %u (最低%u), 历史最低: %u, 碎片: %u‰, 控制帧: %u, 堆变化帧: %u\n",
+                  (unsigned)heap.freeBytes, (unsigned)heap.largestBlock, (unsigned)heap_.lowestLargestBlock(),
+                  (unsigned)heap.minFreeBytes, (unsigned)heap_.fragmentationPermille(),
+                  (unsigned)heap_.frames(), (unsigned)heap_.changedFrames());
+  }
+
+  // 回复堆健康（HEAP_STATS_FORMAT）
+  void formatHeapStats(TextWriter& out) {
+    heap_.sample(readHeap());
+    const HeapReading& heap = heap_.last();
+    out.printf(HEAP_STATS_FORMAT,
+               (unsigned)heap.freeBytes, (unsigned)heap.largestBlock, (unsigned)heap_.lowestLargestBlock(),
+               (unsigned)heap.minFreeBytes, (unsigned)heap_.fragmentationPermille(),
+               (unsigned)heap_.frames(), (unsigned)heap_.changedFrames(),
+               (unsigned)heap_.maxFrameDrop());
+  }
+
+  ControllerLease& lease() { return lease_; }
+  HeapMonitor& heap() { return heap_; }
+#if UDP_CONTROL
+  const SequenceGate& udpGate() const { return udpGate_; }
+#endif
+
+ private:
+  // 联网检测请求：直接回固定的小响应，系统认为网络可用后不再重复检测
+  void handleCaptiveProbe(const CaptiveProbe& probe) {
+    portal_.probes++;
+    http_.send(probe.code, probe.contentType, probe.body);
+  }
+
+  // 其他未知URL（门户浏览器访问的任意地址）重定向到控制页面
+  void handleNotFound() {
+    portal_.redirects++;
+    http_.sendHeader("Location", config_.portalUrl);
+    http_.send(302, "text/plain", "");
+  }
+
+  // 控制页面：直接从flash发送；浏览器带回相同ETag时返回304，不再重复传输
+  void handleRoot() {
+    const String* match = http_.requestHeader("If-None-Match");
+    if (match && strcmp(match->c_str(), page_.etag) == 0) {
+      http_.sendHeader("ETag", page_.etag);
+      http_.send(304);
+      return;
+    }
+    http_.sendHeader("ETag", page_.etag);
+    http_.sendHeader("Cache-Control", "no-cache");
+    http_.sendHeader("Content-Encoding", "gzip");
+    http_.send_P(200, "text/html", (const char*)page_.gz, page_.length);
+  }
+
+#if LATENCY_PROBES
+  // 延迟直方图（Prometheus文本格式），按块直接写到连接上
+  static void sendMetricsChunk(void* ctx, const char* data, size_t length) {
+    static_cast<WebServer*>(ctx)->sendContent(data, length);
+  }
+
+  // 堆健康（gauge），与延迟直方图一起输出
+  void sendHeapMetrics() {
+    heap_.sample(readHeap());
+    const HeapReading& heap = heap_.last();
+    char buffer[384];
+    snprintf(buffer, sizeof(buffer),
+             "# TYPE gyro_heap_bytes gauge\n"
+             "gyro_heap_bytes{kind=\"free\"} %u\n"
+             "gyro_heap_bytes{kind=\"largest_block\"} %u\n"
+             "gyro_heap_bytes{kind=\"min_free\"} %u\n"
+             "gyro_heap_bytes{kind=\"lowest_largest_block\"} %u\n"
+             "# TYPE gyro_heap_frames_total counter\n"
+             "gyro_heap_frames_total{kind=\"control\"} %u\n"
+             "gyro_heap_frames_total{kind=\"heap_changed\"} %u\n",
+             (unsigned)heap.freeBytes, (unsigned)heap.largestBlock, (unsigned)heap.minFreeBytes,
+             (unsigned)heap_.lowestLargestBlock(), (unsigned)heap_.frames(),
+             (unsigned)heap_.changedFrames());
+    http_.sendContent(buffer);
+  }
+
+  void handleMetrics() {
+    http_.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    http_.send(200, "text/plain; version=0.0.4", "");
+    writeLatencyMetrics(sendMetricsChunk, &http_);
+    sendHeapMetrics();
+    http_.sendContent("");
+  }
+#endif
+
+#if UDP_CONTROL
+  // 数据报对应的客户端：来源IP已有WebSocket连接时沿用该连接，否则为独立UDP槽位
+  uint8_t udpClientFor(uint32_t sourceIp) {
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+      if (ipKey(ws_.remoteIP(i)) == sourceIp) return i;
+    }
+    return UDP_CLIENT;
+  }
+
+  // 处理UDP控制数据报（每轮有上限，不挤占WebSocket）
+  template <typename Pipeline, typename Handler>
+  void pollUdp(Handler& onDatagram) {
+    uint8_t buffer[Pipeline::Input::maxBinarySize + 1];   // 多一字节：超长数据报截断后长度不符，解码时丢弃
+    for (int n = 0; n < config_.udpPollBudget; n++) {
+      uint32_t sourceIp;
+      uint16_t sourcePort;
+      int length = udp_.receive(buffer, sizeof(buffer), sourceIp, sourcePort);
+      if (length <= 0) break;
+      PROBE_SCOPE(PROBE_PARSE);
+      HeapFrameScope heapScope(heap_, readFreeHeap);
+      typename Pipeline::Message input;
+      ControlInputKind kind = Pipeline::decodeBinary(buffer, length, input);
+      if (kind == CONTROL_INPUT_NONE) continue;
+      uint16_t seq = Pipeline::Input::sequence(input, kind);
+      if (udpGate_.admit(sourceIp, sourcePort, seq, millis()) != UDP_ACCEPTED) continue;
+      uint8_t num = udpClientFor(sourceIp);
+      bool admitted = num < WEBSOCKETS_SERVER_CLIENT_MAX ? admitControl(num) : lease_.admit(num, millis());
+      if (!admitted) continue;
+      onDatagram(num, kind, input);
+    }
+  }
+#endif
+
+  PortalWebServer& http_;
+  WebSocketsServer& ws_;
+  ControlServerConfig config_;
+  EmbeddedPage page_ = { nullptr, 0, "" };
+  CaptiveDns dns_;
+  DnsBudget dnsBudget_;
+  PortalStats portal_ = {};
+  ControllerLease lease_;
+  HeapMonitor heap_;
+#if UDP_CONTROL
+  DatagramPort udp_;              // 直接用套接字接收，不经过WiFiUDP的堆缓冲
+  SequenceGate udpGate_;          // 迟到/重复数据报过滤
+  uint32_t lastUdpTotal_ = 0;
+#endif
+  uint32_t lastStatsMs_ = 0;
+  uint32_t lastPortalTotal_ = 0;
+  uint32_t lastHeapReportMs_ = 0;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <stdint.h>
+
+// ===================== 控制权租约 =====================
+// 同一时刻只有一个WebSocket客户端可以驱动舵机。第一个发送控制帧的客户端获得租约，
+// 之后每个被接受的控制帧都会续约；超时无控制帧或断开连接时释放。
+// 其他客户端的控制帧在解析前即被拒绝，只能接收遥测。仅在网络侧使用。
+
+const int LEASE_NONE = -1;
+
+class ControllerLease {
+ public:
+  explicit ControllerLease(uint32_t timeoutMs) : timeoutMs_(timeoutMs) {}
+
+  // 判断client的控制帧能否进入流水线（无人持有或已超时则授予租约）
+  bool admit(uint8_t client, uint32_t nowMs) {
+    if (holder_ != (int)client && (holder_ == LEASE_NONE || nowMs - lastSeenMs_ >= timeoutMs_)) {
+      holder_ = client;
+      notified_ = 0;
+      granted_++;
+    }
+    if (holder_ == (int)client) {
+      lastSeenMs_ = nowMs;
+      return true;
+    }
+    rejected_++;
+    return false;
+  }
+
+  // 释放租约（仅持有者有效）
+  void release(uint8_t client) {
+    if (holder_ == (int)client) {
+      holder_ = LEASE_NONE;
+      notified_ = 0;
+    }
+  }
+
+  // 被拒绝的客户端在每次租约变更后只通知一次
+  bool shouldNotify(uint8_t client) {
+    uint32_t bit = 1UL << (client & 31);
+    if (notified_ & bit) return false;
+    notified_ |= bit;
+    return true;
+  }
+
+  // 刚授予租约（本次admit产生了新的持有者）时返回true，供回执使用
+  bool isNewHolder(uint8_t client) const { return holder_ == (int)client && grantedSeen_ != granted_; }
+  void ackGranted() { grantedSeen_ = granted_; }
+
+  int holder() const { return holder_; }
+  uint32_t granted() const { return granted_; }
+  uint32_t rejected() const { return rejected_; }
+
+ private:
+  uint32_t timeoutMs_;
+  int holder_ = LEASE_NONE;
+  uint32_t lastSeenMs_ = 0;
+  uint32_t notified_ = 0;
+  uint32_t granted_ = 0;
+  uint32_t grantedSeen_ = 0;
+  uint32_t rejected_ = 0;
+};
@@ -0,0 +1,113 @@
+#include "DatagramPort.h"
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <lwip/sockets.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+bool hostBind = false;
+uint16_t hostPortOverride = 0;
+}
+
+void DatagramPort::hostBindSockets(bool bind, uint16_t portOverride) {
+  hostBind = bind;
+  hostPortOverride = portOverride;
+}
+
+void DatagramPort::inject(uint32_t sourceIp, uint16_t sourcePort, const uint8_t* data, size_t length) {
+  Datagram d;
+  d.ip = sourceIp;
+  d.port = sourcePort;
+  d.data.assign(data, data + length);
+  injected_.push_back(d);
+}
+#endif
+
+DatagramPort::DatagramPort(bool replayTarget) {
+#if !defined(ARDUINO)
+  replayTarget_ = replayTarget;
+  if (replayTarget) current_ = this;
+#else
+  (void)replayTarget;
+#endif
+}
+
+bool DatagramPort::begin(uint16_t port) {
+  stop();
+#if !defined(ARDUINO)
+  if (!hostBind || !replayTarget_) return true;
+  if (hostPortOverride != 0) port = hostPortOverride;
+#endif
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) return false;
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+    close(fd);
+    return false;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  fd_ = fd;
+  return true;
+}
+
+void DatagramPort::stop() {
+  if (fd_ >= 0) close(fd_);
+  fd_ = -1;
+#if !defined(ARDUINO)
+  injected_.clear();
+#endif
+}
+
+int DatagramPort::receive(uint8_t* buffer, size_t capacity, uint32_t& sourceIp, uint16_t& sourcePort) {
+#if !defined(ARDUINO)
+  if (!injected_.empty()) {
+    Datagram& d = injected_.front();
+    size_t n = d.data.size() < capacity ? d.data.size() : capacity;
+    memcpy(buffer, d.data.data(), n);
+    sourceIp = d.ip;
+    sourcePort = d.port;
+    injected_.pop_front();
+    received_++;
+    return (int)n;
+  }
+#endif
+  if (fd_ < 0) return 0;
+  sockaddr_in from;
+  socklen_t fromLen = sizeof(from);
+  int n = (int)recvfrom(fd_, buffer, capacity, MSG_DONTWAIT, (sockaddr*)&from, &fromLen);
+  if (n <= 0) return 0;
+  sourceIp = ntohl(from.sin_addr.s_addr);
+  sourcePort = ntohs(from.sin_port);
+  received_++;
+  return n;
+}
+
+bool DatagramPort::pending() {
+#if !defined(ARDUINO)
+  if (!injected_.empty()) return true;
+#endif
+  if (fd_ < 0) return false;
+  uint8_t peek;
+  return recv(fd_, &peek, 1, MSG_PEEK | MSG_DONTWAIT) >= 0;
+}
+
+bool DatagramPort::send(uint32_t ip, uint16_t port, const uint8_t* data, size_t length) {
+  if (fd_ < 0) return false;
+  sockaddr_in to;
+  memset(&to, 0, sizeof(to));
+  to.sin_family = AF_INET;
+  to.sin_addr.s_addr = htonl(ip);
+  to.sin_port = htons(port);
+  return (int)sendto(fd_, data, length, 0, (sockaddr*)&to, sizeof(to)) == (int)length;
+}
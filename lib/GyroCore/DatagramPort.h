@@ -0,0 +1,56 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#if !defined(ARDUINO)
+#include <deque>
+#include <vector>
+#endif
+
+// ===================== UDP数据报端口 =====================
+// ESP32 Arduino的WiFiUDP::parsePacket()每次调用都先malloc一个1460字节的接收缓冲（没有数据报时也一样），
+// 有数据报时再拷进new出来的cbuf，控制通道每轮轮询一次就是持续的堆抖动。这里直接用BSD套接字
+// （ESP32上为lwIP，主机上为POSIX）：非阻塞recvfrom写入调用方的缓冲区，不分配内存。
+// 主机上另有回放注入：仿真驱动按日志把数据报排队（inject），只有hostBindSockets(true)之后
+// begin()才绑定真实端口（实时模式），回放时不占用本机端口。回放目标只有UDP控制通道一个，
+// 其他端口（强制门户DNS）构造时传false，主机上从不绑定，也不接收注入。
+
+class DatagramPort {
+ public:
+  explicit DatagramPort(bool replayTarget = true);
+
+  bool begin(uint16_t port);
+  void stop();
+
+  // 取一个数据报写入buffer，返回字节数（没有数据报返回0；超过capacity的部分被截断）。
+  // 来源地址为主机字节序的IPv4地址（a.b.c.d -> a<<24 | b<<16 | c<<8 | d）和端口
+  int receive(uint8_t* buffer, size_t capacity, uint32_t& sourceIp, uint16_t& sourcePort);
+
+  // 是否有待取的数据报（不取出）
+  bool pending();
+
+  // 向ipv4地址（主机字节序）与端口发送一个数据报
+  bool send(uint32_t ip, uint16_t port, const uint8_t* data, size_t length);
+
+  uint32_t received() const { return received_; }
+
+#if !defined(ARDUINO)
+  void inject(uint32_t sourceIp, uint16_t sourcePort, const uint8_t* data, size_t length);
+  static DatagramPort* current() { return current_; }
+  // 实时模式：允许绑定真实端口（portOverride非0时代替草图的端口），须在setup()之前调用
+  static void hostBindSockets(bool bind, uint16_t portOverride);
+#endif
+
+ private:
+  int fd_ = -1;
+  uint32_t received_ = 0;
+#if !defined(ARDUINO)
+  bool replayTarget_;
+  struct Datagram {
+    uint32_t ip;
+    uint16_t port;
+    std::vector<uint8_t> data;
+  };
+  std::deque<Datagram> injected_;
+  static inline DatagramPort* current_ = nullptr;
+#endif
+};
@@ -0,0 +1,71 @@
+#include "EventLog.h"
+#include <string.h>
+#include "TextWriter.h"
+
+namespace {
+
+const LogEventFormat EVENT_FORMATS[LOG_EVENT_COUNT] = {
+  { "[日志] 队列已满，丢失%u条事件", 0 },
+  { "[舵机脉宽] Pitch: %d, Roll: %d, Yaw: %d", 1000 },
+  { "[陀螺仪数据] Pitch: %a, Roll: %a, Yaw: %a, Control: %b", 1000 },
+  { "[WebSocket] 客户端 #%u 发送(%u字节): %s", 1000 },
+  { "[PWM] P(%d):%dus | R(%d):%dus | Y(%d):%dus", 100 },
+};
+
+const LogEventFormat UNKNOWN_FORMAT = { nullptr, 0 };
+
+}  // namespace
+
+const LogEventFormat& logEventFormat(uint16_t id) {
+  return id < LOG_EVENT_COUNT ? EVENT_FORMATS[id] : UNKNOWN_FORMAT;
+}
+
+size_t formatLogEvent(const LogEvent& event, char* out, size_t capacity) {
+  const char* format = logEventFormat(event.id).format;
+  if (!format || capacity < 2) return 0;
+  int argc = event.argc <= LOG_EVENT_ARGS ? event.argc : LOG_EVENT_ARGS;
+
+  // 预留换行符的位置
+  TextWriter line(out, capacity - 1);
+  line.printf("[%5u.%03u] ", (unsigned)(event.timeUs / 1000000), (unsigned)(event.timeUs / 1000 % 1000));
+  int arg = 0;
+  for (const char* p = format; *p; p++) {
+    if (*p != '%' || !p[1]) {
+      line.put(*p);
+      continue;
+    }
+    char spec = *++p;
+    if (spec == 's') {
+      // 文本占用其余全部参数：遇到0结束，填满时表示原文被截断
+      const char* text = (const char*)&event.args[arg];
+      size_t room = arg < argc ? (argc - arg) * sizeof(int32_t) : 0;
+      size_t n = strnlen(text, room);
+      line.append(text, n);
+      if (room > 0 && n == room) line.append("...", 3);
+      arg = argc;
+      continue;
+    }
+    if (arg >= argc) {
+      line.put('?');
+      continue;
+    }
+    int32_t value = event.args[arg++];
+    switch (spec) {
+      case 'd': line.printf("%d", (int)value); break;
+      case 'u': line.printf("%u", (unsigned)value); break;
+      case 'a': {
+        // 0.01° -> 一位小数（四舍五入到0.1°）
+        int32_t tenths = value >= 0 ? (value + 5) / 10 : (value - 5) / 10;
+        line.printf("%s%d.%d", tenths < 0 ? "-" : "", (int)((tenths < 0 ? -tenths : tenths) / 10),
+                    (int)((tenths < 0 ? -tenths : tenths) % 10));
+        break;
+      }
+      case 'b': line.append(value ? "Enabled" : "Disabled", value ? 7 : 8); break;
+      default: line.put('%'); line.put(spec); arg--; break;
+    }
+  }
+  size_t length = line.length();
+  out[length++] = '\n';
+  out[length] = '\0';
+  return length;
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "SpscRing.h"
+
+// ===================== 延迟二进制日志 =====================
+// 热路径里的Serial.printf要做浮点格式化，115200波特率下UART FIFO一满，一行就要阻塞几毫秒。
+// 这里热路径只记录定长二进制事件（事件号、微秒时刻、最多6个原始整数参数）到无锁环形队列，
+// 几次存储即可返回；格式化和串口输出都推迟到loop()的空闲时间，且只在串口发送缓冲放得下时才写，
+// 不会阻塞。每个事件按自己的间隔节流（互不影响），队列满时丢弃并计数，下次输出时报告丢失条数。
+// 每个生产侧（网络侧/控制侧）各用一个EventLog，保持单生产者单消费者。
+// EVENT_LOG_BINARY=1时串口直接输出原始事件记录，格式化交给主机工具 tools/logdecode.cpp。
+
+#ifndef EVENT_LOG_BINARY
+#define EVENT_LOG_BINARY 0
+#endif
+
+// 事件号（V1/V2共用一张表，格式见EventLog.cpp）
+enum LogEventId : uint16_t {
+  LOG_EVENTS_LOST,   // 队列满丢弃的事件数（输出时生成）
+  LOG_SERVO_PULSE,   // V1控制环：三轴脉宽
+  LOG_GYRO_DATA,     // V1控制侧：姿态角与控制状态
+  LOG_WS_TEXT,       // V1网络侧：收到的文本消息（只保留开头）
+  LOG_PULSE_FRAME,   // V2网络侧：三通道引脚与脉宽
+  LOG_EVENT_COUNT
+};
+
+const int LOG_EVENT_ARGS = 6;
+const size_t LOG_LINE_MAX = 120;          // 一行文本上限（小于ESP32 UART 128字节的发送FIFO）
+const uint8_t LOG_RECORD_SYNC[2] = { 0xFF, 'L' }; // 二进制记录前缀（0xFF不会出现在UTF-8文本中）
+const size_t LOG_RECORD_SIZE = 34;        // 前缀 + LogEvent
+
+// 32字节定长事件（小端，与二进制输出的记录体相同）
+struct LogEvent {
+  uint16_t id;
+  uint8_t argc;
+  uint8_t reserved;
+  uint32_t timeUs;
+  int32_t args[LOG_EVENT_ARGS];
+};
+static_assert(sizeof(LogEvent) == 32, "LogEvent须为32字节");
+
+// 事件格式：%d 有符号整数，%u 无符号整数，%a 角度（0.01°，输出一位小数），
+// %b 启用状态（Enabled/Disabled），%s 文本（占用其余全部参数，每个参数4字节）
+struct LogEventFormat {
+  const char* format;
+  uint32_t intervalMs;   // 同一事件的最短记录间隔，0为不节流
+};
+
+const LogEventFormat& logEventFormat(uint16_t id);
+
+// 格式化为一行文本（含时刻前缀和换行），返回字节数；未知事件号返回0
+size_t formatLogEvent(const LogEvent& event, char* out, size_t capacity);
+
+// 二进制记录：前缀 + 事件体
+inline size_t encodeLogRecord(const LogEvent& event, uint8_t* out) {
+  out[0] = LOG_RECORD_SYNC[0];
+  out[1] = LOG_RECORD_SYNC[1];
+  memcpy(out + 2, &event, sizeof(event));
+  return LOG_RECORD_SIZE;
+}
+
+template <uint32_t N>
+class EventLog {
+ public:
+  // 生产者：节流间隔已到则记录（args按int32保存）
+  template <typename... Args>
+  bool record(LogEventId id, uint32_t nowUs, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_EVENT_ARGS, "日志事件参数过多");
+    if (!due(id, nowUs)) return false;
+    LogEvent event;
+    event.id = id;
+    event.argc = (uint8_t)sizeof...(Args);
+    event.reserved = 0;
+    event.timeUs = nowUs;
+    int32_t values[] = { (int32_t)args..., 0 };
+    memcpy(event.args, values, sizeof...(Args) * sizeof(int32_t));
+    return ring_.push(event);
+  }
+
+  // 生产者：两个整数参数 + 文本开头（最多16字节，不足补0）
+  bool recordText(LogEventId id, uint32_t nowUs, int32_t a0, int32_t a1, const char* text, size_t length) {
+    if (!due(id, nowUs)) return false;
+    LogEvent event;
+    event.id = id;
+    event.argc = LOG_EVENT_ARGS;
+    event.reserved = 0;
+    event.timeUs = nowUs;
+    event.args[0] = a0;
+    event.args[1] = a1;
+    const size_t room = (LOG_EVENT_ARGS - 2) * sizeof(int32_t);
+    char packed[room];
+    memset(packed, 0, room);
+    memcpy(packed, text, length < room ? length : room);
+    memcpy(&event.args[2], packed, room);
+    return ring_.push(event);
+  }
+
+  // 消费者：最多输出maxEvents条，out的发送缓冲放不下时留到下一次（不阻塞），返回输出条数。
+  // Out须提供 availableForWrite() 和 write(const uint8_t*, size_t)
+  template <typename Out>
+  int drain(Out& out, int maxEvents, bool binary) {
+    int written = 0;
+    while (written < maxEvents) {
+      if (pendingLength_ == 0 && !nextPending(binary)) break;
+      if (out.availableForWrite() < (int)pendingLength_) break;
+      out.write(pending_, pendingLength_);
+      pendingLength_ = 0;
+      written++;
+    }
+    return written;
+  }
+
+  uint32_t lost() const { return ring_.dropped(); }
+  uint32_t pending() const { return ring_.size(); }
+
+ private:
+  bool due(LogEventId id, uint32_t nowUs) {
+    uint32_t interval = logEventFormat(id).intervalMs * 1000;
+    if (interval != 0 && recorded_[id] && nowUs - lastUs_[id] < interval) return false;
+    recorded_[id] = true;
+    lastUs_[id] = nowUs;
+    return true;
+  }
+
+  // 取下一条待输出的事件（队列取空后报告新增的丢失条数）并编码到pending_
+  bool nextPending(bool binary) {
+    while (pendingLength_ == 0) {
+      LogEvent event;
+      uint32_t lost = ring_.dropped();
+      if (ring_.pop(event)) {
+        lastPoppedUs_ = event.timeUs;
+      } else if (lost != reportedLost_) {
+        // 队列满时丢弃的是较新的事件，排在已入队的事件之后报告
+        event.id = LOG_EVENTS_LOST;
+        event.argc = 1;
+        event.reserved = 0;
+        event.timeUs = lastPoppedUs_;
+        event.args[0] = (int32_t)(lost - reportedLost_);
+        reportedLost_ = lost;
+      } else {
+        return false;
+      }
+      if (binary) {
+        pendingLength_ = encodeLogRecord(event, pending_);
+      } else {
+        pendingLength_ = formatLogEvent(event, (char*)pending_, sizeof(pending_));
+      }
+    }
+    return true;
+  }
+
+  SpscRing<LogEvent, N> ring_;
+  uint32_t lastUs_[LOG_EVENT_COUNT] = {};   // 生产者
+  bool recorded_[LOG_EVENT_COUNT] = {};     // 生产者
+  uint8_t pending_[LOG_LINE_MAX + 1];       // 消费者：已编码、等待发送的一条
+  size_t pendingLength_ = 0;
+  uint32_t reportedLost_ = 0;
+  uint32_t lastPoppedUs_ = 0;
+};
+
+// 空闲时输出各日志：距下一个控制节拍（untilTickUs）不足marginUs时不格式化，
+// 每个日志最多输出maxEvents条，串口发送缓冲放不下的留到下一次，不阻塞
+template <typename Out, typename... Logs>
+void drainWhenIdle(Out& out, int32_t untilTickUs, uint32_t marginUs, int maxEvents, bool binary, Logs&... logs) {
+  if (untilTickUs < (int32_t)marginUs) return;
+  int drained[] = { logs.drain(out, maxEvents, binary)... };
+  (void)drained;
+}
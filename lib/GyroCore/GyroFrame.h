@@ -0,0 +1,194 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ===================== 二进制帧协议 =====================
+// 小端序，通过WebSocket二进制帧（WStype_BIN）下发。版本1固定16字节；
+// 版本2在末尾追加4字节客户端发送时刻（用于延迟估计与外推），两种版本都可解码。
+// 直接在payload上按字节解码，不拷贝、不分配堆内存；JSON文本帧保留作为兼容通道。
+//
+//  偏移  长度  字段
+//  0     1     魔数 'G'
+//  1     1     协议版本（1或2）
+//  2     1     帧类型（GyroFrameKind）
+//  3     1     标志位（GYRO_FLAG_*）
+//  4     2     序号 uint16
+//  6     6     三通道数值 int16[3]（角度帧：0.01°；脉宽帧：us），顺序 pitch/roll/yaw
+//  12    3     三通道引脚 int8[3]（-1表示该通道无效/不修改）
+//  15    1     保留（填0）
+//  16    4     客户端发送时刻 uint32（ms，仅版本2；GYRO_FLAG_TIMESTAMP置位时有效）
+
+const uint8_t GYRO_FRAME_MAGIC = 'G';
+const uint8_t GYRO_FRAME_VERSION_V1 = 1;
+const uint8_t GYRO_FRAME_VERSION = 2;
+const size_t GYRO_FRAME_V1_SIZE = 16;
+const size_t GYRO_FRAME_SIZE = 20;
+const int GYRO_FRAME_AXES = 3;
+
+enum GyroFrameKind : uint8_t {
+  GYRO_FRAME_ANGLE = 1,  // 姿态角（V1：设备端映射）
+  GYRO_FRAME_PULSE = 2,  // 脉宽（V2：网页端映射）
+  GYRO_FRAME_IMU = 3     // 原始IMU样本批（V1：设备端姿态融合，格式见下方IMU批量帧）
+};
+
+const uint8_t GYRO_FLAG_ENABLED = 0x01;      // 启用控制
+const uint8_t GYRO_FLAG_HAS_ENABLED = 0x02;  // 帧中携带了启用状态
+const uint8_t GYRO_FLAG_TIMESTAMP = 0x04;    // 帧中携带了客户端发送时刻
+
+const int8_t GYRO_PIN_NONE = -1;
+
+// 解码后的帧
+struct GyroFrame {
+  uint8_t kind;
+  uint8_t flags;
+  uint16_t seq;
+  int16_t value[GYRO_FRAME_AXES];
+  int8_t pin[GYRO_FRAME_AXES];
+  uint32_t timeMs;         // 客户端发送时刻（无时间戳时为0）
+};
+
+inline uint16_t gyroReadU16(const uint8_t* p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+inline void gyroWriteU16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)(v & 0xFF);
+  p[1] = (uint8_t)(v >> 8);
+}
+
+inline uint32_t gyroReadU32(const uint8_t* p) {
+  return (uint32_t)gyroReadU16(p) | ((uint32_t)gyroReadU16(p + 2) << 16);
+}
+
+inline void gyroWriteU32(uint8_t* p, uint32_t v) {
+  gyroWriteU16(p, (uint16_t)(v & 0xFFFF));
+  gyroWriteU16(p + 2, (uint16_t)(v >> 16));
+}
+
+// 解码：长度、魔数或版本不符时返回false
+inline bool decodeGyroFrame(const uint8_t* payload, size_t length, GyroFrame& frame) {
+  if (payload == nullptr || length < GYRO_FRAME_V1_SIZE || payload[0] != GYRO_FRAME_MAGIC) return false;
+  if (payload[1] == GYRO_FRAME_VERSION_V1) {
+    if (length != GYRO_FRAME_V1_SIZE) return false;
+  } else if (payload[1] != GYRO_FRAME_VERSION || length != GYRO_FRAME_SIZE) {
+    return false;
+  }
+  if (payload[2] != GYRO_FRAME_ANGLE && payload[2] != GYRO_FRAME_PULSE) return false;
+
+  frame.kind = payload[2];
+  frame.flags = payload[3];
+  frame.seq = gyroReadU16(payload + 4);
+  for (int i = 0; i < GYRO_FRAME_AXES; i++) {
+    frame.value[i] = (int16_t)gyroReadU16(payload + 6 + i * 2);
+    frame.pin[i] = (int8_t)payload[12 + i];
+  }
+  if (payload[1] == GYRO_FRAME_VERSION_V1) {
+    frame.flags &= (uint8_t)~GYRO_FLAG_TIMESTAMP;
+    frame.timeMs = 0;
+  } else {
+    frame.timeMs = gyroReadU32(payload + 16);
+  }
+  return true;
+}
+
+// 编码：out至少GYRO_FRAME_SIZE字节
+inline size_t encodeGyroFrame(const GyroFrame& frame, uint8_t* out) {
+  out[0] = GYRO_FRAME_MAGIC;
+  out[1] = GYRO_FRAME_VERSION;
+  out[2] = frame.kind;
+  out[3] = frame.flags;
+  gyroWriteU16(out + 4, frame.seq);
+  for (int i = 0; i < GYRO_FRAME_AXES; i++) {
+    gyroWriteU16(out + 6 + i * 2, (uint16_t)frame.value[i]);
+    out[12 + i] = (uint8_t)frame.pin[i];
+  }
+  out[15] = 0;
+  gyroWriteU32(out + 16, frame.timeMs);
+  return GYRO_FRAME_SIZE;
+}
+
+// 0.01°定点值 -> 角度
+inline float gyroCentiToDegrees(int16_t centi) {
+  return centi / 100.0f;
+}
+
+// ===================== IMU批量帧 =====================
+// 姿态融合模式下客户端按批上传devicemotion的原始样本（同一批样本间隔相同），帧头与姿态帧共用魔数/版本/类型/序号，
+// 长度随样本数变化。样本坐标系为设备坐标系x/y/z（rotationRate的beta/gamma/alpha分别对应x/y/z）。
+//
+//  偏移  长度  字段
+//  0     1     魔数 'G'
+//  1     1     协议版本（2）
+//  2     1     帧类型 GYRO_FRAME_IMU
+//  3     1     标志位（GYRO_FLAG_*）
+//  4     2     序号 uint16
+//  6     1     样本数 n（1~IMU_BATCH_MAX）
+//  7     1     保留（填0）
+//  8     2     样本间隔 uint16（us）
+//  10    2     保留（填0）
+//  12    4     客户端发送时刻 uint32（ms，批内最后一个样本；GYRO_FLAG_TIMESTAMP置位时有效）
+//  16    12*n  样本：角速度int16[3]（0.1°/s）+ 含重力加速度int16[3]（mm/s²）
+
+const int IMU_BATCH_MAX = 8;
+const size_t IMU_BATCH_HEADER_SIZE = 16;
+const size_t IMU_SAMPLE_SIZE = 12;
+const size_t IMU_BATCH_MAX_SIZE = IMU_BATCH_HEADER_SIZE + IMU_BATCH_MAX * IMU_SAMPLE_SIZE;
+
+struct ImuSample {
+  int16_t gyro[GYRO_FRAME_AXES];    // 角速度（0.1°/s）
+  int16_t accel[GYRO_FRAME_AXES];   // 含重力加速度（mm/s²）
+};
+
+struct ImuBatch {
+  uint8_t flags;
+  uint16_t seq;
+  uint8_t count;
+  uint16_t intervalUs;
+  uint32_t timeMs;
+  ImuSample sample[IMU_BATCH_MAX];
+};
+
+// 解码：长度与样本数不符、样本数为0或超过IMU_BATCH_MAX、样本间隔为0时返回false
+inline bool decodeImuBatch(const uint8_t* payload, size_t length, ImuBatch& batch) {
+  if (payload == nullptr || length < IMU_BATCH_HEADER_SIZE + IMU_SAMPLE_SIZE) return false;
+  if (payload[0] != GYRO_FRAME_MAGIC || payload[1] != GYRO_FRAME_VERSION || payload[2] != GYRO_FRAME_IMU) return false;
+  uint8_t count = payload[6];
+  if (count == 0 || count > IMU_BATCH_MAX || length != IMU_BATCH_HEADER_SIZE + count * IMU_SAMPLE_SIZE) return false;
+  batch.intervalUs = gyroReadU16(payload + 8);
+  if (batch.intervalUs == 0) return false;
+
+  batch.flags = payload[3];
+  batch.seq = gyroReadU16(payload + 4);
+  batch.count = count;
+  batch.timeMs = gyroReadU32(payload + 12);
+  const uint8_t* p = payload + IMU_BATCH_HEADER_SIZE;
+  for (int n = 0; n < count; n++, p += IMU_SAMPLE_SIZE) {
+    for (int i = 0; i < GYRO_FRAME_AXES; i++) {
+      batch.sample[n].gyro[i] = (int16_t)gyroReadU16(p + i * 2);
+      batch.sample[n].accel[i] = (int16_t)gyroReadU16(p + 6 + i * 2);
+    }
+  }
+  return true;
+}
+
+// 编码：out至少IMU_BATCH_HEADER_SIZE + count*IMU_SAMPLE_SIZE字节
+inline size_t encodeImuBatch(const ImuBatch& batch, uint8_t* out) {
+  out[0] = GYRO_FRAME_MAGIC;
+  out[1] = GYRO_FRAME_VERSION;
+  out[2] = GYRO_FRAME_IMU;
+  out[3] = batch.flags;
+  gyroWriteU16(out + 4, batch.seq);
+  out[6] = batch.count;
+  out[7] = 0;
+  gyroWriteU16(out + 8, batch.intervalUs);
+  gyroWriteU16(out + 10, 0);
+  gyroWriteU32(out + 12, batch.timeMs);
+  uint8_t* p = out + IMU_BATCH_HEADER_SIZE;
+  for (int n = 0; n < batch.count; n++, p += IMU_SAMPLE_SIZE) {
+    for (int i = 0; i < GYRO_FRAME_AXES; i++) {
+      gyroWriteU16(p + i * 2, (uint16_t)batch.sample[n].gyro[i]);
+      gyroWriteU16(p + 6 + i * 2, (uint16_t)batch.sample[n].accel[i]);
+    }
+  }
+  return IMU_BATCH_HEADER_SIZE + batch.count * IMU_SAMPLE_SIZE;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "ChannelTable.h"
+#include "GyroFrame.h"
+#include "JsonScan.h"
+
+// ===================== JSON姿态消息 =====================
+// 兼容通道：网页的JSON姿态消息 {"pitch":..,"roll":..,"yaw":..,"enabled":0|1,"seq":n}（角度单位°）
+// 解码成与二进制姿态帧相同的GyroFrame，之后两种通道走同一条投递路径，同一姿态得到同一条控制指令。
+// 角度四舍五入到0.01°并限幅到int16；没有enabled/seq字段时与二进制帧不置标志位、序号为0一致；
+// JSON消息不带发送时刻（timeMs为0，不置GYRO_FLAG_TIMESTAMP）。
+// 同一遍扫描还记录顶层键是否出现，用来区分姿态消息与V1的配置消息（见gyroTextKind），
+// 嵌套对象里的同名键不参与分类。
+
+// 扫描目标：字段缺省时enabled/seq保持-1
+struct GyroTextMessage {
+  float pitch;
+  float roll;
+  float yaw;
+  int enabled;
+  int seq;
+  // 顶层键出现标志（值可为任意类型）
+  bool hasPitch;
+  bool hasRoll;
+  bool hasYaw;
+  bool hasEnabled;
+  bool hasControlEnabled;
+};
+
+// 文本消息分类
+enum GyroTextKind : uint8_t {
+  GYRO_TEXT_OTHER,   // 不是控制消息
+  GYRO_TEXT_ANGLE,   // 姿态消息：顶层有pitch、roll、yaw
+  GYRO_TEXT_CONFIG   // 配置消息：顶层有controlEnabled且没有enabled（配置里的pitch/roll/yaw是通道对象）
+};
+
+#define GYRO_TEXT_FIELD(key, type, member) \
+  { JSON_ROOT, jsonKeyHash(key), type, (uint16_t)offsetof(GyroTextMessage, member) }
+
+static const JsonField GYRO_TEXT_FIELDS[] = {
+  GYRO_TEXT_FIELD("pitch", JSON_FIELD_FLOAT, pitch),
+  GYRO_TEXT_FIELD("roll", JSON_FIELD_FLOAT, roll),
+  GYRO_TEXT_FIELD("yaw", JSON_FIELD_FLOAT, yaw),
+  GYRO_TEXT_FIELD("enabled", JSON_FIELD_INT, enabled),
+  GYRO_TEXT_FIELD("seq", JSON_FIELD_INT, seq),
+  GYRO_TEXT_FIELD("pitch", JSON_FIELD_PRESENT, hasPitch),
+  GYRO_TEXT_FIELD("roll", JSON_FIELD_PRESENT, hasRoll),
+  GYRO_TEXT_FIELD("yaw", JSON_FIELD_PRESENT, hasYaw),
+  GYRO_TEXT_FIELD("enabled", JSON_FIELD_PRESENT, hasEnabled),
+  GYRO_TEXT_FIELD("controlEnabled", JSON_FIELD_PRESENT, hasControlEnabled),
+};
+
+inline int16_t gyroDegreesToFrameValue(float degrees) {
+  int32_t centi = degreesToCenti(degrees);
+  if (centi > INT16_MAX) return INT16_MAX;
+  if (centi < INT16_MIN) return INT16_MIN;
+  return (int16_t)centi;
+}
+
+// 一遍扫描消息；返回值同jsonScanFields（格式错误为-1，错误前扫到的字段与出现标志保留）
+inline int scanGyroText(const uint8_t* payload, size_t length, GyroTextMessage& message) {
+  message = GyroTextMessage{ 0.0f, 0.0f, 0.0f, -1, -1, false, false, false, false, false };
+  return jsonScanFields(payload, length, GYRO_TEXT_FIELDS, sizeof(GYRO_TEXT_FIELDS) / sizeof(GYRO_TEXT_FIELDS[0]),
+                        &message);
+}
+
+// 按顶层键分类（配置优先：配置消息的顶层同样有pitch/roll/yaw对象）
+inline GyroTextKind gyroTextKind(const GyroTextMessage& message) {
+  if (message.hasControlEnabled && !message.hasEnabled) return GYRO_TEXT_CONFIG;
+  if (message.hasPitch && message.hasRoll && message.hasYaw) return GYRO_TEXT_ANGLE;
+  return GYRO_TEXT_OTHER;
+}
+
+// 扫描结果 -> 与二进制姿态帧相同的GyroFrame
+inline void gyroTextToFrame(const GyroTextMessage& message, GyroFrame& frame) {
+  frame.kind = GYRO_FRAME_ANGLE;
+  frame.flags = 0;
+  if (message.enabled >= 0) {
+    frame.flags = GYRO_FLAG_HAS_ENABLED | (message.enabled == 1 ? GYRO_FLAG_ENABLED : 0);
+  }
+  frame.seq = message.seq >= 0 ? (uint16_t)message.seq : 0;
+  frame.value[0] = gyroDegreesToFrameValue(message.pitch);
+  frame.value[1] = gyroDegreesToFrameValue(message.roll);
+  frame.value[2] = gyroDegreesToFrameValue(message.yaw);
+  for (int i = 0; i < GYRO_FRAME_AXES; i++) {
+    frame.pin[i] = GYRO_PIN_NONE;
+  }
+  frame.timeMs = 0;
+}
+
+// 解码JSON姿态消息；返回值同jsonScanFields（格式错误为-1，错误前已解析的字段照常写入frame）
+inline int decodeGyroText(const uint8_t* payload, size_t length, GyroFrame& frame) {
+  GyroTextMessage message;
+  int fields = scanGyroText(payload, length, message);
+  gyroTextToFrame(message, frame);
+  return fields;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+
+// ===================== 堆健康监视 =====================
+// 热点长时间运行时，每条消息的临时String会把堆切碎：空闲总量还够，最大连续块却越来越小，
+// 直到WebSocket收发缓冲分配失败。这里定期记录三项读数（空闲堆、最大连续空闲块、历史最低空闲堆），
+// 并在每个控制帧前后比较空闲堆：热路径不分配内存时，“堆变化帧”应始终为0。
+// 读数由调用方提供（ESP32上为ESP.getFreeHeap()/getMaxAllocHeap()/getMinFreeHeap()），纯逻辑。
+// 空闲堆比较只能看到跨帧保留的分配，也会计入同时运行的WiFi/lwIP任务的分配，应作为上限看待；
+// 帧内申请又释放的临时对象由主机仿真逐次计数（回放输出的allocs列）。
+
+struct HeapReading {
+  uint32_t freeBytes;     // 当前空闲堆
+  uint32_t largestBlock;  // 最大连续空闲块（能分配的最大单块）
+  uint32_t minFreeBytes;  // 启动以来的最低空闲堆
+};
+
+class HeapMonitor {
+ public:
+  void sample(const HeapReading& reading) {
+    if (samples_ == 0) {
+      baselineFree_ = reading.freeBytes;
+      lowestLargest_ = reading.largestBlock;
+    }
+    last_ = reading;
+    if (reading.largestBlock < lowestLargest_) lowestLargest_ = reading.largestBlock;
+    samples_++;
+  }
+
+  // 控制帧处理前后各调用一次（网络侧，单写者）
+  void frameBegin(uint32_t freeBytes) { frameStartFree_ = freeBytes; }
+  void frameEnd(uint32_t freeBytes) {
+    frames_++;
+    if (freeBytes == frameStartFree_) return;
+    changedFrames_++;
+    if (freeBytes < frameStartFree_ && frameStartFree_ - freeBytes > maxFrameDrop_) {
+      maxFrameDrop_ = frameStartFree_ - freeBytes;
+    }
+  }
+
+  // 碎片率（千分比）：1 - 最大连续块/空闲总量
+  uint32_t fragmentationPermille() const {
+    if (last_.freeBytes == 0) return 0;
+    return 1000 - (uint32_t)((uint64_t)last_.largestBlock * 1000 / last_.freeBytes);
+  }
+
+  const HeapReading& last() const { return last_; }
+  uint32_t baselineFree() const { return baselineFree_; }
+  uint32_t lowestLargestBlock() const { return lowestLargest_; }
+  uint32_t samples() const { return samples_; }
+  uint32_t frames() const { return frames_; }
+  uint32_t changedFrames() const { return changedFrames_; }
+  uint32_t maxFrameDrop() const { return maxFrameDrop_; }
+
+ private:
+  HeapReading last_ = { 0, 0, 0 };
+  uint32_t baselineFree_ = 0;
+  uint32_t lowestLargest_ = 0;
+  uint32_t samples_ = 0;
+  uint32_t frameStartFree_ = 0;
+  uint32_t frames_ = 0;
+  uint32_t changedFrames_ = 0;
+  uint32_t maxFrameDrop_ = 0;
+};
+
+// 作用域：构造时记下空闲堆，析构时比较（readFree为读取空闲堆的函数）
+class HeapFrameScope {
+ public:
+  HeapFrameScope(HeapMonitor& monitor, uint32_t (*readFree)()) : monitor_(monitor), readFree_(readFree) {
+    monitor_.frameBegin(readFree_());
+  }
+  ~HeapFrameScope() { monitor_.frameEnd(readFree_()); }
+
+ private:
+  HeapMonitor& monitor_;
+  uint32_t (*readFree_)();
+};
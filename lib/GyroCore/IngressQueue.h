@@ -0,0 +1,185 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include "SpscRing.h"
+
+// ===================== 入口队列：最新帧合并与过载回压 =====================
+// 浏览器发送速度超过loop()处理速度时，逐帧排队会让舵机回放过时的姿态历史。
+// 这里把控制帧按客户端合并为“最新一帧”：消费侧来不及取走时新帧直接覆盖（计为合并），
+// 部分更新的帧（如只含某几个通道）用合并函数叠加，不会丢掉尚未生效的通道。
+// 复位类指令走独立的优先队列，不参与合并，消费侧总是先处理指令再取最新帧。
+// 每客户端按时间窗统计合并比例，超过阈值时通知发送端降频（回压），降到阈值一半以下再通知恢复。
+// 生产者为网络侧、消费者为控制侧，跨核无锁。
+
+// 合并函数：默认直接用新帧替换
+template <typename T>
+struct ReplaceMerge {
+  void operator()(T& pending, const T& newer) const { pending = newer; }
+};
+
+// 单生产者单消费者的“最新值”槽（三缓冲）：生产者写后台槽后与中间槽交换，
+// 消费者只在中间槽有新数据时与前台槽交换，双方都不会等待
+template <typename T, typename Merge = ReplaceMerge<T> >
+class LatestSlot {
+ public:
+  // 生产者调用；上一帧未被取走时与其合并，返回true表示发生了合并
+  bool publish(const T& value) {
+    uint8_t middle = middle_.load(std::memory_order_acquire);
+    if (middle & FRESH) {
+      // 消费者只读不写槽内容，这里读中间槽是安全的；若它恰好在此时被取走，
+      // 合并结果只会重复已生效的旧字段，不影响最终状态
+      slots_[back_] = slots_[middle & INDEX_MASK];
+      Merge()(slots_[back_], value);
+    } else {
+      slots_[back_] = value;
+    }
+    uint8_t previous = middle_.exchange((uint8_t)(back_ | FRESH), std::memory_order_acq_rel);
+    back_ = previous & INDEX_MASK;
+    return (previous & FRESH) != 0;
+  }
+
+  // 消费者调用
+  bool take(T& out) {
+    if (!(middle_.load(std::memory_order_acquire) & FRESH)) return false;
+    uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+    front_ = previous & INDEX_MASK;
+    out = slots_[front_];
+    return true;
+  }
+
+ private:
+  static const uint8_t FRESH = 0x80;
+  static const uint8_t INDEX_MASK = 0x03;
+
+  T slots_[3];
+  uint8_t back_ = 0;                    // 生产者独占
+  uint8_t front_ = 1;                   // 消费者独占
+  std::atomic<uint8_t> middle_{2};      // 中间槽下标 | FRESH
+};
+
+// 回压通知
+enum BackpressureSignal : int8_t {
+  BACKPRESSURE_NONE = 0,
+  BACKPRESSURE_ON = 1,    // 请发送端降频
+  BACKPRESSURE_OFF = -1   // 恢复原频率
+};
+
+struct BackpressureConfig {
+  uint32_t windowMs;           // 统计窗口
+  uint32_t thresholdPermille;  // 合并比例阈值（千分比）
+  uint32_t minFrames;          // 窗口内帧数少于该值不判断
+};
+
+inline BackpressureConfig defaultBackpressureConfig() {
+  BackpressureConfig cfg = { 1000, 300, 20 };
+  return cfg;
+}
+
+template <typename T, int CLIENTS, uint32_t PRIORITY_N, typename Merge = ReplaceMerge<T> >
+class IngressQueue {
+ public:
+  explicit IngressQueue(const BackpressureConfig& cfg = defaultBackpressureConfig()) : cfg_(cfg) {}
+
+  // ---- 网络侧 ----
+  // 优先指令（复位等），队列满时丢弃并计数
+  bool pushPriority(const T& command) { return priority_.push(command); }
+
+  // 控制帧：只保留每个客户端最新的一帧
+  void pushLatest(uint8_t client, const T& frame) {
+    if (client >= CLIENTS) return;
+    Client& c = clients_[client];
+    c.frames++;
+    c.windowFrames++;
+    if (latest_[client].publish(frame)) {
+      c.coalesced++;
+      c.windowCoalesced++;
+    }
+  }
+
+  // 窗口结束时判断是否需要通知发送端（在pushLatest之后调用），返回通知类型
+  BackpressureSignal pollBackpressure(uint8_t client, uint32_t nowMs) {
+    if (client >= CLIENTS) return BACKPRESSURE_NONE;
+    Client& c = clients_[client];
+    if (nowMs - c.windowStartMs < cfg_.windowMs) return BACKPRESSURE_NONE;
+    uint32_t elapsed = nowMs - c.windowStartMs;
+    uint32_t frames = c.windowFrames;
+    uint32_t coalesced = c.windowCoalesced;
+    c.windowStartMs = nowMs;
+    c.windowFrames = 0;
+    c.windowCoalesced = 0;
+
+    uint32_t permille = frames > 0 ? coalesced * 1000 / frames : 0;
+    c.dropPermille = permille;
+    if (!c.throttled && frames >= cfg_.minFrames && permille >= cfg_.thresholdPermille) {
+      // 建议频率取实际被消费的帧率（留10%余量）
+      uint32_t consumedHz = elapsed > 0 ? (frames - coalesced) * 1000 / elapsed : 0;
+      c.suggestedHz = consumedHz * 9 / 10 > 1 ? consumedHz * 9 / 10 : 1;
+      c.throttled = true;
+      c.signals++;
+      return BACKPRESSURE_ON;
+    }
+    if (c.throttled && permille < cfg_.thresholdPermille / 2) {
+      c.throttled = false;
+      c.signals++;
+      return BACKPRESSURE_OFF;
+    }
+    return BACKPRESSURE_NONE;
+  }
+
+  // 客户端断开：清除回压状态与统计窗口（已发布的帧仍会被消费一次）
+  void reset(uint8_t client) {
+    if (client >= CLIENTS) return;
+    Client& c = clients_[client];
+    c.throttled = false;
+    c.windowFrames = 0;
+    c.windowCoalesced = 0;
+    c.dropPermille = 0;
+  }
+
+  // ---- 控制侧 ----
+  bool popPriority(T& out) { return priority_.pop(out); }
+
+  // 依次取各客户端的最新帧（每个客户端每轮最多一帧）
+  bool takeLatest(uint8_t client, T& out) {
+    return client < CLIENTS && latest_[client].take(out);
+  }
+
+  // ---- 统计（网络侧维护，任意一侧只读） ----
+  uint32_t frames(uint8_t client) const { return clients_[client].frames; }
+  uint32_t coalesced(uint8_t client) const { return clients_[client].coalesced; }
+  uint32_t dropPermille(uint8_t client) const { return clients_[client].dropPermille; }
+  uint32_t suggestedHz(uint8_t client) const { return clients_[client].suggestedHz; }
+  bool throttled(uint8_t client) const { return clients_[client].throttled; }
+  uint32_t signals(uint8_t client) const { return clients_[client].signals; }
+  uint32_t priorityDropped() const { return priority_.dropped(); }
+
+  uint32_t totalFrames() const {
+    uint32_t total = 0;
+    for (int i = 0; i < CLIENTS; i++) total += clients_[i].frames;
+    return total;
+  }
+
+  uint32_t totalCoalesced() const {
+    uint32_t total = 0;
+    for (int i = 0; i < CLIENTS; i++) total += clients_[i].coalesced;
+    return total;
+  }
+
+ private:
+  struct Client {
+    uint32_t frames = 0;
+    uint32_t coalesced = 0;
+    uint32_t windowStartMs = 0;
+    uint32_t windowFrames = 0;
+    uint32_t windowCoalesced = 0;
+    uint32_t dropPermille = 0;   // 上一窗口的合并比例
+    uint32_t suggestedHz = 0;    // 最近一次回压建议的发送频率
+    uint32_t signals = 0;        // 已发出的回压/恢复通知数
+    bool throttled = false;
+  };
+
+  BackpressureConfig cfg_;
+  SpscRing<T, PRIORITY_N> priority_;
+  LatestSlot<T, Merge> latest_[CLIENTS];
+  Client clients_[CLIENTS];
+};
@@ -0,0 +1,207 @@
+#include "JsonScan.h"
+#include <limits.h>
+#include <string.h>
+
+namespace {
+
+const int MAX_DEPTH = 8;
+const uint32_t ARRAY_PARENT = 1;  // 数组内元素不匹配任何字段
+
+inline void skipSpace(const uint8_t*& p, const uint8_t* end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+}
+
+// 扫描字符串（p指向起始引号），可选计算内容哈希；成功时p指向结束引号之后
+bool scanString(const uint8_t*& p, const uint8_t* end, uint32_t* hash) {
+  uint32_t h = JSON_HASH_SEED;
+  p++;
+  while (p < end && *p != '"') {
+    if (*p == '\\') {
+      if (++p >= end) return false;
+    }
+    h = (h ^ *p) * 16777619u;
+    p++;
+  }
+  if (p >= end) return false;
+  p++;
+  if (hash) *hash = h;
+  return true;
+}
+
+bool matchLiteral(const uint8_t*& p, const uint8_t* end, const char* literal) {
+  size_t n = strlen(literal);
+  if ((size_t)(end - p) < n || memcmp(p, literal, n) != 0) return false;
+  p += n;
+  return true;
+}
+
+
+void storeField(const JsonField& field, void* target, float value, bool isNumber) {
+  uint8_t* dst = (uint8_t*)target + field.offset;
+  switch (field.type) {
+    case JSON_FIELD_FLOAT: {
+      memcpy(dst, &value, sizeof(float));
+      break;
+    }
+    case JSON_FIELD_INT: {
+      // 超出int范围的数（如1e20、溢出为inf的指数）饱和到INT_MIN/INT_MAX，NaN不写入
+      if (value != value) break;
+      double rounded = value < 0 ? (double)value - 0.5 : (double)value + 0.5;
+      int v = rounded >= (double)INT_MAX ? INT_MAX
+            : rounded <= (double)INT_MIN ? INT_MIN
+            : (int)rounded;
+      memcpy(dst, &v, sizeof(int));
+      break;
+    }
+    case JSON_FIELD_FLAG: {
+      bool v = isNumber ? (value == 1.0f) : (value != 0.0f);
+      memcpy(dst, &v, sizeof(bool));
+      break;
+    }
+    case JSON_FIELD_PRESENT: {
+      bool v = true;
+      memcpy(dst, &v, sizeof(bool));
+      break;
+    }
+  }
+}
+
+// 写入(parent, key)命中的全部字段，返回命中的取值字段数（出现标志不计）；
+// scalar为false（值为对象、数组、字符串或null）时只记录出现标志
+int storeMatches(const JsonField* fields, size_t count, uint32_t parent, uint32_t key, void* target,
+                 float value, bool isNumber, bool scalar) {
+  int matched = 0;
+  for (size_t i = 0; i < count; i++) {
+    const JsonField& field = fields[i];
+    if (field.keyHash != key || field.parentHash != parent) continue;
+    if (field.type == JSON_FIELD_PRESENT) {
+      storeField(field, target, value, isNumber);
+    } else if (scalar) {
+      storeField(field, target, value, isNumber);
+      matched++;
+    }
+  }
+  return matched;
+}
+
+}  // namespace
+
+bool jsonParseNumber(const uint8_t*& p, const uint8_t* end, float& value) {
+  const uint8_t* s = p;
+  bool negative = false;
+  if (s < end && (*s == '-' || *s == '+')) negative = (*s++ == '-');
+
+  uint32_t mantissa = 0;
+  int scale = 0;     // 十进制小数位修正
+  int digits = 0;
+  while (s < end && *s >= '0' && *s <= '9') {
+    if (mantissa < 100000000u) mantissa = mantissa * 10 + (*s - '0');
+    else scale++;
+    s++; digits++;
+  }
+  if (s < end && *s == '.') {
+    s++;
+    while (s < end && *s >= '0' && *s <= '9') {
+      if (mantissa < 100000000u) { mantissa = mantissa * 10 + (*s - '0'); scale--; }
+      s++; digits++;
+    }
+  }
+  if (digits == 0) return false;
+
+  if (s < end && (*s == 'e' || *s == 'E')) {
+    s++;
+    bool expNegative = false;
+    if (s < end && (*s == '-' || *s == '+')) expNegative = (*s++ == '-');
+    int exp = 0;
+    while (s < end && *s >= '0' && *s <= '9') {
+      if (exp < 100) exp = exp * 10 + (*s - '0');
+      s++;
+    }
+    scale += expNegative ? -exp : exp;
+  }
+
+  // 用整数尾数除/乘10的幂得到结果，与atof在常见精度下一致
+  float result = (float)mantissa;
+  float pow10 = 1.0f;
+  int n = scale < 0 ? -scale : scale;
+  while (n-- > 0) pow10 *= 10.0f;
+  result = scale < 0 ? result / pow10 : result * pow10;
+
+  value = negative ? -result : result;
+  p = s;
+  return true;
+}
+
+int jsonScanFields(const uint8_t* payload, size_t length,
+                   const JsonField* fields, size_t fieldCount, void* target) {
+  if (payload == nullptr) return -1;
+  const uint8_t* p = payload;
+  const uint8_t* end = payload + length;
+
+  // 每层容器对应的父哈希：对象为其键的哈希，数组为ARRAY_PARENT
+  uint32_t parents[MAX_DEPTH];
+  bool inObject[MAX_DEPTH];
+  int depth = -1;
+  uint32_t pendingKey = JSON_ROOT;  // 当前值所属的键
+  int matched = 0;
+
+  while (true) {
+    skipSpace(p, end);
+    if (p >= end) return depth < 0 ? matched : -1;
+
+    // 对象内先读键
+    if (depth >= 0 && inObject[depth]) {
+      if (*p == '}') { p++; depth--; goto afterValue; }
+      if (*p != '"' || !scanString(p, end, &pendingKey)) return -1;
+      skipSpace(p, end);
+      if (p >= end || *p != ':') return -1;
+      p++;
+      skipSpace(p, end);
+      if (p >= end) return -1;
+    } else if (depth >= 0 && *p == ']') {
+      p++; depth--; goto afterValue;
+    }
+
+    // 读值
+    {
+      uint32_t parent = depth >= 0 ? parents[depth] : JSON_ROOT;
+      uint32_t key = (depth >= 0 && inObject[depth]) ? pendingKey : ARRAY_PARENT;
+      uint8_t c = *p;
+      if (c == '{' || c == '[') {
+        if (depth >= 0) storeMatches(fields, fieldCount, parent, key, target, 0.0f, false, false);
+        if (++depth >= MAX_DEPTH) return -1;
+        parents[depth] = (c == '[' || parent == ARRAY_PARENT) ? ARRAY_PARENT : (depth == 0 ? JSON_ROOT : key);
+        inObject[depth] = (c == '{');
+        p++;
+        continue;
+      }
+      if (depth < 0) return -1;  // 顶层必须是容器
+
+      if (c == '"') {
+        if (!scanString(p, end, nullptr)) return -1;
+        storeMatches(fields, fieldCount, parent, key, target, 0.0f, false, false);
+      } else if (matchLiteral(p, end, "true")) {
+        matched += storeMatches(fields, fieldCount, parent, key, target, 1.0f, false, true);
+      } else if (matchLiteral(p, end, "false")) {
+        matched += storeMatches(fields, fieldCount, parent, key, target, 0.0f, false, true);
+      } else if (matchLiteral(p, end, "null")) {
+        storeMatches(fields, fieldCount, parent, key, target, 0.0f, false, false);
+      } else {
+        float value;
+        if (!jsonParseNumber(p, end, value)) return -1;
+        matched += storeMatches(fields, fieldCount, parent, key, target, value, true, true);
+      }
+    }
+
+  afterValue:
+    if (depth < 0) {
+      skipSpace(p, end);
+      return (p >= end || *p == '\0') ? matched : -1;
+    }
+    skipSpace(p, end);
+    if (p >= end) return -1;
+    if (*p == ',') { p++; continue; }
+    if (*p == '}' || *p == ']') continue;
+    return -1;
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ===================== 单遍JSON字段扫描 =====================
+// 直接在 payload/length 上扫描一遍，不依赖'\0'结尾、不分配内存、不调用atof。
+// 每个键按 (所在对象的键哈希, 键哈希) 在字段表中查找，命中则按偏移写入目标结构体，
+// 因此 "pitch":{"rate":..} 与 "roll":{"rate":..} 不会互相串位。
+
+// FNV-1a 32位键哈希（constexpr，字段表可在编译期生成）
+constexpr uint32_t JSON_HASH_SEED = 2166136261u;
+constexpr uint32_t jsonKeyHash(const char* key, uint32_t hash = JSON_HASH_SEED) {
+  return *key ? jsonKeyHash(key + 1, (hash ^ (uint8_t)*key) * 16777619u) : hash;
+}
+
+// 顶层字段的父哈希
+const uint32_t JSON_ROOT = 0;
+
+enum JsonFieldType : uint8_t {
+  JSON_FIELD_FLOAT,  // float
+  JSON_FIELD_INT,    // int
+  JSON_FIELD_FLAG,   // bool（数值为1或字面量true时为真）
+  JSON_FIELD_PRESENT // bool：键出现即为true（值可以是任意类型，含对象/数组/字符串/null），用于按键分类消息
+};
+
+// 字段表项
+struct JsonField {
+  uint32_t parentHash;  // 所在对象的键哈希（顶层为JSON_ROOT）
+  uint32_t keyHash;     // 键哈希
+  JsonFieldType type;   // 目标类型
+  uint16_t offset;      // 在目标结构体中的偏移（offsetof）
+};
+
+// 扫描payload并写入target；返回命中的字段数（出现标志不计），格式错误返回-1（错误前已写入的字段保留）。
+// 同一个键可以同时登记取值字段和出现标志
+int jsonScanFields(const uint8_t* payload, size_t length,
+                   const JsonField* fields, size_t fieldCount, void* target);
+
+// 解析数值（不使用atof）；成功时p指向数值之后
+bool jsonParseNumber(const uint8_t*& p, const uint8_t* end, float& value);
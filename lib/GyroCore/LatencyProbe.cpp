@@ -0,0 +1,76 @@
+#include "LatencyProbe.h"
+
+#if LATENCY_PROBES
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+LatencyHistogram latencyHistograms[PROBE_COUNT];
+
+namespace {
+
+const char* const PROBE_NAMES[PROBE_COUNT] = {
+  "ws_event", "parse", "map", "pwm", "loop", "dns"
+};
+
+// 固定大小的输出块，满了就交给write
+class ChunkWriter {
+ public:
+  ChunkWriter(MetricsChunkFn write, void* ctx) : write_(write), ctx_(ctx) {}
+
+  void line(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char text[128];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (n <= 0) return;
+    if ((size_t)n >= sizeof(text)) n = sizeof(text) - 1;
+    if (used_ + n > sizeof(buffer_)) flush();
+    memcpy(buffer_ + used_, text, n);
+    used_ += n;
+  }
+
+  void flush() {
+    if (used_ == 0) return;
+    write_(ctx_, buffer_, used_);
+    used_ = 0;
+  }
+
+ private:
+  MetricsChunkFn write_;
+  void* ctx_;
+  char buffer_[512];
+  size_t used_ = 0;
+};
+
+}  // namespace
+
+void writeLatencyMetrics(MetricsChunkFn write, void* ctx) {
+  ChunkWriter out(write, ctx);
+  const double cyclesPerUs = probeCyclesPerUs();
+  out.line("# TYPE gyro_latency_us histogram\n");
+  for (int p = 0; p < PROBE_COUNT; p++) {
+    const LatencyHistogram& h = latencyHistograms[p];
+    int last = LATENCY_BUCKETS - 1;
+    while (last > 0 && h.bucket(last) == 0) last--;
+    uint32_t cumulative = 0;
+    for (int b = 0; b <= last; b++) {
+      cumulative += h.bucket(b);
+      // 第b桶上界为2^b个周期
+      double le = (double)((uint64_t)1 << b) / cyclesPerUs;
+      out.line("gyro_latency_us_bucket{probe=\"%s\",le=\"%.3f\"} %u\n", PROBE_NAMES[p], le, cumulative);
+    }
+    out.line("gyro_latency_us_bucket{probe=\"%s\",le=\"+Inf\"} %u\n", PROBE_NAMES[p], h.count());
+    out.line("gyro_latency_us_sum{probe=\"%s\"} %.3f\n", PROBE_NAMES[p], h.sum() / cyclesPerUs);
+    out.line("gyro_latency_us_count{probe=\"%s\"} %u\n", PROBE_NAMES[p], h.count());
+  }
+  // 最大值不属于直方图的序列，单独作为一个gauge族
+  out.line("# TYPE gyro_latency_us_max gauge\n");
+  for (int p = 0; p < PROBE_COUNT; p++) {
+    out.line("gyro_latency_us_max{probe=\"%s\"} %.3f\n", PROBE_NAMES[p], latencyHistograms[p].max() / cyclesPerUs);
+  }
+  out.flush();
+}
+
+#endif  // LATENCY_PROBES
@@ -0,0 +1,101 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// ===================== 热路径延迟探针 =====================
+// 用CPU周期计数器测量各阶段耗时，记录到固定的log2分桶直方图（第b桶覆盖[2^(b-1), 2^b)个周期），
+// 记录只有一次前导零计数和几次加法，不格式化、不打印。直方图由 /metrics 按Prometheus文本格式输出。
+// 未定义 LATENCY_PROBES=1 时探针宏展开为空，不产生任何代码和数据。
+
+#ifndef LATENCY_PROBES
+#define LATENCY_PROBES 0
+#endif
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+// 探针位置
+enum ProbeId : uint8_t {
+  PROBE_WS_EVENT,   // WebSocket回调（接收→解析→入队）
+  PROBE_PARSE,      // 消息解析
+  PROBE_MAP,        // 控制侧执行指令（映射）
+  PROBE_PWM,        // 控制环节拍（滤波→ledcWrite）
+  PROBE_LOOP,       // loop()一次迭代
+  PROBE_DNS,        // CaptiveDns::answer()（应答一个DNS请求）
+  PROBE_COUNT
+};
+
+const int LATENCY_BUCKETS = 32;
+
+// 周期计数器：ESP32为CCOUNT寄存器，主机上以纳秒代替
+inline uint32_t probeCycles() {
+#if defined(ARDUINO)
+  return ESP.getCycleCount();
+#else
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// 每微秒的计数值
+inline uint32_t probeCyclesPerUs() {
+#if defined(ARDUINO)
+  return getCpuFrequencyMhz();
+#else
+  return 1000;
+#endif
+}
+
+// 固定log2分桶直方图（单写者；读取方可能看到略微不一致的计数，监控用途可接受）
+class LatencyHistogram {
+ public:
+  void record(uint32_t cycles) {
+    int bucket = cycles ? 32 - __builtin_clz(cycles) : 0;
+    if (bucket >= LATENCY_BUCKETS) bucket = LATENCY_BUCKETS - 1;
+    buckets_[bucket]++;
+    count_++;
+    sum_ += cycles;
+    if (cycles > max_) max_ = cycles;
+  }
+
+  uint32_t bucket(int i) const { return buckets_[i]; }
+  uint32_t count() const { return count_; }
+  uint64_t sum() const { return sum_; }
+  uint32_t max() const { return max_; }
+
+ private:
+  uint32_t buckets_[LATENCY_BUCKETS] = {};
+  uint32_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint32_t max_ = 0;
+};
+
+extern LatencyHistogram latencyHistograms[PROBE_COUNT];
+
+// 作用域探针：构造时取计数，析构时记录
+class ProbeScope {
+ public:
+  explicit ProbeScope(ProbeId id) : id_(id), start_(probeCycles()) {}
+  ~ProbeScope() { latencyHistograms[id_].record(probeCycles() - start_); }
+
+ private:
+  ProbeId id_;
+  uint32_t start_;
+};
+
+// 按块输出指标文本（/metrics处理函数把每块直接写到连接上）
+typedef void (*MetricsChunkFn)(void* ctx, const char* data, size_t length);
+
+// 以Prometheus文本格式输出全部直方图（le单位为微秒，只输出到最后一个非空桶）
+void writeLatencyMetrics(MetricsChunkFn write, void* ctx);
+
+#if LATENCY_PROBES
+#define PROBE_CONCAT_(a, b) a##b
+#define PROBE_CONCAT(a, b) PROBE_CONCAT_(a, b)
+#define PROBE_SCOPE(id) ProbeScope PROBE_CONCAT(probeScope_, __LINE__)(id)
+#else
+#define PROBE_SCOPE(id) do {} while (0)
+#endif
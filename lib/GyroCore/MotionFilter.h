@@ -0,0 +1,128 @@
+#pragma once
+#include <stdint.h>
+
+// ===================== 舵机运动平滑 =====================
+// 每通道一个滤波器，在控制环每个节拍对目标脉宽滤波后再写PWM。
+// 配置以浮点形式随配置消息下发，configure()时换算为定点系数；
+// 每节拍的update()只使用整数运算（脉宽内部以Q8表示，系数以Q16表示）。
+
+enum FilterMode {
+  FILTER_NONE = 0,      // 直通
+  FILTER_EMA = 1,       // 指数滑动平均
+  FILTER_ONE_EURO = 2   // One Euro滤波（低速强平滑，高速低延迟）
+};
+
+// 滤波配置（与ChannelConfig一同通过配置消息下发）
+typedef struct {
+  int mode;                // FilterMode
+  float alpha;             // EMA系数（0~1，越小越平滑）
+  float minCutoff;         // One Euro最小截止频率（Hz）
+  float beta;              // One Euro速度系数（Hz / (us/s)）
+  int slewLimit;           // 每节拍最大脉宽变化（us），0为不限制
+} FilterConfig;
+
+inline FilterConfig defaultFilterConfig() {
+  FilterConfig cfg = { FILTER_NONE, 0.5f, 1.0f, 0.0f, 0 };
+  return cfg;
+}
+
+class MotionFilter {
+ public:
+  MotionFilter() { configure(defaultFilterConfig(), 20000); }
+
+  // 更新配置（仅在配置变化时调用），periodUs为控制环节拍周期
+  void configure(const FilterConfig& cfg, uint32_t periodUs) {
+    mode_ = (uint8_t)cfg.mode;
+    if (mode_ > FILTER_ONE_EURO) mode_ = FILTER_NONE;
+    alphaQ16_ = toQ16(cfg.alpha);
+    minCutoffQ8_ = cfg.minCutoff > 0 ? (uint32_t)(cfg.minCutoff * 256.0f + 0.5f) : 0;
+    betaQ16_ = toQ16(cfg.beta);
+    slewLimitQ8_ = cfg.slewLimit > 0 ? (int32_t)cfg.slewLimit << 8 : 0;
+    periodUs_ = periodUs > 0 ? periodUs : 1;
+    derivAlphaQ16_ = cutoffAlphaQ16(DERIVATIVE_CUTOFF_Q8);
+    settled_ = false;
+  }
+
+  // 重置内部状态，下一次update()直接输出输入值
+  void reset() { primed_ = false; }
+
+  // 上一次update()既没有改变滤波值也没有改变输出：输入不变时再运行也不会产生新输出
+  bool settled() const { return primed_ && settled_; }
+
+  // 输入目标脉宽，返回平滑后的脉宽
+  int update(int targetUs) {
+    int32_t x = (int32_t)targetUs << 8;
+    int32_t lastValue = value_;
+    if (!primed_) {
+      value_ = output_ = lastInput_ = x;
+      deriv_ = 0;
+      primed_ = true;
+      settled_ = false;
+      return targetUs;
+    }
+
+    switch (mode_) {
+      case FILTER_EMA:
+        value_ += mulQ16(x - value_, alphaQ16_);
+        break;
+      case FILTER_ONE_EURO: {
+        // 输入变化率（Q8 us/s）先做1Hz低通，再决定本节拍截止频率
+        int32_t rate = (int32_t)(((int64_t)(x - lastInput_) * 1000000) / (int32_t)periodUs_);
+        deriv_ += mulQ16(rate - deriv_, derivAlphaQ16_);
+        uint32_t speed = (uint32_t)(deriv_ < 0 ? -deriv_ : deriv_) >> 8;  // us/s
+        uint32_t cutoffQ8 = minCutoffQ8_ + (uint32_t)(((uint64_t)betaQ16_ * speed) >> 8);
+        value_ += mulQ16(x - value_, cutoffAlphaQ16(cutoffQ8));
+        break;
+      }
+      default:
+        value_ = x;
+        break;
+    }
+    lastInput_ = x;
+
+    // 限制每节拍变化量
+    int32_t delta = value_ - output_;
+    if (slewLimitQ8_ > 0) {
+      if (delta > slewLimitQ8_) delta = slewLimitQ8_;
+      else if (delta < -slewLimitQ8_) delta = -slewLimitQ8_;
+    }
+    output_ += delta;
+    settled_ = (delta == 0 && value_ == lastValue);
+    return (int)((output_ + 128) >> 8);
+  }
+
+ private:
+  static const uint32_t DERIVATIVE_CUTOFF_Q8 = 256;  // 导数低通1Hz
+  static const uint32_t TWO_PI_Q10 = 6434;           // 2π（Q10）
+
+  static uint32_t toQ16(float v) {
+    if (v <= 0) return 0;
+    if (v >= 1) return 65536;
+    return (uint32_t)(v * 65536.0f + 0.5f);
+  }
+
+  static int32_t mulQ16(int32_t v, uint32_t q16) {
+    return (int32_t)(((int64_t)v * q16) >> 16);
+  }
+
+  // 一阶低通系数 α = 2πfcT / (2πfcT + 1)，fc为Q8 Hz，结果为Q16
+  uint32_t cutoffAlphaQ16(uint32_t cutoffQ8) const {
+    uint64_t r = ((uint64_t)cutoffQ8 * periodUs_ * TWO_PI_Q10) >> 10;  // 2πfcT × 256e6
+    return (uint32_t)((r << 16) / (r + 256000000ULL));
+  }
+
+  uint8_t mode_ = FILTER_NONE;
+  uint32_t alphaQ16_ = 0;
+  uint32_t minCutoffQ8_ = 0;
+  uint32_t betaQ16_ = 0;
+  uint32_t derivAlphaQ16_ = 0;
+  int32_t slewLimitQ8_ = 0;
+  uint32_t periodUs_ = 20000;
+
+  bool primed_ = false;
+  bool settled_ = false;   // 上一节拍无变化
+  int32_t value_ = 0;      // 滤波值（Q8 us）
+  int32_t output_ = 0;     // 限速后的输出（Q8 us）
+  int32_t lastInput_ = 0;  // 上一节拍输入（Q8 us）
+  int32_t deriv_ = 0;      // 平滑后的变化率（Q8 us/s）
+};
@@ -0,0 +1,153 @@
+#pragma once
+#include <stdint.h>
+
+// ===================== 网络延迟补偿（外推预测） =====================
+// 姿态帧携带序号和客户端发送时刻。到达时刻减发送时刻 = 单向延迟 + 两端时钟差，
+// 取滑动窗口内的最小值作为基线（视为没有排队的最小延迟），当前帧高于基线的部分
+// 就是排队/重传带来的额外延迟；单向时间戳测不出的最小延迟本身用baseDelayUs补上。
+// 每轴角速度按相邻帧的客户端时刻计算（不受网络抖动影响）并做指数平滑，
+// 控制侧把目标外推到输出时刻，外推时长有上限。乱序/重复帧按序号丢弃，额外延迟过大的帧视为过期丢弃。
+// 纯整数、无硬件依赖，可在主机上用日志回放验证。
+
+const int PREDICT_AXES = 3;
+const int32_t PREDICT_WRAP_CENTI = 36000;  // 角度一周（0.01°），跨±180°时按最短方向计算速度
+
+struct PredictorConfig {
+  uint32_t baseDelayUs;      // 假设的最小单向延迟
+  uint32_t maxHorizonUs;     // 外推时长上限
+  uint32_t staleUs;          // 额外延迟超过该值的帧丢弃
+  uint32_t idleResetUs;      // 超过该时间没有帧则重置（客户端重连后序号从头开始）
+  uint32_t windowUs;         // 最小延迟基线的窗口长度
+  uint32_t maxGapMs;         // 相邻帧客户端时刻相差超过该值时不计算速度（视为停顿）
+  uint32_t velocityAlphaQ16; // 速度平滑系数（Q16）
+};
+
+inline PredictorConfig defaultPredictorConfig() {
+  PredictorConfig cfg = { 5000, 60000, 150000, 500000, 2000000, 200, 32768 };
+  return cfg;
+}
+
+enum PredictVerdict : uint8_t {
+  PREDICT_ACCEPTED,
+  PREDICT_OUT_OF_ORDER,   // 序号不大于上一帧（乱序或重复）
+  PREDICT_STALE           // 额外延迟超过staleUs
+};
+
+class MotionPredictor {
+ public:
+  explicit MotionPredictor(const PredictorConfig& cfg = defaultPredictorConfig()) : cfg_(cfg) { reset(); }
+
+  void configure(const PredictorConfig& cfg) {
+    cfg_ = cfg;
+    reset();
+  }
+
+  // 丢弃全部状态（下一帧无条件接受）
+  void reset() {
+    primed_ = false;
+    for (int i = 0; i < PREDICT_AXES; i++) {
+      angle_[i] = 0;
+      velocity_[i] = 0;
+    }
+    excessUs_ = 0;
+  }
+
+  // 输入一帧：seq/clientMs来自客户端，arrivalUs为本机收到该帧的时刻
+  PredictVerdict observe(uint16_t seq, uint32_t clientMs, uint32_t arrivalUs, const int32_t* angleCenti) {
+    if (primed_ && arrivalUs - lastArrivalUs_ > cfg_.idleResetUs) {
+      reset();
+    }
+
+    // 两端时钟差 + 单向延迟（按uint32回绕运算，只使用差值）
+    uint32_t offset = arrivalUs - clientMs * 1000u;
+    if (!primed_) {
+      windowStartUs_ = arrivalUs;
+      minOffset_ = prevMinOffset_ = offset;
+    } else {
+      if (arrivalUs - windowStartUs_ >= cfg_.windowUs) {
+        prevMinOffset_ = minOffset_;
+        minOffset_ = offset;
+        windowStartUs_ = arrivalUs;
+      } else if ((int32_t)(offset - minOffset_) < 0) {
+        minOffset_ = offset;
+      }
+      if ((int16_t)(seq - lastSeq_) <= 0) {
+        outOfOrder_++;
+        return PREDICT_OUT_OF_ORDER;
+      }
+    }
+
+    uint32_t baseline = (int32_t)(prevMinOffset_ - minOffset_) < 0 ? prevMinOffset_ : minOffset_;
+    int32_t excess = (int32_t)(offset - baseline);
+    if (excess < 0) excess = 0;
+    if (primed_ && (uint32_t)excess > cfg_.staleUs) {
+      lastSeq_ = seq;  // 过期帧之前的帧同样过期
+      stale_++;
+      return PREDICT_STALE;
+    }
+
+    uint32_t dtMs = clientMs - lastClientMs_;
+    for (int i = 0; i < PREDICT_AXES; i++) {
+      int32_t target = 0;
+      if (primed_ && dtMs > 0 && dtMs <= cfg_.maxGapMs) {
+        int32_t delta = angleCenti[i] - angle_[i];
+        if (delta > PREDICT_WRAP_CENTI / 2) delta -= PREDICT_WRAP_CENTI;
+        else if (delta < -PREDICT_WRAP_CENTI / 2) delta += PREDICT_WRAP_CENTI;
+        target = (int32_t)((int64_t)delta * 1000 / (int32_t)dtMs);
+        velocity_[i] += (int32_t)(((int64_t)(target - velocity_[i]) * cfg_.velocityAlphaQ16) >> 16);
+      } else if (primed_ && dtMs > cfg_.maxGapMs) {
+        velocity_[i] = 0;
+      }
+      angle_[i] = angleCenti[i];
+    }
+
+    primed_ = true;
+    lastSeq_ = seq;
+    lastClientMs_ = clientMs;
+    lastArrivalUs_ = arrivalUs;
+    excessUs_ = excess;
+    accepted_++;
+    return PREDICT_ACCEPTED;
+  }
+
+  // 外推到nowUs（通常为下一个输出节拍），写入out[PREDICT_AXES]；尚无数据时返回false
+  bool predict(uint32_t nowUs, int32_t* out) const {
+    if (!primed_) return false;
+    uint32_t horizon = horizonUs(nowUs);
+    for (int i = 0; i < PREDICT_AXES; i++) {
+      out[i] = angle_[i] + (int32_t)(((int64_t)velocity_[i] * horizon) / 1000000);
+    }
+    return true;
+  }
+
+  // 最近一帧从采样到nowUs的估计时长（已限制在maxHorizonUs内）
+  uint32_t horizonUs(uint32_t nowUs) const {
+    int32_t sinceArrival = (int32_t)(nowUs - lastArrivalUs_);
+    if (sinceArrival < 0) sinceArrival = 0;
+    uint32_t age = (uint32_t)sinceArrival + delayUs();
+    return age > cfg_.maxHorizonUs ? cfg_.maxHorizonUs : age;
+  }
+
+  uint32_t delayUs() const { return cfg_.baseDelayUs + excessUs_; }  // 最近一帧的估计单向延迟
+  int32_t velocity(int axis) const { return velocity_[axis]; }       // 0.01°/s
+  bool primed() const { return primed_; }
+  uint32_t accepted() const { return accepted_; }
+  uint32_t outOfOrder() const { return outOfOrder_; }
+  uint32_t stale() const { return stale_; }
+
+ private:
+  PredictorConfig cfg_;
+  bool primed_ = false;
+  uint16_t lastSeq_ = 0;
+  uint32_t lastClientMs_ = 0;
+  uint32_t lastArrivalUs_ = 0;
+  uint32_t windowStartUs_ = 0;
+  uint32_t minOffset_ = 0;       // 当前窗口内的最小时钟差
+  uint32_t prevMinOffset_ = 0;   // 上一窗口的最小时钟差
+  uint32_t excessUs_ = 0;        // 最近一帧的额外延迟
+  int32_t angle_[PREDICT_AXES];
+  int32_t velocity_[PREDICT_AXES];
+  uint32_t accepted_ = 0;
+  uint32_t outOfOrder_ = 0;
+  uint32_t stale_ = 0;
+};
@@ -0,0 +1,267 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "ChannelTable.h"
+#include "ConfigStore.h"
+
+// ===================== 动作录制与回放 =====================
+// 录制控制环取到的目标脉宽（映射后的脉宽流），按块增量编码存入RAM环形缓冲：
+// 每块以关键帧开头（通道数、时刻、各通道绝对脉宽），其后每个样本只写时间差和各通道脉宽差
+// （zigzag变长整数，静止通道只占1字节）。块之间互不依赖，缓冲满时直接丢弃最旧的块。
+// 录制结束后可把全部块按时间顺序串接写入flash（NVS，带CRC）；回放由控制环节拍驱动，
+// 按录制时的时间间隔输出，不经过网络。
+//
+// 串接格式（flash与回放共用）：重复 [块长度 u16][块数据]
+//   块数据：[通道数 u8][时刻 ms u32][脉宽 u16 × 通道数]                  关键帧
+//           { [时间差 ms varint][脉宽差 zigzag varint × 通道数] } × N    增量样本
+
+const uint16_t MOTION_FORMAT_VERSION = 1;
+const int MOTION_SLOTS = 4;               // flash中的录制槽位数
+
+// 无符号变长整数（每字节7位，最高位表示后续还有字节），返回写入字节数
+inline size_t motionPutVarint(uint8_t* p, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+// 读取变长整数，返回消耗的字节数（数据不完整返回0）
+inline size_t motionGetVarint(const uint8_t* p, size_t avail, uint32_t& v) {
+  v = 0;
+  for (size_t n = 0; n < avail && n < 5; n++) {
+    v |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+    if (!(p[n] & 0x80)) return n + 1;
+  }
+  return 0;
+}
+
+inline uint32_t motionZigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t motionUnzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// 录制器：BLOCKS个BLOCK_SIZE字节的块组成环形缓冲
+template <int BLOCKS, int BLOCK_SIZE>
+class MotionRecorder {
+ public:
+  // 串接后的最大字节数（含每块的长度前缀）
+  static const size_t SERIALIZED_CAPACITY = (size_t)BLOCKS * (BLOCK_SIZE + 2);
+
+  void start(uint32_t nowMs) {
+    recording_ = true;
+    startMs_ = nowMs;
+    first_ = 0;
+    blocks_ = 0;
+    samples_ = 0;
+    droppedBlocks_ = 0;
+    lastTimeMs_ = 0;
+    channels_ = 0;
+  }
+
+  void stop() { recording_ = false; }
+
+  // 追加一个样本（nowMs为本机时刻），未在录制时返回false
+  bool record(uint32_t nowMs, int count, const int* pulse) {
+    if (!recording_) return false;
+    if (count < 0) count = 0;
+    if (count > MAX_SERVO_CHANNELS) count = MAX_SERVO_CHANNELS;
+    uint32_t timeMs = nowMs - startMs_;
+
+    // 通道数变化或当前块放不下一个最坏情况的样本时开新块
+    const size_t worst = 5 + 3 * (size_t)count;
+    if (blocks_ == 0 || count != channels_ || used_[current()] + worst > BLOCK_SIZE) {
+      openBlock(timeMs, count, pulse);
+    } else {
+      uint8_t* p = data_[current()] + used_[current()];
+      size_t n = motionPutVarint(p, timeMs - lastTimeMs_);
+      for (int i = 0; i < count; i++) {
+        n += motionPutVarint(p + n, motionZigzag(pulse[i] - last_[i]));
+        last_[i] = pulse[i];
+      }
+      used_[current()] += (uint16_t)n;
+    }
+    lastTimeMs_ = timeMs;
+    samples_++;
+    return true;
+  }
+
+  // 按时间顺序串接全部块到out，返回字节数（空间不足返回0）
+  size_t serialize(uint8_t* out, size_t capacity) const {
+    size_t pos = 0;
+    for (int b = 0; b < blocks_; b++) {
+      int idx = (first_ + b) % BLOCKS;
+      if (pos + 2 + used_[idx] > capacity) return 0;
+      out[pos++] = (uint8_t)(used_[idx] & 0xFF);
+      out[pos++] = (uint8_t)(used_[idx] >> 8);
+      memcpy(out + pos, data_[idx], used_[idx]);
+      pos += used_[idx];
+    }
+    return pos;
+  }
+
+  bool recording() const { return recording_; }
+  uint32_t samples() const { return samples_; }
+  uint32_t durationMs() const { return lastTimeMs_; }
+  uint32_t droppedBlocks() const { return droppedBlocks_; }
+
+  // 当前占用字节数（不含长度前缀）
+  size_t bytes() const {
+    size_t total = 0;
+    for (int b = 0; b < blocks_; b++) total += used_[(first_ + b) % BLOCKS];
+    return total;
+  }
+
+ private:
+  int current() const { return (first_ + blocks_ - 1) % BLOCKS; }
+
+  void openBlock(uint32_t timeMs, int count, const int* pulse) {
+    if (blocks_ == BLOCKS) {
+      first_ = (first_ + 1) % BLOCKS;   // 丢弃最旧的块
+      blocks_--;
+      droppedBlocks_++;
+    }
+    blocks_++;
+    uint8_t* p = data_[current()];
+    size_t n = 0;
+    p[n++] = (uint8_t)count;
+    for (int s = 0; s < 4; s++) p[n++] = (uint8_t)(timeMs >> (8 * s));
+    for (int i = 0; i < count; i++) {
+      p[n++] = (uint8_t)(pulse[i] & 0xFF);
+      p[n++] = (uint8_t)((pulse[i] >> 8) & 0xFF);
+      last_[i] = pulse[i];
+    }
+    used_[current()] = (uint16_t)n;
+    channels_ = count;
+  }
+
+  uint8_t data_[BLOCKS][BLOCK_SIZE];
+  uint16_t used_[BLOCKS];
+  int first_ = 0;               // 最旧块的下标
+  int blocks_ = 0;              // 已用块数
+  int channels_ = 0;            // 当前块的通道数
+  int last_[MAX_SERVO_CHANNELS]; // 上一样本的脉宽（增量基准）
+  bool recording_ = false;
+  uint32_t startMs_ = 0;
+  uint32_t lastTimeMs_ = 0;     // 上一样本时刻（相对录制开始）
+  uint32_t samples_ = 0;
+  uint32_t droppedBlocks_ = 0;
+};
+
+// 回放器：在串接格式的数据上顺序解码，不拷贝
+class MotionPlayer {
+ public:
+  void begin(const uint8_t* data, size_t length) {
+    data_ = data;
+    length_ = length;
+    pos_ = 0;
+    blockEnd_ = 0;
+    samples_ = 0;
+    count_ = 0;
+    pending_ = readSample();
+  }
+
+  // 推进到elapsedMs（相对回放开始），期间最后一个样本写入count/pulse；有新样本返回true
+  bool advance(uint32_t elapsedMs, int& count, int* pulse) {
+    bool updated = false;
+    while (pending_ && nextTimeMs_ <= elapsedMs) {
+      count = count_;
+      for (int i = 0; i < count_; i++) pulse[i] = next_[i];
+      updated = true;
+      samples_++;
+      pending_ = readSample();
+    }
+    return updated;
+  }
+
+  bool finished() const { return !pending_; }
+  uint32_t samples() const { return samples_; }
+
+ private:
+  // 解码下一个样本到next_/nextTimeMs_，数据结束或损坏返回false
+  bool readSample() {
+    if (pos_ >= blockEnd_) {
+      // 新块：长度前缀 + 关键帧
+      if (pos_ + 2 > length_) return false;
+      size_t blockLen = data_[pos_] | (data_[pos_ + 1] << 8);
+      pos_ += 2;
+      if (blockLen < 5 || pos_ + blockLen > length_) return false;
+      blockEnd_ = pos_ + blockLen;
+      int count = data_[pos_++];
+      if (count > MAX_SERVO_CHANNELS || pos_ + 4 + 2 * (size_t)count > blockEnd_) return false;
+      uint32_t timeMs = 0;
+      for (int s = 0; s < 4; s++) timeMs |= (uint32_t)data_[pos_++] << (8 * s);
+      for (int i = 0; i < count; i++) {
+        next_[i] = (int16_t)(data_[pos_] | (data_[pos_ + 1] << 8));
+        pos_ += 2;
+      }
+      count_ = count;
+      nextTimeMs_ = timeMs;
+      return true;
+    }
+    uint32_t v;
+    size_t n = motionGetVarint(data_ + pos_, blockEnd_ - pos_, v);
+    if (n == 0) return false;
+    pos_ += n;
+    nextTimeMs_ += v;
+    for (int i = 0; i < count_; i++) {
+      n = motionGetVarint(data_ + pos_, blockEnd_ - pos_, v);
+      if (n == 0) return false;
+      pos_ += n;
+      next_[i] += motionUnzigzag(v);
+    }
+    return true;
+  }
+
+  const uint8_t* data_ = nullptr;
+  size_t length_ = 0;
+  size_t pos_ = 0;
+  size_t blockEnd_ = 0;
+  bool pending_ = false;        // next_中是否有尚未输出的样本
+  int count_ = 0;
+  int next_[MAX_SERVO_CHANNELS];
+  uint32_t nextTimeMs_ = 0;
+  uint32_t samples_ = 0;
+};
+
+// flash槽位的键名（"motion0"~"motion3"）
+inline void motionSlotKey(int slot, char* key, size_t size) {
+  snprintf(key, size, "motion%d", slot);
+}
+
+// 串接数据写入flash槽位：blob前sizeof(ConfigBlobHeader)字节留给头部，数据已位于其后
+inline bool saveMotionSlot(int slot, uint8_t* blob, size_t length) {
+  if (slot < 0 || slot >= MOTION_SLOTS || length > 0xFFFF) return false;
+  char key[12];
+  motionSlotKey(slot, key, sizeof(key));
+  size_t total = sealConfigBlob(blob, (uint16_t)length, MOTION_FORMAT_VERSION);
+  return writeConfigBlob(key, blob, total);
+}
+
+// 读取flash槽位，成功后数据位于blob + sizeof(ConfigBlobHeader)，长度写入length
+inline ConfigLoadResult loadMotionSlot(int slot, uint8_t* blob, size_t capacity, size_t& length) {
+  if (slot < 0 || slot >= MOTION_SLOTS) return CONFIG_MISSING;
+  char key[12];
+  motionSlotKey(slot, key, sizeof(key));
+  size_t blobLength = 0;
+  if (!readConfigBlob(key, blob, capacity, blobLength)) return CONFIG_MISSING;
+  if (blobLength > capacity) return CONFIG_BAD_SIZE;
+  uint16_t size = 0;
+  ConfigLoadResult result = openConfigBlob(blob, blobLength, MOTION_FORMAT_VERSION, size);
+  length = size;
+  return result;
+}
+
+// 槽位中数据的字节数（不读取内容，不存在返回0）
+inline size_t motionSlotBytes(int slot) {
+  if (slot < 0 || slot >= MOTION_SLOTS) return 0;
+  char key[12];
+  motionSlotKey(slot, key, sizeof(key));
+  size_t blobLength = 0;
+  uint8_t probe;
+  if (!readConfigBlob(key, &probe, 0, blobLength) || blobLength < sizeof(ConfigBlobHeader)) return 0;
+  return blobLength - sizeof(ConfigBlobHeader);
+}
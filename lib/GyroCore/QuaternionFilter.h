@@ -0,0 +1,285 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+// ===================== 姿态融合（定点Mahony四元数滤波） =====================
+// 网页端deviceorientation算好的欧拉角在偏航±180°处跳变，在万向节锁附近剧烈翻转，
+// 固件逐轴限幅后舵机会整程甩动。IMU模式下客户端改为批量上传原始角速度和含重力加速度，
+// 设备端用Mahony互补滤波融合成四元数：陀螺积分给出姿态，加速度方向与估计重力方向的叉积作为误差，
+// 比例项即时修正俯仰/横滚漂移，积分项估计陀螺零偏；静止时另按陀螺读数缓慢跟踪三轴零偏（含偏航）。
+// 姿态归零在四元数空间进行：记下当前四元数作参考，之后输出相对参考姿态的旋转，
+// 跳变点和万向节锁都离归零姿态90°/180°以上。
+// 四元数和单位向量为Q30，角速度为Q24 rad/s；每样本只用32x32->64乘法、移位和一次32位除法
+// （加速度归一化），四元数归一化用1附近的牛顿迭代。欧拉角每批输出一次，用单精度浮点。
+// 纯逻辑，主机上的精度与每样本周期数见 tools/fusion_bench.cpp。
+
+const int FUSION_AXES = 3;
+const int32_t FUSION_ONE_Q30 = 1 << 30;
+const int32_t FUSION_DECIDEG_TO_RAD_Q24 = 29282;   // 0.1°/s -> rad/s（Q24）：0.1*pi/180*2^24
+
+struct FusionConfig {
+  int32_t kpQ16;              // 比例增益（rad/s每单位误差，Q16）
+  int32_t kiQ16;              // 积分增益（Q16）
+  int32_t integralLimitQ24;   // 积分项上限（rad/s，Q24），防止长时间加速时饱和
+  int32_t minAccelMm;         // 加速度模长低于该值（抛起/失重）时不修正（mm/s²）
+  int32_t maxAccelMm;         // 高于该值（甩动）时不修正
+  int32_t stillRateDecideg;   // 去零偏后三轴角速度都低于该值视为静止（0.1°/s）
+  uint16_t stillSamples;      // 连续静止达到该样本数后开始跟踪零偏
+  uint8_t biasShift;          // 零偏跟踪的平滑系数 2^-biasShift
+};
+
+inline FusionConfig defaultFusionConfig() {
+  FusionConfig cfg = { 65536, 3277, 1464000, 4900, 14700, 30, 50, 6 };
+  return cfg;
+}
+
+struct QuatQ30 {
+  int32_t w, x, y, z;
+};
+
+// 四元数乘法 a⊗b（Q30）
+inline QuatQ30 quatMultiplyQ30(const QuatQ30& a, const QuatQ30& b) {
+  QuatQ30 r;
+  r.w = (int32_t)(((int64_t)a.w * b.w - (int64_t)a.x * b.x - (int64_t)a.y * b.y - (int64_t)a.z * b.z) >> 30);
+  r.x = (int32_t)(((int64_t)a.w * b.x + (int64_t)a.x * b.w + (int64_t)a.y * b.z - (int64_t)a.z * b.y) >> 30);
+  r.y = (int32_t)(((int64_t)a.w * b.y - (int64_t)a.x * b.z + (int64_t)a.y * b.w + (int64_t)a.z * b.x) >> 30);
+  r.z = (int32_t)(((int64_t)a.w * b.z + (int64_t)a.x * b.y - (int64_t)a.y * b.x + (int64_t)a.z * b.w) >> 30);
+  return r;
+}
+
+// 逐位整数平方根
+inline uint32_t fusionIsqrt32(uint32_t v) {
+  uint32_t root = 0;
+  uint32_t bit = 1u << 30;
+  while (bit > v) bit >>= 2;
+  while (bit) {
+    if (v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+class QuaternionFilter {
+ public:
+  explicit QuaternionFilter(const FusionConfig& cfg = defaultFusionConfig()) : cfg_(cfg) { reset(); }
+
+  void configure(const FusionConfig& cfg) {
+    cfg_ = cfg;
+    reset();
+  }
+
+  // 丢弃姿态与零偏估计（下一样本按加速度方向重新初始化）
+  void reset() {
+    q_ = ref_ = identity();
+    for (int i = 0; i < FUSION_AXES; i++) {
+      integral_[i] = 0;
+      bias_[i] = 0;
+    }
+    stillCount_ = 0;
+    dtUs_ = 0;
+    halfDtQ32_ = 0;
+    initialized_ = false;
+  }
+
+  // 输入一个样本：gyro为设备坐标系x/y/z角速度（0.1°/s），accel为含重力加速度（mm/s²），
+  // dtUs为距上一样本的时间。第一个有效样本只用加速度确定俯仰/横滚（偏航记为0）并设为参考姿态
+  void update(const int16_t* gyroDecideg, const int16_t* accelMm, uint32_t dtUs) {
+    int32_t unit[FUSION_AXES];
+    bool accelValid = normalizeAccel(accelMm, unit);
+    if (!initialized_) {
+      if (!accelValid) return;
+      initFromGravity(unit);
+      return;
+    }
+    samples_++;
+
+    int32_t rate[FUSION_AXES];
+    bool still = true;
+    int32_t limit = cfg_.stillRateDecideg * FUSION_DECIDEG_TO_RAD_Q24;
+    for (int i = 0; i < FUSION_AXES; i++) {
+      rate[i] = gyroDecideg[i] * FUSION_DECIDEG_TO_RAD_Q24;
+      int32_t residual = rate[i] - bias_[i];
+      if (residual > limit || residual < -limit) still = false;
+    }
+    // 静止时零偏向陀螺读数收敛（加速度计看不到的偏航零偏只能靠这里修正）
+    if (still && accelValid) {
+      if (stillCount_ < cfg_.stillSamples) stillCount_++;
+      else {
+        for (int i = 0; i < FUSION_AXES; i++) bias_[i] += (rate[i] - bias_[i]) >> cfg_.biasShift;
+      }
+    } else {
+      stillCount_ = 0;
+    }
+
+    if (dtUs != dtUs_) {
+      dtUs_ = dtUs;
+      halfDtQ32_ = (uint32_t)(((uint64_t)dtUs << 31) / 1000000u);   // dt/2（秒，Q32）
+    }
+
+    for (int i = 0; i < FUSION_AXES; i++) rate[i] -= bias_[i];
+    if (accelValid) {
+      // 估计的重力方向（机体坐标系）与测得方向的叉积即姿态误差
+      int32_t v[FUSION_AXES];
+      v[0] = (int32_t)(((int64_t)q_.x * q_.z - (int64_t)q_.w * q_.y) >> 29);
+      v[1] = (int32_t)(((int64_t)q_.w * q_.x + (int64_t)q_.y * q_.z) >> 29);
+      v[2] = (int32_t)(((int64_t)q_.w * q_.w - (int64_t)q_.x * q_.x - (int64_t)q_.y * q_.y +
+                        (int64_t)q_.z * q_.z) >> 30);
+      int32_t e[FUSION_AXES];
+      e[0] = (int32_t)(((int64_t)unit[1] * v[2] - (int64_t)unit[2] * v[1]) >> 30);
+      e[1] = (int32_t)(((int64_t)unit[2] * v[0] - (int64_t)unit[0] * v[2]) >> 30);
+      e[2] = (int32_t)(((int64_t)unit[0] * v[1] - (int64_t)unit[1] * v[0]) >> 30);
+      for (int i = 0; i < FUSION_AXES; i++) {
+        if (cfg_.kiQ16 > 0) {
+          int32_t step = (int32_t)(((int64_t)cfg_.kiQ16 * e[i]) >> 22);          // Q24 rad/s²
+          integral_[i] += (int32_t)(((int64_t)step * halfDtQ32_) >> 31);
+          if (integral_[i] > cfg_.integralLimitQ24) integral_[i] = cfg_.integralLimitQ24;
+          else if (integral_[i] < -cfg_.integralLimitQ24) integral_[i] = -cfg_.integralLimitQ24;
+        }
+        rate[i] += (int32_t)(((int64_t)cfg_.kpQ16 * e[i]) >> 22) + integral_[i];
+      }
+    } else {
+      accelRejected_++;
+    }
+
+    // q += q ⊗ (0, ω·dt/2)
+    int32_t hx = (int32_t)(((int64_t)rate[0] * halfDtQ32_) >> 26);
+    int32_t hy = (int32_t)(((int64_t)rate[1] * halfDtQ32_) >> 26);
+    int32_t hz = (int32_t)(((int64_t)rate[2] * halfDtQ32_) >> 26);
+    QuatQ30 q = q_;
+    q_.w += (int32_t)((-(int64_t)q.x * hx - (int64_t)q.y * hy - (int64_t)q.z * hz) >> 30);
+    q_.x += (int32_t)(((int64_t)q.w * hx + (int64_t)q.y * hz - (int64_t)q.z * hy) >> 30);
+    q_.y += (int32_t)(((int64_t)q.w * hy - (int64_t)q.x * hz + (int64_t)q.z * hx) >> 30);
+    q_.z += (int32_t)(((int64_t)q.w * hz + (int64_t)q.x * hy - (int64_t)q.y * hx) >> 30);
+    normalize();
+  }
+
+  // 姿态归零：当前姿态作为参考
+  void setReference() { ref_ = q_; }
+
+  // 相对参考姿态的欧拉角（0.01°），顺序pitch（绕x）/roll（绕y）/yaw（绕z）。
+  // 与deviceorientation的beta/gamma/alpha同一约定（Z-X'-Y''）：pitch ±180°、roll ±90°、yaw ±180°
+  void relativeEulerCenti(int32_t* outCenti) const {
+    QuatQ30 conj = { ref_.w, -ref_.x, -ref_.y, -ref_.z };
+    QuatQ30 r = quatMultiplyQ30(conj, q_);
+    const float s = 1.0f / FUSION_ONE_Q30;
+    float w = r.w * s, x = r.x * s, y = r.y * s, z = r.z * s;
+
+    float sinPitch = 2.0f * (y * z + w * x);
+    if (sinPitch > 1.0f) sinPitch = 1.0f;
+    else if (sinPitch < -1.0f) sinPitch = -1.0f;
+    float pitch = asinf(sinPitch);
+    float roll, yaw;
+    if (fabsf(sinPitch) > 0.99999f) {
+      // 万向节锁：横滚与偏航不可分，全部记到偏航
+      roll = 0.0f;
+      yaw = atan2f(2.0f * (x * y + w * z), 1.0f - 2.0f * (y * y + z * z));
+    } else {
+      roll = atan2f(-2.0f * (x * z - w * y), 1.0f - 2.0f * (x * x + y * y));
+      yaw = atan2f(-2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z));
+    }
+    // 换到横滚±90°的等价解（俯仰扩展到±180°），与网页端原有角度范围一致
+    const float halfPi = 1.57079633f, pi = 3.14159265f;
+    if (roll > halfPi || roll < -halfPi) {
+      roll += roll > 0 ? -pi : pi;
+      pitch = (pitch >= 0 ? pi : -pi) - pitch;
+      yaw += yaw > 0 ? -pi : pi;
+    }
+    // 俯仰接近±90°时横滚与偏航只有和（+90°）或差（-90°）可观测，各自的值随很小的姿态误差大幅摆动。
+    // 距锁点GIMBAL_ZONE以内保持可观测的组合不变，横滚按(cos俯仰/cos边界)²收向0、差额并入偏航，
+    // 到锁点时与上面的万向节锁分支一致，输出在锁点两侧连续
+    float cosPitch = fabsf(cosf(pitch));
+    if (cosPitch < GIMBAL_ZONE_COS) {
+      float k = cosPitch / GIMBAL_ZONE_COS;
+      float side = pitch >= 0 ? 1.0f : -1.0f;
+      float damped = roll * k * k;
+      yaw += side * (roll - damped);
+      roll = damped;
+      if (yaw > pi) yaw -= 2.0f * pi;
+      else if (yaw < -pi) yaw += 2.0f * pi;
+    }
+    outCenti[0] = radiansToCenti(pitch);
+    outCenti[1] = radiansToCenti(roll);
+    outCenti[2] = radiansToCenti(yaw);
+  }
+
+  bool initialized() const { return initialized_; }
+  const QuatQ30& quaternion() const { return q_; }
+  const QuatQ30& reference() const { return ref_; }
+  int32_t biasQ24(int axis) const { return bias_[axis]; }
+  uint32_t samples() const { return samples_; }
+  uint32_t accelRejected() const { return accelRejected_; }
+
+ private:
+  static QuatQ30 identity() {
+    QuatQ30 q = { FUSION_ONE_Q30, 0, 0, 0 };
+    return q;
+  }
+
+  static constexpr float GIMBAL_ZONE_COS = 0.258819f;  // cos(75°)：俯仰距±90°不到15°
+
+  static int32_t radiansToCenti(float radians) {
+    float centi = radians * 5729.57795f;
+    return (int32_t)(centi >= 0 ? centi + 0.5f : centi - 0.5f);
+  }
+
+  // 加速度单位向量（Q30）；模长超出[minAccelMm, maxAccelMm]时返回false
+  bool normalizeAccel(const int16_t* accelMm, int32_t* unit) const {
+    uint32_t norm2 = 0;
+    for (int i = 0; i < FUSION_AXES; i++) norm2 += (uint32_t)((int32_t)accelMm[i] * accelMm[i]);
+    uint32_t minNorm = (uint32_t)cfg_.minAccelMm, maxNorm = (uint32_t)cfg_.maxAccelMm;
+    if (norm2 < minNorm * minNorm || norm2 > maxNorm * maxNorm) return false;
+    uint32_t norm = fusionIsqrt32(norm2);
+    uint32_t recip = (1u << 31) / norm;   // 2^31/|a|，|a|>=minAccelMm时约有18位精度
+    for (int i = 0; i < FUSION_AXES; i++) unit[i] = (int32_t)(((int64_t)accelMm[i] * recip) >> 1);
+    return true;
+  }
+
+  // 由重力方向初始化：q = qx(pitch) ⊗ qy(roll)，偏航为0
+  void initFromGravity(const int32_t* unit) {
+    const float s = 1.0f / FUSION_ONE_Q30;
+    float ax = unit[0] * s, ay = unit[1] * s, az = unit[2] * s;
+    float pitch = atan2f(ay, sqrtf(ax * ax + az * az));
+    float roll = atan2f(-ax, az);
+    float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+    float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+    q_.w = (int32_t)(cp * cr * FUSION_ONE_Q30);
+    q_.x = (int32_t)(sp * cr * FUSION_ONE_Q30);
+    q_.y = (int32_t)(cp * sr * FUSION_ONE_Q30);
+    q_.z = (int32_t)(sp * sr * FUSION_ONE_Q30);
+    ref_ = q_;
+    initialized_ = true;
+  }
+
+  // 归一化：|q|²接近1时用一次牛顿迭代 q *= (3 - |q|²)/2，偏离较大（大步长）时精确开方
+  void normalize() {
+    int64_t n2 = ((int64_t)q_.w * q_.w + (int64_t)q_.x * q_.x + (int64_t)q_.y * q_.y + (int64_t)q_.z * q_.z) >> 30;
+    int64_t deviation = n2 - FUSION_ONE_Q30;
+    int32_t scale;
+    if (deviation < (FUSION_ONE_Q30 >> 6) && deviation > -(FUSION_ONE_Q30 >> 6)) {
+      scale = (int32_t)((3 * (int64_t)FUSION_ONE_Q30 - n2) >> 1);
+    } else {
+      scale = (int32_t)(((int64_t)1 << 45) / fusionIsqrt32((uint32_t)n2));   // 2^30/sqrt(|q|²)
+    }
+    q_.w = (int32_t)(((int64_t)q_.w * scale) >> 30);
+    q_.x = (int32_t)(((int64_t)q_.x * scale) >> 30);
+    q_.y = (int32_t)(((int64_t)q_.y * scale) >> 30);
+    q_.z = (int32_t)(((int64_t)q_.z * scale) >> 30);
+  }
+
+  FusionConfig cfg_;
+  QuatQ30 q_;                       // 当前姿态（机体 -> 世界）
+  QuatQ30 ref_;                     // 归零参考姿态
+  int32_t integral_[FUSION_AXES];   // 积分反馈（Q24 rad/s）
+  int32_t bias_[FUSION_AXES];       // 静止零偏估计（Q24 rad/s）
+  uint16_t stillCount_;
+  uint32_t dtUs_;
+  uint32_t halfDtQ32_;
+  bool initialized_;
+  uint32_t samples_ = 0;
+  uint32_t accelRejected_ = 0;
+};
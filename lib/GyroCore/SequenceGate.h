@@ -0,0 +1,69 @@
+#pragma once
+#include <stdint.h>
+
+// ===================== UDP控制通道：序号闸门 =====================
+// 姿态/脉宽帧也可以走UDP数据报（载荷与WebSocket二进制帧相同的GyroFrame）。TCP丢一个包，
+// 之后的所有帧都要排在重传之后（队头阻塞），而控制只关心最新一帧：UDP下丢掉的帧直接跳过，
+// 迟到或重复的数据报（序号不大于已接受的序号，按uint16回绕比较）在进入流水线前丢弃。
+// 同一时刻只跟随一个发送端（IP+端口），它静默超过idleMs后才接受新的发送端，
+// 新发送端的第一帧无条件接受（序号从头开始）。纯逻辑，可在主机上测试。
+
+enum UdpVerdict : uint8_t {
+  UDP_ACCEPTED,
+  UDP_LATE,      // 迟到/重复（序号不大于已接受序号）
+  UDP_FOREIGN    // 来自其他发送端，当前发送端仍活跃
+};
+
+class SequenceGate {
+ public:
+  explicit SequenceGate(uint32_t idleMs) : idleMs_(idleMs) {}
+
+  UdpVerdict admit(uint32_t sourceIp, uint16_t sourcePort, uint16_t seq, uint32_t nowMs) {
+    bool sameSource = active_ && sourceIp == ip_ && sourcePort == port_;
+    bool idle = !active_ || nowMs - lastMs_ >= idleMs_;
+    if (!sameSource) {
+      if (!idle) {
+        foreign_++;
+        return UDP_FOREIGN;
+      }
+      active_ = true;
+      ip_ = sourceIp;
+      port_ = sourcePort;
+      lastSeq_ = seq;
+      lastMs_ = nowMs;
+      sources_++;
+      accepted_++;
+      return UDP_ACCEPTED;
+    }
+    int16_t delta = (int16_t)(seq - lastSeq_);
+    if (delta <= 0 && !idle) {
+      late_++;
+      return UDP_LATE;
+    }
+    if (delta > 1 && !idle) gaps_ += (uint32_t)(delta - 1);  // 中间的序号丢失或仍在路上（到达后会被判为迟到）
+    lastSeq_ = seq;
+    lastMs_ = nowMs;
+    accepted_++;
+    return UDP_ACCEPTED;
+  }
+
+  bool active() const { return active_; }
+  uint32_t accepted() const { return accepted_; }
+  uint32_t late() const { return late_; }
+  uint32_t gaps() const { return gaps_; }
+  uint32_t foreign() const { return foreign_; }
+  uint32_t sources() const { return sources_; }
+
+ private:
+  uint32_t idleMs_;
+  bool active_ = false;
+  uint32_t ip_ = 0;
+  uint16_t port_ = 0;
+  uint16_t lastSeq_ = 0;
+  uint32_t lastMs_ = 0;
+  uint32_t accepted_ = 0;
+  uint32_t late_ = 0;
+  uint32_t gaps_ = 0;
+  uint32_t foreign_ = 0;
+  uint32_t sources_ = 0;
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include <stdint.h>
+#include <type_traits>
+#include "ControlLoop.h"
+#include "DutyKernel.h"
+#include "MotionFilter.h"
+
+// ===================== 舵机输出级（编译期特化） =====================
+// V1/V2控制环共用的最后一段：目标脉宽 -> 平滑滤波 -> 占空比 -> 仅在变化时写PWM。
+// 通道数、滤波策略、写入函数都是模板参数，由各PlatformIO环境的编译开关选定，
+// 节拍内不再判断“这个固件有没有滤波/有几路”：
+// - SmoothingFilter<N>：每通道一个MotionFilter（滤波模式仍可在运行时按通道配置）；
+// - DirectFilter<N>：没有滤波状态，目标脉宽直接换算占空比，settled()恒为true，
+//   控制环“等待滤波收敛”的空闲节拍判断整段被编译器消去；
+// - 已绑定通道记在位掩码里，节拍内按置位逐个处理，不逐通道判断是否绑定。
+// 纯逻辑，写入函数由调用方提供（ESP32上为ledcWrite，主机基准测试中为计数器）。
+
+template <int N>
+class SmoothingFilter {
+ public:
+  static constexpr bool STATEFUL = true;
+  void configure(int channel, const FilterConfig& cfg, uint32_t periodUs) { filters_[channel].configure(cfg, periodUs); }
+  int apply(int channel, int pulseUs) { return filters_[channel].update(pulseUs); }
+  bool settled(int channel) const { return filters_[channel].settled(); }
+
+ private:
+  MotionFilter filters_[N];
+};
+
+template <int N>
+class DirectFilter {
+ public:
+  static constexpr bool STATEFUL = false;
+  void configure(int, const FilterConfig&, uint32_t) {}
+  int apply(int, int pulseUs) { return pulseUs; }
+  bool settled(int) const { return true; }
+};
+
+// 按编译开关选择滤波策略
+template <int N, bool SMOOTHING>
+using ServoFilterFor = typename std::conditional<SMOOTHING, SmoothingFilter<N>, DirectFilter<N> >::type;
+
+// Writer须提供 static void write(int channel, uint32_t duty)
+template <int CHANNELS, typename Filter, typename Writer>
+class ServoOutput {
+  static_assert(CHANNELS > 0 && CHANNELS <= 32, "ServoOutput: 通道位掩码最多32路");
+
+ public:
+  static constexpr int channels = CHANNELS;
+
+  ServoOutput(int resolutionBits, uint32_t periodUs) : kernel_(resolutionBits, periodUs) {}
+
+  // 绑定/解绑PWM通道（引脚变化时调用），超出编译期通道数的通道忽略
+  void attach(int channel, bool on) {
+    if (channel < 0 || channel >= CHANNELS) return;
+    if (on) {
+      mask_ |= 1u << channel;
+    } else {
+      mask_ &= ~(1u << channel);
+    }
+    cache_.invalidate();
+  }
+
+  bool attached(int channel) const {
+    return channel >= 0 && channel < CHANNELS && (mask_ & (1u << channel)) != 0;
+  }
+
+  void configure(int channel, const FilterConfig& cfg, uint32_t tickUs) {
+    if (channel < 0 || channel >= CHANNELS) return;
+    filter_.configure(channel, cfg, tickUs);
+  }
+
+  // 一个控制节拍：pulseUs至少有CHANNELS项，只读取已绑定通道
+  template <typename Pulse>
+  void write(const Pulse* pulseUs) {
+    for (uint32_t pending = mask_; pending != 0; pending &= pending - 1) {
+      int channel = __builtin_ctz(pending);
+      uint32_t duty = kernel_.duty(filter_.apply(channel, pulseUs[channel]));
+      if (cache_.update(channel, duty)) {
+        Writer::write(channel, duty);
+      }
+    }
+  }
+
+  // 所有已绑定通道的滤波器都已收敛（目标不变时再运行也不会改变输出）
+  bool settled() const {
+    if (!Filter::STATEFUL) return true;
+    for (uint32_t pending = mask_; pending != 0; pending &= pending - 1) {
+      if (!filter_.settled(__builtin_ctz(pending))) return false;
+    }
+    return true;
+  }
+
+  void invalidate() { cache_.invalidate(); }
+
+  uint32_t written() const { return cache_.written(); }
+  uint32_t skipped() const { return cache_.skipped(); }
+  const DutyKernel& kernel() const { return kernel_; }
+
+ private:
+  Filter filter_;
+  DutyKernel kernel_;
+  DutyCache<CHANNELS> cache_;
+  uint32_t mask_ = 0;
+};
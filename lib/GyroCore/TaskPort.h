@@ -0,0 +1,54 @@
+#pragma once
+#include <stdint.h>
+
+// ===================== 任务抽象 =====================
+// ESP32上为固定核心的FreeRTOS任务；主机（native）上为std::thread，
+// 使环形队列和控制流水线可以在Linux上用多线程压力测试。
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+typedef void (*TaskEntry)(void* arg);
+
+// 创建固定在指定核心的任务（主机上忽略core/priority/stackBytes）
+inline bool startPinnedTask(const char* name, TaskEntry entry, void* arg,
+                            int core, int priority, uint32_t stackBytes) {
+#if defined(ARDUINO)
+  return xTaskCreatePinnedToCore(entry, name, stackBytes, arg, priority, nullptr, core) == pdPASS;
+#else
+  (void)name; (void)core; (void)priority; (void)stackBytes;
+  std::thread(entry, arg).detach();
+  return true;
+#endif
+}
+
+// 让出CPU（任务循环中调用，避免看门狗超时）
+inline void taskSleepMs(uint32_t ms) {
+#if defined(ARDUINO)
+  vTaskDelay(ms / portTICK_PERIOD_MS > 0 ? ms / portTICK_PERIOD_MS : 1);
+#else
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+#endif
+}
+
+// 常驻循环任务：反复调用body，每轮之间让出sleepMs（如双核模式下核0上的网络任务）。
+// TaskLoop须在任务存活期间有效（一般为静态常量）
+struct TaskLoop {
+  void (*body)();
+  uint32_t sleepMs;
+};
+
+inline void runTaskLoop(void* arg) {
+  const TaskLoop* loop = static_cast<const TaskLoop*>(arg);
+  for (;;) {
+    loop->body();
+    taskSleepMs(loop->sleepMs);
+  }
+}
+
+inline bool startPinnedLoop(const char* name, const TaskLoop& loop, int core, int priority, uint32_t stackBytes) {
+  return startPinnedTask(name, runTaskLoop, const_cast<TaskLoop*>(&loop), core, priority, stackBytes);
+}
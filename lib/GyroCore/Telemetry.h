@@ -0,0 +1,157 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ChannelTable.h"
+
+// ===================== 遥测发布 =====================
+// 控制侧产生的最新状态只保存一份；网络侧按每个客户端协商的频率定时发送，
+// 且只发送超过阈值变化的字段（新客户端第一帧为全量）。消息写入预分配缓冲区，
+// 前三个通道的字段名与原广播一致（pitch/roll/yaw），其余通道为 chN_mapped/chN_pulse，
+// 网页端按字段是否存在逐项更新即可。状态没有更新过的客户端直接跳过，不做格式化。
+// 有字段变化的帧附带最近生效的控制帧序号（seq），主机侧压测工具据此计算指令到遥测的往返时延。
+
+const uint32_t TELEMETRY_DEFAULT_HZ = 20;
+const uint32_t TELEMETRY_MAX_HZ = 50;
+const float TELEMETRY_ANGLE_THRESHOLD = 0.1f;  // 映射角度变化阈值（°）
+const int TELEMETRY_PULSE_THRESHOLD = 1;       // 脉宽变化阈值（us）
+
+// 遥测状态快照
+typedef struct {
+  int count;                         // 有效通道数
+  float mapped[MAX_SERVO_CHANNELS];  // 各通道映射角度
+  int pulse[MAX_SERVO_CHANNELS];     // 各通道脉宽
+  uint16_t seq;                      // 最近生效的控制帧序号（0为未知，不输出）
+} TelemetryState;
+
+// 每客户端统计
+typedef struct {
+  uint32_t frames;         // 已发送帧数
+  uint32_t bytes;          // 已发送字节数
+  uint32_t rateHz;         // 协商后的发送频率
+} TelemetryClientStats;
+
+typedef void (*TelemetrySendFn)(uint8_t client, const char* data, size_t length);
+
+// 从连接URL（如 "/?rate=20"）中读取请求的遥测频率，未指定返回默认值，并限制在1~50Hz
+inline uint32_t parseTelemetryRate(const uint8_t* url, size_t length) {
+  static const char KEY[] = "rate=";
+  const size_t keyLen = sizeof(KEY) - 1;
+  for (size_t i = 0; url != nullptr && i + keyLen <= length; i++) {
+    if (memcmp(url + i, KEY, keyLen) != 0) continue;
+    uint32_t rate = 0;
+    for (size_t j = i + keyLen; j < length && url[j] >= '0' && url[j] <= '9'; j++) {
+      rate = rate * 10 + (url[j] - '0');
+      if (rate > TELEMETRY_MAX_HZ) break;
+    }
+    if (rate == 0) return TELEMETRY_DEFAULT_HZ;
+    return rate > TELEMETRY_MAX_HZ ? TELEMETRY_MAX_HZ : rate;
+  }
+  return TELEMETRY_DEFAULT_HZ;
+}
+
+template <int MAX_CLIENTS>
+class TelemetryPublisher {
+ public:
+  void connect(uint8_t client, uint32_t rateHz) {
+    if (client >= MAX_CLIENTS) return;
+    Client& c = clients_[client];
+    c.active = true;
+    c.primed = false;
+    c.periodMs = 1000 / (rateHz > 0 ? rateHz : TELEMETRY_DEFAULT_HZ);
+    c.stats.rateHz = rateHz;
+    c.stats.frames = 0;
+    c.stats.bytes = 0;
+  }
+
+  void disconnect(uint8_t client) {
+    if (client < MAX_CLIENTS) clients_[client].active = false;
+  }
+
+  // 更新最新状态（只保存最后一次）
+  void update(const TelemetryState& state) {
+    latest_ = state;
+    hasState_ = true;
+    generation_++;
+  }
+
+  // 到期的客户端发送一帧增量消息；返回本次发送的帧数
+  int poll(uint32_t nowMs, TelemetrySendFn send) {
+    if (!hasState_) return 0;
+    int sent = 0;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+      Client& c = clients_[i];
+      if (!c.active || (c.primed && nowMs - c.lastSendMs < c.periodMs)) continue;
+      if (c.primed && c.generation == generation_) continue;  // 上次发送后状态未更新
+      c.lastSendMs = nowMs;
+      c.generation = generation_;
+      size_t length = formatDelta(c);
+      if (length == 0) continue;  // 无变化，本周期不发送
+      send((uint8_t)i, buffer_, length);
+      c.primed = true;
+      c.stats.frames++;
+      c.stats.bytes += length;
+      sent++;
+    }
+    return sent;
+  }
+
+  bool active(uint8_t client) const { return client < MAX_CLIENTS && clients_[client].active; }
+  const TelemetryClientStats& stats(uint8_t client) const { return clients_[client].stats; }
+
+ private:
+  struct Client {
+    bool active = false;
+    bool primed = false;   // 是否已发送过全量帧
+    uint32_t periodMs = 1000 / TELEMETRY_DEFAULT_HZ;
+    uint32_t lastSendMs = 0;
+    uint32_t generation = 0; // 上次发送时的状态版本
+    TelemetryState sent;   // 该客户端已知的状态
+    TelemetryClientStats stats = { 0, 0, TELEMETRY_DEFAULT_HZ };
+  };
+
+  // 生成增量JSON到buffer_，返回长度（无字段变化时为0）
+  size_t formatDelta(Client& c) {
+    static const char* const LEGACY_NAMES[3] = { "pitch", "roll", "yaw" };
+    size_t pos = 0;
+    int fields = 0;
+    int count = latest_.count < MAX_SERVO_CHANNELS ? latest_.count : MAX_SERVO_CHANNELS;
+    buffer_[pos++] = '{';
+    for (int i = 0; i < count && pos < sizeof(buffer_); i++) {
+      float diff = latest_.mapped[i] - c.sent.mapped[i];
+      if (!c.primed || diff >= TELEMETRY_ANGLE_THRESHOLD || diff <= -TELEMETRY_ANGLE_THRESHOLD) {
+        pos += (i < 3)
+          ? snprintf(buffer_ + pos, sizeof(buffer_) - pos, "%s\"%s_mapped\":%.1f",
+                     fields++ ? "," : "", LEGACY_NAMES[i], latest_.mapped[i])
+          : snprintf(buffer_ + pos, sizeof(buffer_) - pos, "%s\"ch%d_mapped\":%.1f",
+                     fields++ ? "," : "", i, latest_.mapped[i]);
+        c.sent.mapped[i] = latest_.mapped[i];
+      }
+    }
+    for (int i = 0; i < count && pos < sizeof(buffer_); i++) {
+      if (!c.primed || abs(latest_.pulse[i] - c.sent.pulse[i]) >= TELEMETRY_PULSE_THRESHOLD) {
+        pos += (i < 3)
+          ? snprintf(buffer_ + pos, sizeof(buffer_) - pos, "%s\"%s_pulse\":%d",
+                     fields++ ? "," : "", LEGACY_NAMES[i], latest_.pulse[i])
+          : snprintf(buffer_ + pos, sizeof(buffer_) - pos, "%s\"ch%d_pulse\":%d",
+                     fields++ ? "," : "", i, latest_.pulse[i]);
+        c.sent.pulse[i] = latest_.pulse[i];
+      }
+    }
+    if (fields > 0 && latest_.seq != 0 && pos < sizeof(buffer_)) {
+      pos += snprintf(buffer_ + pos, sizeof(buffer_) - pos, ",\"seq\":%u", (unsigned)latest_.seq);
+    }
+    if (fields == 0 || pos + 2 > sizeof(buffer_)) return 0;
+    buffer_[pos++] = '}';
+    buffer_[pos] = '\0';
+    return pos;
+  }
+
+  Client clients_[MAX_CLIENTS];
+  TelemetryState latest_;
+  bool hasState_ = false;
+  uint32_t generation_ = 0;  // 每次update()递增
+  char buffer_[40 * MAX_SERVO_CHANNELS + 16];  // 预分配发送缓冲区
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// ===================== 定长缓冲区文本拼接 =====================
+// 状态回复和日志行都在栈上的定长缓冲区里逐段拼接。连续 pos += snprintf(...) 在某段被截断时
+// pos 会越过缓冲区末尾，下一段就写到缓冲区之外；这里每次追加后都把长度钳在容量之内，
+// 截断只丢掉末尾的内容并记下truncated()，缓冲区始终以'\0'结尾。
+// 缓冲区大小可用 textFormatMaxLength() 在编译期按格式串算出最坏情况，再用static_assert约束。
+
+class TextWriter {
+ public:
+  TextWriter(char* out, size_t capacity) : out_(out), capacity_(capacity) {
+    if (capacity_ > 0) out_[0] = '\0';
+  }
+
+  void put(char c) {
+    if (length_ + 1 < capacity_) {
+      out_[length_++] = c;
+      out_[length_] = '\0';
+    } else {
+      truncated_ = true;
+    }
+  }
+
+  void append(const char* text, size_t n) {
+    for (size_t i = 0; i < n; i++) put(text[i]);
+  }
+
+  void printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    if (length_ + 1 >= capacity_) {
+      truncated_ = true;
+      return;
+    }
+    size_t room = capacity_ - length_;
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(out_ + length_, room, format, args);
+    va_end(args);
+    if (n < 0) return;
+    if ((size_t)n >= room) {
+      length_ = capacity_ - 1;
+      truncated_ = true;
+    } else {
+      length_ += (size_t)n;
+    }
+  }
+
+  const char* c_str() const { return out_; }
+  size_t length() const { return length_; }
+  bool truncated() const { return truncated_; }
+
+ private:
+  char* out_;
+  size_t capacity_;
+  size_t length_ = 0;
+  bool truncated_ = false;
+};
+
+// 格式串输出的最大长度（不含'\0'）：%u按10位、%d按11位计，其余字符按字面计。
+// 只支持这两种转换说明，出现其他的 % 时结果为一个极大值，使调用处的static_assert失败
+constexpr size_t TEXT_FORMAT_UNSUPPORTED = (size_t)1 << 30;
+
+constexpr size_t textFormatMaxLength(const char* format) {
+  return *format == '\0' ? 0
+       : *format != '%' ? 1 + textFormatMaxLength(format + 1)
+       : format[1] == 'u' ? 10 + textFormatMaxLength(format + 2)
+       : format[1] == 'd' ? 11 + textFormatMaxLength(format + 2)
+       : TEXT_FORMAT_UNSUPPORTED;
+}
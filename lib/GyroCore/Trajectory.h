@@ -0,0 +1,87 @@
+#pragma once
+#include <stdint.h>
+
+// ===================== 关键帧轨迹插值 =====================
+// 客户端一次下发某通道的若干(时刻, 脉宽)关键帧，控制环每个节拍在设备端插值出中间脉宽，
+// 平滑扫动不再需要浏览器高频发送每一个中间点。段内插值支持线性、三次（smoothstep）
+// 和最小加加速度（min-jerk，5次多项式，起止速度和加速度均为0）三种曲线，
+// 全部在Q24定点下计算（20000us的跳变上中间截断累计不到0.02us，最终四舍五入），
+// 不依赖硬件，可在主机上测试和测速。
+
+const int TRAJECTORY_MAX_KEYS = 16;
+const int TRAJECTORY_FRAC_BITS = 24;   // 进度τ与曲线位置s的小数位数
+
+enum TrajectoryMode : uint8_t {
+  TRAJ_LINEAR = 0,    // 线性
+  TRAJ_CUBIC = 1,     // 三次：3τ² - 2τ³
+  TRAJ_MIN_JERK = 2   // 最小加加速度：10τ³ - 15τ⁴ + 6τ⁵
+};
+
+struct TrajectoryKey {
+  uint32_t timeMs;    // 相对轨迹开始的时刻
+  int32_t pulseUs;    // 该时刻的脉宽
+};
+
+// 段内进度τ（Q24，0~1<<24）-> 曲线位置s（Q24）
+inline int32_t trajectoryEase(uint8_t mode, int32_t tau) {
+  const int64_t one = (int64_t)1 << TRAJECTORY_FRAC_BITS;
+  int64_t t = tau;
+  switch (mode) {
+    case TRAJ_CUBIC: {
+      int64_t t2 = (t * t) >> TRAJECTORY_FRAC_BITS;
+      return (int32_t)((t2 * (3 * one - 2 * t)) >> TRAJECTORY_FRAC_BITS);
+    }
+    case TRAJ_MIN_JERK: {
+      int64_t t2 = (t * t) >> TRAJECTORY_FRAC_BITS;
+      int64_t t3 = (t2 * t) >> TRAJECTORY_FRAC_BITS;
+      return (int32_t)((t3 * (10 * one - 15 * t + 6 * t2)) >> TRAJECTORY_FRAC_BITS);
+    }
+    default:
+      return tau;
+  }
+}
+
+class Trajectory {
+ public:
+  // 载入关键帧（时刻必须严格递增），非法输入返回false且保持原轨迹不变
+  bool load(const TrajectoryKey* keys, int count, uint8_t mode) {
+    if (count < 1 || count > TRAJECTORY_MAX_KEYS || mode > TRAJ_MIN_JERK) return false;
+    for (int i = 1; i < count; i++) {
+      if (keys[i].timeMs <= keys[i - 1].timeMs) return false;
+    }
+    for (int i = 0; i < count; i++) keys_[i] = keys[i];
+    count_ = count;
+    mode_ = mode;
+    segment_ = 0;
+    return true;
+  }
+
+  // 取elapsedMs时刻的脉宽：第一个关键帧之前保持首帧，最后一个之后保持末帧。
+  // 时间单调递增时每次只需从上次所在段向后查找
+  int sample(uint32_t elapsedMs) {
+    if (count_ == 0) return 0;
+    if (elapsedMs <= keys_[0].timeMs) return keys_[0].pulseUs;
+    if (elapsedMs >= keys_[count_ - 1].timeMs) return keys_[count_ - 1].pulseUs;
+    if (elapsedMs < keys_[segment_].timeMs) segment_ = 0;
+    while (elapsedMs >= keys_[segment_ + 1].timeMs) segment_++;
+
+    const TrajectoryKey& a = keys_[segment_];
+    const TrajectoryKey& b = keys_[segment_ + 1];
+    int32_t tau = (int32_t)(((uint64_t)(elapsedMs - a.timeMs) << TRAJECTORY_FRAC_BITS) / (b.timeMs - a.timeMs));
+    int64_t s = trajectoryEase(mode_, tau);
+    int64_t delta = (int64_t)b.pulseUs - a.pulseUs;
+    const int64_t half = (int64_t)1 << (TRAJECTORY_FRAC_BITS - 1);
+    return a.pulseUs + (int32_t)((delta * s + half) >> TRAJECTORY_FRAC_BITS);   // 四舍五入
+  }
+
+  bool finished(uint32_t elapsedMs) const { return count_ == 0 || elapsedMs >= durationMs(); }
+  uint32_t durationMs() const { return count_ > 0 ? keys_[count_ - 1].timeMs : 0; }
+  int finalPulse() const { return count_ > 0 ? keys_[count_ - 1].pulseUs : 0; }
+  int keyCount() const { return count_; }
+
+ private:
+  TrajectoryKey keys_[TRAJECTORY_MAX_KEYS];
+  int count_ = 0;
+  uint8_t mode_ = TRAJ_LINEAR;
+  int segment_ = 0;   // 上次所在段（keys_[segment_] ~ keys_[segment_ + 1]）
+};
@@ -0,0 +1,163 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdarg.h>
+#include <algorithm>
+#include <string>
+
+// ===================== 主机（native）Arduino替身 =====================
+// 只覆盖两个工程实际用到的API。时间由仿真时钟驱动（见 NativeHal.h），
+// LEDC写入被记录成占空比时间线，串口输出转到stderr。
+
+#define PROGMEM
+#define IRAM_ATTR
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::min;
+using std::max;
+
+template <typename T, typename L, typename H>
+inline auto constrain(T x, L low, H high) -> decltype(x + low) {
+  return x < low ? low : (x > high ? high : x);
+}
+
+// 时间（仿真时钟）
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+// LEDC PWM（写入记录到占空比时间线）
+double ledcSetup(uint8_t channel, double freq, uint8_t resolutionBits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcDetachPin(uint8_t pin);
+void ledcWrite(uint8_t channel, uint32_t duty);
+
+// Arduino String的最小实现（基于std::string）
+class String {
+public:
+  String() {}
+  String(const char* str) : s_(str ? str : "") {}
+  String(const std::string& str) : s_(str) {}
+  explicit String(int value) : s_(std::to_string(value)) {}
+  explicit String(unsigned int value) : s_(std::to_string(value)) {}
+  explicit String(long value) : s_(std::to_string(value)) {}
+  explicit String(unsigned long value) : s_(std::to_string(value)) {}
+  String(float value, unsigned int decimals = 2) { format(value, decimals); }
+  String(double value, unsigned int decimals = 2) { format(value, decimals); }
+
+  const char* c_str() const { return s_.c_str(); }
+  unsigned int length() const { return (unsigned int)s_.size(); }
+  bool reserve(unsigned int size) { s_.reserve(size); return true; }
+  char operator[](unsigned int index) const { return index < s_.size() ? s_[index] : 0; }
+  char charAt(unsigned int index) const { return (*this)[index]; }
+
+  int indexOf(char c, unsigned int from = 0) const { return toIndex(s_.find(c, from)); }
+  int indexOf(const char* str, unsigned int from = 0) const { return toIndex(s_.find(str, from)); }
+  int indexOf(const String& str, unsigned int from = 0) const { return toIndex(s_.find(str.s_, from)); }
+  int lastIndexOf(char c) const { return toIndex(s_.rfind(c)); }
+  String substring(unsigned int from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s_.size()) return String();
+    return String(s_.substr(from, to - from));
+  }
+  bool startsWith(const char* prefix) const { return s_.compare(0, strlen(prefix), prefix) == 0; }
+  bool endsWith(const char* suffix) const {
+    size_t n = strlen(suffix);
+    return n <= s_.size() && s_.compare(s_.size() - n, n, suffix) == 0;
+  }
+  bool equals(const char* str) const { return s_ == str; }
+  long toInt() const { return atol(s_.c_str()); }
+  float toFloat() const { return (float)atof(s_.c_str()); }
+
+  String& operator+=(const char* str) { s_ += str; return *this; }
+  String& operator+=(const String& str) { s_ += str.s_; return *this; }
+  String& operator+=(char c) { s_ += c; return *this; }
+  String& operator+=(int value) { s_ += std::to_string(value); return *this; }
+  bool operator==(const char* str) const { return s_ == str; }
+  bool operator==(const String& str) const { return s_ == str.s_; }
+  bool operator!=(const char* str) const { return s_ != str; }
+  friend String operator+(String lhs, const String& rhs) { lhs += rhs; return lhs; }
+  friend String operator+(String lhs, const char* rhs) { lhs += rhs; return lhs; }
+
+private:
+  static int toIndex(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+  void format(double value, unsigned int decimals) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+    s_ = buf;
+  }
+  std::string s_;
+};
+
+// 串口：输出转到stderr，仿真时可整体静音
+class HardwareSerial {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  void setEcho(bool echo) { echo_ = echo; }
+  int printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    if (!echo_) return 0;
+    va_list args;
+    va_start(args, format);
+    int n = vfprintf(stderr, format, args);
+    va_end(args);
+    return n;
+  }
+  size_t print(const char* str) {
+    if (!echo_) return 0;
+    fputs(str, stderr);
+    return strlen(str);
+  }
+  size_t print(const String& str) { return print(str.c_str()); }
+  size_t print(long value) { return printf("%ld", value); }
+  size_t print(double value, int decimals = 2) { return printf("%.*f", decimals, value); }
+  size_t println() { return print("\n"); }
+  size_t println(const char* str) { return print(str) + println(); }
+  size_t println(const String& str) { return println(str.c_str()); }
+  size_t println(long value) { return print(value) + println(); }
+  size_t println(double value, int decimals = 2) { return print(value, decimals) + println(); }
+  size_t write(const uint8_t* data, size_t length) { return echo_ ? fwrite(data, 1, length, stderr) : length; }
+  size_t write(uint8_t c) { return write(&c, 1); }
+  int availableForWrite() { return 128; }
+  void flush() { fflush(stderr); }
+
+private:
+  bool echo_ = true;
+};
+
+extern HardwareSerial Serial;
+
+// 堆信息：主机上用一个固定大小的“堆”模拟，已用量为草图运行期间operator new分配且未释放的字节数
+// （见 NativeHal.cpp），不模拟碎片，最大连续空闲块等于空闲总量
+class EspClass {
+public:
+  uint32_t getHeapSize();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap() { return getFreeHeap(); }
+};
+
+extern EspClass ESP;
+
+class IPAddress {
+public:
+  IPAddress() : bytes_{ 0, 0, 0, 0 } {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes_{ a, b, c, d } {}
+  uint8_t operator[](int index) const { return bytes_[index]; }
+  bool operator==(const IPAddress& other) const { return memcmp(bytes_, other.bytes_, 4) == 0; }
+  String toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes_[0], bytes_[1], bytes_[2], bytes_[3]);
+    return String(buf);
+  }
+
+private:
+  uint8_t bytes_[4];
+};
@@ -0,0 +1,140 @@
+#include "Arduino.h"
+#include "NativeHal.h"
+#include "WiFi.h"
+#include <atomic>
+#include <malloc.h>
+#include <new>
+
+// ===================== 主机HAL实现 =====================
+
+static const int HAL_PWM_CHANNELS = 16;
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+
+static uint64_t simTimeUs = 0;
+static HalPwmSink pwmSink = nullptr;
+static uint32_t pwmDuty[HAL_PWM_CHANNELS];
+static uint32_t pwmWrites = 0;
+
+uint64_t halTimeUs() {
+  return simTimeUs;
+}
+
+void halAdvanceUs(uint64_t us) {
+  simTimeUs += us;
+}
+
+void halSetPwmSink(HalPwmSink sink) {
+  pwmSink = sink;
+}
+
+uint32_t halPwmDuty(int channel) {
+  return (channel >= 0 && channel < HAL_PWM_CHANNELS) ? pwmDuty[channel] : 0;
+}
+
+uint32_t halPwmWrites() {
+  return pwmWrites;
+}
+
+unsigned long millis() {
+  return (unsigned long)(simTimeUs / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)simTimeUs;
+}
+
+void delay(unsigned long ms) {
+  simTimeUs += (uint64_t)ms * 1000;
+}
+
+void yield() {
+}
+
+double ledcSetup(uint8_t channel, double freq, uint8_t resolutionBits) {
+  (void)channel;
+  (void)resolutionBits;
+  return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+  (void)pin;
+  (void)channel;
+}
+
+void ledcDetachPin(uint8_t pin) {
+  (void)pin;
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+  if (channel >= HAL_PWM_CHANNELS) return;
+  pwmDuty[channel] = duty;
+  pwmWrites++;
+  if (pwmSink) {
+    pwmSink(simTimeUs, channel, duty);
+  }
+}
+
+// ===================== 堆替身 =====================
+// 全局operator new/delete按块计数（malloc_usable_size得到块大小），双核模式的任务线程也会调用，用原子量
+
+static const uint32_t HAL_HEAP_BYTES = 300 * 1024;   // 约为ESP32 Arduino启动后的空闲堆
+static std::atomic<uint64_t> heapAllocations{0};
+static std::atomic<int64_t> heapLiveBytes{0};
+static std::atomic<int64_t> heapMarkBytes{0};
+static std::atomic<int64_t> heapPeakBytes{0};
+
+static void* heapAllocate(size_t size) {
+  void* p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  heapAllocations.fetch_add(1, std::memory_order_relaxed);
+  int64_t live = heapLiveBytes.fetch_add((int64_t)malloc_usable_size(p), std::memory_order_relaxed) +
+                 (int64_t)malloc_usable_size(p);
+  int64_t peak = heapPeakBytes.load(std::memory_order_relaxed);
+  while (live > peak && !heapPeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+  return p;
+}
+
+static void heapRelease(void* p) {
+  if (!p) return;
+  heapLiveBytes.fetch_sub((int64_t)malloc_usable_size(p), std::memory_order_relaxed);
+  free(p);
+}
+
+void* operator new(size_t size) { return heapAllocate(size); }
+void* operator new[](size_t size) { return heapAllocate(size); }
+void operator delete(void* p) noexcept { heapRelease(p); }
+void operator delete[](void* p) noexcept { heapRelease(p); }
+void operator delete(void* p, size_t) noexcept { heapRelease(p); }
+void operator delete[](void* p, size_t) noexcept { heapRelease(p); }
+
+uint64_t halHeapAllocations() {
+  return heapAllocations.load(std::memory_order_relaxed);
+}
+
+void halHeapMark() {
+  int64_t live = heapLiveBytes.load(std::memory_order_relaxed);
+  heapMarkBytes.store(live, std::memory_order_relaxed);
+  heapPeakBytes.store(live, std::memory_order_relaxed);
+}
+
+static uint32_t heapFreeFor(int64_t liveBytes) {
+  int64_t used = liveBytes - heapMarkBytes.load(std::memory_order_relaxed);
+  if (used < 0) used = 0;
+  return used >= HAL_HEAP_BYTES ? 0 : HAL_HEAP_BYTES - (uint32_t)used;
+}
+
+uint32_t EspClass::getHeapSize() {
+  return HAL_HEAP_BYTES;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return heapFreeFor(heapLiveBytes.load(std::memory_order_relaxed));
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return heapFreeFor(heapPeakBytes.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <stdint.h>
+
+// ===================== 仿真控制接口 =====================
+// 仿真时钟只在回放驱动推进时前进（delay()也会推进），使控制环节拍、限频打印、
+// 租约超时等逻辑与墙钟无关，回放结果可重复。
+
+// 仿真时钟（微秒）
+uint64_t halTimeUs();
+void halAdvanceUs(uint64_t us);
+
+// 占空比时间线：每次ledcWrite回调一次（sink为空则只记录最新值）
+typedef void (*HalPwmSink)(uint64_t timeUs, int channel, uint32_t duty);
+void halSetPwmSink(HalPwmSink sink);
+uint32_t halPwmDuty(int channel);
+uint32_t halPwmWrites();
+
+// 堆替身：operator new/delete 计数。halHeapAllocations()为累计分配次数（回放按消息做差），
+// halHeapMark()把当前已用量作为ESP.getFreeHeap()的零点（在setup()之前调用，排除驱动自身的内存）
+uint64_t halHeapAllocations();
+void halHeapMark();
+
+// 主机侧的草图入口（由仓库根目录的src/main.cpp提供）
+void setup();
+void loop();
@@ -0,0 +1,299 @@
+#include "Arduino.h"
+#include "NativeHal.h"
+#include "WebSocketsServer.h"
+#include <DatagramPort.h>
+#include <LatencyProbe.h>
+#include <chrono>
+#include <signal.h>
+#include <thread>
+#include <vector>
+
+// ===================== 消息日志回放驱动 =====================
+// 用法：program <trace文件> [--speed N] [--step-us N] [--tail-ms N] [--verbose]
+//       program --listen <端口> [--udp-port N] [--duration-s N] [--verbose]
+//   --speed    0为尽快回放（默认），1为实时，N为N倍速
+//   --step-us  两条消息之间调用loop()的仿真步长（默认1000us）
+//   --tail-ms  最后一条消息之后继续运行的时间（默认500ms，观察滤波收敛）
+//   --verbose  打印草图的串口输出（stderr）
+//
+// 日志格式，每行一条：<时间ms> <客户端号> <事件> [载荷]，'#'开头为注释
+//   connect [url]    客户端连接（url用于?rate=等参数）
+//   disconnect       客户端断开
+//   text <文本>      文本帧（行尾之前的全部内容）
+//   bin <十六进制>   二进制帧
+//   udp <十六进制>   UDP数据报（来源IP与该客户端的WebSocket地址相同，端口为50000+客户端号）
+//
+// 输出（stdout，CSV）：
+//   pwm,<仿真时间us>,<PWM通道>,<占空比>          每次ledcWrite
+//   msg,<仿真时间us>,<客户端>,<事件>,<字节数>,<耗时ns>,<堆分配次数>
+// 耗时为注入回调加紧随其后的一次loop()（指令出队、映射并投递到控制环）的墙钟时间，
+// 堆分配次数为同一区间内草图的operator new调用次数（热路径应为0）。
+// 最后以'#'开头输出汇总：消息数、耗时均值/P50/P99/最大值、堆分配、PWM写入次数、发送帧数。
+// 以 -D LATENCY_PROBES=1 编译时，另把 /metrics 的直方图文本输出到stderr。
+//
+// 实时模式（--listen）：不读日志，在该端口接受真实WebSocket连接（供tools/loadgen.py压测），
+// UDP控制通道绑定草图的端口（或--udp-port），仿真时钟跟随墙钟推进；
+// 运行到--duration-s（0为一直运行）或收到SIGINT/SIGTERM后输出同样的汇总。
+
+struct TraceEvent {
+  uint64_t timeUs;
+  uint8_t client;
+  WStype_t type;
+  bool udp;                   // UDP数据报（type为WStype_BIN）
+  std::vector<uint8_t> payload;
+};
+
+static const char* eventName(WStype_t type) {
+  switch (type) {
+    case WStype_CONNECTED: return "connect";
+    case WStype_DISCONNECTED: return "disconnect";
+    case WStype_TEXT: return "text";
+    case WStype_BIN: return "bin";
+    default: return "other";
+  }
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// 解析一行日志，格式错误返回false
+static bool parseTraceLine(const char* line, TraceEvent& event) {
+  double timeMs;
+  unsigned client;
+  char kind[16];
+  int consumed = 0;
+  if (sscanf(line, "%lf %u %15s%n", &timeMs, &client, kind, &consumed) != 3) return false;
+  const char* rest = line + consumed;
+  if (*rest == ' ') rest++;
+  size_t restLen = strcspn(rest, "\r\n");
+
+  event.timeUs = (uint64_t)(timeMs * 1000.0);
+  event.client = (uint8_t)client;
+  event.payload.clear();
+  event.udp = false;
+  if (strcmp(kind, "connect") == 0) {
+    event.type = WStype_CONNECTED;
+    event.payload.assign(rest, rest + restLen);
+  } else if (strcmp(kind, "disconnect") == 0) {
+    event.type = WStype_DISCONNECTED;
+  } else if (strcmp(kind, "text") == 0) {
+    event.type = WStype_TEXT;
+    event.payload.assign(rest, rest + restLen);
+  } else if (strcmp(kind, "bin") == 0 || strcmp(kind, "udp") == 0) {
+    event.type = WStype_BIN;
+    event.udp = kind[0] == 'u';
+    for (size_t i = 0; i + 1 < restLen; i += 2) {
+      int hi = hexValue(rest[i]);
+      int lo = hexValue(rest[i + 1]);
+      if (hi < 0 || lo < 0) return false;
+      event.payload.push_back((uint8_t)((hi << 4) | lo));
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static bool loadTrace(const char* path, std::vector<TraceEvent>& events) {
+  FILE* file = fopen(path, "r");
+  if (!file) return false;
+  char line[4096];
+  int lineNo = 0;
+  TraceEvent event;
+  while (fgets(line, sizeof(line), file)) {
+    lineNo++;
+    if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') continue;
+    if (!parseTraceLine(line, event)) {
+      fprintf(stderr, "[回放] 第%d行格式错误，已跳过\n", lineNo);
+      continue;
+    }
+    events.push_back(event);
+  }
+  fclose(file);
+  return true;
+}
+
+#if LATENCY_PROBES
+static void printMetrics(void*, const char* data, size_t length) {
+  fwrite(data, 1, length, stderr);
+}
+#endif
+
+static void printPwm(uint64_t timeUs, int channel, uint32_t duty) {
+  printf("pwm,%llu,%d,%u\n", (unsigned long long)timeUs, channel, duty);
+}
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int) {
+  stopRequested = 1;
+}
+
+// 实时模式：仿真时钟跟随墙钟，持续调用loop()，网络收发在草图的webSocket.loop()中完成
+static int runLive(uint16_t port, uint16_t udpPort, uint64_t durationS) {
+  DatagramPort::hostBindSockets(true, udpPort);
+  halHeapMark();
+  setup();
+  WebSocketsServer* ws = WebSocketsServer::current();
+  if (!ws) {
+    fprintf(stderr, "[实时] 草图未创建WebSocketsServer\n");
+    return 1;
+  }
+  if (!ws->listen(port)) {
+    fprintf(stderr, "[实时] 无法监听端口 %u\n", port);
+    return 1;
+  }
+  fprintf(stderr, "[实时] 监听端口 %u\n", port);
+  signal(SIGINT, requestStop);
+  signal(SIGTERM, requestStop);
+
+  const uint64_t baseUs = halTimeUs();
+  const auto wallStart = std::chrono::steady_clock::now();
+  uint64_t loops = 0;
+  while (!stopRequested) {
+    uint64_t wallUs = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - wallStart).count();
+    if (durationS > 0 && wallUs >= durationS * 1000000) break;
+    if (baseUs + wallUs > halTimeUs()) halAdvanceUs(baseUs + wallUs - halTimeUs());
+    loop();
+    loops++;
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+
+  printf("# connections=%u rx_frames=%u loops=%llu\n", ws->liveConnections(), ws->rxFrames(),
+         (unsigned long long)loops);
+  printf("# pwm_writes=%u ws_tx_frames=%u ws_tx_bytes=%llu sim_ms=%llu\n",
+         halPwmWrites(), ws->txFrames(), (unsigned long long)ws->txBytes(),
+         (unsigned long long)((halTimeUs() - baseUs) / 1000));
+#if LATENCY_PROBES
+  writeLatencyMetrics(printMetrics, nullptr);
+#endif
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  const char* tracePath = nullptr;
+  double speed = 0.0;
+  uint64_t stepUs = 1000;
+  uint64_t tailMs = 500;
+  bool verbose = false;
+  int listenPort = -1;
+  int udpPort = 0;
+  uint64_t durationS = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) speed = atof(argv[++i]);
+    else if (strcmp(argv[i], "--step-us") == 0 && i + 1 < argc) stepUs = strtoull(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--tail-ms") == 0 && i + 1 < argc) tailMs = strtoull(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--listen") == 0 && i + 1 < argc) listenPort = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--udp-port") == 0 && i + 1 < argc) udpPort = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--duration-s") == 0 && i + 1 < argc) durationS = strtoull(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--verbose") == 0) verbose = true;
+    else tracePath = argv[i];
+  }
+  if (listenPort > 0 && listenPort <= 0xFFFF) {
+    Serial.setEcho(verbose);
+    return runLive((uint16_t)listenPort, (uint16_t)udpPort, durationS);
+  }
+  if (!tracePath || stepUs == 0) {
+    fprintf(stderr, "用法: %s <trace文件> [--speed N] [--step-us N] [--tail-ms N] [--verbose]\n"
+                    "      %s --listen <端口> [--udp-port N] [--duration-s N] [--verbose]\n", argv[0], argv[0]);
+    return 2;
+  }
+
+  std::vector<TraceEvent> events;
+  if (!loadTrace(tracePath, events)) {
+    fprintf(stderr, "[回放] 无法打开 %s\n", tracePath);
+    return 1;
+  }
+
+  Serial.setEcho(verbose);
+  halSetPwmSink(printPwm);
+  halHeapMark();
+  setup();
+
+  WebSocketsServer* ws = WebSocketsServer::current();
+  if (!ws) {
+    fprintf(stderr, "[回放] 草图未创建WebSocketsServer\n");
+    return 1;
+  }
+
+  // 日志时间相对于setup()结束时刻（setup中的delay()也推进仿真时钟）
+  const uint64_t baseUs = halTimeUs();
+  const auto wallStart = std::chrono::steady_clock::now();
+  std::vector<uint64_t> costs;
+  costs.reserve(events.size());
+  uint64_t allocTotal = 0;
+  uint64_t allocMax = 0;
+  size_t allocMessages = 0;
+
+  // 推进仿真时钟到目标时刻，期间按步长调用loop()；非0倍速时按墙钟节奏等待
+  auto runUntil = [&](uint64_t targetUs) {
+    while (halTimeUs() < targetUs) {
+      uint64_t step = targetUs - halTimeUs();
+      if (step > stepUs) step = stepUs;
+      halAdvanceUs(step);
+      loop();
+      if (speed > 0.0) {
+        auto due = wallStart + std::chrono::microseconds((uint64_t)((halTimeUs() - baseUs) / speed));
+        std::this_thread::sleep_until(due);
+      }
+    }
+  };
+
+  for (const TraceEvent& event : events) {
+    runUntil(baseUs + event.timeUs);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t allocStart = halHeapAllocations();
+    if (event.udp) {
+      DatagramPort* udp = DatagramPort::current();
+      if (udp) {
+        IPAddress ip = ws->remoteIP(event.client);
+        uint32_t sourceIp = ((uint32_t)ip[0] << 24) | ((uint32_t)ip[1] << 16) | ((uint32_t)ip[2] << 8) | ip[3];
+        udp->inject(sourceIp, (uint16_t)(50000 + event.client), event.payload.data(), event.payload.size());
+      }
+      allocStart = halHeapAllocations();   // 数据报排队是替身的分配，不计入草图
+    } else {
+      ws->inject(event.client, event.type, event.payload.data(), event.payload.size());
+    }
+    loop();
+    uint64_t allocs = halHeapAllocations() - allocStart;
+    auto cost = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    costs.push_back((uint64_t)cost);
+    allocTotal += allocs;
+    if (allocs > allocMax) allocMax = allocs;
+    if (allocs > 0) allocMessages++;
+    printf("msg,%llu,%u,%s,%zu,%lld,%llu\n", (unsigned long long)halTimeUs(), event.client,
+           event.udp ? "udp" : eventName(event.type), event.payload.size(), (long long)cost,
+           (unsigned long long)allocs);
+  }
+  runUntil(halTimeUs() + tailMs * 1000);
+
+  // 汇总
+  std::vector<uint64_t> sorted = costs;
+  std::sort(sorted.begin(), sorted.end());
+  uint64_t total = 0;
+  for (uint64_t c : sorted) total += c;
+  size_t n = sorted.size();
+  printf("# messages=%zu\n", n);
+  if (n > 0) {
+    printf("# cost_ns mean=%llu p50=%llu p99=%llu max=%llu\n",
+           (unsigned long long)(total / n),
+           (unsigned long long)sorted[n / 2],
+           (unsigned long long)sorted[(n * 99) / 100 < n ? (n * 99) / 100 : n - 1],
+           (unsigned long long)sorted[n - 1]);
+  }
+  printf("# heap_allocs total=%llu max_per_msg=%llu msgs_with_allocs=%zu free=%u min_free=%u\n",
+         (unsigned long long)allocTotal, (unsigned long long)allocMax, allocMessages,
+         ESP.getFreeHeap(), ESP.getMinFreeHeap());
+  printf("# pwm_writes=%u ws_tx_frames=%u ws_tx_bytes=%llu sim_ms=%llu\n",
+         halPwmWrites(), ws->txFrames(), (unsigned long long)ws->txBytes(),
+         (unsigned long long)((halTimeUs() - baseUs) / 1000));
+#if LATENCY_PROBES
+  writeLatencyMetrics(printMetrics, nullptr);
+#endif
+  return 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "Arduino.h"
+#include <functional>
+
+// 主机替身：只登记路由，仿真中没有HTTP请求
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_POST };
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+
+class WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  explicit WebServer(int port = 80) { (void)port; }
+  void on(const char* uri, THandlerFunction handler) { (void)uri; (void)handler; }
+  void on(const char* uri, HTTPMethod method, THandlerFunction handler) { (void)uri; (void)method; (void)handler; }
+  void onNotFound(THandlerFunction handler) { (void)handler; }
+  void begin() {}
+  void handleClient() {}
+  void send(int code, const char* contentType = nullptr, const String& content = String()) {
+    (void)code;
+    (void)contentType;
+    (void)content;
+  }
+  void send_P(int code, const char* contentType, const char* content, size_t length) {
+    (void)code;
+    (void)contentType;
+    (void)content;
+    (void)length;
+  }
+  void sendHeader(const String& name, const String& value, bool first = false) {
+    (void)name;
+    (void)value;
+    (void)first;
+  }
+  void collectHeaders(const char* headerKeys[], size_t count) { (void)headerKeys; (void)count; }
+  String header(const char* name) { (void)name; return String(); }
+  String uri() const { return String("/"); }
+  void setContentLength(size_t length) { (void)length; }
+  void sendContent(const char* content, size_t length) { (void)content; (void)length; }
+  void sendContent(const String& content) { (void)content; }
+
+protected:
+  // 与ESP32 WebServer相同的当前请求成员（仿真中始终没有请求头）
+  struct RequestArgument {
+    String key;
+    String value;
+  };
+  RequestArgument* _currentHeaders = nullptr;
+  int _headerKeysCount = 0;
+};
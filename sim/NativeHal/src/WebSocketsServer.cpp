@@ -0,0 +1,271 @@
+#include "WebSocketsServer.h"
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// ===================== WebSocket服务器替身：实时模式 =====================
+// 只实现压测需要的最小子集：HTTP升级握手、客户端掩码帧解码、服务端不分片发送。
+// 监听与接收均为非阻塞，在草图的loop()中轮询；发送为阻塞写，保证帧完整。
+
+// SHA-1（仅用于计算Sec-WebSocket-Accept）
+static void sha1(const uint8_t* data, size_t length, uint8_t out[20]) {
+  uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+  std::vector<uint8_t> msg(data, data + length);
+  uint64_t bits = (uint64_t)length * 8;
+  msg.push_back(0x80);
+  while (msg.size() % 64 != 56) msg.push_back(0);
+  for (int i = 7; i >= 0; i--) msg.push_back((uint8_t)(bits >> (8 * i)));
+
+  auto rol = [](uint32_t v, int n) { return (v << n) | (v >> (32 - n)); };
+  for (size_t chunk = 0; chunk < msg.size(); chunk += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+      const uint8_t* p = &msg[chunk + 4 * i];
+      w[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+    for (int i = 16; i < 80; i++) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+      uint32_t f, k;
+      if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+      else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+      else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+      else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+      uint32_t t = rol(a, 5) + f + e + k + w[i];
+      e = d; d = c; c = rol(b, 30); b = a; a = t;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+  }
+  for (int i = 0; i < 5; i++) {
+    out[4 * i] = (uint8_t)(h[i] >> 24);
+    out[4 * i + 1] = (uint8_t)(h[i] >> 16);
+    out[4 * i + 2] = (uint8_t)(h[i] >> 8);
+    out[4 * i + 3] = (uint8_t)h[i];
+  }
+}
+
+static std::string base64(const uint8_t* data, size_t length) {
+  static const char TABLE[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (size_t i = 0; i < length; i += 3) {
+    uint32_t v = (uint32_t)data[i] << 16;
+    if (i + 1 < length) v |= (uint32_t)data[i + 1] << 8;
+    if (i + 2 < length) v |= data[i + 2];
+    out += TABLE[(v >> 18) & 0x3F];
+    out += TABLE[(v >> 12) & 0x3F];
+    out += i + 1 < length ? TABLE[(v >> 6) & 0x3F] : '=';
+    out += i + 2 < length ? TABLE[v & 0x3F] : '=';
+  }
+  return out;
+}
+
+static bool writeAll(int fd, const uint8_t* data, size_t length) {
+  while (length > 0) {
+    ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    length -= (size_t)n;
+  }
+  return true;
+}
+
+bool WebSocketsServer::listen(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return false;
+  int yes = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(fd, 8) < 0) {
+    close(fd);
+    return false;
+  }
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  listenFd_ = fd;
+  return true;
+}
+
+void WebSocketsServer::pollNetwork() {
+  // 接受新连接：没有空闲槽位时直接关闭（与真实库的客户端上限一致）
+  for (;;) {
+    sockaddr_in peer = {};
+    socklen_t peerLen = sizeof(peer);
+    int fd = accept(listenFd_, (sockaddr*)&peer, &peerLen);
+    if (fd < 0) break;
+    int slot = -1;
+    for (int i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+      if (live_[i].fd < 0) { slot = i; break; }
+    }
+    if (slot < 0) {
+      close(fd);
+      continue;
+    }
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    live_[slot].fd = fd;
+    live_[slot].open = false;
+    live_[slot].ip = ntohl(peer.sin_addr.s_addr);
+    live_[slot].rx.clear();
+  }
+
+  uint8_t buffer[4096];
+  for (int i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    LiveClient& c = live_[i];
+    if (c.fd < 0) continue;
+    bool closed = false;
+    for (;;) {
+      ssize_t n = recv(c.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+      if (n > 0) {
+        c.rx.insert(c.rx.end(), buffer, buffer + n);
+        continue;
+      }
+      if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) closed = true;
+      break;
+    }
+    bool ok = c.open || handshake(i);
+    if (ok && c.open) ok = processFrames(i);
+    if (closed || !ok) closeClient(i, c.open);
+  }
+}
+
+// 解析HTTP升级请求；请求尚不完整时返回true等待更多数据，格式错误返回false
+bool WebSocketsServer::handshake(int num) {
+  LiveClient& c = live_[num];
+  std::string request(c.rx.begin(), c.rx.end());
+  size_t end = request.find("\r\n\r\n");
+  if (end == std::string::npos) return c.rx.size() < 8192;
+  c.rx.erase(c.rx.begin(), c.rx.begin() + end + 4);
+
+  size_t pathStart = request.find(' ');
+  size_t pathEnd = pathStart == std::string::npos ? std::string::npos : request.find(' ', pathStart + 1);
+  if (request.compare(0, 4, "GET ") != 0 || pathEnd == std::string::npos) return false;
+  std::string url = request.substr(pathStart + 1, pathEnd - pathStart - 1);
+
+  std::string key;
+  size_t pos = 0;
+  while ((pos = request.find("\r\n", pos)) != std::string::npos && pos < end) {
+    pos += 2;
+    static const char HEADER[] = "sec-websocket-key:";
+    size_t headerLen = sizeof(HEADER) - 1;
+    if (request.size() - pos < headerLen) break;
+    bool match = true;
+    for (size_t k = 0; k < headerLen && match; k++) match = tolower(request[pos + k]) == HEADER[k];
+    if (!match) continue;
+    size_t valueStart = request.find_first_not_of(' ', pos + headerLen);
+    key = request.substr(valueStart, request.find("\r\n", valueStart) - valueStart);
+    break;
+  }
+  if (key.empty()) return false;
+
+  std::string accept = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+  uint8_t digest[20];
+  sha1((const uint8_t*)accept.data(), accept.size(), digest);
+  std::string response =
+    "HTTP/1.1 101 Switching Protocols\r\n"
+    "Upgrade: websocket\r\n"
+    "Connection: Upgrade\r\n"
+    "Sec-WebSocket-Accept: " + base64(digest, sizeof(digest)) + "\r\n\r\n";
+  if (!writeAll(c.fd, (const uint8_t*)response.data(), response.size())) return false;
+
+  c.open = true;
+  liveConnections_++;
+  if (event_) inject((uint8_t)num, WStype_CONNECTED, (const uint8_t*)url.data(), url.size());
+  return true;
+}
+
+// 逐帧交给草图回调；数据不完整时保留等待，协议错误或收到close返回false
+bool WebSocketsServer::processFrames(int num) {
+  LiveClient& c = live_[num];
+  size_t pos = 0;
+  bool ok = true;
+  while (ok && c.open) {
+    const uint8_t* p = c.rx.data() + pos;
+    size_t avail = c.rx.size() - pos;
+    if (avail < 2) break;
+    bool fin = (p[0] & 0x80) != 0;
+    uint8_t opcode = p[0] & 0x0F;
+    bool masked = (p[1] & 0x80) != 0;
+    uint64_t length = p[1] & 0x7F;
+    size_t header = 2;
+    if (length == 126) {
+      if (avail < 4) break;
+      length = ((uint64_t)p[2] << 8) | p[3];
+      header = 4;
+    } else if (length == 127) {
+      if (avail < 10) break;
+      length = 0;
+      for (int i = 0; i < 8; i++) length = (length << 8) | p[2 + i];
+      header = 10;
+    }
+    if (!masked || !fin || length > 65536) return false;  // 客户端帧必须掩码；不支持分片
+    if (avail < header + 4 + length) break;
+    const uint8_t* mask = p + header;
+    std::vector<uint8_t> payload(p + header + 4, p + header + 4 + length);
+    for (size_t i = 0; i < payload.size(); i++) payload[i] ^= mask[i & 3];
+    pos += header + 4 + (size_t)length;
+
+    switch (opcode) {
+      case OPCODE_TEXT:
+      case OPCODE_BINARY:
+        rxFrames_++;
+        inject((uint8_t)num, opcode == OPCODE_TEXT ? WStype_TEXT : WStype_BIN, payload.data(), payload.size());
+        break;
+      case OPCODE_PING:
+        sendFrame(num, OPCODE_PONG, payload.data(), payload.size());
+        break;
+      case OPCODE_PONG:
+        break;
+      default:
+        ok = false;  // close或未知操作码
+        break;
+    }
+  }
+  if (c.fd >= 0) c.rx.erase(c.rx.begin(), c.rx.begin() + (pos < c.rx.size() ? pos : c.rx.size()));
+  return ok;
+}
+
+bool WebSocketsServer::sendFrame(int num, uint8_t opcode, const uint8_t* payload, size_t length) {
+  LiveClient& c = live_[num];
+  if (c.fd < 0) return false;
+  uint8_t header[10];
+  size_t n = 0;
+  header[n++] = (uint8_t)(0x80 | opcode);
+  if (length < 126) {
+    header[n++] = (uint8_t)length;
+  } else if (length <= 0xFFFF) {
+    header[n++] = 126;
+    header[n++] = (uint8_t)(length >> 8);
+    header[n++] = (uint8_t)length;
+  } else {
+    header[n++] = 127;
+    for (int i = 7; i >= 0; i--) header[n++] = (uint8_t)((uint64_t)length >> (8 * i));
+  }
+  // 发送期间临时切换为阻塞写
+  int flags = fcntl(c.fd, F_GETFL);
+  fcntl(c.fd, F_SETFL, flags & ~O_NONBLOCK);
+  bool ok = writeAll(c.fd, header, n) && (length == 0 || writeAll(c.fd, payload, length));
+  fcntl(c.fd, F_SETFL, flags);
+  return ok;
+}
+
+void WebSocketsServer::closeClient(int num, bool notify) {
+  LiveClient& c = live_[num];
+  if (c.fd < 0) return;
+  if (c.open) {
+    uint8_t frame[2] = { 0x80 | OPCODE_CLOSE, 0 };
+    send(c.fd, frame, sizeof(frame), MSG_NOSIGNAL | MSG_DONTWAIT);
+  }
+  close(c.fd);
+  c.fd = -1;
+  c.open = false;
+  c.rx.clear();
+  if (notify) inject((uint8_t)num, WStype_DISCONNECTED, nullptr, 0);
+}
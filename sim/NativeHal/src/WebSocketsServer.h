@@ -0,0 +1,129 @@
+#pragma once
+#include "Arduino.h"
+#include <functional>
+#include <vector>
+
+// ===================== WebSocket服务器替身 =====================
+// 接口与links2004/WebSockets一致；回放驱动通过inject()把录制的消息交给草图注册的回调，
+// 草图发出的帧只计数（可选打印），不经过网络。
+// 调用listen()后进入实时模式：在本机端口接受真实的WebSocket连接（RFC 6455最小子集：
+// 不分片的文本/二进制帧、ping/pong、close），由草图loop()里的webSocket.loop()收发，
+// 主机侧压测工具（tools/loadgen.py）即可直接连到仿真上。
+
+#ifndef WEBSOCKETS_SERVER_CLIENT_MAX
+#define WEBSOCKETS_SERVER_CLIENT_MAX 5
+#endif
+
+typedef enum {
+  WStype_ERROR,
+  WStype_DISCONNECTED,
+  WStype_CONNECTED,
+  WStype_TEXT,
+  WStype_BIN,
+  WStype_FRAGMENT_TEXT_START,
+  WStype_FRAGMENT_BIN_START,
+  WStype_FRAGMENT,
+  WStype_FRAGMENT_FIN,
+  WStype_PING,
+  WStype_PONG,
+} WStype_t;
+
+class WebSocketsServer {
+public:
+  typedef std::function<void(uint8_t num, WStype_t type, uint8_t* payload, size_t length)> WebSocketServerEvent;
+
+  explicit WebSocketsServer(uint16_t port) {
+    (void)port;
+    current_ = this;
+    scratch_.reserve(4096);   // 预留注入缓冲，回放按消息统计的堆分配不含替身自身
+  }
+
+  void begin() {}
+  void loop() {
+    if (listenFd_ >= 0) pollNetwork();
+  }
+  void onEvent(WebSocketServerEvent cbEvent) { event_ = cbEvent; }
+
+  bool sendTXT(uint8_t num, const char* payload, size_t length = 0) {
+    return record(num, OPCODE_TEXT, (const uint8_t*)payload, length ? length : strlen(payload));
+  }
+  bool sendTXT(uint8_t num, const String& payload) {
+    return record(num, OPCODE_TEXT, (const uint8_t*)payload.c_str(), payload.length());
+  }
+  bool sendBIN(uint8_t num, const uint8_t* payload, size_t length) { return record(num, OPCODE_BINARY, payload, length); }
+  bool broadcastTXT(const char* payload, size_t length = 0) {
+    return record(0xFF, OPCODE_TEXT, (const uint8_t*)payload, length ? length : strlen(payload));
+  }
+  bool broadcastBIN(const uint8_t* payload, size_t length) { return record(0xFF, OPCODE_BINARY, payload, length); }
+  // 回放时按客户端号编造热点网段地址；实时模式返回真实对端地址（UDP控制通道按来源IP匹配连接）
+  IPAddress remoteIP(uint8_t num) {
+    if (num < WEBSOCKETS_SERVER_CLIENT_MAX && live_[num].fd >= 0) {
+      uint32_t ip = live_[num].ip;
+      return IPAddress((uint8_t)(ip >> 24), (uint8_t)(ip >> 16), (uint8_t)(ip >> 8), (uint8_t)ip);
+    }
+    return IPAddress(192, 168, 4, (uint8_t)(2 + num));
+  }
+
+  // 仿真注入：与真实库一样，载荷末尾补'\0'（文本帧按C字符串解析依赖这一点）
+  void inject(uint8_t num, WStype_t type, const uint8_t* payload, size_t length) {
+    if (!event_) return;
+    scratch_.assign(payload, payload + length);
+    scratch_.push_back(0);
+    event_(num, type, scratch_.data(), length);
+  }
+
+  // 草图发出的帧数/字节数（遥测、回执）
+  uint32_t txFrames() const { return txFrames_; }
+  uint64_t txBytes() const { return txBytes_; }
+
+  static WebSocketsServer* current() { return current_; }
+
+  // 实时模式（WebSocketsServer.cpp）：监听失败返回false
+  bool listen(uint16_t port);
+  bool live() const { return listenFd_ >= 0; }
+  uint32_t liveConnections() const { return liveConnections_; }
+  uint32_t rxFrames() const { return rxFrames_; }
+
+private:
+  static const uint8_t OPCODE_TEXT = 0x1;
+  static const uint8_t OPCODE_BINARY = 0x2;
+  static const uint8_t OPCODE_CLOSE = 0x8;
+  static const uint8_t OPCODE_PING = 0x9;
+  static const uint8_t OPCODE_PONG = 0xA;
+
+  struct LiveClient {
+    int fd = -1;
+    bool open = false;             // 握手已完成
+    uint32_t ip = 0;               // 对端IPv4地址（主机字节序）
+    std::vector<uint8_t> rx;       // 未处理的接收数据
+  };
+
+  bool record(uint8_t num, uint8_t opcode, const uint8_t* payload, size_t length) {
+    txFrames_++;
+    txBytes_ += length;
+    if (listenFd_ < 0) return true;
+    if (num == 0xFF) {
+      for (int i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+        if (live_[i].open) sendFrame(i, opcode, payload, length);
+      }
+      return true;
+    }
+    return num < WEBSOCKETS_SERVER_CLIENT_MAX && live_[num].open && sendFrame(num, opcode, payload, length);
+  }
+
+  void pollNetwork();
+  bool handshake(int num);
+  bool processFrames(int num);
+  bool sendFrame(int num, uint8_t opcode, const uint8_t* payload, size_t length);
+  void closeClient(int num, bool notify);
+
+  WebSocketServerEvent event_;
+  std::vector<uint8_t> scratch_;
+  uint32_t txFrames_ = 0;
+  uint64_t txBytes_ = 0;
+  int listenFd_ = -1;
+  LiveClient live_[WEBSOCKETS_SERVER_CLIENT_MAX];
+  uint32_t liveConnections_ = 0;
+  uint32_t rxFrames_ = 0;
+  static inline WebSocketsServer* current_ = nullptr;
+};
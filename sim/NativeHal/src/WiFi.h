@@ -0,0 +1,24 @@
+#pragma once
+#include "Arduino.h"
+
+// 主机替身：热点配置只记录地址
+class WiFiClass {
+public:
+  bool softAPConfig(IPAddress local, IPAddress gateway, IPAddress subnet) {
+    (void)gateway;
+    (void)subnet;
+    ip_ = local;
+    return true;
+  }
+  bool softAP(const char* ssid, const char* passphrase = nullptr) {
+    (void)ssid;
+    (void)passphrase;
+    return true;
+  }
+  IPAddress softAPIP() const { return ip_; }
+
+private:
+  IPAddress ip_;
+};
+
+extern WiFiClass WiFi;
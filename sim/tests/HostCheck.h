@@ -0,0 +1,35 @@
+#pragma once
+#include <stdio.h>
+
+// ===================== 主机侧自检 =====================
+// sim/tests 下的检查程序共用的断言宏：失败时打印位置并计数，不中断后续检查；
+// main()返回hostCheckResult()，有失败时退出码非0（由 run_tests.sh 汇总）。
+
+static int hostCheckFailures = 0;
+static int hostCheckCount = 0;
+
+#define CHECK(cond)                                                              \
+  do {                                                                           \
+    hostCheckCount++;                                                            \
+    if (!(cond)) {                                                               \
+      hostCheckFailures++;                                                       \
+      fprintf(stderr, "%s:%d: 检查失败: %s\n", __FILE__, __LINE__, #cond);      \
+    }                                                                            \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                           \
+  do {                                                                           \
+    hostCheckCount++;                                                            \
+    long long hostCheckA = (long long)(a);                                       \
+    long long hostCheckB = (long long)(b);                                       \
+    if (hostCheckA != hostCheckB) {                                              \
+      hostCheckFailures++;                                                       \
+      fprintf(stderr, "%s:%d: 检查失败: %s == %s（%lld != %lld）\n", __FILE__,   \
+              __LINE__, #a, #b, hostCheckA, hostCheckB);                         \
+    }                                                                            \
+  } while (0)
+
+inline int hostCheckResult(const char* name) {
+  printf("%s: %d项检查，%d项失败\n", name, hostCheckCount, hostCheckFailures);
+  return hostCheckFailures == 0 ? 0 : 1;
+}
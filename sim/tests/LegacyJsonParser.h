@@ -0,0 +1,174 @@
+#pragma once
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// ===================== 原有JSON解析（对照用） =====================
+// 从基线版本（提交7b88175）V1 main.cpp 摘出的strstr/extractFloat解析，只供主机侧对照和基准使用，
+// 固件不再包含。改动仅限于能在主机上编译：Arduino String 换成 std::string（indexOf→find，
+// toFloat/toInt→atof/atoi），结果写入传入的结构体而不是全局config；匹配与取值逻辑保持原样，
+// 包括它的局限（按子串查找、不区分所在对象，只认数字形式的0/1）。
+
+struct LegacyChannel {
+  float rate;
+  int minPulse;
+  int maxPulse;
+};
+
+struct LegacyConfig {
+  bool controlEnabled;
+  bool operationLocked;
+  LegacyChannel pitch;
+  LegacyChannel roll;
+  LegacyChannel yaw;
+};
+
+struct LegacyGyro {
+  float pitch;
+  float roll;
+  float yaw;
+  int enabled;   // 消息中没有enabled时为-1
+};
+
+// 辅助函数：从字符串中提取浮点数
+inline float legacyExtractFloat(const char* json, int startIndex, int& endIndex) {
+  const char* ptr = json + startIndex;
+  // 找到冒号位置
+  while (*ptr != ':' && *ptr != '\0') ptr++;
+  if (*ptr == '\0') return 0.0;
+  ptr++;
+  // 跳过空格
+  while (*ptr == ' ' || *ptr == '\t') ptr++;
+
+  // 提取数值，直到遇到非数字字符
+  char valueStr[16] = {0};
+  int i = 0;
+  while ((i < 15) && ((*ptr >= '0' && *ptr <= '9') || *ptr == '.' || *ptr == '-' || *ptr == '+')) {
+    valueStr[i++] = *ptr++;
+  }
+  valueStr[i] = '\0';
+
+  endIndex = (ptr - json);
+  return atof(valueStr);
+}
+
+// 辅助函数：从字符串中提取整数
+inline int legacyExtractInt(const char* json, int startIndex, int& endIndex) {
+  const char* ptr = json + startIndex;
+  // 找到冒号位置
+  while (*ptr != ':' && *ptr != '\0') ptr++;
+  if (*ptr == '\0') return 0;
+  ptr++;
+  // 跳过空格
+  while (*ptr == ' ' || *ptr == '\t') ptr++;
+
+  // 提取数值，直到遇到非数字字符
+  char valueStr[16] = {0};
+  int i = 0;
+  while ((i < 15) && ((*ptr >= '0' && *ptr <= '9') || *ptr == '-' || *ptr == '+')) {
+    valueStr[i++] = *ptr++;
+  }
+  valueStr[i] = '\0';
+
+  endIndex = (ptr - json);
+  return atoi(valueStr);
+}
+
+inline void legacyParseChannel(const char* jsonStr, const char* key, LegacyChannel& channel) {
+  const char* channelPtr = strstr(jsonStr, key);
+  if (channelPtr != nullptr) {
+    // 解析rate
+    const char* ratePtr = strstr(channelPtr, "\"rate\":");
+    if (ratePtr != nullptr) {
+      int endIndex;
+      channel.rate = legacyExtractFloat(ratePtr, 0, endIndex);
+    }
+
+    // 解析minPulse
+    const char* minPtr = strstr(channelPtr, "\"minPulse\":");
+    if (minPtr != nullptr) {
+      int endIndex;
+      channel.minPulse = legacyExtractInt(minPtr, 0, endIndex);
+    }
+
+    // 解析maxPulse
+    const char* maxPtr = strstr(channelPtr, "\"maxPulse\":");
+    if (maxPtr != nullptr) {
+      int endIndex;
+      channel.maxPulse = legacyExtractInt(maxPtr, 0, endIndex);
+    }
+  }
+}
+
+// 解析JSON配置数据（原parseConfigData，三个通道的重复代码合并为legacyParseChannel）
+inline void legacyParseConfigData(const std::string& json, LegacyConfig& config) {
+  const char* jsonStr = json.c_str();
+
+  // 解析controlEnabled
+  const char* enabledPtr = strstr(jsonStr, "controlEnabled");
+  if (enabledPtr != nullptr) {
+    int endIndex;
+    int enabledValue = legacyExtractInt(enabledPtr, 0, endIndex);
+    config.controlEnabled = (enabledValue == 1);
+  }
+
+  // 解析operationLocked
+  const char* lockedPtr = strstr(jsonStr, "operationLocked");
+  if (lockedPtr != nullptr) {
+    int endIndex;
+    int lockedValue = legacyExtractInt(lockedPtr, 0, endIndex);
+    config.operationLocked = (lockedValue == 1);
+  }
+
+  legacyParseChannel(jsonStr, "\"pitch\":", config.pitch);
+  legacyParseChannel(jsonStr, "\"roll\":", config.roll);
+  legacyParseChannel(jsonStr, "\"yaw\":", config.yaw);
+}
+
+// 原onWebSocketEvent中的消息分类：0=其他，1=配置，2=陀螺仪数据
+inline int legacyClassify(const std::string& message) {
+  if (message.empty() || message[0] != '{') return 0;
+  size_t npos = std::string::npos;
+  if (message.find("controlEnabled") != npos && message.find("enabled") == npos) return 1;
+  if (message.find("pitch") != npos && message.find("roll") != npos && message.find("yaw") != npos) return 2;
+  return 0;
+}
+
+inline float legacyToFloat(const std::string& message, size_t begin, size_t end) {
+  return (float)atof(message.substr(begin, end == std::string::npos ? std::string::npos : end - begin).c_str());
+}
+
+// 原onWebSocketEvent中的陀螺仪数据提取（indexOf/substring/toFloat）
+inline void legacyParseGyro(const std::string& message, LegacyGyro& gyro) {
+  const size_t npos = std::string::npos;
+  gyro.pitch = 0.0f;
+  gyro.roll = 0.0f;
+  gyro.yaw = 0.0f;
+  gyro.enabled = -1;
+
+  size_t pitchIndex = message.find("pitch");
+  if (pitchIndex != npos && pitchIndex > 0) {
+    gyro.pitch = legacyToFloat(message, message.find(":", pitchIndex) + 1, message.find(",", pitchIndex));
+  }
+
+  size_t rollIndex = message.find("roll");
+  if (rollIndex != npos && rollIndex > 0) {
+    gyro.roll = legacyToFloat(message, message.find(":", rollIndex) + 1, message.find(",", rollIndex));
+  }
+
+  size_t yawIndex = message.find("yaw");
+  if (yawIndex != npos && yawIndex > 0) {
+    size_t comma = message.find(",", yawIndex);
+    gyro.yaw = legacyToFloat(message, message.find(":", yawIndex) + 1,
+                             comma != npos ? comma : message.find("}", yawIndex));
+  }
+
+  // 提取enabled字段，用于更新控制状态
+  size_t enabledIndex = message.find("enabled");
+  if (enabledIndex != npos && enabledIndex > 0) {
+    size_t comma = message.find(",", enabledIndex);
+    size_t begin = message.find(":", enabledIndex) + 1;
+    size_t end = comma != npos ? comma : message.find("}", enabledIndex);
+    gyro.enabled = atoi(message.substr(begin, end == npos ? npos : end - begin).c_str()) == 1 ? 1 : 0;
+  }
+}
@@ -0,0 +1,126 @@
+"""JSON消息与二进制帧的整条固件路径对比。
+
+把trace中的JSON控制消息（V1姿态角 {"pitch","roll","yaw","enabled"}，
+V2脉宽 {"P-PIN","P-PWM",...}）改写成内容相同的16字节二进制帧（版本1，格式见 lib/GyroCore/GyroFrame.h），
+其余消息原样保留；两份trace分别在主机仿真上回放，PWM占空比时间线必须逐行一致。
+帧编码在这里独立实现（不复用固件代码），同时校验了网页端的编码约定。
+
+用法：python sim/tests/frame_equivalence.py <仿真程序> <trace文件> --kind angle|pulse
+"""
+import argparse
+import json
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+FRAME_MAGIC = 0x47
+FRAME_VERSION_V1 = 1
+FRAME_ANGLE = 1
+FRAME_PULSE = 2
+FLAG_ENABLED = 0x01
+FLAG_HAS_ENABLED = 0x02
+PIN_NONE = -1
+
+
+def round_half_away(value):
+    return int(value + 0.5) if value >= 0 else -int(-value + 0.5)
+
+
+def encode_frame(kind, flags, seq, values, pins):
+    values = [max(-32768, min(32767, v)) for v in values]
+    return struct.pack("<BBBBH3h3bB", FRAME_MAGIC, FRAME_VERSION_V1, kind, flags, seq & 0xFFFF,
+                       *values, *pins, 0)
+
+
+def angle_frame(message):
+    if not all(k in message for k in ("pitch", "roll", "yaw")) or "controlEnabled" in message:
+        return None
+    flags = 0
+    if "enabled" in message:
+        flags = FLAG_HAS_ENABLED | (FLAG_ENABLED if message["enabled"] == 1 else 0)
+    values = [round_half_away(message[k] * 100) for k in ("pitch", "roll", "yaw")]
+    return encode_frame(FRAME_ANGLE, flags, message.get("seq", 0), values, [PIN_NONE] * 3)
+
+
+def pulse_frame(message):
+    axes = ("P", "R", "Y")
+    # 只改写纯脉宽消息：带滤波/轨迹等设置的消息仍走JSON
+    if set(message) - {"%s-%s" % (a, f) for a in axes for f in ("PIN", "PWM")}:
+        return None
+    values = []
+    pins = []
+    for a in axes:
+        if "%s-PIN" % a in message and "%s-PWM" % a in message:
+            values.append(int(message["%s-PWM" % a]))
+            pins.append(int(message["%s-PIN" % a]))
+        else:
+            values.append(0)
+            pins.append(PIN_NONE)
+    return encode_frame(FRAME_PULSE, 0, 0, values, pins)
+
+
+def convert(lines, kind):
+    encode = angle_frame if kind == "angle" else pulse_frame
+    converted = 0
+    out = []
+    for line in lines:
+        parts = line.rstrip("\n").split(" ", 3)
+        if len(parts) == 4 and parts[2] == "text" and parts[3].startswith("{"):
+            try:
+                frame = encode(json.loads(parts[3]))
+            except ValueError:
+                frame = None
+            if frame is not None:
+                out.append("%s %s bin %s\n" % (parts[0], parts[1], frame.hex()))
+                converted += 1
+                continue
+        out.append(line if line.endswith("\n") else line + "\n")
+    return out, converted
+
+
+def pwm_timeline(program, trace_path):
+    result = subprocess.run([program, trace_path], stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                            universal_newlines=True, check=True)
+    return [line for line in result.stdout.splitlines() if line.startswith("pwm,")]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("program")
+    parser.add_argument("trace")
+    parser.add_argument("--kind", choices=("angle", "pulse"), required=True)
+    args = parser.parse_args()
+
+    with open(args.trace) as f:
+        lines = f.readlines()
+    binary_lines, converted = convert(lines, args.kind)
+    if converted == 0:
+        print("%s: 没有可改写的JSON消息" % args.trace)
+        return 1
+
+    fd, binary_path = tempfile.mkstemp(suffix=".trace")
+    try:
+        with os.fdopen(fd, "w") as f:
+            f.writelines(binary_lines)
+        text_pwm = pwm_timeline(args.program, args.trace)
+        binary_pwm = pwm_timeline(args.program, binary_path)
+    finally:
+        os.unlink(binary_path)
+
+    name = os.path.basename(args.trace)
+    if text_pwm != binary_pwm:
+        for i, (a, b) in enumerate(zip(text_pwm, binary_pwm)):
+            if a != b:
+                print("%s: 第%d行不同：JSON %s / 二进制 %s" % (name, i + 1, a, b))
+                break
+        else:
+            print("%s: PWM行数不同：JSON %d / 二进制 %d" % (name, len(text_pwm), len(binary_pwm)))
+        return 1
+    print("%s: %d条JSON消息改写为二进制帧，%d行PWM一致" % (name, converted, len(text_pwm)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
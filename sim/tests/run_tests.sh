@@ -0,0 +1,66 @@
+#!/bin/sh
+# ===================== 主机侧检查 =====================
+# 1. 编译运行 sim/tests/test_*.cpp（只依赖 lib/GyroCore，每个程序自带main，失败时退出码非0）；
+# 2. 在主机仿真上回放trace，对比JSON消息与二进制帧的整条固件路径（frame_equivalence.py）。
+#    V2的JSON路径依赖ArduinoJson：先在 PIO_V2esp32_servo_Gyroscope 下运行一次 pio run -e native，
+#    或用 ARDUINOJSON_DIR 指向其 src 目录；找不到时跳过V2对比。
+#
+# 用法（仓库根目录）：sh sim/tests/run_tests.sh
+# 构建输出在 $TEST_BUILD_DIR（默认 /tmp/gyro_tests）。
+
+cd "$(dirname "$0")/../.." || exit 1
+CXX=${CXX:-g++}
+PYTHON=${PYTHON:-python3}
+OUT=${TEST_BUILD_DIR:-/tmp/gyro_tests}
+CXXFLAGS="-std=gnu++17 -O2 -Wall -Wextra -pthread"
+mkdir -p "$OUT"
+
+failed=0
+fail() {
+  echo "失败: $1"
+  failed=$((failed + 1))
+}
+
+for src in sim/tests/test_*.cpp; do
+  name=$(basename "$src" .cpp)
+  if ! $CXX $CXXFLAGS -Ilib/GyroCore -Isim/tests "$src" lib/GyroCore/*.cpp -o "$OUT/$name"; then
+    fail "$name（编译）"
+    continue
+  fi
+  "$OUT/$name" || fail "$name"
+done
+
+# 主机仿真：与 platformio.ini 的 native 环境相同的源文件和宏
+build_sim() {
+  project=$1
+  mode=$2
+  shift 2
+  "$PYTHON" tools/embed_html.py "$project" > /dev/null &&
+    $CXX -std=gnu++17 -O2 -D UDP_CONTROL=1 -D INPUT_MODE=$mode -Isim/NativeHal/src -Ilib/GyroCore -I"$project/include" "$@" \
+      src/main.cpp lib/GyroCore/*.cpp sim/NativeHal/src/*.cpp -o "$OUT/$(basename "$project")"
+}
+
+if build_sim PIO_V1esp32_servo_Gyroscope INPUT_MODE_ANGLE; then
+  "$PYTHON" sim/tests/frame_equivalence.py "$OUT/PIO_V1esp32_servo_Gyroscope" sim/traces/v1_sample.trace \
+    --kind angle || fail "frame_equivalence v1_sample"
+else
+  fail "V1仿真（编译）"
+fi
+
+json_dir=${ARDUINOJSON_DIR:-PIO_V2esp32_servo_Gyroscope/.pio/libdeps/native/ArduinoJson/src}
+if [ -f "$json_dir/ArduinoJson.h" ]; then
+  if build_sim PIO_V2esp32_servo_Gyroscope INPUT_MODE_PULSE -I"$json_dir"; then
+    "$PYTHON" sim/tests/frame_equivalence.py "$OUT/PIO_V2esp32_servo_Gyroscope" sim/traces/v2_sample.trace \
+      --kind pulse || fail "frame_equivalence v2_sample"
+  else
+    fail "V2仿真（编译）"
+  fi
+else
+  echo "跳过V2对比：未找到ArduinoJson（$json_dir）"
+fi
+
+if [ "$failed" -ne 0 ]; then
+  echo "共$failed项失败"
+  exit 1
+fi
+echo "全部通过"
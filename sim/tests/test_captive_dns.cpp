@@ -0,0 +1,121 @@
+// ===================== 强制门户DNS =====================
+// - buildDnsReply：A/ANY查询回答本机地址（TTL、RD位、问题原样带回），AAAA回答无记录，
+//   附加记录丢弃；应答、多问题、非标准查询、截断或带压缩指针的问题不应答；
+// - DnsBudget：预算只在确有请求时扣除，推迟按被挡下的请求计数（同一请求只计一次），
+//   answered()只在真正处理了数据报时调用。
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "CaptivePortal.h"
+#include "HostCheck.h"
+
+const uint32_t AP_IP = (192u << 24) | (168u << 16) | (4u << 8) | 1u;
+
+// 查询 connectivitycheck.gstatic.com，可选附加一条EDNS OPT记录
+static std::vector<uint8_t> makeQuery(uint16_t type, bool rd, bool edns) {
+  std::vector<uint8_t> q = { 0x12, 0x34, (uint8_t)(rd ? 0x01 : 0x00), 0x00, 0, 1, 0, 0, 0, 0, 0, (uint8_t)(edns ? 1 : 0) };
+  const char* labels[] = { "connectivitycheck", "gstatic", "com" };
+  for (const char* label : labels) {
+    q.push_back((uint8_t)strlen(label));
+    q.insert(q.end(), label, label + strlen(label));
+  }
+  q.push_back(0);
+  q.push_back((uint8_t)(type >> 8));
+  q.push_back((uint8_t)type);
+  q.push_back(0);
+  q.push_back(1);
+  if (edns) {
+    const uint8_t opt[] = { 0, 0, 41, 0x10, 0, 0, 0, 0, 0, 0, 0 };
+    q.insert(q.end(), opt, opt + sizeof(opt));
+  }
+  return q;
+}
+
+static size_t reply(const std::vector<uint8_t>& q, uint8_t* out, size_t capacity = DNS_MAX_PACKET + DNS_ANSWER_SIZE) {
+  return buildDnsReply(q.data(), q.size(), AP_IP, 300, out, capacity);
+}
+
+static void testReply() {
+  uint8_t out[DNS_MAX_PACKET + DNS_ANSWER_SIZE];
+  std::vector<uint8_t> q = makeQuery(1, true, true);
+  size_t question = q.size() - 11;   // 去掉OPT记录
+  size_t n = reply(q, out);
+  CHECK_EQ(n, question + DNS_ANSWER_SIZE);
+  CHECK(out[0] == 0x12 && out[1] == 0x34);
+  CHECK_EQ(out[2], 0x85);            // QR、AA、RD
+  CHECK_EQ(out[3], 0x00);
+  CHECK_EQ(out[5], 1);               // 问题数
+  CHECK_EQ(out[7], 1);               // 回答数
+  CHECK_EQ(out[11], 0);              // OPT已丢弃
+  CHECK(memcmp(out + DNS_HEADER_SIZE, q.data() + DNS_HEADER_SIZE, question - DNS_HEADER_SIZE) == 0);
+  const uint8_t answer[DNS_ANSWER_SIZE] = { 0xC0, 0x0C, 0, 1, 0, 1, 0, 0, 0x01, 0x2C, 0, 4, 192, 168, 4, 1 };
+  CHECK(memcmp(out + question, answer, DNS_ANSWER_SIZE) == 0);
+
+  // 不带RD、ANY查询
+  q = makeQuery(255, false, false);
+  CHECK_EQ(reply(q, out), q.size() + DNS_ANSWER_SIZE);
+  CHECK_EQ(out[2], 0x84);
+
+  // AAAA：无记录
+  q = makeQuery(28, true, false);
+  CHECK_EQ(reply(q, out), q.size());
+  CHECK_EQ(out[7], 0);
+  CHECK_EQ(out[3] & 0x0F, 0);
+
+  // 缓冲区不够放回答时不应答
+  q = makeQuery(1, true, false);
+  CHECK_EQ(reply(q, out, q.size() + DNS_ANSWER_SIZE - 1), 0);
+}
+
+static void testReject() {
+  uint8_t out[DNS_MAX_PACKET + DNS_ANSWER_SIZE];
+  std::vector<uint8_t> q = makeQuery(1, true, false);
+  CHECK_EQ(buildDnsReply(q.data(), DNS_HEADER_SIZE - 1, AP_IP, 300, out, sizeof(out)), 0);
+
+  std::vector<uint8_t> bad = q;
+  bad[2] |= 0x80;                    // 应答
+  CHECK_EQ(reply(bad, out), 0);
+  bad = q;
+  bad[2] |= 0x10;                    // 非标准查询（opcode=2）
+  CHECK_EQ(reply(bad, out), 0);
+  bad = q;
+  bad[5] = 2;                        // 两个问题
+  CHECK_EQ(reply(bad, out), 0);
+  bad = q;
+  bad[DNS_HEADER_SIZE] = 0xC0;       // 问题里的压缩指针
+  CHECK_EQ(reply(bad, out), 0);
+  for (size_t cut = DNS_HEADER_SIZE; cut < q.size(); cut++) {
+    CHECK_EQ(buildDnsReply(q.data(), cut, AP_IP, 300, out, sizeof(out)), 0);
+  }
+  bad = q;
+  bad[DNS_HEADER_SIZE] = 60;         // 标签长度越过报文末尾
+  CHECK_EQ(reply(bad, out), 0);
+}
+
+static void testBudget() {
+  DnsBudget budget(2, 20);
+  // 窗口内两个请求通过，第三个被挡下；同一请求在本窗口内反复检查只计一次推迟
+  CHECK(budget.allow(0));
+  budget.answered();
+  CHECK(budget.allow(1));
+  budget.answered();
+  for (uint32_t t = 2; t < 20; t++) CHECK(!budget.allow(t));
+  CHECK_EQ(budget.deferred(), 1);
+  // 下个窗口应答被推迟的请求，再来一个被挡下的请求计第二次推迟
+  CHECK(budget.allow(20));
+  budget.answered();
+  CHECK(budget.allow(21));
+  CHECK(!budget.allow(22));
+  CHECK(!budget.allow(23));
+  CHECK_EQ(budget.deferred(), 2);
+  // 预算通过但套接字里取不到数据报时不计应答
+  CHECK_EQ(budget.answers(), 3);
+}
+
+int main() {
+  testReply();
+  testReject();
+  testBudget();
+  return hostCheckResult("test_captive_dns");
+}
@@ -0,0 +1,229 @@
+// ===================== 持久化配置（主机存储后端） =====================
+// - storeConfig/loadStoredConfig往返：写入后读出的结构逐字节相同；
+// - 校验失败时out保持不变：键不存在为missing、版本号不同为version mismatch、魔数错误为bad magic、
+//   负载任一字节翻转为bad crc、块被截断或多出字节（以及另一尺寸的结构写在同一键下）为bad size；
+// - 变长块（sealConfigBlob/openConfigBlob）往返，长度为0的负载也合法；
+// - ConfigDebouncer：markDirty后配置保持quietMs不变才提交一次，期间再次变更重新计时，
+//   millis()回绕时同样按差值计算；
+// - 录制槽位：从未写入、写入空数据和越界槽位时loadMotionSlot/motionSlotBytes的结果。
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "ConfigStore.h"
+#include "HostCheck.h"
+#include "MotionRecord.h"
+
+const uint16_t TEST_VERSION = 3;
+
+struct TestConfig {
+  int32_t pulse[4];
+  float rate;
+  uint8_t flags;
+};
+
+struct SmallConfig {
+  int32_t pulse[2];
+};
+
+static TestConfig sampleConfig() {
+  TestConfig config;
+  memset(&config, 0, sizeof(config));  // 填充字节也参与CRC，先清零
+  for (int i = 0; i < 4; i++) config.pulse[i] = 1000 + 250 * i;
+  config.rate = 5.55f;
+  config.flags = 0x5A;
+  return config;
+}
+
+static std::vector<uint8_t> encoded(const TestConfig& config, uint16_t version) {
+  std::vector<uint8_t> blob(sizeof(ConfigBlobHeader) + sizeof(TestConfig));
+  CHECK_EQ(encodeConfigBlob(&config, sizeof(config), version, blob.data(), blob.size()), blob.size());
+  return blob;
+}
+
+// 把blob直接写入后端再按TestConfig读取；out预置为哨兵值，用于确认失败时不被改写
+static ConfigLoadResult loadRaw(const std::vector<uint8_t>& blob, bool& untouched) {
+  writeConfigBlob("raw", blob.data(), blob.size());
+  TestConfig out;
+  memset(&out, 0xEE, sizeof(out));
+  ConfigLoadResult result = loadStoredConfig("raw", TEST_VERSION, out);
+  TestConfig sentinel;
+  memset(&sentinel, 0xEE, sizeof(sentinel));
+  untouched = memcmp(&out, &sentinel, sizeof(out)) == 0;
+  return result;
+}
+
+static void testRoundTrip() {
+  TestConfig config = sampleConfig();
+  CHECK(storeConfig("servo", TEST_VERSION, config));
+  TestConfig out;
+  memset(&out, 0, sizeof(out));
+  CHECK_EQ(loadStoredConfig("servo", TEST_VERSION, out), CONFIG_LOADED);
+  CHECK(memcmp(&out, &config, sizeof(config)) == 0);
+
+  // 再次写入覆盖旧值
+  config.pulse[2] = 2222;
+  CHECK(storeConfig("servo", TEST_VERSION, config));
+  CHECK_EQ(loadStoredConfig("servo", TEST_VERSION, out), CONFIG_LOADED);
+  CHECK_EQ(out.pulse[2], 2222);
+
+  CHECK_EQ(loadStoredConfig("absent", TEST_VERSION, out), CONFIG_MISSING);
+  CHECK_EQ(out.pulse[2], 2222);
+}
+
+static void testRejected() {
+  TestConfig config = sampleConfig();
+  bool untouched = false;
+
+  CHECK_EQ(loadRaw(encoded(config, TEST_VERSION), untouched), CONFIG_LOADED);
+  CHECK(!untouched);
+
+  CHECK_EQ(loadRaw(encoded(config, TEST_VERSION + 1), untouched), CONFIG_BAD_VERSION);
+  CHECK(untouched);
+
+  std::vector<uint8_t> blob = encoded(config, TEST_VERSION);
+  blob[0] ^= 0x01;
+  CHECK_EQ(loadRaw(blob, untouched), CONFIG_BAD_MAGIC);
+  CHECK(untouched);
+
+  // 负载每个字节的每一位单独翻转都应被CRC发现
+  uint32_t missed = 0;
+  uint32_t touched = 0;
+  for (size_t i = sizeof(ConfigBlobHeader); i < blob.size(); i++) {
+    for (int bit = 0; bit < 8; bit++) {
+      blob = encoded(config, TEST_VERSION);
+      blob[i] ^= (uint8_t)(1u << bit);
+      if (loadRaw(blob, untouched) != CONFIG_BAD_CRC) missed++;
+      if (!untouched) touched++;
+    }
+  }
+  CHECK_EQ(missed, 0);
+  CHECK_EQ(touched, 0);
+
+  // 截断：少一个字节、只剩半个头部、空块
+  blob = encoded(config, TEST_VERSION);
+  blob.pop_back();
+  CHECK_EQ(loadRaw(blob, untouched), CONFIG_BAD_SIZE);
+  CHECK(untouched);
+  blob.resize(sizeof(ConfigBlobHeader) / 2);
+  CHECK_EQ(loadRaw(blob, untouched), CONFIG_BAD_SIZE);
+  CHECK(untouched);
+  blob.clear();
+  CHECK_EQ(loadRaw(blob, untouched), CONFIG_MISSING);
+  CHECK(untouched);
+
+  // 多出字节：超过读取缓冲区，不拷贝
+  blob = encoded(config, TEST_VERSION);
+  blob.push_back(0);
+  CHECK_EQ(loadRaw(blob, untouched), CONFIG_BAD_SIZE);
+  CHECK(untouched);
+  blob.resize(blob.size() + 4096, 0xAB);
+  CHECK_EQ(loadRaw(blob, untouched), CONFIG_BAD_SIZE);
+  CHECK(untouched);
+
+  // 结构体变小但版本号未变：头部尺寸与当前结构不符
+  SmallConfig small = { { 1, 2 } };
+  CHECK(storeConfig("raw", TEST_VERSION, small));
+  TestConfig out;
+  memset(&out, 0xEE, sizeof(out));
+  CHECK_EQ(loadStoredConfig("raw", TEST_VERSION, out), CONFIG_BAD_SIZE);
+  CHECK_EQ(out.pulse[0], (int32_t)0xEEEEEEEE);
+
+  // 编码空间不足
+  uint8_t tiny[sizeof(ConfigBlobHeader) + sizeof(TestConfig) - 1];
+  CHECK_EQ(encodeConfigBlob(&config, sizeof(config), TEST_VERSION, tiny, sizeof(tiny)), 0);
+}
+
+static void testVariableBlob() {
+  uint8_t blob[sizeof(ConfigBlobHeader) + 64];
+  for (int size = 0; size <= 64; size += 16) {
+    for (int i = 0; i < size; i++) blob[sizeof(ConfigBlobHeader) + i] = (uint8_t)(i * 7 + size);
+    size_t total = sealConfigBlob(blob, (uint16_t)size, TEST_VERSION);
+    CHECK_EQ(total, sizeof(ConfigBlobHeader) + size);
+    uint16_t opened = 0xFFFF;
+    CHECK_EQ(openConfigBlob(blob, total, TEST_VERSION, opened), CONFIG_LOADED);
+    CHECK_EQ(opened, size);
+    CHECK_EQ(openConfigBlob(blob, total, TEST_VERSION + 1, opened), CONFIG_BAD_VERSION);
+    CHECK_EQ(openConfigBlob(blob, total + 1, TEST_VERSION, opened), CONFIG_BAD_SIZE);
+    if (size > 0) {
+      blob[sizeof(ConfigBlobHeader) + size - 1] ^= 0x80;
+      CHECK_EQ(openConfigBlob(blob, total, TEST_VERSION, opened), CONFIG_BAD_CRC);
+    }
+  }
+}
+
+static void testDebouncer() {
+  ConfigDebouncer debouncer(500);
+  CHECK(!debouncer.due(0));
+  CHECK(!debouncer.due(10000));
+
+  // 连续变更期间不提交，最后一次变更后满500ms才提交一次
+  uint32_t early = 0;
+  for (uint32_t t = 1000; t <= 3000; t += 100) {
+    debouncer.markDirty(t);
+    if (debouncer.due(t + 50)) early++;
+  }
+  CHECK_EQ(early, 0);
+  CHECK(debouncer.dirty());
+  CHECK(!debouncer.due(3499));
+  CHECK(debouncer.due(3500));
+  CHECK(!debouncer.dirty());
+  CHECK(!debouncer.due(3501));
+  CHECK(!debouncer.due(9000));
+  CHECK_EQ(debouncer.commits(), 1);
+
+  // millis()回绕
+  debouncer.markDirty(0xFFFFFF00u);
+  CHECK(!debouncer.due(0xFFFFFFFFu));
+  CHECK(!debouncer.due(0x000000F3u));
+  CHECK(debouncer.due(0x000000F4u));
+  CHECK_EQ(debouncer.commits(), 2);
+}
+
+static void testMotionSlots() {
+  uint8_t blob[sizeof(ConfigBlobHeader) + 64];
+  size_t length = 12345;
+
+  // 从未写入的槽位
+  for (int slot = 0; slot < MOTION_SLOTS; slot++) {
+    CHECK_EQ(loadMotionSlot(slot, blob, sizeof(blob), length), CONFIG_MISSING);
+    CHECK_EQ(motionSlotBytes(slot), 0);
+  }
+  CHECK_EQ(loadMotionSlot(-1, blob, sizeof(blob), length), CONFIG_MISSING);
+  CHECK_EQ(loadMotionSlot(MOTION_SLOTS, blob, sizeof(blob), length), CONFIG_MISSING);
+  CHECK_EQ(motionSlotBytes(MOTION_SLOTS), 0);
+
+  // 空录制：只有头部，合法且长度为0
+  CHECK(saveMotionSlot(1, blob, 0));
+  CHECK_EQ(motionSlotBytes(1), 0);
+  length = 12345;
+  CHECK_EQ(loadMotionSlot(1, blob, sizeof(blob), length), CONFIG_LOADED);
+  CHECK_EQ(length, 0);
+
+  // 写入数据后其他槽位仍为空
+  for (int i = 0; i < 40; i++) blob[sizeof(ConfigBlobHeader) + i] = (uint8_t)i;
+  CHECK(saveMotionSlot(2, blob, 40));
+  CHECK_EQ(motionSlotBytes(2), 40);
+  CHECK_EQ(motionSlotBytes(3), 0);
+  memset(blob, 0, sizeof(blob));
+  CHECK_EQ(loadMotionSlot(2, blob, sizeof(blob), length), CONFIG_LOADED);
+  CHECK_EQ(length, 40);
+  CHECK_EQ(blob[sizeof(ConfigBlobHeader) + 39], 39);
+  // 读取缓冲区放不下
+  CHECK_EQ(loadMotionSlot(2, blob, sizeof(ConfigBlobHeader) + 39, length), CONFIG_BAD_SIZE);
+  CHECK(!saveMotionSlot(MOTION_SLOTS, blob, 0));
+
+  // 后端中的零长度值（如被擦除的键）按空槽处理
+  writeConfigBlob("motion3", blob, 0);
+  CHECK_EQ(motionSlotBytes(3), 0);
+  CHECK_EQ(loadMotionSlot(3, blob, sizeof(blob), length), CONFIG_MISSING);
+}
+
+int main() {
+  testRoundTrip();
+  testRejected();
+  testVariableBlob();
+  testDebouncer();
+  testMotionSlots();
+  return hostCheckResult("test_config_store");
+}
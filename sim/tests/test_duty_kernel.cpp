@@ -0,0 +1,96 @@
+// ===================== 定点占空比内核与整数映射 =====================
+// - DutyKernel：8~16位分辨率、常用周期（50/100/300/400Hz等）下，-10us~周期+10us内每个脉宽的占空比
+//   与64位整数除法 floor(pulse * dutyMax / period) 逐值相同（超出周期的按周期计、负值为0，直到int两端）；
+//   16位分辨率下另对1~20000us的每个周期逐值检查（倒数最难精确的情形）；
+// - mapChannels：±180°内每个0.01°刻度，脉宽与原浮点公式 1500 + mapped * rate 相差不超过1us。
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "ChannelTable.h"
+#include "DutyKernel.h"
+#include "HostCheck.h"
+
+static uint32_t referenceDuty(int pulseUs, uint32_t dutyMax, uint32_t periodUs) {
+  if (pulseUs <= 0) return 0;
+  uint64_t pulse = (uint32_t)pulseUs > periodUs ? periodUs : (uint32_t)pulseUs;
+  return (uint32_t)(pulse * dutyMax / periodUs);
+}
+
+// 返回不一致的脉宽个数（每个周期只报告第一个）
+static uint32_t checkPeriod(int bits, uint32_t periodUs) {
+  DutyKernel kernel(bits, periodUs);
+  uint32_t mismatches = 0;
+  for (int pulse = -10; pulse <= (int)periodUs + 10; pulse++) {
+    if (kernel.duty(pulse) != referenceDuty(pulse, kernel.dutyMax(), periodUs)) {
+      if (mismatches == 0) {
+        fprintf(stderr, "%d位 周期%uus 脉宽%dus: %u != %u\n", bits, periodUs, pulse, kernel.duty(pulse),
+                referenceDuty(pulse, kernel.dutyMax(), periodUs));
+      }
+      mismatches++;
+    }
+  }
+  return mismatches;
+}
+
+static void testDutyExact() {
+  const uint32_t periods[] = { 20000, 10000, 3333, 2500, 1000, 1 };
+  for (int bits = PWM_MIN_BITS; bits <= PWM_MAX_BITS; bits++) {
+    for (uint32_t period : periods) CHECK_EQ(checkPeriod(bits, period), 0);
+  }
+  uint32_t badPeriods = 0;
+  for (uint32_t period = 1; period <= PWM_PERIOD_US; period++) {
+    if (checkPeriod(PWM_MAX_BITS, period) != 0) badPeriods++;
+  }
+  CHECK_EQ(badPeriods, 0);
+
+  // 原公式（12位、20ms）
+  DutyKernel legacy;
+  for (int pulse = 0; pulse <= (int)PWM_PERIOD_US; pulse++) CHECK_EQ(legacy.duty(pulse), (uint32_t)(pulse * 4095) / 20000);
+
+  // 越界配置被钳到支持范围
+  DutyKernel low(4, 0);
+  CHECK_EQ(low.bits(), PWM_MIN_BITS);
+  CHECK_EQ(low.periodUs(), PWM_PERIOD_US);
+  DutyKernel high(20, PWM_PERIOD_US);
+  CHECK_EQ(high.dutyMax(), 65535);
+  CHECK_EQ(high.duty(INT_MAX), 65535);
+  CHECK_EQ(high.duty(INT_MIN), 0);
+}
+
+// 基线的浮点映射：constrain(raw - offset, ±180) 后 1500 + mapped * rate（float乘积截断为int）
+static int legacyPulse(float rawDeg, float offset, float rate, int minPulse, int maxPulse) {
+  double mapped = rawDeg - offset;
+  if (mapped < -180.0) mapped = -180.0;
+  if (mapped > 180.0) mapped = 180.0;
+  float mappedValue = (float)mapped;
+  int pulse = 1500 + (mappedValue * rate);
+  return pulse < minPulse ? minPulse : (pulse > maxPulse ? maxPulse : pulse);
+}
+
+static void testMappingWithinOneUs() {
+  const float rates[] = { 5.55f, -5.55f, 3.7f, 1.0f, 0.5f, 11.1f };
+  const float offsets[] = { 0.0f, 12.5f, -30.25f };
+  for (float rate : rates) {
+    for (float offset : offsets) {
+      ChannelConfig ch = defaultChannelConfig(0, AXIS_PITCH);
+      ch.rate = rate;
+      ch.offset = offset;
+      ch.deadband = 0;
+      prepareChannel(ch);
+      int maxDiff = 0;
+      for (int32_t centi = -18000; centi <= 18000; centi++) {
+        mapChannels(&ch, 1, &centi, true);
+        int diff = abs(ch.pulseWidth - legacyPulse(centi * 0.01f, offset, rate, ch.minPulse, ch.maxPulse));
+        if (diff > maxDiff) maxDiff = diff;
+      }
+      CHECK(maxDiff <= 1);
+    }
+  }
+}
+
+int main() {
+  testDutyExact();
+  testMappingWithinOneUs();
+  return hostCheckResult("test_duty_kernel");
+}
@@ -0,0 +1,202 @@
+// ===================== 二进制帧与JSON姿态消息 =====================
+// - 姿态/脉宽帧、IMU批量帧编码后解码还原全部字段，版本1的16字节帧照常解码；
+// - 长度、魔数、版本、帧类型、样本数不符的帧被拒绝；
+// - 同一姿态的JSON消息（decodeGyroText）与二进制帧解码出相同的GyroFrame，
+//   覆盖±180°内每个0.01°刻度、enabled/seq有无的组合。
+// 固件里两种通道之后都交给pushAngleFrame，帧相同即指令相同；整条固件路径的对比见 frame_equivalence.py。
+
+#include <stdio.h>
+#include <string.h>
+#include "GyroFrame.h"
+#include "GyroText.h"
+#include "HostCheck.h"
+
+static bool sameFrame(const GyroFrame& a, const GyroFrame& b) {
+  if (a.kind != b.kind || a.flags != b.flags || a.seq != b.seq || a.timeMs != b.timeMs) return false;
+  for (int i = 0; i < GYRO_FRAME_AXES; i++) {
+    if (a.value[i] != b.value[i] || a.pin[i] != b.pin[i]) return false;
+  }
+  return true;
+}
+
+static GyroFrame makeFrame(uint8_t kind, uint8_t flags, uint16_t seq, int16_t v0, int16_t v1, int16_t v2,
+                           int8_t p0, int8_t p1, int8_t p2, uint32_t timeMs) {
+  GyroFrame frame;
+  frame.kind = kind;
+  frame.flags = flags;
+  frame.seq = seq;
+  frame.value[0] = v0;
+  frame.value[1] = v1;
+  frame.value[2] = v2;
+  frame.pin[0] = p0;
+  frame.pin[1] = p1;
+  frame.pin[2] = p2;
+  frame.timeMs = timeMs;
+  return frame;
+}
+
+static void testFrameRoundTrip() {
+  const GyroFrame frames[] = {
+    makeFrame(GYRO_FRAME_ANGLE, GYRO_FLAG_HAS_ENABLED | GYRO_FLAG_ENABLED | GYRO_FLAG_TIMESTAMP,
+              1, 1234, -5678, 18000, GYRO_PIN_NONE, GYRO_PIN_NONE, GYRO_PIN_NONE, 123456),
+    makeFrame(GYRO_FRAME_ANGLE, 0, 65535, INT16_MIN, INT16_MAX, 0, GYRO_PIN_NONE, GYRO_PIN_NONE, GYRO_PIN_NONE,
+              0xFFFFFFFFu),
+    makeFrame(GYRO_FRAME_PULSE, GYRO_FLAG_TIMESTAMP, 42, 500, 1500, 2500, 12, 13, 14, 7),
+    makeFrame(GYRO_FRAME_PULSE, 0, 0, 1000, 2000, 1500, 0, GYRO_PIN_NONE, 39, 0),
+  };
+  for (const GyroFrame& frame : frames) {
+    uint8_t buf[GYRO_FRAME_SIZE];
+    CHECK_EQ(encodeGyroFrame(frame, buf), GYRO_FRAME_SIZE);
+    GyroFrame decoded;
+    CHECK(decodeGyroFrame(buf, sizeof(buf), decoded));
+    CHECK(sameFrame(frame, decoded));
+
+    // 版本1：前16字节，无发送时刻，时间戳标志被清除
+    buf[1] = GYRO_FRAME_VERSION_V1;
+    CHECK(decodeGyroFrame(buf, GYRO_FRAME_V1_SIZE, decoded));
+    GyroFrame v1 = frame;
+    v1.flags &= (uint8_t)~GYRO_FLAG_TIMESTAMP;
+    v1.timeMs = 0;
+    CHECK(sameFrame(v1, decoded));
+  }
+}
+
+static void testFrameRejects() {
+  GyroFrame frame = makeFrame(GYRO_FRAME_ANGLE, 0, 1, 0, 0, 0, GYRO_PIN_NONE, GYRO_PIN_NONE, GYRO_PIN_NONE, 0);
+  uint8_t buf[GYRO_FRAME_SIZE + 1];
+  encodeGyroFrame(frame, buf);
+  GyroFrame decoded;
+  CHECK(!decodeGyroFrame(nullptr, GYRO_FRAME_SIZE, decoded));
+  CHECK(!decodeGyroFrame(buf, GYRO_FRAME_SIZE - 1, decoded));
+  CHECK(!decodeGyroFrame(buf, GYRO_FRAME_SIZE + 1, decoded));
+  CHECK(!decodeGyroFrame(buf, GYRO_FRAME_V1_SIZE, decoded));   // 版本2却只有16字节
+
+  uint8_t bad[GYRO_FRAME_SIZE];
+  memcpy(bad, buf, sizeof(bad));
+  bad[0] = 'X';
+  CHECK(!decodeGyroFrame(bad, sizeof(bad), decoded));
+  memcpy(bad, buf, sizeof(bad));
+  bad[1] = 3;
+  CHECK(!decodeGyroFrame(bad, sizeof(bad), decoded));
+  memcpy(bad, buf, sizeof(bad));
+  bad[1] = GYRO_FRAME_VERSION_V1;
+  CHECK(!decodeGyroFrame(bad, sizeof(bad), decoded));          // 版本1却有20字节
+  memcpy(bad, buf, sizeof(bad));
+  bad[2] = GYRO_FRAME_IMU;
+  CHECK(!decodeGyroFrame(bad, sizeof(bad), decoded));
+  bad[2] = 0;
+  CHECK(!decodeGyroFrame(bad, sizeof(bad), decoded));
+}
+
+static void testImuBatch() {
+  ImuBatch batch;
+  batch.flags = GYRO_FLAG_HAS_ENABLED | GYRO_FLAG_ENABLED | GYRO_FLAG_TIMESTAMP;
+  batch.seq = 513;
+  batch.count = IMU_BATCH_MAX;
+  batch.intervalUs = 16667;
+  batch.timeMs = 987654321u;
+  for (int n = 0; n < IMU_BATCH_MAX; n++) {
+    for (int i = 0; i < GYRO_FRAME_AXES; i++) {
+      batch.sample[n].gyro[i] = (int16_t)(n * 1000 - i * 7000 - 3);
+      batch.sample[n].accel[i] = (int16_t)(i == 2 ? 9807 - n : -n * 300 + i);
+    }
+  }
+  batch.sample[0].gyro[0] = INT16_MIN;
+  batch.sample[1].accel[1] = INT16_MAX;
+
+  for (int count = 1; count <= IMU_BATCH_MAX; count++) {
+    batch.count = (uint8_t)count;
+    uint8_t buf[IMU_BATCH_MAX_SIZE];
+    size_t length = encodeImuBatch(batch, buf);
+    CHECK_EQ(length, IMU_BATCH_HEADER_SIZE + count * IMU_SAMPLE_SIZE);
+    ImuBatch decoded;
+    CHECK(decodeImuBatch(buf, length, decoded));
+    CHECK_EQ(decoded.flags, batch.flags);
+    CHECK_EQ(decoded.seq, batch.seq);
+    CHECK_EQ(decoded.count, count);
+    CHECK_EQ(decoded.intervalUs, batch.intervalUs);
+    CHECK_EQ(decoded.timeMs, batch.timeMs);
+    CHECK(memcmp(decoded.sample, batch.sample, count * sizeof(ImuSample)) == 0);
+
+    // 长度与样本数不符、样本间隔为0
+    CHECK(!decodeImuBatch(buf, length - 1, decoded));
+    buf[8] = buf[9] = 0;
+    CHECK(!decodeImuBatch(buf, length, decoded));
+    // 姿态帧解码器不接受IMU批量帧
+    GyroFrame frame;
+    CHECK(!decodeGyroFrame(buf, length, frame));
+  }
+  uint8_t buf[IMU_BATCH_MAX_SIZE];
+  batch.count = 1;
+  size_t length = encodeImuBatch(batch, buf);
+  buf[6] = 0;
+  ImuBatch decoded;
+  CHECK(!decodeImuBatch(buf, length, decoded));
+  buf[6] = IMU_BATCH_MAX + 1;
+  CHECK(!decodeImuBatch(buf, length, decoded));
+}
+
+// 按网页的两种发送方式构造同一姿态：JSON文本与二进制帧（编码后再解码）
+static bool textMatchesBinary(int32_t pitch, int32_t roll, int32_t yaw, int enabled, int seq) {
+  char text[128];
+  int n = snprintf(text, sizeof(text), "{\"pitch\":%.2f,\"roll\":%.2f,\"yaw\":%.2f", pitch / 100.0, roll / 100.0,
+                   yaw / 100.0);
+  if (enabled >= 0) n += snprintf(text + n, sizeof(text) - n, ",\"enabled\":%d", enabled);
+  if (seq >= 0) n += snprintf(text + n, sizeof(text) - n, ",\"seq\":%d", seq);
+  n += snprintf(text + n, sizeof(text) - n, "}");
+
+  GyroFrame fromText;
+  if (decodeGyroText((const uint8_t*)text, (size_t)n, fromText) < 0) return false;
+
+  uint8_t flags = enabled >= 0 ? (uint8_t)(GYRO_FLAG_HAS_ENABLED | (enabled == 1 ? GYRO_FLAG_ENABLED : 0)) : 0;
+  GyroFrame sent = makeFrame(GYRO_FRAME_ANGLE, flags, seq >= 0 ? (uint16_t)seq : 0, (int16_t)pitch, (int16_t)roll,
+                             (int16_t)yaw, GYRO_PIN_NONE, GYRO_PIN_NONE, GYRO_PIN_NONE, 0);
+  uint8_t buf[GYRO_FRAME_SIZE];
+  GyroFrame fromBinary;
+  encodeGyroFrame(sent, buf);
+  if (!decodeGyroFrame(buf, sizeof(buf), fromBinary)) return false;
+  return sameFrame(fromText, fromBinary);
+}
+
+static void testTextMatchesBinary() {
+  int mismatches = 0;
+  for (int32_t centi = -18000; centi <= 18000; centi++) {
+    if (!textMatchesBinary(centi, -centi, centi / 2, 1, -1)) mismatches++;
+  }
+  CHECK_EQ(mismatches, 0);
+
+  const int enabledCases[] = { -1, 0, 1 };
+  const int seqCases[] = { -1, 0, 1, 65535 };
+  for (int enabled : enabledCases) {
+    for (int seq : seqCases) {
+      CHECK(textMatchesBinary(1234, -5678, 9000, enabled, seq));
+    }
+  }
+
+  // 字段顺序、空白与数值写法不影响结果；超出int16的角度限幅
+  GyroFrame a;
+  GyroFrame b;
+  const char* compact = "{\"pitch\":12.5,\"roll\":-0.01,\"yaw\":180,\"enabled\":0,\"seq\":7}";
+  const char* spaced = "{ \"seq\" : 7 , \"yaw\" : 1.8e2 , \"enabled\" : 0 , \"roll\" : -1e-2 , \"pitch\" : 12.50 }";
+  CHECK_EQ(decodeGyroText((const uint8_t*)compact, strlen(compact), a), 5);
+  CHECK_EQ(decodeGyroText((const uint8_t*)spaced, strlen(spaced), b), 5);
+  CHECK(sameFrame(a, b));
+  CHECK_EQ(a.value[0], 1250);
+  CHECK_EQ(a.value[1], -1);
+  CHECK_EQ(a.value[2], 18000);
+  CHECK_EQ(a.flags, GYRO_FLAG_HAS_ENABLED);
+
+  const char* large = "{\"pitch\":400,\"roll\":-400,\"yaw\":0}";
+  CHECK(decodeGyroText((const uint8_t*)large, strlen(large), a) >= 0);
+  CHECK_EQ(a.value[0], INT16_MAX);
+  CHECK_EQ(a.value[1], INT16_MIN);
+  CHECK_EQ(a.flags, 0);
+}
+
+int main() {
+  testFrameRoundTrip();
+  testFrameRejects();
+  testImuBatch();
+  testTextMatchesBinary();
+  return hostCheckResult("test_gyro_frame");
+}
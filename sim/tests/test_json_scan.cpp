@@ -0,0 +1,256 @@
+// ===================== 单遍JSON扫描与原有解析对照 =====================
+// 对sim/traces中全部JSON消息和按网页格式生成的消息，分别用原有strstr/extractFloat解析
+// （LegacyJsonParser.h，基线版本摘出）和现在的jsonScanFields/decodeGyroText解析，比较结果：
+// 整数字段逐个相等，角度按0.01°取整后相等，感度倍率相对误差不超过1e-6（float单次舍入）。
+// 原解析只认数字形式的0/1，trace中字面量true/false先改写成1/0再交给它（页面发送的就是0/1）。
+// 消息分类：按顶层键的gyroTextKind与原strstr分类（legacyClassify）在全部消息上一致。
+// 另外检查几处原解析做不到的情况：嵌套对象的同名键不串位、格式错误时返回-1、
+// 字符串值或嵌套对象里的键名不影响分类、超出int范围的整数字段饱和而不是溢出。
+//
+// 用法：test_json_scan [trace目录]（默认 sim/traces，在仓库根目录运行）
+
+#include <dirent.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "GyroText.h"
+#include "HostCheck.h"
+#include "JsonScan.h"
+#include "LegacyJsonParser.h"
+
+// 与src/main.cpp角度固件中CONFIG_FIELDS的对应项相同的键，写入原有解析的配置结构
+#define LEGACY_FIELD(parent, key, type, member) \
+  { parent, jsonKeyHash(key), type, (uint16_t)offsetof(LegacyConfig, member) }
+#define LEGACY_CHANNEL(name) \
+  LEGACY_FIELD(jsonKeyHash(#name), "rate", JSON_FIELD_FLOAT, name.rate), \
+  LEGACY_FIELD(jsonKeyHash(#name), "minPulse", JSON_FIELD_INT, name.minPulse), \
+  LEGACY_FIELD(jsonKeyHash(#name), "maxPulse", JSON_FIELD_INT, name.maxPulse)
+
+static const JsonField CONFIG_FIELDS[] = {
+  LEGACY_FIELD(JSON_ROOT, "controlEnabled", JSON_FIELD_FLAG, controlEnabled),
+  LEGACY_FIELD(JSON_ROOT, "operationLocked", JSON_FIELD_FLAG, operationLocked),
+  LEGACY_CHANNEL(pitch),
+  LEGACY_CHANNEL(roll),
+  LEGACY_CHANNEL(yaw),
+};
+
+static LegacyConfig defaultConfig() {
+  LegacyConfig config = { true, true, { 5.55f, 500, 2500 }, { 5.55f, 500, 2500 }, { 5.55f, 500, 2500 } };
+  return config;
+}
+
+static std::string replaceAll(std::string text, const char* from, const char* to) {
+  size_t n = strlen(from);
+  for (size_t pos = text.find(from); pos != std::string::npos; pos = text.find(from, pos + strlen(to))) {
+    text.replace(pos, n, to);
+  }
+  return text;
+}
+
+static bool closeRelative(float a, float b) {
+  return fabsf(a - b) <= 1e-6f * fmaxf(1.0f, fabsf(b));
+}
+
+static bool sameChannel(const LegacyChannel& a, const LegacyChannel& b) {
+  return closeRelative(a.rate, b.rate) && a.minPulse == b.minPulse && a.maxPulse == b.maxPulse;
+}
+
+static int compared[3];
+
+// gyroTextKind -> legacyClassify的编号（0其他、1配置、2姿态）
+static int rootKeyClassify(const std::string& message) {
+  if (message.empty() || message[0] != '{') return 0;
+  GyroTextMessage text;
+  scanGyroText((const uint8_t*)message.data(), message.size(), text);
+  switch (gyroTextKind(text)) {
+    case GYRO_TEXT_CONFIG: return 1;
+    case GYRO_TEXT_ANGLE: return 2;
+    default: return 0;
+  }
+}
+
+static bool compareMessage(const std::string& message) {
+  int kind = legacyClassify(message);
+  if (rootKeyClassify(message) != kind) return false;
+  const uint8_t* payload = (const uint8_t*)message.data();
+  if (kind == 1) {
+    LegacyConfig legacy = defaultConfig();
+    LegacyConfig scanned = defaultConfig();
+    legacyParseConfigData(replaceAll(replaceAll(message, ":true", ":1"), ":false", ":0"), legacy);
+    if (jsonScanFields(payload, message.size(), CONFIG_FIELDS, sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]),
+                       &scanned) < 0) {
+      return false;
+    }
+    compared[kind]++;
+    return legacy.controlEnabled == scanned.controlEnabled && legacy.operationLocked == scanned.operationLocked &&
+           sameChannel(legacy.pitch, scanned.pitch) && sameChannel(legacy.roll, scanned.roll) &&
+           sameChannel(legacy.yaw, scanned.yaw);
+  }
+  if (kind == 2) {
+    LegacyGyro legacy;
+    GyroFrame frame;
+    legacyParseGyro(message, legacy);
+    if (decodeGyroText(payload, message.size(), frame) < 0) return false;
+    compared[kind]++;
+    int enabled = (frame.flags & GYRO_FLAG_HAS_ENABLED) ? ((frame.flags & GYRO_FLAG_ENABLED) ? 1 : 0) : -1;
+    return degreesToCenti(legacy.pitch) == frame.value[0] && degreesToCenti(legacy.roll) == frame.value[1] &&
+           degreesToCenti(legacy.yaw) == frame.value[2] && legacy.enabled == enabled;
+  }
+  return true;
+}
+
+static std::vector<std::string> loadTraceMessages(const char* dir) {
+  std::vector<std::string> messages;
+  DIR* d = opendir(dir);
+  if (!d) return messages;
+  while (dirent* entry = readdir(d)) {
+    size_t n = strlen(entry->d_name);
+    if (n < 6 || strcmp(entry->d_name + n - 6, ".trace") != 0) continue;
+    std::string path = std::string(dir) + "/" + entry->d_name;
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f) continue;
+    char line[4096];
+    while (fgets(line, sizeof(line), f)) {
+      // <ms> <客户端> text <消息>
+      char* text = strstr(line, " text {");
+      if (line[0] == '#' || !text) continue;
+      std::string message(text + 6);
+      while (!message.empty() && (message.back() == '\n' || message.back() == '\r')) message.pop_back();
+      messages.push_back(message);
+    }
+    fclose(f);
+  }
+  closedir(d);
+  return messages;
+}
+
+// 按网页sendData/sendConfig的格式生成消息（JSON.stringify输出最短可还原的小数）
+static std::vector<std::string> pageMessages() {
+  std::vector<std::string> messages;
+  uint32_t seed = 12345;
+  auto next = [&seed]() {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+  };
+  char text[256];
+  for (int i = 0; i < 20000; i++) {
+    double p = (int)(next() % 3600001 - 1800000) / 10000.0;
+    double r = (int)(next() % 1800001 - 900000) / 10000.0;
+    double y = (int)(next() % 3600001 - 1800000) / 10000.0;
+    snprintf(text, sizeof(text), "{\"pitch\":%.15g,\"roll\":%.15g,\"yaw\":%.15g,\"enabled\":%d}", p, r, y,
+             (int)(next() % 2));
+    messages.push_back(text);
+  }
+  for (int i = 0; i < 2000; i++) {
+    snprintf(text, sizeof(text),
+             "{\"controlEnabled\":%d,\"operationLocked\":%d,\"pitch\":{\"rate\":%.15g,\"minPulse\":%d,\"maxPulse\":%d},"
+             "\"roll\":{\"rate\":%.15g,\"minPulse\":%d,\"maxPulse\":%d},"
+             "\"yaw\":{\"rate\":%.15g,\"minPulse\":%d,\"maxPulse\":%d}}",
+             (int)(next() % 2), (int)(next() % 2), (next() % 2000) / 100.0, 500 + (int)(next() % 500),
+             2000 + (int)(next() % 500), (next() % 2000) / 100.0, 500 + (int)(next() % 500),
+             2000 + (int)(next() % 500), (next() % 2000) / 100.0, 500 + (int)(next() % 500),
+             2000 + (int)(next() % 500));
+    messages.push_back(text);
+  }
+  return messages;
+}
+
+static void testScannerOnly() {
+  // 原解析在pitch对象里找rate时会越界取到roll的rate；扫描按所在对象区分
+  const char* nested = "{\"controlEnabled\":1,\"pitch\":{\"minPulse\":600},\"roll\":{\"rate\":9.5}}";
+  LegacyConfig legacy = defaultConfig();
+  LegacyConfig scanned = defaultConfig();
+  legacyParseConfigData(nested, legacy);
+  CHECK_EQ(jsonScanFields((const uint8_t*)nested, strlen(nested), CONFIG_FIELDS,
+                          sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]), &scanned), 3);
+  CHECK(legacy.pitch.rate == 9.5f);
+  CHECK(scanned.pitch.rate == 5.55f);
+  CHECK(scanned.roll.rate == 9.5f);
+  CHECK_EQ(scanned.pitch.minPulse, 600);
+
+  // 格式错误：返回-1，之前的字段保留
+  const char* broken = "{\"controlEnabled\":0,\"pitch\":{\"rate\":3.0";
+  scanned = defaultConfig();
+  CHECK_EQ(jsonScanFields((const uint8_t*)broken, strlen(broken), CONFIG_FIELDS,
+                          sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]), &scanned), -1);
+  CHECK(!scanned.controlEnabled);
+
+  // 不依赖'\0'结尾：长度之外的内容不参与
+  const char* prefix = "{\"pitch\":1,\"roll\":2,\"yaw\":3}{\"pitch\":9";
+  GyroFrame frame;
+  CHECK_EQ(decodeGyroText((const uint8_t*)prefix, 28, frame), 3);
+  CHECK_EQ(frame.value[0], 100);
+  CHECK_EQ(frame.value[2], 300);
+}
+
+static void testIntegerRange() {
+  // 超出int范围的整数字段饱和到INT_MIN/INT_MAX；指数溢出为inf同样饱和；0e999（NaN）不写入
+  const char* huge = "{\"pitch\":{\"minPulse\":1e20,\"maxPulse\":-1e20},\"roll\":{\"minPulse\":1e999},"
+                     "\"yaw\":{\"minPulse\":0e999,\"maxPulse\":2147483647}}";
+  LegacyConfig scanned = defaultConfig();
+  int yawMin = scanned.yaw.minPulse;
+  CHECK_EQ(jsonScanFields((const uint8_t*)huge, strlen(huge), CONFIG_FIELDS,
+                          sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]), &scanned), 5);
+  CHECK_EQ(scanned.pitch.minPulse, INT_MAX);
+  CHECK_EQ(scanned.pitch.maxPulse, INT_MIN);
+  CHECK_EQ(scanned.roll.minPulse, INT_MAX);
+  CHECK_EQ(scanned.yaw.minPulse, yawMin);
+  CHECK_EQ(scanned.yaw.maxPulse, INT_MAX);
+}
+
+static void testRootKeyClassify() {
+  // 嵌套对象里的enabled不影响配置分类（原strstr会误判为姿态消息）
+  std::string nested = "{\"controlEnabled\":true,\"ui\":{\"enabled\":1},\"pitch\":{\"rate\":2},\"roll\":{},\"yaw\":{}}";
+  CHECK_EQ(legacyClassify(nested), 2);
+  CHECK_EQ(rootKeyClassify(nested), 1);
+  // 字符串值里的键名不算
+  std::string quoted = "{\"note\":\"pitch roll yaw controlEnabled\"}";
+  CHECK_EQ(legacyClassify(quoted), 1);
+  CHECK_EQ(rootKeyClassify(quoted), 0);
+  // 出现标志对任意类型的值都成立，但不计入命中数，取值字段保持缺省
+  std::string anyType = "{\"pitch\":null,\"roll\":\"x\",\"yaw\":[1,2],\"seq\":7}";
+  GyroTextMessage text;
+  CHECK_EQ(scanGyroText((const uint8_t*)anyType.data(), anyType.size(), text), 1);
+  CHECK(text.hasPitch && text.hasRoll && text.hasYaw && !text.hasEnabled && !text.hasControlEnabled);
+  CHECK_EQ(gyroTextKind(text), GYRO_TEXT_ANGLE);
+  CHECK(text.pitch == 0.0f);
+  CHECK_EQ(text.seq, 7);
+  // 姿态消息带enabled时不是配置；缺一个轴不是姿态
+  std::string both = "{\"controlEnabled\":1,\"enabled\":1,\"pitch\":1,\"roll\":2,\"yaw\":3}";
+  CHECK_EQ(rootKeyClassify(both), 2);
+  std::string partial = "{\"pitch\":1,\"roll\":2}";
+  CHECK_EQ(rootKeyClassify(partial), 0);
+}
+
+int main(int argc, char** argv) {
+  const char* dir = argc > 1 ? argv[1] : "sim/traces";
+  std::vector<std::string> traces = loadTraceMessages(dir);
+  CHECK(!traces.empty());
+  int mismatches = 0;
+  for (const std::string& message : traces) {
+    if (!compareMessage(message)) {
+      if (mismatches++ < 5) fprintf(stderr, "不一致: %s\n", message.c_str());
+    }
+  }
+  CHECK_EQ(mismatches, 0);
+  printf("trace消息%zu条（配置%d，姿态%d）\n", traces.size(), compared[1], compared[2]);
+
+  compared[1] = compared[2] = 0;
+  mismatches = 0;
+  for (const std::string& message : pageMessages()) {
+    if (!compareMessage(message)) {
+      if (mismatches++ < 5) fprintf(stderr, "不一致: %s\n", message.c_str());
+    }
+  }
+  CHECK_EQ(mismatches, 0);
+  printf("生成消息：配置%d，姿态%d\n", compared[1], compared[2]);
+
+  testScannerOnly();
+  testIntegerRange();
+  testRootKeyClassify();
+  return hostCheckResult("test_json_scan");
+}
@@ -0,0 +1,177 @@
+// ===================== 舵机运动平滑 =====================
+// - 抖动：静止目标1500us叠加高斯噪声（σ=3us，同 tools/filter_bench.cpp 的默认值），EMA和One Euro
+//   输出相对1500us的RMS与占空比改变次数都低于直通；
+// - 限速：随机阶跃和噪声输入下，每节拍输出变化不超过slewLimit（第一帧直接输出输入值除外）；
+// - 收敛：各模式（含限速）对上下阶跃都在限定节拍内精确到达目标脉宽，之后settled()为true、输出不再变化；
+// - 越界模式按直通处理，reset()后下一帧直接输出输入值。
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+#include "HostCheck.h"
+#include "MotionFilter.h"
+
+const uint32_t PERIOD_US = 20000;  // 50Hz控制环
+
+static uint32_t rngState = 1;
+static double uniform() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return ((rngState >> 8) + 0.5) * (1.0 / 16777216.0);
+}
+static double gaussian() { return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform()); }
+
+static FilterConfig makeConfig(int mode, float alpha, float minCutoff, float beta, int slewLimit) {
+  FilterConfig cfg = defaultFilterConfig();
+  cfg.mode = mode;
+  cfg.alpha = alpha;
+  cfg.minCutoff = minCutoff;
+  cfg.beta = beta;
+  cfg.slewLimit = slewLimit;
+  return cfg;
+}
+
+struct Jitter {
+  double rmsUs;
+  int changes;
+};
+
+static Jitter measureJitter(const FilterConfig& cfg, const std::vector<int>& input) {
+  MotionFilter filter;
+  filter.configure(cfg, PERIOD_US);
+  const size_t warmup = 50;
+  double sum = 0;
+  Jitter j = { 0, 0 };
+  int last = 0;
+  for (size_t i = 0; i < input.size(); i++) {
+    int out = filter.update(input[i]);
+    if (i >= warmup) {
+      sum += (out - 1500.0) * (out - 1500.0);
+      if (out != last) j.changes++;
+    }
+    last = out;
+  }
+  j.rmsUs = sqrt(sum / (input.size() - warmup));
+  return j;
+}
+
+static void testJitter() {
+  std::vector<int> still(50 + 500);
+  for (int& v : still) v = 1500 + (int)lround(gaussian() * 3.0);
+
+  Jitter none = measureJitter(makeConfig(FILTER_NONE, 0.5f, 1.0f, 0.0f, 0), still);
+  Jitter ema = measureJitter(makeConfig(FILTER_EMA, 0.2f, 1.0f, 0.0f, 0), still);
+  Jitter euro = measureJitter(makeConfig(FILTER_ONE_EURO, 0.5f, 1.0f, 0.007f, 0), still);
+  if (!(ema.rmsUs < none.rmsUs && euro.rmsUs < none.rmsUs)) {
+    fprintf(stderr, "抖动RMS：直通%.2f EMA %.2f OneEuro %.2f\n", none.rmsUs, ema.rmsUs, euro.rmsUs);
+  }
+  CHECK(none.rmsUs > 2.0);  // 噪声确实到达了输出
+  CHECK(ema.rmsUs < none.rmsUs);
+  CHECK(euro.rmsUs < none.rmsUs);
+  CHECK(ema.changes < none.changes);
+  CHECK(euro.changes < none.changes);
+}
+
+static void testSlewLimit() {
+  const int limits[] = { 1, 5, 20 };
+  const int modes[] = { FILTER_NONE, FILTER_EMA, FILTER_ONE_EURO };
+  for (int limit : limits) {
+    for (int mode : modes) {
+      MotionFilter filter;
+      filter.configure(makeConfig(mode, 0.5f, 1.0f, 0.01f, limit), PERIOD_US);
+      int last = filter.update(1500);
+      int target = 1500;
+      int maxStep = 0;
+      bool moved = false;
+      for (int tick = 0; tick < 3000; tick++) {
+        if (tick % 40 == 0) target = 500 + (int)(uniform() * 2000);
+        int out = filter.update(target + (int)lround(gaussian() * 3.0));
+        int step = abs(out - last);
+        if (step > maxStep) maxStep = step;
+        moved = moved || out != 1500;
+        last = out;
+      }
+      if (maxStep > limit) fprintf(stderr, "模式%d 限速%dus：最大步长%dus\n", mode, limit, maxStep);
+      CHECK(moved);
+      CHECK(maxStep <= limit);
+      CHECK(limit == 1 || maxStep == limit);  // 大阶跃时确实按限速走满
+    }
+  }
+}
+
+// 从from阶跃到to，返回输出首次等于to的节拍数（maxTicks内未到达返回-1），并检查到达后保持不变
+static int ticksToConverge(const FilterConfig& cfg, int from, int to, int maxTicks) {
+  MotionFilter filter;
+  filter.configure(cfg, PERIOD_US);
+  filter.update(from);
+  for (int i = 0; i < 10; i++) filter.update(from);
+  int reached = -1;
+  uint32_t drift = 0;
+  for (int tick = 1; tick <= maxTicks; tick++) {
+    int out = filter.update(to);
+    if (reached < 0 && out == to) reached = tick;
+    if (reached >= 0 && out != to) drift++;
+  }
+  // 到达后继续运行直到滤波值也不再变化
+  bool settled = false;
+  for (int tick = 0; tick < 2000 && !settled; tick++) {
+    if (filter.update(to) != to) drift++;
+    settled = filter.settled();
+  }
+  CHECK_EQ(drift, 0);
+  CHECK(settled);
+  return reached;
+}
+
+static void testConvergence() {
+  struct Case {
+    FilterConfig cfg;
+    int maxTicks;  // 3s内（150节拍）应到达；限速20us时800us阶跃需40节拍
+  };
+  const Case cases[] = {
+    { makeConfig(FILTER_NONE, 0.5f, 1.0f, 0.0f, 0), 1 },
+    { makeConfig(FILTER_EMA, 0.5f, 1.0f, 0.0f, 0), 150 },
+    { makeConfig(FILTER_EMA, 0.05f, 1.0f, 0.0f, 0), 150 },
+    { makeConfig(FILTER_ONE_EURO, 0.5f, 1.0f, 0.0f, 0), 150 },
+    { makeConfig(FILTER_ONE_EURO, 0.5f, 0.5f, 0.01f, 0), 150 },
+    { makeConfig(FILTER_NONE, 0.5f, 1.0f, 0.0f, 20), 40 },
+    { makeConfig(FILTER_EMA, 0.3f, 1.0f, 0.0f, 20), 150 },
+    { makeConfig(FILTER_ONE_EURO, 0.5f, 1.0f, 0.01f, 20), 150 },
+  };
+  uint32_t failures = 0;
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    int up = ticksToConverge(cases[i].cfg, 1000, 1800, cases[i].maxTicks);
+    int down = ticksToConverge(cases[i].cfg, 1800, 1000, cases[i].maxTicks);
+    if (up < 0 || down < 0) {
+      fprintf(stderr, "第%zu组（模式%d）未收敛：上升%d 下降%d节拍\n", i, cases[i].cfg.mode, up, down);
+      failures++;
+    }
+  }
+  CHECK_EQ(failures, 0);
+}
+
+static void testModeAndReset() {
+  MotionFilter filter;
+  filter.configure(makeConfig(7, 0.1f, 1.0f, 0.0f, 0), PERIOD_US);  // 越界模式
+  filter.update(1000);
+  CHECK_EQ(filter.update(2000), 2000);
+
+  filter.configure(makeConfig(FILTER_EMA, 0.1f, 1.0f, 0.0f, 0), PERIOD_US);
+  filter.update(1000);
+  CHECK(filter.update(2000) < 2000);
+  filter.reset();
+  CHECK(!filter.settled());
+  CHECK_EQ(filter.update(2000), 2000);
+  CHECK_EQ(filter.update(2000), 2000);
+  CHECK(filter.settled());
+}
+
+int main() {
+  testJitter();
+  testSlewLimit();
+  testConvergence();
+  testModeAndReset();
+  return hostCheckResult("test_motion_filter");
+}
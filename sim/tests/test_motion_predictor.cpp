@@ -0,0 +1,262 @@
+// ===================== 网络延迟补偿（外推预测） =====================
+// - 录制日志 sim/traces/v1_predict.trace 按固件时序回放（与 tools/predict_bench.cpp 相同：20ms节拍、
+//   节拍内只取最后到达的一帧、真值为按客户端时刻插值的发送样本）：开启预测的pitch跟踪误差RMS
+//   低于直接使用最近一帧；逐帧输入时日志中的重复帧、乱序帧和200ms卡顿后的积压帧被拒绝；
+// - 序号按int16差值比较：重复和更早的帧拒绝，65535 -> 0 回绕接受，超过半圈视为更早；
+// - 额外延迟超过staleUs的帧判为过期，其序号之前的帧随之过期；
+// - 超过500ms没有帧时重置：之后的帧无条件接受（客户端重连序号从头开始），速度清零；
+// - 外推时长不超过maxHorizonUs，输出 = 最近角度 + 速度 × 上限。
+//
+// 用法：test_motion_predictor [trace目录]（默认 sim/traces，在仓库根目录运行）
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "GyroFrame.h"
+#include "HostCheck.h"
+#include "MotionPredictor.h"
+
+// 与src/main.cpp角度固件的PREDICT_*常量相同
+const uint32_t TEST_BASE_DELAY_US = 5000;
+const uint32_t TEST_MAX_HORIZON_US = 60000;
+const uint32_t TEST_STALE_US = 150000;
+const uint32_t TICK_US = 20000;
+
+struct Sample {
+  uint32_t arrivalUs;
+  uint16_t seq;
+  uint32_t clientMs;
+  int32_t angle[PREDICT_AXES];
+};
+
+static PredictorConfig firmwareConfig() {
+  PredictorConfig cfg = defaultPredictorConfig();
+  cfg.baseDelayUs = TEST_BASE_DELAY_US;
+  cfg.maxHorizonUs = TEST_MAX_HORIZON_US;
+  cfg.staleUs = TEST_STALE_US;
+  return cfg;
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// 读取带时间戳的二进制姿态帧
+static bool loadTrace(const std::string& path, std::vector<Sample>& samples) {
+  FILE* f = fopen(path.c_str(), "r");
+  if (!f) return false;
+  char line[4096];
+  while (fgets(line, sizeof(line), f)) {
+    double timeMs;
+    int client;
+    char kind[16];
+    char hex[1024];
+    if (line[0] == '#' || sscanf(line, "%lf %d %15s %1023s", &timeMs, &client, kind, hex) != 4) continue;
+    if (strcmp(kind, "bin") != 0 && strcmp(kind, "udp") != 0) continue;
+    uint8_t payload[512];
+    size_t n = 0;
+    for (size_t i = 0; hex[i] && hex[i + 1] && n < sizeof(payload); i += 2) {
+      int hi = hexValue(hex[i]);
+      int lo = hexValue(hex[i + 1]);
+      if (hi < 0 || lo < 0) break;
+      payload[n++] = (uint8_t)(hi << 4 | lo);
+    }
+    GyroFrame frame;
+    if (!decodeGyroFrame(payload, n, frame) || frame.kind != GYRO_FRAME_ANGLE) continue;
+    if ((frame.flags & GYRO_FLAG_TIMESTAMP) == 0) continue;
+    Sample s;
+    s.arrivalUs = (uint32_t)llround(timeMs * 1000);
+    s.seq = frame.seq;
+    s.clientMs = frame.timeMs;
+    for (int a = 0; a < PREDICT_AXES; a++) s.angle[a] = frame.value[a];
+    samples.push_back(s);
+  }
+  fclose(f);
+  return true;
+}
+
+// 真值：按客户端时刻排序、去重后的pitch样本，线性插值（0.01°）
+static double truthAt(const std::vector<Sample>& points, double clientUs) {
+  size_t i = 1;
+  while (i + 1 < points.size() && points[i].clientMs * 1000.0 < clientUs) i++;
+  const Sample& a = points[i - 1];
+  const Sample& b = points[i];
+  double span = (b.clientMs - a.clientMs) * 1000.0;
+  double f = span > 0 ? (clientUs - a.clientMs * 1000.0) / span : 0;
+  return a.angle[0] + f * (b.angle[0] - a.angle[0]);
+}
+
+// 回放：返回pitch误差RMS（°）
+static double replayRms(const std::vector<Sample>& samples, bool predict, MotionPredictor& predictor) {
+  std::vector<Sample> points;
+  for (const Sample& s : samples) {
+    bool seen = false;
+    for (const Sample& p : points) seen = seen || p.clientMs == s.clientMs;
+    if (!seen) points.push_back(s);
+  }
+  for (size_t i = 1; i < points.size(); i++) {
+    for (size_t j = i; j > 0 && points[j - 1].clientMs > points[j].clientMs; j--) std::swap(points[j - 1], points[j]);
+  }
+  // 客户端时刻 = 本机时刻 + clockShiftUs（最小时钟差减去假设的最小单向延迟）
+  double minOffsetUs = 1e300;
+  for (const Sample& s : samples) minOffsetUs = fmin(minOffsetUs, (double)s.arrivalUs - s.clientMs * 1000.0);
+  double clockShiftUs = -(minOffsetUs - TEST_BASE_DELAY_US);
+
+  predictor.configure(firmwareConfig());
+  size_t next = 0;
+  bool hasTarget = false;
+  int32_t target[PREDICT_AXES] = { 0, 0, 0 };
+  double sum = 0;
+  uint32_t count = 0;
+  for (uint32_t tick = (samples.front().arrivalUs / TICK_US + 1) * TICK_US; tick <= samples.back().arrivalUs;
+       tick += TICK_US) {
+    const Sample* latest = nullptr;
+    while (next < samples.size() && samples[next].arrivalUs <= tick) latest = &samples[next++];
+    if (latest) {
+      if (!predict) {
+        memcpy(target, latest->angle, sizeof(target));
+        hasTarget = true;
+      } else if (predictor.observe(latest->seq, latest->clientMs, latest->arrivalUs, latest->angle) == PREDICT_ACCEPTED) {
+        predictor.predict(tick + TICK_US, target);
+        hasTarget = true;
+      }
+    }
+    if (!hasTarget) continue;
+    for (uint32_t t = tick; t < tick + TICK_US; t += 1000) {
+      double clientUs = t + clockShiftUs;
+      if (clientUs < points.front().clientMs * 1000.0 || clientUs > points.back().clientMs * 1000.0) continue;
+      double error = (target[0] - truthAt(points, clientUs)) / 100.0;
+      sum += error * error;
+      count++;
+    }
+  }
+  return count ? sqrt(sum / count) : 0;
+}
+
+static void testTrace(const char* dir) {
+  std::vector<Sample> samples;
+  CHECK(loadTrace(std::string(dir) + "/v1_predict.trace", samples));
+  CHECK(samples.size() > 100);
+  if (samples.size() < 2) return;
+  MotionPredictor predictor;
+  double holdRms = replayRms(samples, false, predictor);
+  double predictRms = replayRms(samples, true, predictor);
+  printf("v1_predict.trace: 直接RMS %.2f°，预测RMS %.2f°\n", holdRms, predictRms);
+  CHECK(predictRms > 0);
+  CHECK(predictRms < holdRms);
+
+  // 逐帧输入（不经节拍合并）：日志中的一帧重复和一帧乱序按序号拒绝，卡顿后积压的4帧判为过期
+  MotionPredictor framewise(firmwareConfig());
+  for (const Sample& s : samples) framewise.observe(s.seq, s.clientMs, s.arrivalUs, s.angle);
+  CHECK_EQ(framewise.outOfOrder(), 2);
+  CHECK_EQ(framewise.stale(), 4);
+  CHECK_EQ(framewise.accepted() + 6, samples.size());
+}
+
+static void testSequenceOrder() {
+  const int32_t angle[PREDICT_AXES] = { 100, 200, 300 };
+  MotionPredictor predictor(firmwareConfig());
+  uint32_t arrivalUs = 1000000;
+  uint32_t clientMs = 50000;
+  CHECK_EQ(predictor.observe(65534, clientMs, arrivalUs, angle), PREDICT_ACCEPTED);
+  CHECK_EQ(predictor.observe(65534, clientMs += 20, arrivalUs += 20000, angle), PREDICT_OUT_OF_ORDER);
+  CHECK_EQ(predictor.observe(65533, clientMs += 20, arrivalUs += 20000, angle), PREDICT_OUT_OF_ORDER);
+  CHECK_EQ(predictor.observe(65535, clientMs += 20, arrivalUs += 20000, angle), PREDICT_ACCEPTED);
+  CHECK_EQ(predictor.observe(0, clientMs += 20, arrivalUs += 20000, angle), PREDICT_ACCEPTED);
+  CHECK_EQ(predictor.observe(1, clientMs += 20, arrivalUs += 20000, angle), PREDICT_ACCEPTED);
+  // 回绕之前的序号仍是更早的帧
+  CHECK_EQ(predictor.observe(65535, clientMs += 20, arrivalUs += 20000, angle), PREDICT_OUT_OF_ORDER);
+  // 向前不足半圈接受，超过半圈视为更早
+  CHECK_EQ(predictor.observe(1 + 32767, clientMs += 20, arrivalUs += 20000, angle), PREDICT_ACCEPTED);
+  CHECK_EQ(predictor.observe((uint16_t)(1 + 32767 + 32768), clientMs += 20, arrivalUs += 20000, angle),
+           PREDICT_OUT_OF_ORDER);
+  CHECK_EQ(predictor.accepted(), 5);
+  CHECK_EQ(predictor.outOfOrder(), 4);
+
+  // 过期：额外延迟超过staleUs；过期帧的序号同样推进
+  uint16_t seq = 40000;
+  CHECK_EQ(predictor.observe(seq, clientMs += 20, arrivalUs += 20000, angle), PREDICT_ACCEPTED);
+  CHECK_EQ(predictor.observe(seq + 1, clientMs += 20, arrivalUs += 20000 + TEST_STALE_US + 1000, angle),
+           PREDICT_STALE);
+  CHECK_EQ(predictor.observe(seq + 1, clientMs, arrivalUs + 1000, angle), PREDICT_OUT_OF_ORDER);
+  CHECK_EQ(predictor.stale(), 1);
+  // 积压清空后（到达时刻追上客户端时刻）恢复接受
+  CHECK_EQ(predictor.observe(seq + 2, clientMs += TEST_STALE_US / 1000 + 40, arrivalUs += 60000, angle),
+           PREDICT_ACCEPTED);
+}
+
+static void testIdleReset() {
+  PredictorConfig cfg = firmwareConfig();
+  MotionPredictor predictor(cfg);
+  int32_t angle[PREDICT_AXES] = { 0, 0, 0 };
+  uint32_t arrivalUs = 5000000;
+  uint32_t clientMs = 1000;
+  for (uint16_t seq = 100; seq < 110; seq++) {
+    angle[0] += 200;  // 10°/s
+    CHECK_EQ(predictor.observe(seq, clientMs += 20, arrivalUs += 20000, angle), PREDICT_ACCEPTED);
+  }
+  CHECK(predictor.velocity(0) > 0);
+
+  // 恰好idleResetUs不重置：旧序号仍被拒绝
+  CHECK_EQ(predictor.observe(5, clientMs + cfg.idleResetUs / 1000, arrivalUs + cfg.idleResetUs, angle),
+           PREDICT_OUT_OF_ORDER);
+  // 超过后重置：序号从头开始的帧接受，速度清零
+  arrivalUs += cfg.idleResetUs + 1;
+  angle[0] = -500;
+  CHECK_EQ(predictor.observe(5, 1, arrivalUs, angle), PREDICT_ACCEPTED);
+  CHECK_EQ(predictor.velocity(0), 0);
+  int32_t out[PREDICT_AXES];
+  CHECK(predictor.predict(arrivalUs + 40000, out));
+  CHECK_EQ(out[0], -500);
+}
+
+static void testHorizonCap() {
+  MotionPredictor predictor(firmwareConfig());
+  int32_t out[PREDICT_AXES];
+  CHECK(!predictor.predict(0, out));
+
+  // pitch 100°/s、roll -50°/s，速度平滑收敛后外推
+  int32_t angle[PREDICT_AXES] = { 0, 0, 1000 };
+  uint32_t arrivalUs = 0;
+  uint32_t clientMs = 0;
+  for (uint16_t seq = 1; seq <= 40; seq++) {
+    angle[0] += 200;
+    angle[1] -= 100;
+    predictor.observe(seq, clientMs += 20, arrivalUs += 20000, angle);
+  }
+  CHECK(abs(predictor.velocity(0) - 10000) <= 1);
+  CHECK(abs(predictor.velocity(1) + 5000) <= 1);
+  CHECK_EQ(predictor.velocity(2), 0);
+
+  // 到达后立即外推：时长 = 估计延迟（无额外延迟时为baseDelayUs）
+  CHECK_EQ(predictor.horizonUs(arrivalUs), TEST_BASE_DELAY_US);
+  // 早于到达时刻按0计
+  CHECK_EQ(predictor.horizonUs(arrivalUs - 10000), TEST_BASE_DELAY_US);
+  // 任意更晚的时刻都不超过上限
+  uint32_t overCap = 0;
+  for (uint32_t later = 0; later <= 2000000; later += 5000) {
+    if (predictor.horizonUs(arrivalUs + later) > TEST_MAX_HORIZON_US) overCap++;
+  }
+  CHECK_EQ(overCap, 0);
+  CHECK_EQ(predictor.horizonUs(arrivalUs + 1000000), TEST_MAX_HORIZON_US);
+  CHECK(predictor.predict(arrivalUs + 1000000, out));
+  CHECK_EQ(out[0], angle[0] + (int64_t)predictor.velocity(0) * TEST_MAX_HORIZON_US / 1000000);
+  CHECK_EQ(out[1], angle[1] + (int64_t)predictor.velocity(1) * TEST_MAX_HORIZON_US / 1000000);
+  CHECK(out[0] - angle[0] >= 599 && out[0] - angle[0] <= 600);
+  CHECK_EQ(out[2], 1000);
+}
+
+int main(int argc, char** argv) {
+  testTrace(argc > 1 ? argv[1] : "sim/traces");
+  testSequenceOrder();
+  testIdleReset();
+  testHorizonCap();
+  return hostCheckResult("test_motion_predictor");
+}
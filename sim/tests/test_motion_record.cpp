@@ -0,0 +1,177 @@
+// ===================== 动作录制格式往返 =====================
+// MotionRecorder编码 -> serialize()串接 -> MotionPlayer解码，逐样本比较通道数、脉宽和时刻：
+// - 随机脉宽流（大跳变、静止通道、时间间隔从0ms到数小时、通道数中途变化）完整还原；
+// - 环形缓冲写满后丢弃最旧的块，回放结果恰为录制的后缀，从第一个保留块的关键帧开始；
+// - 串接数据被截断时回放在截断处结束，之前的样本照常还原；
+// - 变长整数与zigzag在边界值上往返一致。
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "HostCheck.h"
+#include "MotionRecord.h"
+
+struct RecordedSample {
+  uint32_t timeMs;   // 相对录制开始
+  int count;
+  int pulse[MAX_SERVO_CHANNELS];
+};
+
+// xorshift32：确定性，便于复现
+static uint32_t rngState = 1;
+static uint32_t nextRandom() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+static std::vector<RecordedSample> makeStream(int n) {
+  std::vector<RecordedSample> stream;
+  RecordedSample s;
+  s.timeMs = 0;
+  s.count = 3;
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) s.pulse[i] = 1500;
+  for (int k = 0; k < n; k++) {
+    uint32_t r = nextRandom();
+    if (k > 0) {
+      // 多数为一个节拍，偶尔为0、长停顿或数小时
+      uint32_t gap = 20;
+      if ((r & 0xF) == 0) gap = 0;
+      else if ((r & 0xFF) == 1) gap = 5000 + (r >> 20);
+      else if (k == n / 2) gap = 3 * 3600 * 1000;
+      s.timeMs += gap;
+    }
+    if ((r >> 8 & 0x3F) == 0) s.count = 1 + (int)(nextRandom() % MAX_SERVO_CHANNELS);
+    for (int i = 0; i < s.count; i++) {
+      uint32_t c = nextRandom();
+      if ((c & 3) == 0) continue;                                   // 静止通道
+      if ((c & 0x30) == 0) s.pulse[i] = (int)(c >> 16) % 20001;    // 任意跳变（0~20000us）
+      else s.pulse[i] += (int)((c >> 16) % 41) - 20;               // 小幅变化
+      if (s.pulse[i] < 0) s.pulse[i] = 0;
+      if (s.pulse[i] > 20000) s.pulse[i] = 20000;
+    }
+    stream.push_back(s);
+  }
+  return stream;
+}
+
+static int playerUnfinished = 0;
+
+// 回放：每个录制时刻推进一次，返回解码出的样本
+static std::vector<RecordedSample> play(const uint8_t* data, size_t length, const std::vector<RecordedSample>& input) {
+  MotionPlayer player;
+  player.begin(data, length);
+  std::vector<RecordedSample> output;
+  for (const RecordedSample& in : input) {
+    RecordedSample out;
+    out.timeMs = in.timeMs;
+    out.count = 0;
+    if (player.advance(in.timeMs, out.count, out.pulse)) output.push_back(out);
+  }
+  if (!player.finished()) playerUnfinished++;
+  return output;
+}
+
+static bool sameSample(const RecordedSample& a, const RecordedSample& b) {
+  if (a.timeMs != b.timeMs || a.count != b.count) return false;
+  for (int i = 0; i < a.count; i++) {
+    if (a.pulse[i] != b.pulse[i]) return false;
+  }
+  return true;
+}
+
+// 录制时刻严格递增时每次推进恰好输出一个样本；同一时刻的多个样本只输出最后一个
+static std::vector<RecordedSample> expectedPlayback(const std::vector<RecordedSample>& input) {
+  std::vector<RecordedSample> expected;
+  for (size_t i = 0; i < input.size(); i++) {
+    if (i + 1 < input.size() && input[i + 1].timeMs == input[i].timeMs) continue;
+    expected.push_back(input[i]);
+  }
+  return expected;
+}
+
+static void testRoundTrip() {
+  static MotionRecorder<128, 1024> recorder;
+  static uint8_t blob[MotionRecorder<128, 1024>::SERIALIZED_CAPACITY];
+  std::vector<RecordedSample> input = makeStream(3000);
+  recorder.start(123456);
+  for (const RecordedSample& s : input) CHECK(recorder.record(123456 + s.timeMs, s.count, s.pulse));
+  recorder.stop();
+  CHECK(!recorder.record(0, 1, input[0].pulse));
+  CHECK_EQ(recorder.droppedBlocks(), 0);
+  CHECK_EQ(recorder.samples(), input.size());
+  CHECK_EQ(recorder.durationMs(), input.back().timeMs);
+
+  size_t length = recorder.serialize(blob, sizeof(blob));
+  CHECK(length > 0);
+  CHECK_EQ(recorder.serialize(blob, length - 1), 0);   // 空间不足时不写半截
+  length = recorder.serialize(blob, sizeof(blob));
+
+  std::vector<RecordedSample> expected = expectedPlayback(input);
+  std::vector<RecordedSample> output = play(blob, length, input);
+  CHECK_EQ(output.size(), expected.size());
+  size_t mismatches = 0;
+  for (size_t i = 0; i < output.size() && i < expected.size(); i++) {
+    if (!sameSample(output[i], expected[i])) mismatches++;
+  }
+  CHECK_EQ(mismatches, 0);
+
+  // 截断：在各个长度上解码都不越界，输出为完整回放的前缀
+  size_t notPrefix = 0;
+  for (size_t cut = 0; cut < length; cut += 7) {
+    std::vector<uint8_t> copy(blob, blob + cut);
+    std::vector<RecordedSample> partial = play(copy.data(), copy.size(), input);
+    bool prefix = partial.size() <= expected.size();
+    for (size_t i = 0; prefix && i < partial.size(); i++) prefix = sameSample(partial[i], expected[i]);
+    if (!prefix) notPrefix++;
+  }
+  CHECK_EQ(notPrefix, 0);
+}
+
+static void testOverflow() {
+  static MotionRecorder<4, 128> recorder;
+  static uint8_t blob[MotionRecorder<4, 128>::SERIALIZED_CAPACITY];
+  std::vector<RecordedSample> input = makeStream(2000);
+  recorder.start(0);
+  for (const RecordedSample& s : input) recorder.record(s.timeMs, s.count, s.pulse);
+  recorder.stop();
+  CHECK(recorder.droppedBlocks() > 0);
+
+  size_t length = recorder.serialize(blob, sizeof(blob));
+  std::vector<RecordedSample> expected = expectedPlayback(input);
+  std::vector<RecordedSample> output = play(blob, length, input);
+  CHECK(!output.empty());
+  CHECK(output.size() < expected.size());
+  // 回放是录制的后缀
+  size_t offset = expected.size() - output.size();
+  size_t mismatches = 0;
+  for (size_t i = 0; i < output.size(); i++) {
+    if (!sameSample(output[i], expected[offset + i])) mismatches++;
+  }
+  CHECK_EQ(mismatches, 0);
+}
+
+static void testVarint() {
+  const uint32_t values[] = { 0, 1, 127, 128, 16383, 16384, 0x1FFFFF, 0x200000, 0x0FFFFFFF, 0x10000000, 0xFFFFFFFF };
+  for (uint32_t v : values) {
+    uint8_t buf[5];
+    size_t n = motionPutVarint(buf, v);
+    uint32_t back = 0;
+    CHECK_EQ(motionGetVarint(buf, n, back), n);
+    CHECK_EQ(back, v);
+    CHECK_EQ(motionGetVarint(buf, n - 1, back), 0);   // 不完整
+  }
+  const int32_t deltas[] = { 0, 1, -1, 63, -64, 64, 20000, -20000, INT32_MAX, INT32_MIN };
+  for (int32_t d : deltas) CHECK_EQ(motionUnzigzag(motionZigzag(d)), d);
+  CHECK_EQ(motionZigzag(-1), 1);
+  CHECK_EQ(motionZigzag(1), 2);
+}
+
+int main() {
+  testRoundTrip();
+  testOverflow();
+  testVarint();
+  CHECK_EQ(playerUnfinished, 0);
+  return hostCheckResult("test_motion_record");
+}
@@ -0,0 +1,287 @@
+// ===================== 姿态融合（定点Mahony四元数滤波） =====================
+// - 定点与双精度：同一组带零偏、噪声和量化的陀螺/加速度样本（60Hz，偏航整圈、俯仰到竖直、三轴摆动），
+//   定点QuaternionFilter与同算法同参数的双精度Mahony（tools/fusion_bench.cpp中的参照实现）
+//   每个样本的姿态相差不超过0.25°（当前约0.08°）；
+// - 穿过±90°俯仰：绕机体x轴从-150°匀速转到+150°再转回，relativeEulerCenti()的俯仰连续变化
+//   （相邻帧不超过3°，90°/s下每帧1.5°），与真实俯仰相差不超过2°；横滚/偏航三轴都没有帧间跳变，
+//   保持在5°以内（加速度计看不到的偏航零偏在转动中积累约2°），锁点附近不因微小误差大幅摆动；
+// - 加速度模长超出范围的样本不做重力修正（计数），第一个有效样本之前不初始化。
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "HostCheck.h"
+#include "QuaternionFilter.h"
+
+const double DEG = M_PI / 180.0;
+const double GRAVITY = 9.80665;
+const double RATE_HZ = 60;
+const double BIAS_DPS[3] = { 0.5, -0.3, 0.8 };
+
+static uint32_t rngState = 5;
+static double uniform() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return ((rngState >> 8) + 0.5) * (1.0 / 16777216.0);
+}
+static double gaussian() { return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform()); }
+
+struct Quat {
+  double w = 1, x = 0, y = 0, z = 0;
+};
+
+static Quat multiply(const Quat& a, const Quat& b) {
+  Quat r;
+  r.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+  r.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+  r.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+  r.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+  return r;
+}
+
+static Quat axisAngle(double ax, double ay, double az, double angle) {
+  Quat q;
+  q.w = cos(angle / 2);
+  q.x = ax * sin(angle / 2);
+  q.y = ay * sin(angle / 2);
+  q.z = az * sin(angle / 2);
+  return q;
+}
+
+static Quat fromQ30(const QuatQ30& q) {
+  const double s = 1.0 / FUSION_ONE_Q30;
+  Quat r;
+  r.w = q.w * s;
+  r.x = q.x * s;
+  r.y = q.y * s;
+  r.z = q.z * s;
+  return r;
+}
+
+static double angleBetween(const Quat& a, const Quat& b) {
+  double dot = fabs(a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z);
+  return 2.0 * acos(dot > 1.0 ? 1.0 : dot) / DEG;
+}
+
+static void gravityInBody(const Quat& q, double* v) {
+  v[0] = 2 * (q.x * q.z - q.w * q.y);
+  v[1] = 2 * (q.w * q.x + q.y * q.z);
+  v[2] = q.w * q.w - q.x * q.x - q.y * q.y + q.z * q.z;
+}
+
+// 双精度Mahony：与定点版同一算法和参数
+class ReferenceMahony {
+ public:
+  explicit ReferenceMahony(const FusionConfig& cfg) : cfg_(cfg) {}
+
+  void update(const double* gyroRad, const double* accel, double dt) {
+    double norm = sqrt(accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2]);
+    bool valid = norm >= cfg_.minAccelMm / 1000.0 && norm <= cfg_.maxAccelMm / 1000.0;
+    double a[3] = { accel[0] / norm, accel[1] / norm, accel[2] / norm };
+    if (!initialized_) {
+      if (!valid) return;
+      double pitch = atan2(a[1], sqrt(a[0] * a[0] + a[2] * a[2]));
+      double roll = atan2(-a[0], a[2]);
+      q_ = multiply(axisAngle(1, 0, 0, pitch), axisAngle(0, 1, 0, roll));
+      initialized_ = true;
+      return;
+    }
+    double rate[3];
+    bool still = true;
+    for (int i = 0; i < 3; i++) {
+      rate[i] = gyroRad[i];
+      if (fabs(rate[i] - bias_[i]) > cfg_.stillRateDecideg * 0.1 * DEG) still = false;
+    }
+    if (still && valid) {
+      if (stillCount_ < cfg_.stillSamples) stillCount_++;
+      else {
+        for (int i = 0; i < 3; i++) bias_[i] += (rate[i] - bias_[i]) / (1 << cfg_.biasShift);
+      }
+    } else {
+      stillCount_ = 0;
+    }
+    for (int i = 0; i < 3; i++) rate[i] -= bias_[i];
+    if (valid) {
+      double v[3];
+      gravityInBody(q_, v);
+      double e[3] = { a[1] * v[2] - a[2] * v[1], a[2] * v[0] - a[0] * v[2], a[0] * v[1] - a[1] * v[0] };
+      double limit = cfg_.integralLimitQ24 / 16777216.0;
+      for (int i = 0; i < 3; i++) {
+        integral_[i] += cfg_.kiQ16 / 65536.0 * e[i] * dt;
+        integral_[i] = integral_[i] > limit ? limit : (integral_[i] < -limit ? -limit : integral_[i]);
+        rate[i] += cfg_.kpQ16 / 65536.0 * e[i] + integral_[i];
+      }
+    }
+    Quat h;
+    h.w = 0;
+    h.x = rate[0] * dt / 2;
+    h.y = rate[1] * dt / 2;
+    h.z = rate[2] * dt / 2;
+    Quat d = multiply(q_, h);
+    q_.w += d.w;
+    q_.x += d.x;
+    q_.y += d.y;
+    q_.z += d.z;
+    double n = sqrt(q_.w * q_.w + q_.x * q_.x + q_.y * q_.y + q_.z * q_.z);
+    q_.w /= n;
+    q_.x /= n;
+    q_.y /= n;
+    q_.z /= n;
+  }
+
+  const Quat& quaternion() const { return q_; }
+
+ private:
+  FusionConfig cfg_;
+  Quat q_;
+  double integral_[3] = { 0, 0, 0 };
+  double bias_[3] = { 0, 0, 0 };
+  uint16_t stillCount_ = 0;
+  bool initialized_ = false;
+};
+
+static int16_t clamp16(long v) { return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v)); }
+
+// 真实姿态与机体角速度 -> 量化样本（0.1°/s、mm/s²），带零偏和噪声
+static void sample(const Quat& truth, const double* rateRad, int16_t* gyro, int16_t* accel) {
+  double up[3];
+  gravityInBody(truth, up);
+  for (int i = 0; i < 3; i++) {
+    gyro[i] = clamp16(lround((rateRad[i] / DEG + BIAS_DPS[i] + 0.1 * gaussian()) * 10.0));
+    accel[i] = clamp16(lround((up[i] * GRAVITY + 0.05 * gaussian()) * 1000.0));
+  }
+}
+
+// 机体角速度剖面（rad/s）
+static void motionProfile(double t, double* rate) {
+  rate[0] = rate[1] = rate[2] = 0;
+  if (t >= 2 && t < 6) rate[2] = 90 * DEG;            // 偏航整圈
+  else if (t >= 8 && t < 9) rate[0] = 90 * DEG;       // 俯仰到竖直
+  else if (t >= 10 && t < 11) rate[2] = 90 * DEG;     // 竖直姿态下绕机体z转动
+  else if (t >= 11 && t < 12) rate[0] = -90 * DEG;
+  else if (t >= 12 && t < 20) {
+    rate[0] = 40 * DEG * 2 * M_PI * 0.3 * cos(2 * M_PI * 0.3 * (t - 12));
+    rate[1] = 30 * DEG * 2 * M_PI * 0.5 * cos(2 * M_PI * 0.5 * (t - 12));
+    rate[2] = 50 * DEG * 2 * M_PI * 0.2 * cos(2 * M_PI * 0.2 * (t - 12));
+  }
+}
+
+static Quat advance(Quat q, double t, double dt) {
+  const int steps = 8;
+  for (int k = 0; k < steps; k++) {
+    double rate[3];
+    motionProfile(t + (k + 0.5) * dt / steps, rate);
+    double mag = sqrt(rate[0] * rate[0] + rate[1] * rate[1] + rate[2] * rate[2]);
+    if (mag > 0) q = multiply(q, axisAngle(rate[0] / mag, rate[1] / mag, rate[2] / mag, mag * dt / steps));
+  }
+  return q;
+}
+
+static void testAgainstDouble() {
+  QuaternionFilter fused;
+  ReferenceMahony reference(defaultFusionConfig());
+  const double dt = 1.0 / RATE_HZ;
+  const uint32_t dtUs = (uint32_t)lround(dt * 1e6);
+  Quat truth;
+  double maxDiff = 0;
+  uint32_t compared = 0;
+  for (double t = 0; t < 30; t += dt) {
+    double rate[3];
+    motionProfile(t, rate);
+    int16_t gyro[3], accel[3];
+    sample(truth, rate, gyro, accel);
+    fused.update(gyro, accel, dtUs);
+    double gyroRad[3], accelMs[3];
+    for (int i = 0; i < 3; i++) {
+      gyroRad[i] = gyro[i] * 0.1 * DEG;
+      accelMs[i] = accel[i] / 1000.0;
+    }
+    reference.update(gyroRad, accelMs, dt);
+    truth = advance(truth, t, dt);
+    if (!fused.initialized()) continue;
+    maxDiff = fmax(maxDiff, angleBetween(fromQ30(fused.quaternion()), reference.quaternion()));
+    compared++;
+  }
+  if (maxDiff > 0.25) fprintf(stderr, "定点与双精度最大相差%.3f°\n", maxDiff);
+  CHECK(compared > 1700);
+  CHECK(maxDiff <= 0.25);
+  CHECK_EQ(fused.accelRejected(), 0);
+}
+
+// 绕机体x轴匀速转动：俯仰从-150°到+150°再回到-150°，两次穿过±90°
+static void testPitchThroughVertical() {
+  QuaternionFilter fused;
+  const double dt = 1.0 / RATE_HZ;
+  const uint32_t dtUs = (uint32_t)lround(dt * 1e6);
+  const double speed = 90 * DEG;
+  // 从水平静止开始（参考姿态即水平），先以-90°/s转到-150°
+  double pitch = 0;
+  double maxStep = 0, maxError = 0, maxOffAxis = 0;
+  int32_t last[3] = { 0, 0, 0 };
+  bool primed = false;
+  uint32_t frames = 0;
+  int phase = 0;  // 0：转到-150°；1：转到+150°；2：转回-150°
+  for (int n = 0; n < 60 * 20 && phase < 3; n++) {
+    double direction = phase == 1 ? 1.0 : -1.0;
+    double rate[3] = { n < 60 ? 0.0 : direction * speed, 0.0, 0.0 };  // 前1秒静止，便于初始化
+    Quat truth = axisAngle(1, 0, 0, pitch);
+    int16_t gyro[3], accel[3];
+    sample(truth, rate, gyro, accel);
+    fused.update(gyro, accel, dtUs);
+    pitch += rate[0] * dt;
+    if (phase == 0 && pitch <= -150 * DEG) phase = 1;
+    else if (phase == 1 && pitch >= 150 * DEG) phase = 2;
+    else if (phase == 2 && pitch <= -150 * DEG) phase = 3;
+    if (n < 60) continue;
+
+    int32_t centi[3];
+    fused.relativeEulerCenti(centi);
+    if (primed) {
+      double step = 0;
+      for (int i = 0; i < 3; i++) step = fmax(step, fabs((centi[i] - last[i]) / 100.0));
+      maxStep = fmax(maxStep, step);
+    }
+    maxError = fmax(maxError, fabs(centi[0] / 100.0 - pitch / DEG));
+    maxOffAxis = fmax(maxOffAxis, fmax(fabs(centi[1] / 100.0), fabs(centi[2] / 100.0)));
+    for (int i = 0; i < 3; i++) last[i] = centi[i];
+    primed = true;
+    frames++;
+  }
+  if (maxStep > 3.0 || maxError > 2.0 || maxOffAxis > 5.0) {
+    fprintf(stderr, "穿过±90°：最大帧间变化%.2f° 俯仰误差%.2f° 横滚/偏航%.2f°\n", maxStep, maxError, maxOffAxis);
+  }
+  CHECK_EQ(phase, 3);
+  CHECK(frames > 400);
+  CHECK(maxStep <= 3.0);
+  CHECK(maxError <= 2.0);
+  CHECK(maxOffAxis <= 5.0);
+}
+
+static void testAccelGate() {
+  QuaternionFilter fused;
+  const int16_t gyro[3] = { 0, 0, 0 };
+  const int16_t freefall[3] = { 0, 0, 500 };
+  const int16_t level[3] = { 0, 0, 9807 };
+  fused.update(gyro, freefall, 16667);
+  CHECK(!fused.initialized());
+  fused.update(gyro, level, 16667);
+  CHECK(fused.initialized());
+  CHECK_EQ(fused.samples(), 0);
+  fused.update(gyro, freefall, 16667);
+  const int16_t shaken[3] = { 20000, 0, 9807 };
+  fused.update(gyro, shaken, 16667);
+  fused.update(gyro, level, 16667);
+  CHECK_EQ(fused.samples(), 3);
+  CHECK_EQ(fused.accelRejected(), 2);
+  int32_t centi[3];
+  fused.relativeEulerCenti(centi);
+  CHECK(abs(centi[0]) <= 1 && abs(centi[1]) <= 1 && abs(centi[2]) <= 1);
+}
+
+int main() {
+  testAgainstDouble();
+  testPitchThroughVertical();
+  testAccelGate();
+  return hostCheckResult("test_quaternion_filter");
+}
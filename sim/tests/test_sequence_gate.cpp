@@ -0,0 +1,136 @@
+// ===================== UDP控制通道：序号闸门 =====================
+// - 注入模式：一个发送端的序号从65000开始（中途跨过65535 -> 0），按随机位置丢包、推迟若干帧到达（乱序）、
+//   重复投递；闸门的计数与注入一致：接受 = 发送 - 丢失 - 推迟，gaps = 丢失 + 推迟（推迟的帧被跳过时先计为缺口），
+//   late = 推迟 + 重复（推迟的帧到达时已有更大的序号被接受）；被接受的序号严格递增（按int16差值）；
+// - 回绕与半圈：65535 -> 0 接受，向前32767接受，向前32768视为迟到；
+// - 发送端切换：当前发送端活跃时其他IP或端口的帧为foreign，静默idleMs后新发送端的第一帧无条件接受；
+//   同一发送端静默后序号从头开始同样接受，且不计缺口。
+
+#include <stdint.h>
+#include <vector>
+#include "HostCheck.h"
+#include "SequenceGate.h"
+
+const uint32_t IDLE_MS = 500;
+const uint32_t SOURCE_IP = 0xC0A80402;  // 192.168.4.2
+const uint16_t SOURCE_PORT = 50000;
+
+static uint32_t rngState = 11;
+static uint32_t nextRandom() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+static void testInjectedPattern() {
+  const int SENT = 4000;
+  const uint16_t FIRST_SEQ = 65000;
+  enum Fate { DELIVERED, LOST, DELAYED };
+  std::vector<Fate> fate(SENT, DELIVERED);
+  // 首帧建立发送端，末尾留几帧正常到达，使末尾的丢失也能计入缺口；推迟的帧之后3帧内不再注入
+  for (int i = 1; i < SENT - 8; i++) {
+    if (fate[i - 1] == DELAYED || (i >= 2 && fate[i - 2] == DELAYED) || (i >= 3 && fate[i - 3] == DELAYED)) continue;
+    uint32_t r = nextRandom() % 100;
+    if (r < 5) fate[i] = LOST;
+    else if (r < 8) fate[i] = DELAYED;
+  }
+
+  // 到达顺序：推迟的帧排在其后1~3个帧之后，部分正常帧紧接着重复一次
+  std::vector<uint16_t> arrivals;
+  std::vector<std::pair<int, uint16_t> > pending;  // (还需等待的帧数, 序号)
+  int lost = 0, delayed = 0, duplicated = 0;
+  for (int i = 0; i < SENT; i++) {
+    uint16_t seq = (uint16_t)(FIRST_SEQ + i);
+    if (fate[i] == LOST) {
+      lost++;
+      continue;
+    }
+    if (fate[i] == DELAYED) {
+      delayed++;
+      pending.push_back(std::make_pair(1 + (int)(nextRandom() % 3), seq));
+      continue;
+    }
+    arrivals.push_back(seq);
+    if (i > 0 && nextRandom() % 50 == 0) {
+      arrivals.push_back(seq);
+      duplicated++;
+    }
+    for (size_t k = 0; k < pending.size();) {
+      if (--pending[k].first == 0) {
+        arrivals.push_back(pending[k].second);
+        pending.erase(pending.begin() + k);
+      } else {
+        k++;
+      }
+    }
+  }
+  CHECK(pending.empty());
+  CHECK(lost > 50 && delayed > 50 && duplicated > 20);
+
+  SequenceGate gate(IDLE_MS);
+  uint32_t nowMs = 1000;
+  uint16_t lastAccepted = 0;
+  uint32_t notIncreasing = 0;
+  bool first = true;
+  for (uint16_t seq : arrivals) {
+    nowMs += 10;
+    if (gate.admit(SOURCE_IP, SOURCE_PORT, seq, nowMs) != UDP_ACCEPTED) continue;
+    if (!first && (int16_t)(seq - lastAccepted) <= 0) notIncreasing++;
+    lastAccepted = seq;
+    first = false;
+  }
+  CHECK_EQ(notIncreasing, 0);
+  CHECK_EQ(lastAccepted, (uint16_t)(FIRST_SEQ + SENT - 1));
+  CHECK_EQ(gate.accepted(), SENT - lost - delayed);
+  CHECK_EQ(gate.gaps(), lost + delayed);
+  CHECK_EQ(gate.late(), delayed + duplicated);
+  CHECK_EQ(gate.foreign(), 0);
+  CHECK_EQ(gate.sources(), 1);
+}
+
+static void testWraparound() {
+  SequenceGate gate(IDLE_MS);
+  CHECK(!gate.active());
+  CHECK_EQ(gate.admit(SOURCE_IP, SOURCE_PORT, 65534, 0), UDP_ACCEPTED);
+  CHECK(gate.active());
+  CHECK_EQ(gate.admit(SOURCE_IP, SOURCE_PORT, 65535, 10), UDP_ACCEPTED);
+  CHECK_EQ(gate.admit(SOURCE_IP, SOURCE_PORT, 0, 20), UDP_ACCEPTED);
+  CHECK_EQ(gate.admit(SOURCE_IP, SOURCE_PORT, 65535, 30), UDP_LATE);  // 回绕之前的帧迟到
+  CHECK_EQ(gate.admit(SOURCE_IP, SOURCE_PORT, 0, 40), UDP_LATE);      // 重复
+  CHECK_EQ(gate.admit(SOURCE_IP, SOURCE_PORT, 2, 50), UDP_ACCEPTED);
+  CHECK_EQ(gate.gaps(), 1);
+  CHECK_EQ(gate.admit(SOURCE_IP, SOURCE_PORT, 1, 60), UDP_LATE);      // 缺口中的帧随后到达
+  CHECK_EQ(gate.admit(SOURCE_IP, SOURCE_PORT, 2 + 32767, 70), UDP_ACCEPTED);
+  CHECK_EQ(gate.admit(SOURCE_IP, SOURCE_PORT, (uint16_t)(2 + 32767 + 32768), 80), UDP_LATE);
+  CHECK_EQ(gate.accepted(), 5);
+  CHECK_EQ(gate.late(), 4);
+}
+
+static void testSources() {
+  SequenceGate gate(IDLE_MS);
+  CHECK_EQ(gate.admit(SOURCE_IP, SOURCE_PORT, 100, 1000), UDP_ACCEPTED);
+  // 活跃期间：其他IP、同IP其他端口都被拒绝，且不刷新当前发送端的活跃时刻
+  CHECK_EQ(gate.admit(SOURCE_IP + 1, SOURCE_PORT, 500, 1100), UDP_FOREIGN);
+  CHECK_EQ(gate.admit(SOURCE_IP, SOURCE_PORT + 1, 500, 1499), UDP_FOREIGN);
+  CHECK_EQ(gate.foreign(), 2);
+  // 静默idleMs后新发送端接受，序号任意
+  CHECK_EQ(gate.admit(SOURCE_IP + 1, SOURCE_PORT, 7, 1000 + IDLE_MS), UDP_ACCEPTED);
+  CHECK_EQ(gate.sources(), 2);
+  // 原发送端此时成了外来者
+  CHECK_EQ(gate.admit(SOURCE_IP, SOURCE_PORT, 101, 1000 + IDLE_MS + 10), UDP_FOREIGN);
+  // 同一发送端静默后重连：序号从头开始也接受，不计缺口
+  CHECK_EQ(gate.admit(SOURCE_IP + 1, SOURCE_PORT, 8, 1600), UDP_ACCEPTED);
+  CHECK_EQ(gate.admit(SOURCE_IP + 1, SOURCE_PORT, 3, 1600 + IDLE_MS), UDP_ACCEPTED);
+  CHECK_EQ(gate.admit(SOURCE_IP + 1, SOURCE_PORT, 3000, 1600 + 2 * IDLE_MS), UDP_ACCEPTED);
+  CHECK_EQ(gate.gaps(), 0);
+  CHECK_EQ(gate.late(), 0);
+  CHECK_EQ(gate.sources(), 2);
+}
+
+int main() {
+  testInjectedPattern();
+  testWraparound();
+  testSources();
+  return hostCheckResult("test_sequence_gate");
+}
@@ -0,0 +1,156 @@
+// ===================== 跨线程队列压力检查 =====================
+// 网络侧与控制侧之间的无锁结构在两个std::thread上各跑100万次（可用第一个参数修改次数）：
+// - SpscRing：生产者遇满重试，消费者并发取出；要求顺序不变、不丢不重、没有撕裂的元素，
+//   dropped()等于重试次数；
+// - IngressQueue的最新帧槽（LatestSlot）：生产者连续发布，消费者并发取；要求取到的序号单调递增、
+//   元素不撕裂、最后一帧一定被取到，且 取出数 + 合并数 = 发布数；
+// - Mailbox只在控制侧内部使用（投递与取出在同一任务），这里只检查单线程下的合并计数。
+// 每个元素的校验字由序号算出，读到一半被覆盖的元素校验字对不上。
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+#include "ControlLoop.h"
+#include "HostCheck.h"
+#include "IngressQueue.h"
+#include "SpscRing.h"
+
+// 比ControlCommand稍大（40字节），拷贝不是单条指令，能暴露撕裂
+struct StressItem {
+  uint32_t seq;
+  uint32_t words[8];
+  uint32_t check;
+};
+
+static StressItem makeItem(uint32_t seq) {
+  StressItem item;
+  item.seq = seq;
+  uint32_t check = seq * 2654435761u;
+  for (int i = 0; i < 8; i++) {
+    item.words[i] = seq ^ (0x9E3779B9u * (uint32_t)(i + 1));
+    check ^= item.words[i];
+  }
+  item.check = check;
+  return item;
+}
+
+static bool intact(const StressItem& item) {
+  StressItem expected = makeItem(item.seq);
+  if (item.check != expected.check) return false;
+  for (int i = 0; i < 8; i++) {
+    if (item.words[i] != expected.words[i]) return false;
+  }
+  return true;
+}
+
+static void stressSpscRing(uint32_t count) {
+  static SpscRing<StressItem, 64> ring;
+  uint32_t retries = 0;
+  uint32_t received = 0;
+  uint32_t outOfOrder = 0;
+  uint32_t torn = 0;
+
+  std::thread producer([&]() {
+    for (uint32_t seq = 0; seq < count; seq++) {
+      StressItem item = makeItem(seq);
+      while (!ring.push(item)) {
+        retries++;
+        std::this_thread::yield();
+      }
+    }
+  });
+  std::thread consumer([&]() {
+    StressItem item;
+    while (received < count) {
+      if (!ring.pop(item)) {
+        std::this_thread::yield();
+        continue;
+      }
+      if (item.seq != received) outOfOrder++;
+      if (!intact(item)) torn++;
+      received++;
+    }
+  });
+  producer.join();
+  consumer.join();
+
+  StressItem extra;
+  CHECK_EQ(received, count);
+  CHECK_EQ(outOfOrder, 0);
+  CHECK_EQ(torn, 0);
+  CHECK(!ring.pop(extra));
+  CHECK_EQ(ring.size(), 0);
+  CHECK_EQ(ring.dropped(), retries);
+  printf("SpscRing: %u个元素，生产者遇满重试%u次\n", count, retries);
+}
+
+static void stressLatestSlot(uint32_t count) {
+  static IngressQueue<StressItem, 1, 4> ingress;
+  std::atomic<bool> done{false};
+  uint32_t taken = 0;
+  uint32_t regressions = 0;
+  uint32_t torn = 0;
+  uint32_t lastSeq = 0;
+  bool any = false;
+
+  std::thread producer([&]() {
+    for (uint32_t seq = 0; seq < count; seq++) {
+      ingress.pushLatest(0, makeItem(seq));
+      // 单核主机上也让消费者穿插进来
+      if ((seq & 63) == 0) std::this_thread::yield();
+    }
+    done.store(true, std::memory_order_release);
+  });
+  std::thread consumer([&]() {
+    StressItem item;
+    for (;;) {
+      // 先读done再取：生产者结束后还要再取一次，保证最后一帧不漏
+      bool finished = done.load(std::memory_order_acquire);
+      if (ingress.takeLatest(0, item)) {
+        if (any && item.seq <= lastSeq) regressions++;
+        if (!intact(item)) torn++;
+        lastSeq = item.seq;
+        any = true;
+        taken++;
+      } else if (finished) {
+        break;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+  producer.join();
+  consumer.join();
+
+  CHECK(any);
+  CHECK_EQ(lastSeq, count - 1);
+  CHECK_EQ(regressions, 0);
+  CHECK_EQ(torn, 0);
+  CHECK_EQ(ingress.frames(0), count);
+  CHECK_EQ(taken + ingress.coalesced(0), count);
+  printf("LatestSlot: 发布%u帧，取出%u帧，合并%u帧\n", count, taken, ingress.coalesced(0));
+}
+
+static void checkMailbox() {
+  Mailbox<StressItem> mailbox;
+  StressItem item;
+  CHECK(!mailbox.take(item));
+  for (uint32_t seq = 0; seq < 10; seq++) {
+    mailbox.post(makeItem(seq));
+  }
+  CHECK(mailbox.take(item));
+  CHECK_EQ(item.seq, 9);
+  CHECK(intact(item));
+  CHECK(!mailbox.take(item));
+  CHECK_EQ(mailbox.posted(), 10);
+  CHECK_EQ(mailbox.coalesced(), 9);
+}
+
+int main(int argc, char** argv) {
+  uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : 1000000;
+  stressSpscRing(count);
+  stressLatestSlot(count);
+  checkMailbox();
+  return hostCheckResult("test_spsc_stress");
+}
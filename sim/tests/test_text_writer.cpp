@@ -0,0 +1,59 @@
+// ===================== 定长缓冲区文本拼接 =====================
+// TextWriter逐段追加时长度始终钳在容量之内（连续截断也不会越界写），缓冲区始终以'\0'结尾；
+// textFormatMaxLength()给出的长度不小于任何数值下的实际输出。
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include "HostCheck.h"
+#include "TextWriter.h"
+
+#define CLIENT_FORMAT "{\"client\":%u,\"rate\":%u,\"frames\":%d}"
+
+static void testClamp() {
+  // 守卫字节检查越界写
+  char buffer[24 + 8];
+  memset(buffer, 'X', sizeof(buffer));
+  TextWriter out(buffer, 24);
+  for (int i = 0; i < 10; i++) {
+    out.printf(CLIENT_FORMAT, 1u, 20u, -5);
+    out.put(',');
+  }
+  CHECK(out.truncated());
+  CHECK_EQ(out.length(), 23);
+  CHECK_EQ(strlen(buffer), 23);
+  CHECK(strncmp(buffer, "{\"client\":1,\"rate\":20,\"f", 23) == 0);
+  for (size_t i = 24; i < sizeof(buffer); i++) CHECK_EQ(buffer[i], 'X');
+
+  char small[4];
+  TextWriter tiny(small, sizeof(small));
+  tiny.append("abcdef", 6);
+  CHECK(tiny.truncated());
+  CHECK(strcmp(small, "abc") == 0);
+
+  char exact[8];
+  TextWriter fit(exact, sizeof(exact));
+  fit.printf("%u", 1234567u);
+  CHECK(!fit.truncated());
+  CHECK(strcmp(exact, "1234567") == 0);
+  fit.put('8');
+  CHECK(fit.truncated());
+}
+
+static void testMaxLength() {
+  static_assert(textFormatMaxLength("abc") == 3, "字面长度");
+  static_assert(textFormatMaxLength("%u%d") == 21, "数值位数");
+  static_assert(textFormatMaxLength("%s") >= TEXT_FORMAT_UNSUPPORTED, "不支持的转换说明");
+
+  char buffer[textFormatMaxLength(CLIENT_FORMAT) + 1];
+  TextWriter out(buffer, sizeof(buffer));
+  out.printf(CLIENT_FORMAT, UINT_MAX, UINT_MAX, INT_MIN);
+  CHECK(!out.truncated());
+  CHECK_EQ(out.length(), textFormatMaxLength(CLIENT_FORMAT));
+}
+
+int main() {
+  testClamp();
+  testMaxLength();
+  return hostCheckResult("test_text_writer");
+}
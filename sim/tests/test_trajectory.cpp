@@ -0,0 +1,128 @@
+// ===================== 关键帧轨迹插值 =====================
+// - 三种曲线：随机关键帧（段长1ms~数秒、脉宽0~20000us、跳变可正可负）逐毫秒采样，
+//   与双精度参考实现 a + (b - a) * ease(τ) 相差不超过0.55us（四舍五入的0.5us加定点截断）；
+// - 端点：第一个关键帧之前保持首帧，最后一个之后保持末帧，每个关键帧时刻恰为该帧脉宽；
+// - 时间倒退（重新采样更早的时刻）时从头查找所在段，结果与顺序采样相同；
+// - 非法输入（时刻不严格递增、关键帧数或曲线越界）返回false且保留原轨迹。
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "HostCheck.h"
+#include "Trajectory.h"
+
+static uint32_t rngState = 7;
+static uint32_t nextRandom() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+static double referenceEase(uint8_t mode, double t) {
+  switch (mode) {
+    case TRAJ_CUBIC: return t * t * (3 - 2 * t);
+    case TRAJ_MIN_JERK: return t * t * t * (10 - 15 * t + 6 * t * t);
+    default: return t;
+  }
+}
+
+static double referenceSample(const TrajectoryKey* keys, int count, uint8_t mode, uint32_t elapsedMs) {
+  if (elapsedMs <= keys[0].timeMs) return keys[0].pulseUs;
+  if (elapsedMs >= keys[count - 1].timeMs) return keys[count - 1].pulseUs;
+  int k = 0;
+  while (elapsedMs >= keys[k + 1].timeMs) k++;
+  double tau = (double)(elapsedMs - keys[k].timeMs) / (keys[k + 1].timeMs - keys[k].timeMs);
+  return keys[k].pulseUs + (keys[k + 1].pulseUs - keys[k].pulseUs) * referenceEase(mode, tau);
+}
+
+static int makeKeys(TrajectoryKey* keys) {
+  int count = 1 + (int)(nextRandom() % TRAJECTORY_MAX_KEYS);
+  uint32_t t = nextRandom() % 50;
+  for (int i = 0; i < count; i++) {
+    keys[i].timeMs = t;
+    keys[i].pulseUs = (int32_t)(nextRandom() % 20001);
+    uint32_t r = nextRandom();
+    t += (r & 3) == 0 ? 1 + (r >> 8) % 5 : 1 + (r >> 8) % 3000;   // 偶尔很短的段
+  }
+  return count;
+}
+
+static void testAgainstReference() {
+  for (uint8_t mode = TRAJ_LINEAR; mode <= TRAJ_MIN_JERK; mode++) {
+    double maxError = 0;
+    uint32_t endpointMismatches = 0;
+    for (int round = 0; round < 200; round++) {
+      TrajectoryKey keys[TRAJECTORY_MAX_KEYS];
+      int count = makeKeys(keys);
+      Trajectory trajectory;
+      CHECK(trajectory.load(keys, count, mode));
+      CHECK_EQ(trajectory.durationMs(), keys[count - 1].timeMs);
+      uint32_t end = keys[count - 1].timeMs + 20;
+      for (uint32_t t = 0; t <= end; t++) {
+        double error = fabs(trajectory.sample(t) - referenceSample(keys, count, mode, t));
+        if (error > maxError) maxError = error;
+      }
+      for (int i = 0; i < count; i++) {
+        if (trajectory.sample(keys[i].timeMs) != keys[i].pulseUs) endpointMismatches++;
+      }
+      if (trajectory.sample(0) != keys[0].pulseUs || trajectory.sample(end) != keys[count - 1].pulseUs) {
+        endpointMismatches++;
+      }
+      CHECK(trajectory.finished(keys[count - 1].timeMs));
+      CHECK(count == 1 || !trajectory.finished(keys[count - 1].timeMs - 1));
+    }
+    if (maxError > 0.55) fprintf(stderr, "曲线%u 最大误差%.3fus\n", mode, maxError);
+    CHECK(maxError <= 0.55);
+    CHECK_EQ(endpointMismatches, 0);
+  }
+}
+
+static void testBackwardsTime() {
+  const TrajectoryKey keys[] = { { 0, 1000 }, { 100, 2000 }, { 300, 1200 }, { 700, 1800 } };
+  Trajectory forward;
+  Trajectory jumping;
+  CHECK(forward.load(keys, 4, TRAJ_MIN_JERK));
+  CHECK(jumping.load(keys, 4, TRAJ_MIN_JERK));
+  int expected[701];
+  for (uint32_t t = 0; t <= 700; t++) expected[t] = forward.sample(t);
+  uint32_t mismatches = 0;
+  for (int n = 0; n < 5000; n++) {
+    uint32_t t = nextRandom() % 701;
+    if (jumping.sample(t) != expected[t]) mismatches++;
+  }
+  CHECK_EQ(mismatches, 0);
+}
+
+static void testInvalidLoad() {
+  const TrajectoryKey keys[] = { { 0, 1000 }, { 100, 2000 } };
+  Trajectory trajectory;
+  CHECK_EQ(trajectory.sample(50), 0);
+  CHECK(trajectory.finished(0));
+  CHECK(trajectory.load(keys, 2, TRAJ_LINEAR));
+  CHECK_EQ(trajectory.sample(50), 1500);
+
+  const TrajectoryKey repeated[] = { { 0, 1000 }, { 100, 1200 }, { 100, 1300 } };
+  const TrajectoryKey reversed[] = { { 200, 1000 }, { 100, 1200 } };
+  CHECK(!trajectory.load(repeated, 3, TRAJ_LINEAR));
+  CHECK(!trajectory.load(reversed, 2, TRAJ_LINEAR));
+  CHECK(!trajectory.load(keys, 0, TRAJ_LINEAR));
+  CHECK(!trajectory.load(keys, TRAJECTORY_MAX_KEYS + 1, TRAJ_LINEAR));
+  CHECK(!trajectory.load(keys, 2, TRAJ_MIN_JERK + 1));
+  // 原轨迹保持不变
+  CHECK_EQ(trajectory.keyCount(), 2);
+  CHECK_EQ(trajectory.sample(50), 1500);
+  CHECK_EQ(trajectory.finalPulse(), 2000);
+
+  // 单个关键帧：始终保持该脉宽
+  CHECK(trajectory.load(keys + 1, 1, TRAJ_CUBIC));
+  CHECK_EQ(trajectory.sample(0), 2000);
+  CHECK_EQ(trajectory.sample(1000), 2000);
+}
+
+int main() {
+  testAgainstReference();
+  testBackwardsTime();
+  testInvalidLoad();
+  return hostCheckResult("test_trajectory");
+}
@@ -0,0 +1,1660 @@
+#include <WiFi.h>
+#include <WebServer.h>
+#include <WebSocketsServer.h>
+#include <GyroFrame.h>
+#include <GyroText.h>
+#include <JsonScan.h>
+#include <ControlLoop.h>
+#include <SpscRing.h>
+#include <TaskPort.h>
+#include <MotionFilter.h>
+#include <Telemetry.h>
+#include <ControllerLease.h>
+#include <ChannelTable.h>
+#include <LatencyProbe.h>
+#include <CaptivePortal.h>
+#include <ConfigStore.h>
+#include <DutyKernel.h>
+#include <MotionPredictor.h>
+#include <MotionRecord.h>
+#include <Trajectory.h>
+#include <IngressQueue.h>
+#include <SequenceGate.h>
+#include <DatagramPort.h>
+#include <HeapMonitor.h>
+#include <QuaternionFilter.h>
+#include <ControlPipeline.h>
+#include <ControlServer.h>
+#include <EventLog.h>
+#include <TextWriter.h>
+#include "index_html_gz.h" // 由 tools/embed_html.py 在构建前生成（各工程的 include/ 目录）
+
+// ===================== 固件变体 =====================
+// 同一份main.cpp编译出两种固件，由各PlatformIO环境的 -D INPUT_MODE=... 选定控制流水线的输入与映射策略：
+// INPUT_MODE_ANGLE（PIO_V1工程）：网页发送姿态角或原始IMU样本，设备端按通道表映射（AngleInput + ChannelTableMapping），
+//   另有姿态融合、延迟补偿、动作录制与遥测；
+// INPUT_MODE_PULSE（PIO_V2工程）：网页算好各通道脉宽直接下发（PulseInput + ClientPulseMapping），
+//   设备端只做滤波、关键帧轨迹和PWM输出，JSON消息由ArduinoJson解析。
+// 网络侧（ControlServer.h）、控制环节拍和输出级两种固件共用
+#define INPUT_MODE_ANGLE 1
+#define INPUT_MODE_PULSE 2
+#ifndef INPUT_MODE
+#define INPUT_MODE INPUT_MODE_ANGLE
+#endif
+#if INPUT_MODE == INPUT_MODE_PULSE
+#include <ArduinoJson.h> // 需在platformio.ini添加lib_deps=bblanchon/ArduinoJson@^6.21.0
+#elif INPUT_MODE != INPUT_MODE_ANGLE
+#error "INPUT_MODE须为INPUT_MODE_ANGLE或INPUT_MODE_PULSE"
+#endif
+
+// ===================== 配置参数 =====================
+// WiFi热点配置
+const char* AP_SSID = "ESP32_Gyroscope";
+const char* AP_PASS = "fzcnfzcn";
+const IPAddress AP_IP(192, 168, 4, 1);
+const IPAddress AP_GW(192, 168, 4, 1);
+const IPAddress AP_SUBNET(255, 255, 255, 0);
+
+// 服务器端口
+const uint16_t DNS_PORT = 53;
+const uint16_t HTTP_PORT = 80;
+const uint16_t WS_PORT = 81;
+
+// 默认舵机通道：D12、D13、D14对应GPIO12、13、14（姿态角输入时分别跟随pitch/roll/yaw）
+// 通道表下标即PWM通道号，可通过配置消息扩展到16路
+const int DEFAULT_CHANNEL_COUNT = 3;
+const int DEFAULT_SERVO_PINS[DEFAULT_CHANNEL_COUNT] = { 12, 13, 14 };
+
+// 舵机PWM配置
+const int PWM_FREQUENCY = 50;      // 50Hz
+// 分辨率（8~16位，-D PWM_RESOLUTION_BITS=N 修改；16位时每级约0.3us，12位约4.9us）
+#ifndef PWM_RESOLUTION_BITS
+#define PWM_RESOLUTION_BITS 16
+#endif
+const int PWM_RESOLUTION = PWM_RESOLUTION_BITS;
+
+// 输出级特化（-D SERVO_SMOOTHING=0 不编译平滑滤波，目标脉宽直接写PWM；
+// -D SERVO_OUTPUT_CHANNELS=N 限定输出通道数，通道表超出的部分不会启用）
+#ifndef SERVO_SMOOTHING
+#define SERVO_SMOOTHING 1
+#endif
+#ifndef SERVO_OUTPUT_CHANNELS
+#define SERVO_OUTPUT_CHANNELS MAX_SERVO_CHANNELS
+#endif
+const int OUTPUT_CHANNELS = SERVO_OUTPUT_CHANNELS;
+static_assert(OUTPUT_CHANNELS >= DEFAULT_CHANNEL_COUNT && OUTPUT_CHANNELS <= MAX_SERVO_CHANNELS,
+              "SERVO_OUTPUT_CHANNELS须在默认通道数与MAX_SERVO_CHANNELS之间");
+
+// 控制环频率（与50Hz PWM帧对齐，网络回调只投递目标，不直接写PWM）
+const uint32_t CONTROL_RATE_HZ = PWM_FREQUENCY;
+
+// 双核模式（platformio.ini中 -D DUAL_CORE_MODE=1 开启）：
+// 网络任务固定在核0（与WiFi协议栈同核），解析后的指令经无锁队列交给核1上的控制环
+#ifndef DUAL_CORE_MODE
+#define DUAL_CORE_MODE 0
+#endif
+const int NETWORK_CORE = 0;
+const int NETWORK_TASK_PRIORITY = 1;
+const uint32_t NETWORK_TASK_STACK = 8192;
+
+// 控制权租约超时（持有者超过该时间无控制帧则其他客户端可接管）
+const uint32_t LEASE_TIMEOUT_MS = 2000;
+
+// 强制门户：DNS应答TTL较长，客户端缓存解析结果、减少重复查询；DNS应答按时间窗限额
+const char* PORTAL_URL = "http://192.168.4.1/";
+const uint32_t DNS_TTL_SECONDS = 300;
+const uint32_t DNS_ANSWERS_PER_WINDOW = 4;
+const uint32_t DNS_WINDOW_MS = 20;
+
+// UDP控制通道（-D UDP_CONTROL=1 开启）：姿态/脉宽帧也可用UDP数据报发送（载荷同二进制帧），
+// 丢包不重传、迟到的数据报直接丢弃，不会像TCP那样让后续帧排在重传之后；配置、指令和遥测仍走WebSocket。
+// 来源IP与某个WebSocket连接相同的数据报沿用该连接的租约和入口槽位，否则使用单独的UDP槽位
+const uint16_t UDP_PORT = 4210;
+const uint32_t UDP_SOURCE_IDLE_MS = 500;   // 当前发送端静默超过该时间才接受新的发送端
+const int UDP_POLL_BUDGET = 8;             // 每轮最多处理的数据报数
+const int INGRESS_SLOTS = ControlServer::UDP_CLIENT + 1;
+
+// 打印频率控制（避免串口刷屏）
+const unsigned long STATS_INTERVAL = 5000;        // 5秒打印一次控制环/门户统计
+const unsigned long HEAP_REPORT_INTERVAL = 60000; // 1分钟打印一次堆健康
+
+// 延迟日志：热路径只记录二进制事件（各事件独立节流，间隔见EventLog.cpp），
+// loop()空闲时再格式化输出；-D EVENT_LOG_BINARY=1 时输出原始记录，由 tools/logdecode.cpp 解码
+const uint32_t LOG_RING_SIZE = 32;
+const int LOG_DRAIN_PER_LOOP = 4;          // 每次空闲最多输出的条数
+const uint32_t LOG_IDLE_MARGIN_US = 2000;  // 距下一个控制节拍不足该时间时不输出
+
+#if INPUT_MODE == INPUT_MODE_ANGLE
+const char* FIRMWARE_NAME = "ESP32 陀螺仪数据采集系统";
+
+// 延迟补偿：带时间戳的二进制姿态帧按估计延迟外推到下一个输出节拍（外推上限60ms），
+// 额外延迟超过150ms的帧丢弃；文本帧不带时间戳，直接使用原值
+const uint32_t PREDICT_BASE_DELAY_US = 5000;
+const uint32_t PREDICT_MAX_HORIZON_US = 60000;
+const uint32_t PREDICT_STALE_US = 150000;
+
+// 姿态融合：IMU批量帧在网络侧按样本顺序融合（不经过入口合并，样本不丢），结果作为普通姿态帧交给控制侧；
+// 换了发送端或超过500ms没有IMU帧时丢弃融合状态，下一批按重力方向重新初始化并以当时姿态为零点
+const uint32_t FUSION_IDLE_RESET_MS = 500;
+
+// 动作录制：16块×256字节的环形缓冲（50Hz、三通道约每样本4字节，可录约20秒），
+// 停止录制时写入flash槽位，回放时按原始时间间隔驱动PWM
+const int MOTION_BLOCKS = 16;
+const int MOTION_BLOCK_SIZE = 256;
+const uint8_t MOTION_SLOT_RAM = 0xFF;   // 回放RAM中的录制（不读flash）
+
+// 持久化配置：配置稳定3秒后才写入NVS；SystemConfig布局变化时提升版本号
+const char* CONFIG_KEY = "v1cfg";
+const uint16_t CONFIG_VERSION = 3;
+#else
+const char* FIRMWARE_NAME = "ESP32 舵机控制器";
+
+// 持久化设置：引脚/滤波变化稳定3秒后才写入NVS；StoredServos布局变化时提升版本号
+const char* CONFIG_KEY = "v2servo";
+const uint16_t CONFIG_VERSION = 1;
+#endif
+const uint32_t CONFIG_COMMIT_QUIET_MS = 3000;
+
+// ===================== 全局实例 =====================
+const ControlServerConfig SERVER_CONFIG = {
+  ipKey(AP_IP), DNS_PORT, DNS_TTL_SECONDS, DNS_ANSWERS_PER_WINDOW, DNS_WINDOW_MS, PORTAL_URL,
+  LEASE_TIMEOUT_MS, UDP_PORT, UDP_SOURCE_IDLE_MS, UDP_POLL_BUDGET, STATS_INTERVAL, HEAP_REPORT_INTERVAL
+};
+PortalWebServer server(HTTP_PORT);
+WebSocketsServer webSocket(WS_PORT);
+ControlServer network(server, webSocket, SERVER_CONFIG); // 门户/HTTP/租约/UDP/堆健康（网络侧）
+
+FixedRateTicker controlTicker(CONTROL_RATE_HZ);
+struct LedcWriter {
+  static void write(int channel, uint32_t duty) { ledcWrite(channel, duty); }
+};
+// 控制流水线：输入解码 -> 映射 -> 输出级（平滑滤波 -> 定点占空比 -> 占空比未变化时跳过ledcWrite，控制环节拍内运行）
+// 姿态角输入：二进制/JSON姿态帧按顶层键分派，设备端按通道表映射；
+// 脉宽输入：二进制脉宽帧的脉宽原样成为通道指令，JSON消息（通道数组、滤波键、轨迹可任意组合）仍由ArduinoJson整体解析
+#if INPUT_MODE == INPUT_MODE_ANGLE
+typedef ControlPipeline<AngleInput, ChannelTableMapping,
+                        ServoOutput<OUTPUT_CHANNELS, ServoFilterFor<OUTPUT_CHANNELS, SERVO_SMOOTHING>, LedcWriter> >
+    Pipeline;
+#else
+typedef ControlPipeline<PulseInput, ClientPulseMapping,
+                        ServoOutput<OUTPUT_CHANNELS, ServoFilterFor<OUTPUT_CHANNELS, SERVO_SMOOTHING>, LedcWriter> >
+    Pipeline;
+#endif
+Pipeline pipeline(PWM_RESOLUTION, PWM_PERIOD_US);
+bool hasTarget = false;
+bool outputDirty = true;                     // 引脚/滤波配置变化后需要重新输出一次
+SuppressionStats frameStats;                 // 控制帧：映射结果无变化（跳过投递）
+SuppressionStats tickStats;                  // 控制节拍：无新目标且滤波已收敛（跳过PWM）
+ConfigDebouncer configDebouncer(CONFIG_COMMIT_QUIET_MS); // 配置写入防抖（控制侧）
+EventLog<LOG_RING_SIZE> networkLog;          // 网络侧事件（WebSocket回调）
+unsigned long lastStatsTime = 0;             // 控制环统计（控制侧）
+
+void networkLoop();
+
+#if INPUT_MODE == INPUT_MODE_ANGLE
+// ===================== 姿态角输入 =====================
+QuaternionFilter fusion;                   // IMU样本 -> 姿态四元数（网络侧）
+int fusionClient = -1;                     // 当前融合的发送端（-1为姿态角输入模式）
+uint32_t lastFusionMs = 0;
+uint32_t fusionBatches = 0;                // 融合统计：批数、样本数、累计/单样本最大周期数
+uint32_t fusionSamples = 0;
+uint64_t fusionCycles = 0;
+uint32_t fusionMaxCycles = 0;
+
+// 系统配置（通道配置结构体ChannelConfig见 ChannelTable.h）
+typedef struct {
+  bool controlEnabled;     // 启用控制
+  bool operationLocked;    // 操作锁定
+  int channelCount;        // 启用的通道数（不超过MAX_SERVO_CHANNELS）
+  ChannelConfig channels[MAX_SERVO_CHANNELS]; // 通道表，下标即PWM通道号
+} SystemConfig;
+
+// 全局配置变量（控制侧独占）
+SystemConfig config;
+int32_t axisCenti[INPUT_AXES];               // 最新的pitch/roll/yaw原始角度（0.01°，控制侧）
+
+// 网络侧配置影子：配置消息先在网络侧解析到这里，再整体交给控制侧
+SystemConfig networkConfig;
+
+// 网络侧 -> 控制侧的已解码指令
+typedef enum : uint8_t {
+  CMD_GYRO,                // 陀螺仪数据
+  CMD_SERVO_RESET,         // 舵机回中
+  CMD_ATTITUDE_RESET,      // 姿态归零
+  CMD_RECORD_START,        // 开始录制
+  CMD_RECORD_STOP,         // 停止录制并写入flash槽位
+  CMD_PLAY_START,          // 开始回放
+  CMD_PLAY_STOP            // 停止回放
+} CommandType;
+
+const uint8_t RESET_FLAG_QUATERNION = 0x01;   // CMD_ATTITUDE_RESET：融合模式，已在四元数空间归零
+
+typedef struct {
+  uint8_t type;            // CommandType
+  uint8_t flags;           // CMD_GYRO：GYRO_FLAG_*；CMD_ATTITUDE_RESET：RESET_FLAG_*
+  uint8_t slot;            // CMD_RECORD_STOP/CMD_PLAY_START：flash槽位（MOTION_SLOT_RAM为RAM）
+  uint16_t seq;            // CMD_GYRO：帧序号（0为未携带；预测仅在GYRO_FLAG_TIMESTAMP置位时使用）
+  int32_t angleCenti[INPUT_AXES]; // CMD_GYRO：pitch/roll/yaw原始角度（0.01°）
+  uint32_t clientMs;       // CMD_GYRO：客户端发送时刻
+  uint32_t arrivalUs;      // CMD_GYRO：网络侧收到该帧的时刻
+} ControlCommand;
+
+// 姿态帧合并：新帧整体替换旧帧，但旧帧携带的启用状态在新帧未携带时保留
+struct GyroFrameMerge {
+  void operator()(ControlCommand& pending, const ControlCommand& newer) const {
+    uint8_t enabledFlags = pending.flags & (GYRO_FLAG_HAS_ENABLED | GYRO_FLAG_ENABLED);
+    pending = newer;
+    if (!(newer.flags & GYRO_FLAG_HAS_ENABLED)) pending.flags |= enabledFlags;
+  }
+};
+
+// 入口队列：姿态帧按客户端只保留最新一帧，复位/录制等指令走优先队列（网络侧 -> 控制侧）
+IngressQueue<ControlCommand, INGRESS_SLOTS, 16, GyroFrameMerge> ingress;
+LatestSlot<SystemConfig> configSlot;         // 配置较大且低频，单独传递；networkConfig是累积的完整配置，只需最新一份
+SpscRing<TelemetryState, 4> telemetryRing;   // 控制侧 -> 网络侧的遥测快照
+
+// 遥测发布：按客户端协商频率发送变化字段
+TelemetryPublisher<WEBSOCKETS_SERVER_CLIENT_MAX> telemetry;
+
+// 舵机目标脉宽（网络回调 -> 控制环）
+typedef struct {
+  int count;                        // 有效通道数
+  int pulse[MAX_SERVO_CHANNELS];    // 各通道脉宽
+} ServoTarget;
+
+Mailbox<ServoTarget> servoMailbox;           // 单槽邮箱，只保留最新目标
+int attachedPins[MAX_SERVO_CHANNELS];        // 各PWM通道当前绑定的引脚（-1为未绑定）
+ServoTarget currentTarget;                   // 控制环当前目标
+MotionPredictor predictor;                   // 延迟估计与外推（控制侧）
+uint16_t appliedSeq = 0;                     // 最近生效的姿态帧序号（随遥测回显）
+
+// 动作录制与回放（控制侧）
+typedef MotionRecorder<MOTION_BLOCKS, MOTION_BLOCK_SIZE> ServoRecorder;
+ServoRecorder motionRecorder;
+MotionPlayer motionPlayer;
+bool motionPlaying = false;
+uint32_t playStartMs = 0;
+uint8_t motionBlob[sizeof(ConfigBlobHeader) + ServoRecorder::SERIALIZED_CAPACITY]; // 串接/flash读写缓冲
+EventLog<LOG_RING_SIZE> controlLog;         // 控制侧事件（映射、控制环）
+uint32_t lastFusionBatches = 0;              // 融合统计（网络侧）
+
+// 函数声明
+void initPWM();
+void updateServoPWM(const ServoTarget& target);
+void postServoTarget();
+void configureFilters();
+bool filtersSettled();
+void attachChannels();
+void applyConfig(const SystemConfig& settings);
+void loadConfig();
+void saveConfig();
+void controlLoop();
+void startRecording();
+void stopRecording(uint8_t slot);
+void startPlayback(uint8_t slot);
+void stopPlayback();
+void applyCommand(const ControlCommand& cmd);
+void pushCommand(const ControlCommand& cmd);
+void pushGyroFrame(uint8_t num, const ControlCommand& cmd);
+void pushAngleFrame(uint8_t num, const GyroFrame& frame);
+void pushImuBatch(uint8_t num, const ImuBatch& batch);
+void pushAttitudeReset();
+void publishTelemetry();
+void flushTelemetry();
+void servoReset();
+void attitudeReset(bool quaternionSpace);
+void updateGyroData(int32_t pitchCenti, int32_t rollCenti, int32_t yawCenti);
+void parseConfigData(const uint8_t* payload, size_t length);
+
+// 按通道表绑定/更换PWM引脚（仅在配置变化时调用）
+void attachChannels() {
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    int pin = (i < config.channelCount) ? config.channels[i].pin : -1;
+    if (pin == attachedPins[i]) continue;
+    if (attachedPins[i] >= 0) {
+      ledcDetachPin(attachedPins[i]);
+    }
+    if (pin >= 0) {
+      ledcSetup(i, PWM_FREQUENCY, PWM_RESOLUTION);
+      ledcAttachPin(pin, i);
+    }
+    attachedPins[i] = pin;
+    pipeline.output().attach(i, pin >= 0);
+  }
+  pipeline.output().invalidate();
+  outputDirty = true;
+}
+
+// 初始化PWM
+void initPWM() {
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    attachedPins[i] = -1;
+  }
+  // 配置PWM通道并绑定GPIO引脚
+  attachChannels();
+  
+  // 初始化为中心位置
+  servoReset();
+}
+
+// 更新PWM输出（仅由控制环每个节拍调用，目标脉宽先经过平滑滤波）
+void updateServoPWM(const ServoTarget& target) {
+  PROBE_SCOPE(PROBE_PWM);
+  // 只处理已绑定的通道（通道表之外的通道已解绑）：滤波 -> 占空比 -> 未变化则跳过写入
+  pipeline.output().write(target.pulse);
+  controlLog.record(LOG_SERVO_PULSE, micros(), target.pulse[0], target.pulse[1], target.pulse[2]);
+}
+
+// 投递当前脉宽到控制环
+void postServoTarget() {
+  ServoTarget target;
+  target.count = config.channelCount;
+  for (int i = 0; i < config.channelCount; i++) {
+    target.pulse[i] = config.channels[i].pulseWidth;
+  }
+  servoMailbox.post(target);
+}
+
+// 按当前配置重新计算滤波器定点系数（仅在配置变化时调用）
+void configureFilters() {
+  for (int i = 0; i < config.channelCount; i++) {
+    pipeline.output().configure(i, config.channels[i].filter, controlTicker.periodUs());
+  }
+  outputDirty = true;
+}
+
+// 所有已绑定通道的滤波器都已收敛（目标不变时再运行也不会改变输出）
+// 不编译滤波（SERVO_SMOOTHING=0）时恒为true
+bool filtersSettled() {
+  return pipeline.output().settled();
+}
+
+// 控制环：先执行优先指令，再按固定频率取各客户端的最新姿态帧映射并写入PWM，
+// 期间到达的多个姿态帧只生效最后一个
+void controlLoop() {
+  SystemConfig settings;
+  if (configSlot.take(settings)) {
+    applyConfig(settings);
+  }
+  
+  // 复位/录制等优先指令每轮立即执行
+  ControlCommand cmd;
+  while (ingress.popPriority(cmd)) {
+    applyCommand(cmd);
+  }
+  
+  // 配置稳定后写入NVS（流式更新期间不会反复擦写flash）
+  if (configDebouncer.due(millis())) {
+    saveConfig();
+  }
+  
+  if (!controlTicker.due(micros())) return;
+  
+  // 每个节拍只取各客户端的最新姿态帧（节拍之间到达的旧帧已在入口合并掉，不再解析映射）
+  for (uint8_t i = 0; i < INGRESS_SLOTS; i++) {
+    if (ingress.takeLatest(i, cmd)) {
+      applyCommand(cmd);
+    }
+  }
+  
+  // 没有新目标时继续运行滤波向上一个目标收敛，收敛后整个PWM阶段跳过
+  // 回放期间目标来自录制数据，网络目标被忽略；否则新目标同时送入录制器
+  ServoTarget incoming;
+  bool fresh = servoMailbox.take(incoming);
+  if (motionPlaying) {
+    fresh = motionPlayer.advance(millis() - playStartMs, currentTarget.count, currentTarget.pulse);
+    if (motionPlayer.finished()) {
+      Serial.printf("[回放] 结束，共%u个样本\n", motionPlayer.samples());
+      motionPlaying = false;
+    }
+  } else if (fresh) {
+    currentTarget = incoming;
+    motionRecorder.record(millis(), currentTarget.count, currentTarget.pulse);
+  }
+  if (fresh) {
+    hasTarget = true;
+  }
+  bool active = hasTarget && (fresh || outputDirty || !filtersSettled());
+  if (active) {
+    outputDirty = false;
+    updateServoPWM(currentTarget);
+  }
+  tickStats.record(active);
+  
+  unsigned long currentTime = millis();
+  if (currentTime - lastStatsTime >= STATS_INTERVAL) {
+    Serial.printf("[控制环] 输入: %u, 合并: %u, 写入: %u, 跳过: %u, 超时: %u, 入口合并: %u/%u, 队列丢弃: %u\n",
+                  servoMailbox.posted(), servoMailbox.coalesced(),
+                  pipeline.output().written(), pipeline.output().skipped(), controlTicker.overruns(),
+                  ingress.totalCoalesced(), ingress.totalFrames(), ingress.priorityDropped());
+    Serial.printf("[抑制] 姿态帧: %u/%u (%u.%u%%), 空闲节拍: %u/%u (%u.%u%%)\n",
+                  frameStats.suppressed(), frameStats.total(),
+                  frameStats.permille() / 10, frameStats.permille() % 10,
+                  tickStats.suppressed(), tickStats.total(),
+                  tickStats.permille() / 10, tickStats.permille() % 10);
+    if (predictor.accepted() > 0) {
+      Serial.printf("[预测] 延迟: %uus, 接受: %u, 乱序: %u, 过期: %u\n",
+                    predictor.delayUs(), predictor.accepted(), predictor.outOfOrder(), predictor.stale());
+    }
+    lastStatsTime = currentTime;
+  }
+}
+
+// 开始录制（清空RAM中的上一段录制）
+void startRecording() {
+  stopPlayback();
+  motionRecorder.start(millis());
+  Serial.println("[录制] 开始");
+}
+
+// 停止录制，串接后写入flash槽位
+void stopRecording(uint8_t slot) {
+  if (!motionRecorder.recording()) return;
+  motionRecorder.stop();
+  size_t length = motionRecorder.serialize(motionBlob + sizeof(ConfigBlobHeader),
+                                           sizeof(motionBlob) - sizeof(ConfigBlobHeader));
+  bool ok = length > 0 && saveMotionSlot(slot, motionBlob, length);
+  Serial.printf("[录制] 停止：%u个样本，%ums，%u字节，丢弃%u块，写入槽位%u%s\n",
+                motionRecorder.samples(), motionRecorder.durationMs(), (unsigned)length,
+                motionRecorder.droppedBlocks(), slot, ok ? "成功" : "失败");
+}
+
+// 回放RAM中的录制或flash槽位
+// 正在录制时只结束录制，不写flash：只有record_stop会写入槽位，回放不能覆盖已保存的录制
+void startPlayback(uint8_t slot) {
+  if (motionRecorder.recording()) {
+    motionRecorder.stop();
+    Serial.printf("[录制] 停止：%u个样本（未写入flash）\n", motionRecorder.samples());
+  }
+  size_t length = 0;
+  if (slot == MOTION_SLOT_RAM) {
+    length = motionRecorder.serialize(motionBlob + sizeof(ConfigBlobHeader),
+                                      sizeof(motionBlob) - sizeof(ConfigBlobHeader));
+  } else {
+    ConfigLoadResult result = loadMotionSlot(slot, motionBlob, sizeof(motionBlob), length);
+    if (result != CONFIG_LOADED) {
+      Serial.printf("[回放] 槽位%u读取失败: %s\n", slot, configLoadResultName(result));
+      return;
+    }
+  }
+  if (length == 0) {
+    Serial.println("[回放] 没有可回放的录制");
+    return;
+  }
+  motionPlayer.begin(motionBlob + sizeof(ConfigBlobHeader), length);
+  motionPlaying = true;
+  playStartMs = millis();
+  Serial.printf("[回放] 开始（%s，%u字节）\n", slot == MOTION_SLOT_RAM ? "RAM" : "flash", (unsigned)length);
+}
+
+void stopPlayback() {
+  if (!motionPlaying) return;
+  motionPlaying = false;
+  Serial.printf("[回放] 停止，已输出%u个样本\n", motionPlayer.samples());
+}
+
+// 舵机回中
+void servoReset() {
+  // 中位脉宽限制在各通道的校准上下限内
+  for (int i = 0; i < config.channelCount; i++) {
+    ChannelConfig& ch = config.channels[i];
+    ch.pulseWidth = constrain(SERVO_CENTER_PULSE, ch.minPulse, ch.maxPulse);
+  }
+  
+  postServoTarget();
+}
+
+// 姿态归零（quaternionSpace：融合模式下网络侧已把当前姿态设为参考，之后的输入即相对角度，偏移量清零）
+void attitudeReset(bool quaternionSpace) {
+  if (quaternionSpace) {
+    // 输入从归零前的相对角度跳到0，旧的速度估计不再可用
+    predictor.reset();
+    for (int i = 0; i < INPUT_AXES; i++) {
+      axisCenti[i] = 0;
+    }
+  }
+  // 设置当前原始值为偏移量
+  for (int i = 0; i < config.channelCount; i++) {
+    ChannelConfig& ch = config.channels[i];
+    if (quaternionSpace) ch.rawCenti = 0;
+    ch.offsetCenti = ch.rawCenti;
+    ch.offset = centiToDegrees(ch.rawCenti);
+  }
+  configDebouncer.markDirty(millis());
+  
+  // 立即更新映射角度和脉宽（考虑新的偏移量，范围限制在±180°，不受死区限制；控制未启用时只更新角度）
+  Pipeline::Mapping::map(config.channels, config.channelCount, axisCenti, config.controlEnabled, true);
+  if (config.controlEnabled) {
+    // 投递到控制环
+    postServoTarget();
+  }
+  
+  // 立即发送更新后的数据到所有WebSocket客户端（由网络侧发送）
+  publishTelemetry();
+}
+
+// 更新陀螺仪数据
+void updateGyroData(int32_t pitchCenti, int32_t rollCenti, int32_t yawCenti) {
+  // 更新原始值
+  axisCenti[AXIS_PITCH] = pitchCenti;
+  axisCenti[AXIS_ROLL] = rollCenti;
+  axisCenti[AXIS_YAW] = yawCenti;
+  
+  // 按通道表一次循环完成映射：映射角度 = 原始值 - 偏移（±180°），输出脉宽 = 1500 + (映射角度 * rate)
+  // 1500us为中位，rate控制灵敏度；控制未启用时只更新映射角度；变化在死区内的通道保持不变
+  MapResult changed = Pipeline::Mapping::map(config.channels, config.channelCount, axisCenti, config.controlEnabled);
+  bool anyChanged = (changed.mappedChanged | changed.pulseChanged) != 0;
+  frameStats.record(anyChanged);
+  if (config.controlEnabled && changed.pulseChanged) {
+    // 投递到控制环
+    postServoTarget();
+  }
+  
+  controlLog.record(LOG_GYRO_DATA, micros(), pitchCenti, rollCenti, yawCenti, config.controlEnabled);
+  
+  // 发送实时数据到所有WebSocket客户端（由网络侧发送）；没有变化时不产生遥测
+  if (anyChanged) {
+    publishTelemetry();
+  }
+}
+
+// 控制侧：把当前映射结果交给网络侧发送
+void publishTelemetry() {
+  TelemetryState snapshot;
+  snapshot.count = config.channelCount;
+  snapshot.seq = appliedSeq;
+  for (int i = 0; i < config.channelCount; i++) {
+    snapshot.mapped[i] = centiToDegrees(config.channels[i].mappedCenti);
+    snapshot.pulse[i] = config.channels[i].pulseWidth;
+  }
+  telemetryRing.push(snapshot);
+}
+
+void sendTelemetry(uint8_t num, const char* data, size_t length) {
+  webSocket.sendTXT(num, data, length);
+}
+
+// 网络侧：只保留最新遥测，按各客户端频率发送增量
+void flushTelemetry() {
+  TelemetryState snapshot;
+  while (telemetryRing.pop(snapshot)) {
+    telemetry.update(snapshot);
+  }
+  telemetry.poll(millis(), sendTelemetry);
+}
+
+// telemetry_stats回复的各片段（缓冲区按各片段的最长输出在编译期算出，见 TextWriter.h）
+#define STATS_CLIENT_FORMAT "{\"client\":%u,\"rate\":%u,\"frames\":%u,\"bytes\":%u}"
+#define STATS_LEASE_FORMAT "],\"lease\":{\"holder\":%d,\"granted\":%u,\"rejected\":%u}"
+#define STATS_INGRESS_FORMAT ",\"ingress\":{\"frames\":%u,\"coalesced\":%u,\"priorityDropped\":%u,\"throttled\":["
+#define STATS_THROTTLED_FORMAT "{\"client\":%u,\"dropPermille\":%u,\"suggestHz\":%u}"
+#if UDP_CONTROL
+#define STATS_UDP_FORMAT "]},\"udp\":{\"accepted\":%u,\"late\":%u,\"gaps\":%u,\"foreign\":%u},"
+#else
+#define STATS_UDP_FORMAT "]},"
+#endif
+// 姿态融合：每样本周期数（主机仿真中为纳秒）与静止零偏估计（0.1°/s）
+#define STATS_FUSION_FORMAT \
+  ",\"fusion\":{\"client\":%d,\"batches\":%u,\"samples\":%u,\"cyclesPerSample\":%u,\"maxCyclesPerSample\":%u," \
+  "\"accelRejected\":%u,\"bias\":[%d,%d,%d]}}"
+
+const size_t telemetryStatsSize =
+  textFormatMaxLength("{\"telemetry\":[") +
+  WEBSOCKETS_SERVER_CLIENT_MAX * (1 + textFormatMaxLength(STATS_CLIENT_FORMAT)) +
+  textFormatMaxLength(STATS_LEASE_FORMAT) + textFormatMaxLength(STATS_INGRESS_FORMAT) +
+  WEBSOCKETS_SERVER_CLIENT_MAX * (1 + textFormatMaxLength(STATS_THROTTLED_FORMAT)) +
+  textFormatMaxLength(STATS_UDP_FORMAT) + textFormatMaxLength(HEAP_STATS_FORMAT) +
+  textFormatMaxLength(STATS_FUSION_FORMAT) + 1;
+static_assert(telemetryStatsSize <= 1536, "telemetry_stats回复超出网络任务栈上的缓冲预算");
+
+// 回复各客户端的遥测统计
+void sendTelemetryStats(uint8_t num) {
+  char buffer[telemetryStatsSize];
+  TextWriter out(buffer, sizeof(buffer));
+  out.printf("{\"telemetry\":[");
+  bool first = true;
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (!telemetry.active(i)) continue;
+    const TelemetryClientStats& st = telemetry.stats(i);
+    if (!first) out.put(',');
+    out.printf(STATS_CLIENT_FORMAT, i, (unsigned)st.rateHz, (unsigned)st.frames, (unsigned)st.bytes);
+    first = false;
+  }
+  const ControllerLease& lease = network.lease();
+  out.printf(STATS_LEASE_FORMAT, lease.holder(), (unsigned)lease.granted(), (unsigned)lease.rejected());
+  out.printf(STATS_INGRESS_FORMAT,
+             (unsigned)ingress.totalFrames(), (unsigned)ingress.totalCoalesced(), (unsigned)ingress.priorityDropped());
+  first = true;
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (!ingress.throttled(i)) continue;
+    if (!first) out.put(',');
+    out.printf(STATS_THROTTLED_FORMAT, i, (unsigned)ingress.dropPermille(i), (unsigned)ingress.suggestedHz(i));
+    first = false;
+  }
+#if UDP_CONTROL
+  const SequenceGate& udpGate = network.udpGate();
+  out.printf(STATS_UDP_FORMAT,
+             (unsigned)udpGate.accepted(), (unsigned)udpGate.late(), (unsigned)udpGate.gaps(), (unsigned)udpGate.foreign());
+#else
+  out.printf(STATS_UDP_FORMAT);
+#endif
+  network.formatHeapStats(out);
+  out.printf(STATS_FUSION_FORMAT,
+             fusionClient, (unsigned)fusionBatches, (unsigned)fusionSamples,
+             (unsigned)(fusionSamples ? fusionCycles / fusionSamples : 0), (unsigned)fusionMaxCycles,
+             (unsigned)fusion.accelRejected(), (int)(fusion.biasQ24(0) / FUSION_DECIDEG_TO_RAD_Q24),
+             (int)(fusion.biasQ24(1) / FUSION_DECIDEG_TO_RAD_Q24), (int)(fusion.biasQ24(2) / FUSION_DECIDEG_TO_RAD_Q24));
+  webSocket.sendTXT(num, buffer);
+}
+
+// 回复录制状态与flash槽位（录制计数由控制侧更新，这里只读）
+void sendMotionList(uint8_t num) {
+  char buffer[256];
+  TextWriter out(buffer, sizeof(buffer));
+  out.printf("{\"motion\":{\"recording\":%d,\"playing\":%d,\"samples\":%u,\"durationMs\":%u,\"bytes\":%u,\"dropped\":%u},\"slots\":[",
+             motionRecorder.recording() ? 1 : 0, motionPlaying ? 1 : 0,
+             (unsigned)motionRecorder.samples(), (unsigned)motionRecorder.durationMs(),
+             (unsigned)motionRecorder.bytes(), (unsigned)motionRecorder.droppedBlocks());
+  for (int i = 0; i < MOTION_SLOTS; i++) {
+    if (i) out.put(',');
+    out.printf("%u", (unsigned)motionSlotBytes(i));
+  }
+  out.printf("]}");
+  webSocket.sendTXT(num, buffer);
+}
+
+// 解析录制指令后的槽位号（如 "play_start 2"），未指定返回defaultSlot
+uint8_t parseMotionSlot(const char* message, size_t length, size_t prefixLength, uint8_t defaultSlot) {
+  if (length <= prefixLength) return defaultSlot;
+  int slot = atoi(message + prefixLength);
+  return (slot >= 0 && slot < MOTION_SLOTS) ? (uint8_t)slot : defaultSlot;
+}
+
+// 网络侧：控制帧准入检查（在解析之前调用），非控制类查询直接放行
+bool admitControl(uint8_t num, const uint8_t* payload, size_t length) {
+  static const char STATS_CMD[] = "telemetry_stats";
+  if (length == sizeof(STATS_CMD) - 1 && memcmp(payload, STATS_CMD, length) == 0) {
+    return true;
+  }
+  return network.admitControl(num);
+}
+
+// 网络侧：投递指令到控制侧（优先队列，不合并）
+void pushCommand(const ControlCommand& cmd) {
+  ingress.pushPriority(cmd);
+}
+
+// 网络侧：投递姿态帧（只保留最新一帧），合并比例越过阈值时通知客户端调整发送频率
+void pushGyroFrame(uint8_t num, const ControlCommand& cmd) {
+  ingress.pushLatest(num, cmd);
+  network.notifyBackpressure(ingress, num);
+}
+
+// 网络侧：二进制姿态帧（WebSocket或UDP）-> 指令，两种传输共用同一条流水线
+void pushAngleFrame(uint8_t num, const GyroFrame& frame) {
+  fusionClient = -1;   // 姿态角输入：退出融合模式
+  ControlCommand cmd;
+  cmd.type = CMD_GYRO;
+  cmd.flags = frame.flags;
+  cmd.seq = frame.seq;
+  cmd.clientMs = frame.timeMs;
+  cmd.arrivalUs = micros();
+  if (frame.flags & GYRO_FLAG_HAS_ENABLED) {
+    networkConfig.controlEnabled = (frame.flags & GYRO_FLAG_ENABLED) != 0;
+  }
+  for (int i = 0; i < GYRO_FRAME_AXES; i++) {
+    cmd.angleCenti[i] = frame.value[i];
+  }
+  pushGyroFrame(num, cmd);
+}
+
+// 网络侧：把融合结果（相对参考姿态的欧拉角）作为一帧姿态帧投递，序号/时间戳沿用IMU批
+void pushFusedFrame(uint8_t num, uint8_t flags, uint16_t seq, uint32_t clientMs) {
+  ControlCommand cmd;
+  cmd.type = CMD_GYRO;
+  cmd.flags = flags;
+  cmd.seq = seq;
+  cmd.clientMs = clientMs;
+  cmd.arrivalUs = micros();
+  fusion.relativeEulerCenti(cmd.angleCenti);
+  pushGyroFrame(num, cmd);
+}
+
+// 网络侧：姿态归零指令。融合模式下在这里把当前四元数设为参考，并立即投递一帧归零后的姿态，
+// 替换入口中归零前融合出的旧帧（控制侧先执行优先指令，再取最新姿态帧）
+void pushAttitudeReset() {
+  ControlCommand cmd = {};
+  cmd.type = CMD_ATTITUDE_RESET;
+  if (fusionClient >= 0) {
+    fusion.setReference();
+    cmd.flags = RESET_FLAG_QUATERNION;
+  }
+  pushCommand(cmd);
+  if (fusionClient >= 0) {
+    pushFusedFrame((uint8_t)fusionClient, 0, 0, 0);
+  }
+}
+
+// 网络侧：IMU批量帧 -> 姿态融合 -> 姿态帧（每个样本都进入滤波，只有融合结果经过入口合并）
+void pushImuBatch(uint8_t num, const ImuBatch& batch) {
+  uint32_t now = millis();
+  if (fusionClient != num || now - lastFusionMs > FUSION_IDLE_RESET_MS) {
+    fusion.reset();
+    fusionClient = num;
+  }
+  lastFusionMs = now;
+  bool wasInitialized = fusion.initialized();
+  uint32_t start = probeCycles();
+  for (int n = 0; n < batch.count; n++) {
+    fusion.update(batch.sample[n].gyro, batch.sample[n].accel, batch.intervalUs);
+  }
+  uint32_t cycles = probeCycles() - start;
+  fusionBatches++;
+  fusionSamples += batch.count;
+  fusionCycles += cycles;
+  if (cycles / batch.count > fusionMaxCycles) fusionMaxCycles = cycles / batch.count;
+  if (!fusion.initialized()) return;   // 加速度无效（失重/甩动），等待下一批初始化
+
+  if (batch.flags & GYRO_FLAG_HAS_ENABLED) {
+    networkConfig.controlEnabled = (batch.flags & GYRO_FLAG_ENABLED) != 0;
+  }
+  if (!wasInitialized) {
+    // 刚进入融合模式：以初始化时的姿态为零点，原有的逐轴偏移量清零
+    Serial.printf("[姿态融合] 客户端 #%u 开始融合，当前姿态设为零点\n", num);
+    pushAttitudeReset();
+    return;
+  }
+  pushFusedFrame(num, batch.flags, batch.seq, batch.timeMs);
+}
+
+// 网络侧：通过序号闸门和租约的UDP数据报（姿态帧或IMU批量帧）
+void onControlDatagram(uint8_t num, ControlInputKind kind, const Pipeline::Message& input) {
+  if (kind == CONTROL_INPUT_ANGLE) pushAngleFrame(num, input.frame);
+  else pushImuBatch(num, input.batch);
+}
+
+// 控制侧：执行一条指令
+void applyCommand(const ControlCommand& cmd) {
+  PROBE_SCOPE(PROBE_MAP);
+  switch (cmd.type) {
+    case CMD_GYRO:
+      if (cmd.flags & GYRO_FLAG_HAS_ENABLED) {
+        config.controlEnabled = (cmd.flags & GYRO_FLAG_ENABLED) != 0;
+      }
+      if (cmd.flags & GYRO_FLAG_TIMESTAMP) {
+        // 乱序/过期帧丢弃；其余按估计延迟外推到下一个输出节拍
+        if (predictor.observe(cmd.seq, cmd.clientMs, cmd.arrivalUs, cmd.angleCenti) != PREDICT_ACCEPTED) {
+          break;
+        }
+        appliedSeq = cmd.seq;
+        int32_t predicted[INPUT_AXES];
+        predictor.predict(controlTicker.nextUs(), predicted);
+        updateGyroData(predicted[0], predicted[1], predicted[2]);
+      } else {
+        appliedSeq = cmd.seq;
+        updateGyroData(cmd.angleCenti[0], cmd.angleCenti[1], cmd.angleCenti[2]);
+      }
+      break;
+    case CMD_SERVO_RESET:
+      servoReset();
+      break;
+    case CMD_ATTITUDE_RESET:
+      attitudeReset((cmd.flags & RESET_FLAG_QUATERNION) != 0);
+      break;
+    case CMD_RECORD_START:
+      startRecording();
+      break;
+    case CMD_RECORD_STOP:
+      stopRecording(cmd.slot);
+      break;
+    case CMD_PLAY_START:
+      startPlayback(cmd.slot);
+      break;
+    case CMD_PLAY_STOP:
+      stopPlayback();
+      break;
+  }
+}
+
+// 控制侧：应用网络侧下发的配置（偏移量由姿态归零维护，不随配置覆盖）
+void applyConfig(const SystemConfig& settings) {
+  config.controlEnabled = settings.controlEnabled;
+  config.operationLocked = settings.operationLocked;
+  config.channelCount = constrain(settings.channelCount, 0, OUTPUT_CHANNELS);
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    ChannelConfig& ch = config.channels[i];
+    const ChannelConfig& src = settings.channels[i];
+    ch.rate = src.rate;
+    ch.minPulse = src.minPulse;
+    ch.maxPulse = src.maxPulse;
+    ch.pin = src.pin;
+    ch.axis = src.axis;
+    ch.filter = src.filter;
+    ch.deadband = src.deadband;
+    sanitizeChannel(ch);
+  }
+  attachChannels();
+  configureFilters();
+  configDebouncer.markDirty(millis());
+}
+
+// 读取上次保存的配置与校准（无效时保留默认配置）
+void loadConfig() {
+  SystemConfig stored;
+  ConfigLoadResult result = loadStoredConfig(CONFIG_KEY, CONFIG_VERSION, stored);
+  Serial.printf("[配置] 读取NVS: %s\n", configLoadResultName(result));
+  if (result != CONFIG_LOADED) return;
+  
+  config.controlEnabled = stored.controlEnabled;
+  config.channelCount = constrain(stored.channelCount, 0, OUTPUT_CHANNELS);
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    ChannelConfig& ch = config.channels[i];
+    ch = stored.channels[i];
+    ch.rawCenti = 0;
+    ch.mappedCenti = 0;
+    ch.tracking = false;
+    sanitizeChannel(ch);
+  }
+}
+
+// 写入NVS（由控制环在配置稳定后调用）
+void saveConfig() {
+  bool ok = storeConfig(CONFIG_KEY, CONFIG_VERSION, config);
+  Serial.printf("[配置] 写入NVS%s（第%u次）\n", ok ? "成功" : "失败", configDebouncer.commits());
+}
+
+// 配置消息字段表：按(所在对象, 键)的哈希定位到SystemConfig中的成员
+#define CONFIG_FIELD(parent, key, type, member) \
+  { parent, jsonKeyHash(key), type, (uint16_t)offsetof(SystemConfig, member) }
+// 通道对象的键为 ch0~ch15，pitch/roll/yaw 分别是 ch0/ch1/ch2 的别名（兼容原配置消息）
+#define CHANNEL_FIELDS(name, idx) \
+  CONFIG_FIELD(jsonKeyHash(name), "rate", JSON_FIELD_FLOAT, channels[idx].rate), \
+  CONFIG_FIELD(jsonKeyHash(name), "minPulse", JSON_FIELD_INT, channels[idx].minPulse), \
+  CONFIG_FIELD(jsonKeyHash(name), "maxPulse", JSON_FIELD_INT, channels[idx].maxPulse), \
+  CONFIG_FIELD(jsonKeyHash(name), "pin", JSON_FIELD_INT, channels[idx].pin), \
+  CONFIG_FIELD(jsonKeyHash(name), "axis", JSON_FIELD_INT, channels[idx].axis), \
+  CONFIG_FIELD(jsonKeyHash(name), "filterMode", JSON_FIELD_INT, channels[idx].filter.mode), \
+  CONFIG_FIELD(jsonKeyHash(name), "filterAlpha", JSON_FIELD_FLOAT, channels[idx].filter.alpha), \
+  CONFIG_FIELD(jsonKeyHash(name), "minCutoff", JSON_FIELD_FLOAT, channels[idx].filter.minCutoff), \
+  CONFIG_FIELD(jsonKeyHash(name), "beta", JSON_FIELD_FLOAT, channels[idx].filter.beta), \
+  CONFIG_FIELD(jsonKeyHash(name), "slewLimit", JSON_FIELD_INT, channels[idx].filter.slewLimit), \
+  CONFIG_FIELD(jsonKeyHash(name), "deadband", JSON_FIELD_FLOAT, channels[idx].deadband)
+
+static const JsonField CONFIG_FIELDS[] = {
+  CONFIG_FIELD(JSON_ROOT, "controlEnabled", JSON_FIELD_FLAG, controlEnabled),
+  CONFIG_FIELD(JSON_ROOT, "operationLocked", JSON_FIELD_FLAG, operationLocked),
+  CONFIG_FIELD(JSON_ROOT, "channelCount", JSON_FIELD_INT, channelCount),
+  CHANNEL_FIELDS("pitch", 0),
+  CHANNEL_FIELDS("roll", 1),
+  CHANNEL_FIELDS("yaw", 2),
+  CHANNEL_FIELDS("ch0", 0),   CHANNEL_FIELDS("ch1", 1),   CHANNEL_FIELDS("ch2", 2),
+  CHANNEL_FIELDS("ch3", 3),   CHANNEL_FIELDS("ch4", 4),   CHANNEL_FIELDS("ch5", 5),
+  CHANNEL_FIELDS("ch6", 6),   CHANNEL_FIELDS("ch7", 7),   CHANNEL_FIELDS("ch8", 8),
+  CHANNEL_FIELDS("ch9", 9),   CHANNEL_FIELDS("ch10", 10), CHANNEL_FIELDS("ch11", 11),
+  CHANNEL_FIELDS("ch12", 12), CHANNEL_FIELDS("ch13", 13), CHANNEL_FIELDS("ch14", 14),
+  CHANNEL_FIELDS("ch15", 15),
+};
+
+// 解析JSON配置数据（单遍扫描payload，不拷贝、不分配内存），结果作为指令交给控制侧
+void parseConfigData(const uint8_t* payload, size_t length) {
+  int fields = jsonScanFields(payload, length, CONFIG_FIELDS,
+                              sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]), &networkConfig);
+  if (fields < 0) {
+    Serial.println("[配置] JSON格式错误，已忽略剩余字段");
+  }
+  
+  configSlot.publish(networkConfig);  // 控制侧未取走的旧配置被覆盖，不会因队列满而丢掉最新配置
+}
+
+// 文本指令匹配（payload以'\0'结尾，直接比较，不构造String）
+bool isCommand(const char* message, const char* command) {
+  return strcmp(message, command) == 0;
+}
+
+bool hasCommandPrefix(const char* message, const char* prefix) {
+  return strncmp(message, prefix, strlen(prefix)) == 0;
+}
+
+// WebSocket事件处理
+void onWebSocketEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
+  PROBE_SCOPE(PROBE_WS_EVENT);
+  switch (type) {
+    case WStype_DISCONNECTED:
+      Serial.printf("[WebSocket] 客户端 #%u 断开连接\n", num);
+      telemetry.disconnect(num);
+      network.lease().release(num);
+      ingress.reset(num);
+      if (fusionClient == num) fusionClient = -1;
+      break;
+    case WStype_CONNECTED:
+      {
+        IPAddress ip = webSocket.remoteIP(num);
+        Serial.printf("[WebSocket] 客户端 #%u 连接, IP地址: %u.%u.%u.%u\n", num, ip[0], ip[1], ip[2], ip[3]);
+        // 发送欢迎消息和当前配置
+        webSocket.sendTXT(num, "Connected to ESP32 WebSocket Server");
+        // 连接URL中可携带遥测频率，如 ws://192.168.4.1:81/?rate=20
+        uint32_t rate = parseTelemetryRate(payload, length);
+        telemetry.connect(num, rate);
+        Serial.printf("[WebSocket] 客户端 #%u 遥测频率: %uHz\n", num, (unsigned)rate);
+      }
+      break;
+    case WStype_TEXT:
+      {
+        // 非租约持有者的控制帧在解析前直接丢弃
+        if (!admitControl(num, payload, length)) {
+          break;
+        }
+        
+        // 库保证文本帧payload以'\0'结尾：直接在接收缓冲区上匹配和解析，不拷贝、不分配内存
+        const char* message = (const char*)payload;
+        networkLog.recordText(LOG_WS_TEXT, micros(), num, (int32_t)length, message, length);
+        
+        // 解析JSON数据：一遍扫描按顶层键分类（配置：有controlEnabled且没有enabled；姿态：有pitch、roll、yaw），
+        // 姿态消息同时解码成与二进制姿态帧相同的GyroFrame，两种通道共用pushAngleFrame（同一姿态得到同一条指令）
+        if (message[0] == '{') {
+          PROBE_SCOPE(PROBE_PARSE);
+          HeapFrameScope heapScope(network.heap(), readFreeHeap);
+          Pipeline::Message input;
+          switch (Pipeline::decodeText(payload, length, input)) {
+            case CONTROL_INPUT_CONFIG:
+              // operationLocked只是网页端的界面锁（禁止改配置），锁定后页面仍发送姿态，不影响控制权
+              parseConfigData(payload, length);
+              break;
+            case CONTROL_INPUT_ANGLE:
+              pushAngleFrame(num, input.frame);
+              break;
+            default:
+              break;
+          }
+        }
+        
+        // 处理控制指令
+        if (isCommand(message, "reset_servo")) {
+          Serial.println("[控制指令] 舵机回中");
+          ControlCommand cmd = {};
+          cmd.type = CMD_SERVO_RESET;
+          pushCommand(cmd);
+          webSocket.sendTXT(num, "Servo reset");
+        } else if (isCommand(message, "reset_attitude")) {
+          Serial.println("[控制指令] 姿态归零");
+          pushAttitudeReset();
+          webSocket.sendTXT(num, "Attitude reset");
+        } else if (isCommand(message, "telemetry_stats")) {
+          sendTelemetryStats(num);
+        } else if (isCommand(message, "record_start")) {
+          ControlCommand cmd = {};
+          cmd.type = CMD_RECORD_START;
+          pushCommand(cmd);
+          webSocket.sendTXT(num, "Recording started");
+        } else if (hasCommandPrefix(message, "record_stop")) {
+          // "record_stop [槽位]"，默认槽位0
+          ControlCommand cmd = {};
+          cmd.type = CMD_RECORD_STOP;
+          cmd.slot = parseMotionSlot(message, length, 12, 0);
+          pushCommand(cmd);
+          webSocket.sendTXT(num, "Recording stopped");
+        } else if (hasCommandPrefix(message, "play_start")) {
+          // "play_start" 回放RAM中的录制，"play_start N" 回放flash槽位N
+          ControlCommand cmd = {};
+          cmd.type = CMD_PLAY_START;
+          cmd.slot = parseMotionSlot(message, length, 11, MOTION_SLOT_RAM);
+          pushCommand(cmd);
+          webSocket.sendTXT(num, "Playback started");
+        } else if (isCommand(message, "play_stop")) {
+          ControlCommand cmd = {};
+          cmd.type = CMD_PLAY_STOP;
+          pushCommand(cmd);
+          webSocket.sendTXT(num, "Playback stopped");
+        } else if (isCommand(message, "record_list")) {
+          sendMotionList(num);
+        }
+      }
+      break;
+    case WStype_BIN:
+      {
+        // 二进制姿态帧/IMU批量帧：直接在payload上解码，不经过String
+        if (!admitControl(num, payload, length)) {
+          break;
+        }
+        PROBE_SCOPE(PROBE_PARSE);
+        HeapFrameScope heapScope(network.heap(), readFreeHeap);
+        Pipeline::Message input;
+        switch (Pipeline::decodeBinary(payload, length, input)) {
+          case CONTROL_INPUT_ANGLE:
+            pushAngleFrame(num, input.frame);
+            break;
+          case CONTROL_INPUT_IMU_BATCH:
+            pushImuBatch(num, input.batch);
+            break;
+          default:
+            break;
+        }
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// 初始化配置
+void initConfig() {
+  // 系统配置
+  config.controlEnabled = true;     // 默认启用控制
+  config.operationLocked = true;    // 默认锁定
+  
+  // 通道表：前三路默认跟随pitch/roll/yaw，其余未启用
+  config.channelCount = DEFAULT_CHANNEL_COUNT;
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    config.channels[i] = (i < DEFAULT_CHANNEL_COUNT)
+      ? defaultChannelConfig(DEFAULT_SERVO_PINS[i], i)
+      : defaultChannelConfig(-1, AXIS_PITCH);
+  }
+  for (int i = 0; i < INPUT_AXES; i++) {
+    axisCenti[i] = 0;
+  }
+  
+  PredictorConfig predict = defaultPredictorConfig();
+  predict.baseDelayUs = PREDICT_BASE_DELAY_US;
+  predict.maxHorizonUs = PREDICT_MAX_HORIZON_US;
+  predict.staleUs = PREDICT_STALE_US;
+  predictor.configure(predict);
+}
+
+// 控制侧初始化：默认配置，再用NVS中保存的配置覆盖（在initPWM之前，舵机直接以校准后的参数上电）
+void setupControl() {
+  initConfig();
+  loadConfig();
+  networkConfig = config;
+  configureFilters();
+  initPWM();
+}
+
+// 姿态融合统计（有新的IMU批时才打印，网络侧）
+void printFusionStats() {
+  if (fusionBatches == lastFusionBatches) return;
+  Serial.printf("[姿态融合] 批: %u, 样本: %u, 每样本周期: %u (最大%u), 加速度未用: %u\n",
+                (unsigned)fusionBatches, (unsigned)fusionSamples,
+                (unsigned)(fusionSamples ? fusionCycles / fusionSamples : 0), (unsigned)fusionMaxCycles,
+                (unsigned)fusion.accelRejected());
+  lastFusionBatches = fusionBatches;
+}
+
+#else
+// ===================== 脉宽输入 =====================
+// 舵机通道缓存（存储最新的引脚和脉宽），数组下标即PWM通道号
+struct ServoChannel {
+  int pin = -1;    // 引脚（-1表示未配置）
+  int pulseUs = SERVO_CENTER_PULSE; // 脉宽（默认中位1500us）
+  FilterConfig filter = defaultFilterConfig(); // 当前滤波配置（持久化用）
+  Trajectory trajectory; // 关键帧轨迹（控制环节拍内插值）
+  bool trajectoryActive = false;
+  bool trajectoryOwned = false;  // 当前脉宽来自轨迹（运行中或已走完停在末帧）
+  uint32_t trajectoryStartMs = 0;
+  int commandUs = -1;            // 上次直接下发的脉宽（-1为尚未下发）
+} servos[MAX_SERVO_CHANNELS];
+
+// 舵机目标脉宽（WebSocket回调 -> 控制环）
+struct ServoTarget {
+  int pulseUs[MAX_SERVO_CHANNELS]; // 各通道脉宽
+};
+
+// 网络侧 -> 控制侧的已解码指令（引脚为-1的通道不更新）
+struct PulseCommand {
+  int8_t pin[MAX_SERVO_CHANNELS];
+  int16_t pulseUs[MAX_SERVO_CHANNELS];
+};
+
+// 关键帧轨迹（一条消息可为多个通道各下发一条，同一消息内的轨迹同时开始）
+struct TrajectoryCommand {
+  uint8_t channel;
+  int8_t pin;              // -1为沿用当前引脚
+  uint8_t mode;            // TrajectoryMode
+  uint8_t count;           // 关键帧数
+  uint32_t startMs;        // 开始时刻（网络侧收到消息的时刻）
+  TrajectoryKey keys[TRAJECTORY_MAX_KEYS];
+};
+
+// 持久化的舵机设置（脉宽是流式数据，不保存）
+struct StoredServos {
+  int8_t pin[MAX_SERVO_CHANNELS];
+  FilterConfig filter[MAX_SERVO_CHANNELS];
+};
+
+// 网络侧滤波配置影子（配置键可以只下发一部分）
+FilterConfig networkFilters[MAX_SERVO_CHANNELS];
+
+// 脉宽帧合并：新帧中引脚不为-1的通道覆盖旧帧，其余通道保留旧帧中尚未生效的设定
+struct PulseCommandMerge {
+  void operator()(PulseCommand& pending, const PulseCommand& newer) const {
+    for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+      if (newer.pin[i] == -1) continue;
+      pending.pin[i] = newer.pin[i];
+      pending.pulseUs[i] = newer.pulseUs[i];
+    }
+  }
+};
+
+// 入口队列：脉宽帧按客户端只保留最新一帧（网络侧 -> 控制侧）
+IngressQueue<PulseCommand, INGRESS_SLOTS, 4, PulseCommandMerge> ingress;
+// 滤波配置变更（低频，按通道只传最新一份，避免每条脉宽指令都携带；
+// 一条消息可改全部16个通道，控制侧来不及取走时旧配置被覆盖而不是因队列满丢掉新配置）
+LatestSlot<FilterConfig> filterSlots[MAX_SERVO_CHANNELS];
+SpscRing<TrajectoryCommand, MAX_SERVO_CHANNELS> trajectoryRing; // 一条消息最多每通道一条，整条放得下才入队
+Mailbox<ServoTarget> servoMailbox;           // 单槽邮箱，只保留最新目标
+ServoTarget currentTarget;                   // 控制环当前目标
+
+// ===================== 工具函数 =====================
+// 初始化PWM通道（按下标绑定引脚，引脚变化时重新绑定），输出由控制环统一写入
+// 超出编译期输出通道数（SERVO_OUTPUT_CHANNELS）的通道只记录引脚，不绑定
+void updatePWMChannel(int channel) {
+  ServoChannel& sc = servos[channel];
+  if (sc.pin == -1 || channel >= OUTPUT_CHANNELS) return;
+  
+  if (!pipeline.output().attached(channel)) {
+    ledcSetup(channel, PWM_FREQUENCY, PWM_RESOLUTION);
+  }
+  ledcAttachPin(sc.pin, channel);
+  pipeline.output().attach(channel, true);
+  outputDirty = true;
+}
+
+// 所有已绑定通道的滤波器都已收敛（不编译滤波时恒为true）
+bool filtersSettled() {
+  return pipeline.output().settled();
+}
+
+// 投递各通道最新脉宽到控制环
+void postServoTarget() {
+  ServoTarget target;
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    target.pulseUs[i] = servos[i].pulseUs;
+  }
+  servoMailbox.post(target);
+}
+
+// 控制侧：通道绑定到新引脚（引脚不变时不操作），返回是否变化
+bool bindChannelPin(int channel, int pin) {
+  ServoChannel& sc = servos[channel];
+  if (sc.pin == pin) return false;
+  if (sc.pin != -1) {
+    ledcDetachPin(sc.pin);
+  }
+  sc.pin = pin;
+  updatePWMChannel(channel);
+  configDebouncer.markDirty(millis());
+  return true;
+}
+
+// 控制侧：执行一条脉宽指令（引脚绑定也在控制侧完成）；没有任何通道变化时不投递
+// 流式帧每帧都带着各通道的脉宽：与上次直接下发相同的脉宽只是重复，不取代该通道的轨迹
+// （运行中的或已走完停在末帧的）；脉宽改变才取代轨迹
+void applyCommand(const PulseCommand& cmd) {
+  PROBE_SCOPE(PROBE_MAP);
+  bool changed = false;
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    if (cmd.pin[i] == -1) continue;
+    ServoChannel& sc = servos[i];
+    bool repeated = (cmd.pulseUs[i] == sc.commandUs);
+    sc.commandUs = cmd.pulseUs[i];
+    if (!repeated || !sc.trajectoryOwned) {
+      sc.trajectoryActive = false;
+      sc.trajectoryOwned = false;
+      if (sc.pulseUs != cmd.pulseUs[i]) changed = true;
+      sc.pulseUs = cmd.pulseUs[i];
+    }
+    if (bindChannelPin(i, cmd.pin[i])) changed = true;
+  }
+  frameStats.record(changed);
+  if (changed || !hasTarget) {
+    postServoTarget();
+  }
+}
+
+// 控制侧：载入一条轨迹
+void applyTrajectory(const TrajectoryCommand& cmd) {
+  if (cmd.channel >= MAX_SERVO_CHANNELS) return;
+  ServoChannel& sc = servos[cmd.channel];
+  if (!sc.trajectory.load(cmd.keys, cmd.count, cmd.mode)) {
+    Serial.printf("[轨迹] 通道%u关键帧无效，已忽略\n", cmd.channel);
+    return;
+  }
+  if (cmd.pin >= 0) {
+    bindChannelPin(cmd.channel, cmd.pin);
+  }
+  sc.trajectoryActive = true;
+  sc.trajectoryOwned = true;
+  sc.trajectoryStartMs = cmd.startMs;
+  Serial.printf("[轨迹] 通道%u：%d个关键帧，时长%ums\n", cmd.channel, cmd.count, sc.trajectory.durationMs());
+}
+
+// 控制侧：按当前时刻插值各轨迹通道的目标脉宽，返回本节拍是否有轨迹在运行
+bool runTrajectories(uint32_t nowMs) {
+  bool running = false;
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    ServoChannel& sc = servos[i];
+    if (!sc.trajectoryActive) continue;
+    int32_t elapsed = (int32_t)(nowMs - sc.trajectoryStartMs);
+    uint32_t t = elapsed > 0 ? (uint32_t)elapsed : 0;
+    sc.pulseUs = sc.trajectory.sample(t);
+    currentTarget.pulseUs[i] = sc.pulseUs;
+    if (sc.trajectory.finished(t)) {
+      sc.trajectoryActive = false;
+    }
+    running = true;
+  }
+  return running;
+}
+
+// 读取上次保存的引脚与滤波配置（无效时使用默认引脚12/13/14）
+void loadServoSettings() {
+  StoredServos stored;
+  ConfigLoadResult result = loadStoredConfig(CONFIG_KEY, CONFIG_VERSION, stored);
+  Serial.printf("[配置] 读取NVS: %s\n", configLoadResultName(result));
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    if (result == CONFIG_LOADED) {
+      servos[i].pin = stored.pin[i];
+      servos[i].filter = stored.filter[i];
+    } else {
+      servos[i].pin = (i < DEFAULT_CHANNEL_COUNT) ? DEFAULT_SERVO_PINS[i] : -1;
+      servos[i].filter = defaultFilterConfig();
+    }
+    networkFilters[i] = servos[i].filter;
+    pipeline.output().configure(i, servos[i].filter, controlTicker.periodUs());
+  }
+}
+
+// 写入NVS（由控制环在设置稳定后调用）
+void saveServoSettings() {
+  StoredServos stored;
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    stored.pin[i] = servos[i].pin;
+    stored.filter[i] = servos[i].filter;
+  }
+  bool ok = storeConfig(CONFIG_KEY, CONFIG_VERSION, stored);
+  Serial.printf("[配置] 写入NVS%s（第%u次）\n", ok ? "成功" : "失败", configDebouncer.commits());
+}
+
+// 控制环：先执行队列中的指令，再按固定频率取最新目标，仅写入占空比有变化的通道
+void controlLoop() {
+  FilterConfig filter;
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    if (!filterSlots[i].take(filter)) continue;
+    servos[i].filter = filter;
+    pipeline.output().configure(i, filter, controlTicker.periodUs());
+    configDebouncer.markDirty(millis());
+    outputDirty = true;
+  }
+  
+  // 设置稳定后写入NVS（流式更新期间不会反复擦写flash）
+  if (configDebouncer.due(millis())) {
+    saveServoSettings();
+  }
+  
+  if (!controlTicker.due(micros())) return;
+  
+  // 每个节拍只取各客户端的最新脉宽帧（节拍之间到达的旧帧已在入口合并），再载入新轨迹
+  PulseCommand cmd;
+  for (uint8_t i = 0; i < INGRESS_SLOTS; i++) {
+    if (ingress.takeLatest(i, cmd)) {
+      applyCommand(cmd);
+    }
+  }
+  
+  TrajectoryCommand trajectory;
+  while (trajectoryRing.pop(trajectory)) {
+    applyTrajectory(trajectory);
+  }
+  
+  // 没有新目标时继续运行滤波向上一个目标收敛，收敛后整个PWM阶段跳过
+  // 轨迹通道每个节拍在设备端插值，覆盖邮箱目标中的对应通道
+  bool fresh = servoMailbox.take(currentTarget);
+  if (runTrajectories(millis())) {
+    fresh = true;
+  }
+  if (fresh) {
+    hasTarget = true;
+  }
+  bool active = hasTarget && (fresh || outputDirty || !filtersSettled());
+  tickStats.record(active);
+  if (active) {
+    PROBE_SCOPE(PROBE_PWM);
+    outputDirty = false;
+    // 只处理已绑定通道：滤波 -> 占空比（20ms周期对应满量程） -> 未变化则跳过写入
+    pipeline.output().write(currentTarget.pulseUs);
+  }
+  
+  unsigned long now = millis();
+  if (now - lastStatsTime >= STATS_INTERVAL) {
+    Serial.printf("[控制环] 输入:%u 合并:%u 写入:%u 跳过:%u 超时:%u 入口合并:%u/%u\n",
+                  servoMailbox.posted(), servoMailbox.coalesced(),
+                  pipeline.output().written(), pipeline.output().skipped(), controlTicker.overruns(),
+                  ingress.totalCoalesced(), ingress.totalFrames());
+    Serial.printf("[抑制] 指令:%u/%u (%u.%u%%) 空闲节拍:%u/%u (%u.%u%%)\n",
+                  frameStats.suppressed(), frameStats.total(),
+                  frameStats.permille() / 10, frameStats.permille() % 10,
+                  tickStats.suppressed(), tickStats.total(),
+                  tickStats.permille() / 10, tickStats.permille() % 10);
+    lastStatsTime = now;
+  }
+}
+
+// 解析某通道的滤波配置键（如 P-FILTER/P-ALPHA/P-MINCUT/P-BETA/P-SLEW、CH5-FILTER），有任一键返回true
+template <typename Doc>
+bool parseFilterKeys(Doc& doc, const char* prefix, FilterConfig& cfg) {
+  char key[16];
+  bool found = false;
+  snprintf(key, sizeof(key), "%s-FILTER", prefix);
+  if (doc.containsKey(key)) { cfg.mode = doc[key]; found = true; }
+  snprintf(key, sizeof(key), "%s-ALPHA", prefix);
+  if (doc.containsKey(key)) { cfg.alpha = doc[key]; found = true; }
+  snprintf(key, sizeof(key), "%s-MINCUT", prefix);
+  if (doc.containsKey(key)) { cfg.minCutoff = doc[key]; found = true; }
+  snprintf(key, sizeof(key), "%s-BETA", prefix);
+  if (doc.containsKey(key)) { cfg.beta = doc[key]; found = true; }
+  snprintf(key, sizeof(key), "%s-SLEW", prefix);
+  if (doc.containsKey(key)) { cfg.slewLimit = doc[key]; found = true; }
+  return found;
+}
+
+// 解析通道表形式的指令："PIN":[...]、"PWM":[...]，下标即通道号，引脚为-1的通道不更新
+template <typename Doc>
+void parseChannelArrays(Doc& doc, PulseCommand& cmd) {
+  JsonArrayConst pins = doc["PIN"];
+  JsonArrayConst pulses = doc["PWM"];
+  if (pins.isNull() || pulses.isNull()) return;
+  int count = (int)pins.size();
+  if ((int)pulses.size() < count) count = (int)pulses.size();
+  if (count > MAX_SERVO_CHANNELS) count = MAX_SERVO_CHANNELS;
+  for (int i = 0; i < count; i++) {
+    cmd.pin[i] = pins[i] | -1;
+    cmd.pulseUs[i] = pulses[i] | SERVO_CENTER_PULSE;
+  }
+}
+
+// 解析轨迹指令，整条消息交给控制侧，返回轨迹条数（没有TRAJ键为0）：
+// "TRAJ":[{"CH":0,"MODE":2,"T":[0,500,1000],"P":[1500,2000,1500],"PIN":12}, ...]
+// MODE：0线性、1三次、2最小加加速度；T为相对消息到达时刻的ms，须严格递增；PIN可省略。
+// 同一消息内的轨迹同时开始，所以要么全部入队、要么全部拒绝：有任何一条无效、超过通道数
+// 或队列剩余空间不够时返回-1，error指向拒绝原因
+template <typename Doc>
+int parseTrajectories(Doc& doc, uint32_t nowMs, const char*& error) {
+  static TrajectoryCommand staged[MAX_SERVO_CHANNELS];   // 仅网络侧使用
+  static Trajectory validator;
+  JsonArrayConst list = doc["TRAJ"];
+  if (list.isNull()) return 0;
+  if (list.size() > (size_t)MAX_SERVO_CHANNELS) {
+    error = "too many trajectories";
+    return -1;
+  }
+  int items = (int)list.size();
+  for (int k = 0; k < items; k++) {
+    JsonObjectConst item = list[k];
+    JsonArrayConst times = item["T"];
+    JsonArrayConst pulses = item["P"];
+    int channel = item["CH"] | -1;
+    if (channel < 0 || channel >= MAX_SERVO_CHANNELS || times.isNull() || pulses.isNull()) {
+      error = "invalid channel or keys";
+      return -1;
+    }
+    TrajectoryCommand& cmd = staged[k];
+    cmd.channel = (uint8_t)channel;
+    cmd.pin = (int8_t)(item["PIN"] | -1);
+    cmd.mode = (uint8_t)(item["MODE"] | (int)TRAJ_MIN_JERK);
+    cmd.startMs = nowMs;
+    int count = (int)times.size();
+    if ((int)pulses.size() < count) count = (int)pulses.size();
+    if (count > TRAJECTORY_MAX_KEYS) count = TRAJECTORY_MAX_KEYS;
+    for (int i = 0; i < count; i++) {
+      cmd.keys[i].timeMs = (uint32_t)(times[i] | 0);
+      cmd.keys[i].pulseUs = pulses[i] | SERVO_CENTER_PULSE;
+    }
+    cmd.count = (uint8_t)count;
+    if (!validator.load(cmd.keys, count, cmd.mode)) {
+      error = "invalid keys";
+      return -1;
+    }
+  }
+  if (trajectoryRing.capacity() - trajectoryRing.size() < (uint32_t)items) {
+    error = "queue full";
+    return -1;
+  }
+  for (int k = 0; k < items; k++) trajectoryRing.push(staged[k]);
+  return items;
+}
+
+// 初始化一条空指令（全部通道不更新）
+void clearPulseCommand(PulseCommand& cmd) {
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    cmd.pin[i] = -1;
+    cmd.pulseUs[i] = SERVO_CENTER_PULSE;
+  }
+}
+
+// 网络侧：投递脉宽帧（只保留最新一帧），合并比例越过阈值时通知客户端调整发送间隔
+void pushPulseFrame(uint8_t num, const PulseCommand& cmd) {
+  bool any = false;
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    if (cmd.pin[i] != -1) any = true;
+  }
+  if (!any) return;   // 仅含滤波/轨迹的消息不占用脉宽槽
+  ingress.pushLatest(num, cmd);
+  network.notifyBackpressure(ingress, num);
+}
+
+// 网络侧：二进制脉宽帧（WebSocket或UDP）-> 指令，两种传输共用同一条流水线
+void pushBinaryPulseFrame(uint8_t num, const GyroFrame& frame) {
+  PulseCommand cmd;
+  clearPulseCommand(cmd);
+  Pipeline::Mapping::map(frame, cmd);
+  pushPulseFrame(num, cmd);
+}
+
+// 网络侧：通过序号闸门和租约的UDP数据报（脉宽帧）
+void onControlDatagram(uint8_t num, ControlInputKind, const Pipeline::Message& input) {
+  pushBinaryPulseFrame(num, input.frame);
+}
+
+// 回复堆健康（heap_stats指令）
+void sendHeapStats(uint8_t num) {
+  char buffer[textFormatMaxLength(HEAP_STATS_FORMAT) + 3];
+  TextWriter out(buffer, sizeof(buffer));
+  out.put('{');
+  network.formatHeapStats(out);
+  out.put('}');
+  webSocket.sendTXT(num, buffer);
+}
+
+// WebSocket事件处理（核心：解析网页下发的脉宽指令）
+void onWebSocketEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
+  PROBE_SCOPE(PROBE_WS_EVENT);
+  switch (type) {
+    case WStype_DISCONNECTED:
+      Serial.printf("[WS] 客户端 #%u 断开连接\n", num);
+      network.lease().release(num);
+      ingress.reset(num);
+      break;
+      
+    case WStype_CONNECTED: {
+      IPAddress ip = webSocket.remoteIP(num);
+      Serial.printf("[WS] 客户端 #%u 连接 (IP: %u.%u.%u.%u)\n", num, ip[0], ip[1], ip[2], ip[3]);
+      webSocket.sendTXT(num, "ESP32 Servo Controller Ready");
+      break;
+    }
+      
+    case WStype_TEXT: {
+      // 非持有者的控制帧在解析前直接丢弃（映射归零仅回执，不受限制）
+      static const char RESET_MAPPING[] = "reset_mapping";
+      static const char HEAP_STATS[] = "heap_stats";
+      bool isResetMapping = (length == sizeof(RESET_MAPPING) - 1 && memcmp(payload, RESET_MAPPING, length) == 0);
+      if (length == sizeof(HEAP_STATS) - 1 && memcmp(payload, HEAP_STATS, length) == 0) {
+        sendHeapStats(num);   // 只读查询，不受租约限制
+        break;
+      }
+      if (!isResetMapping && !network.admitControl(num)) break;
+      
+      PROBE_SCOPE(PROBE_PARSE);
+      HeapFrameScope heapScope(network.heap(), readFreeHeap);
+      static StaticJsonDocument<3072> doc;   // 容纳16通道的PIN/PWM数组或4条16关键帧的轨迹；静态，不占回调栈
+      // 直接解析payload（const指针让ArduinoJson复制字符串，不改写接收缓冲区）
+      DeserializationError err = deserializeJson(doc, (const char*)payload, length);
+      
+      // 解析成功则把舵机参数交给控制侧
+      if (!err) {
+        PulseCommand cmd;
+        clearPulseCommand(cmd);
+        // 通道表形式（可覆盖全部通道），随后的P/R/Y键优先
+        parseChannelArrays(doc, cmd);
+        // 解析Pitch通道
+        if (doc.containsKey("P-PIN") && doc.containsKey("P-PWM")) {
+          cmd.pin[0] = doc["P-PIN"];
+          cmd.pulseUs[0] = doc["P-PWM"];
+        }
+        // 解析Roll通道
+        if (doc.containsKey("R-PIN") && doc.containsKey("R-PWM")) {
+          cmd.pin[1] = doc["R-PIN"];
+          cmd.pulseUs[1] = doc["R-PWM"];
+        }
+        // 解析Yaw通道
+        if (doc.containsKey("Y-PIN") && doc.containsKey("Y-PWM")) {
+          cmd.pin[2] = doc["Y-PIN"];
+          cmd.pulseUs[2] = doc["Y-PWM"];
+        }
+        // 解析各通道滤波配置（P/R/Y为通道0/1/2的别名，其余通道用CHn前缀）
+        static const char* const prefixes[MAX_SERVO_CHANNELS] = {
+          "P", "R", "Y", "CH3", "CH4", "CH5", "CH6", "CH7",
+          "CH8", "CH9", "CH10", "CH11", "CH12", "CH13", "CH14", "CH15"
+        };
+        for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+          if (parseFilterKeys(doc, prefixes[i], networkFilters[i])) {
+            filterSlots[i].publish(networkFilters[i]);
+          }
+        }
+        pushPulseFrame(num, cmd);
+        
+        // 关键帧轨迹（设备端插值）
+        const char* trajectoryError = "";
+        int trajectories = parseTrajectories(doc, millis(), trajectoryError);
+        if (trajectories != 0) {
+          char ack[48];
+          if (trajectories > 0) snprintf(ack, sizeof(ack), "Trajectory accepted: %d", trajectories);
+          else snprintf(ack, sizeof(ack), "Trajectory rejected: %s", trajectoryError);
+          webSocket.sendTXT(num, ack);
+        }
+        
+        // 调试信息（延迟输出）
+        networkLog.record(LOG_PULSE_FRAME, micros(), cmd.pin[0], cmd.pulseUs[0],
+                          cmd.pin[1], cmd.pulseUs[1], cmd.pin[2], cmd.pulseUs[2]);
+      }
+      
+      // 处理指令（映射归零仅需网页端处理，这里仅回执）
+      if (isResetMapping) {
+        webSocket.sendTXT(num, "Mapping Reset ACK");
+        Serial.println("[CMD] 收到映射归零指令（网页端处理）");
+      }
+      break;
+    }
+    
+    case WStype_BIN: {
+      // 二进制脉宽帧：直接在payload上解码（引脚为-1的通道不更新）
+      if (!network.admitControl(num)) break;
+      PROBE_SCOPE(PROBE_PARSE);
+      HeapFrameScope heapScope(network.heap(), readFreeHeap);
+      Pipeline::Message input;
+      if (Pipeline::decodeBinary(payload, length, input) != CONTROL_INPUT_PULSE) break;
+      pushBinaryPulseFrame(num, input.frame);
+      break;
+    }
+    
+    default: break;
+  }
+}
+
+// 控制侧初始化：舵机中位（引脚取NVS中保存的设置，默认12/13/14，可被网页覆盖）
+void setupControl() {
+  loadServoSettings();
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    updatePWMChannel(i);
+  }
+  postServoTarget();
+}
+
+#endif
+
+// 双核模式下的网络任务（核0）
+const TaskLoop NETWORK_TASK = { networkLoop, 1 };
+
+// ===================== 初始化 =====================
+void setup() {
+  // 初始化串口
+  Serial.begin(115200);
+  Serial.printf("\n%s 启动中...\n", FIRMWARE_NAME);
+  
+  // 控制侧（配置、PWM通道、舵机初始位置）
+  setupControl();
+  
+  // 配置WiFi热点
+  WiFi.softAPConfig(AP_IP, AP_GW, AP_SUBNET);
+  WiFi.softAP(AP_SSID, AP_PASS);
+  
+  // 等待热点启动
+  delay(1000);
+  
+  IPAddress apIP = WiFi.softAPIP();
+  Serial.printf("[WiFi热点] SSID: %s, IP地址: %u.%u.%u.%u\n", AP_SSID, apIP[0], apIP[1], apIP[2], apIP[3]);
+  
+  // DNS（所有域名重定向到ESP32）、Web服务器、WebSocket服务器、UDP控制通道
+  static const EmbeddedPage page = { INDEX_HTML_GZ, INDEX_HTML_GZ_LEN, INDEX_HTML_ETAG };
+  network.begin(page, onWebSocketEvent);
+  
+#if DUAL_CORE_MODE
+  // 网络处理移到核0，loop()所在的核1只运行控制环
+  startPinnedLoop("network", NETWORK_TASK, NETWORK_CORE, NETWORK_TASK_PRIORITY, NETWORK_TASK_STACK);
+  Serial.printf("[系统] 双核模式：网络任务运行于核%d\n", NETWORK_CORE);
+#endif
+  
+  Serial.println("[系统] 初始化完成，等待客户端连接...");
+}
+
+// ===================== 主循环 =====================
+// 网络侧：DNS/HTTP/WebSocket/UDP处理与统计
+void networkLoop() {
+  network.poll<Pipeline>(onControlDatagram);
+#if INPUT_MODE == INPUT_MODE_ANGLE
+  // 发送控制侧产生的遥测
+  flushTelemetry();
+#endif
+  
+  // 门户/UDP统计（有新请求时才打印）与堆健康
+  if (network.report(millis())) {
+#if INPUT_MODE == INPUT_MODE_ANGLE
+    printFusionStats();
+#endif
+  }
+}
+
+void loop() {
+#if DUAL_CORE_MODE
+  // 固定频率控制环（网络由独立任务处理）
+  {
+    PROBE_SCOPE(PROBE_LOOP);
+    controlLoop();
+  }
+  taskSleepMs(1);
+#else
+  {
+    PROBE_SCOPE(PROBE_LOOP);
+    networkLoop();
+    
+    // 固定频率控制环
+    controlLoop();
+  }
+#endif
+  
+  // 空闲时间输出延迟日志（不计入loop探针）
+  int32_t untilTickUs = (int32_t)(controlTicker.nextUs() - micros());
+#if INPUT_MODE == INPUT_MODE_ANGLE
+  drainWhenIdle(Serial, untilTickUs, LOG_IDLE_MARGIN_US, LOG_DRAIN_PER_LOOP, EVENT_LOG_BINARY, networkLog, controlLog);
+#else
+  drainWhenIdle(Serial, untilTickUs, LOG_IDLE_MARGIN_US, LOG_DRAIN_PER_LOOP, EVENT_LOG_BINARY, networkLog);
+#endif
+}
@@ -0,0 +1,219 @@
+// ===================== 通道表映射循环：每帧耗时与原有三路代码的对比 =====================
+// 主机侧基准测试，只测映射这一段（姿态 -> 映射角度 -> 脉宽），不含解码与PWM输出级：
+//   - 原有写法：基线V1 updateGyroData中pitch/roll/yaw三段复制的浮点映射
+//     （constrain(raw - offset, ±180) 后 1500 + mapped * rate，再限制在上下限内）；
+//   - 通道表：mapChannels()对连续数组的一次循环（0.01°整数域、Q16定点系数），
+//     分别在死区为0（每帧都重算）和默认死区下计时，通道数从1扫到16，给出每帧与每通道的耗时。
+// 输入为合成的三轴姿态流（±170°正弦叠加σ=0.1°噪声，含越过±180°限幅的偏移），
+// 同时比对3路时两种写法的脉宽：定点系数与浮点乘法在取整边界上可能差1us，这里报告差异帧数和最大差值。
+//
+// 编译运行（仓库根目录）：
+//   g++ -std=gnu++17 -O2 -Ilib/GyroCore tools/channel_bench.cpp -o /tmp/channel_bench
+//   /tmp/channel_bench [--frames 2000000] [--seed 1] [--json 文件]
+// 整条控制流水线（解码、映射、滤波、占空比）的耗时见 tools/pipeline_bench.cpp。
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "ChannelTable.h"
+
+const int FRAME_POOL = 4096;   // 预先生成的姿态帧（循环使用，避免被编译器常量折叠）
+
+struct Options {
+  uint32_t frames = 2000000;
+  uint32_t seed = 1;
+  const char* jsonPath = nullptr;
+};
+
+// xorshift32：确定性，便于复现
+class Rng {
+ public:
+  explicit Rng(uint32_t seed) : state_(seed ? seed : 1) {}
+  double uniform() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 17;
+    state_ ^= state_ << 5;
+    return ((state_ >> 8) + 0.5) * (1.0 / 16777216.0);
+  }
+  double gaussian() { return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform()); }
+
+ private:
+  uint32_t state_;
+};
+
+// 基线V1的通道结构与映射（三段相同的代码）
+struct LegacyChannel {
+  float rawValue;
+  float mappedValue;
+  float rate;
+  float offset;
+  int pulseWidth;
+  int minPulse;
+  int maxPulse;
+};
+
+struct LegacyConfig {
+  LegacyChannel pitch, roll, yaw;
+};
+
+template <typename T>
+static T constrainValue(T v, T lo, T hi) {
+  return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static void legacyUpdate(LegacyConfig& config, float pitchRaw, float rollRaw, float yawRaw) {
+  config.pitch.rawValue = pitchRaw;
+  config.roll.rawValue = rollRaw;
+  config.yaw.rawValue = yawRaw;
+
+  config.pitch.mappedValue = constrainValue((double)(pitchRaw - config.pitch.offset), -180.0, 180.0);
+  config.roll.mappedValue = constrainValue((double)(rollRaw - config.roll.offset), -180.0, 180.0);
+  config.yaw.mappedValue = constrainValue((double)(yawRaw - config.yaw.offset), -180.0, 180.0);
+
+  int pitchPulse = 1500 + (config.pitch.mappedValue * config.pitch.rate);
+  int rollPulse = 1500 + (config.roll.mappedValue * config.roll.rate);
+  int yawPulse = 1500 + (config.yaw.mappedValue * config.yaw.rate);
+
+  config.pitch.pulseWidth = constrainValue(pitchPulse, config.pitch.minPulse, config.pitch.maxPulse);
+  config.roll.pulseWidth = constrainValue(rollPulse, config.roll.minPulse, config.roll.maxPulse);
+  config.yaw.pulseWidth = constrainValue(yawPulse, config.yaw.minPulse, config.yaw.maxPulse);
+}
+
+// 三个轴各自的rate/offset，通道表与原有写法使用相同的值
+static const float BENCH_RATE[INPUT_AXES] = { 5.55f, -3.7f, 8.0f };
+static const float BENCH_OFFSET[INPUT_AXES] = { 12.5f, -30.25f, 0.0f };
+
+struct AxisFrame {
+  float degrees[INPUT_AXES];
+  int32_t centi[INPUT_AXES];
+};
+
+static std::vector<AxisFrame> buildFrames(uint32_t seed) {
+  Rng rng(seed);
+  std::vector<AxisFrame> frames(FRAME_POOL);
+  for (int i = 0; i < FRAME_POOL; i++) {
+    for (int a = 0; a < INPUT_AXES; a++) {
+      double deg = 170.0 * sin(i * 0.013 * (a + 1) + a) + rng.gaussian() * 0.1;
+      // 姿态帧本身是0.01°，两种写法拿到同一个量化后的角度
+      frames[i].centi[a] = (int32_t)lround(deg * 100);
+      frames[i].degrees[a] = frames[i].centi[a] * 0.01f;
+    }
+  }
+  return frames;
+}
+
+static volatile int32_t sink;
+
+template <typename Fn>
+static double nsPerFrame(uint32_t frames, Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < frames; n++) fn(n % FRAME_POOL);
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+}
+
+static void initTable(ChannelConfig* channels, int count, float deadband) {
+  for (int i = 0; i < count; i++) {
+    int axis = i % INPUT_AXES;
+    channels[i] = defaultChannelConfig(i, axis);
+    channels[i].rate = BENCH_RATE[axis];
+    channels[i].offset = BENCH_OFFSET[axis];
+    channels[i].deadband = deadband;
+    prepareChannel(channels[i]);
+  }
+}
+
+struct Row {
+  int channels;
+  double exactNs;      // 死区为0
+  double deadbandNs;   // 默认死区
+};
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) opt.frames = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) opt.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) opt.jsonPath = argv[++i];
+    else {
+      fprintf(stderr, "用法: %s [--frames N] [--seed N] [--json 文件]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (opt.frames == 0) opt.frames = 1;
+
+  std::vector<AxisFrame> frames = buildFrames(opt.seed);
+  static ChannelConfig channels[MAX_SERVO_CHANNELS];
+
+  // 3路时两种写法的脉宽比对
+  LegacyConfig legacy;
+  LegacyChannel* legacyChannels[INPUT_AXES] = { &legacy.pitch, &legacy.roll, &legacy.yaw };
+  for (int a = 0; a < INPUT_AXES; a++) {
+    *legacyChannels[a] = { 0, 0, BENCH_RATE[a], BENCH_OFFSET[a], SERVO_CENTER_PULSE, 500, 2500 };
+  }
+  initTable(channels, INPUT_AXES, 0);
+  uint32_t mismatchFrames = 0;
+  int maxDiff = 0;
+  for (const AxisFrame& f : frames) {
+    legacyUpdate(legacy, f.degrees[0], f.degrees[1], f.degrees[2]);
+    mapChannels(channels, INPUT_AXES, f.centi, true);
+    bool mismatch = false;
+    for (int a = 0; a < INPUT_AXES; a++) {
+      int diff = abs(channels[a].pulseWidth - legacyChannels[a]->pulseWidth);
+      if (diff > maxDiff) maxDiff = diff;
+      mismatch = mismatch || diff != 0;
+    }
+    if (mismatch) mismatchFrames++;
+  }
+
+  double legacyNs = nsPerFrame(opt.frames, [&](uint32_t i) {
+    const AxisFrame& f = frames[i];
+    legacyUpdate(legacy, f.degrees[0], f.degrees[1], f.degrees[2]);
+    sink = legacy.pitch.pulseWidth + legacy.roll.pulseWidth + legacy.yaw.pulseWidth;
+  });
+
+  std::vector<Row> rows;
+  for (int count = 1; count <= MAX_SERVO_CHANNELS; count++) {
+    Row row;
+    row.channels = count;
+    initTable(channels, count, 0);
+    row.exactNs = nsPerFrame(opt.frames, [&](uint32_t i) {
+      MapResult r = mapChannels(channels, count, frames[i].centi, true);
+      sink = r.pulseChanged + channels[count - 1].pulseWidth;
+    });
+    initTable(channels, count, DEFAULT_DEADBAND);
+    row.deadbandNs = nsPerFrame(opt.frames, [&](uint32_t i) {
+      MapResult r = mapChannels(channels, count, frames[i].centi, true);
+      sink = r.pulseChanged + channels[count - 1].pulseWidth;
+    });
+    rows.push_back(row);
+  }
+
+  printf("映射每帧耗时（%u帧）\n", opt.frames);
+  printf("原有三路浮点代码：%.1f ns/帧\n", legacyNs);
+  printf("3路脉宽比对：%zu帧中%u帧不同，最大差%dus\n", frames.size(), mismatchFrames, maxDiff);
+  printf("%4s %14s %14s %14s\n", "通道", "死区0(ns/帧)", "默认死区(ns/帧)", "每通道(ns)");
+  for (const Row& r : rows) {
+    printf("%4d %14.1f %14.1f %14.2f\n", r.channels, r.exactNs, r.deadbandNs, r.exactNs / r.channels);
+  }
+
+  if (opt.jsonPath) {
+    FILE* f = fopen(opt.jsonPath, "w");
+    if (!f) {
+      fprintf(stderr, "无法写入 %s\n", opt.jsonPath);
+      return 1;
+    }
+    fprintf(f, "{\"frames\":%u,\"legacyNs\":%.2f,\"mismatchFrames\":%u,\"maxDiffUs\":%d,\"rows\":[", opt.frames, legacyNs,
+            mismatchFrames, maxDiff);
+    for (size_t i = 0; i < rows.size(); i++) {
+      fprintf(f, "%s{\"channels\":%d,\"exactNs\":%.2f,\"deadbandNs\":%.2f}", i ? "," : "", rows[i].channels,
+              rows[i].exactNs, rows[i].deadbandNs);
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+  }
+  return maxDiff <= 1 ? 0 : 2;
+}
@@ -0,0 +1,100 @@
+// ===================== 占空比换算：定点倒数与除法的耗时 =====================
+// 主机侧微基准，每次换算一个脉宽（us）到LEDC占空比，三种写法结果逐值相同（先校验再计时）：
+//   - 常量除法：基线的 (pulse * 4095) / 20000，分辨率和周期都是编译期常量，编译器自己会换成乘法；
+//   - 运行时除法：分辨率/周期可配置后的直接写法 pulse * dutyMax / period（除数只在运行时可知）；
+//   - DutyKernel：配置时算好倒数，每次一条32x32->64位乘法加移位。
+// 主机上的硬件除法很快，差距是下限；ESP32（Xtensa LX6）的32位除法约为乘法的数倍，
+// 实际节拍内的耗时以设备上 /metrics 的pwm阶段直方图为准。
+//
+// 编译运行（仓库根目录）：
+//   g++ -std=gnu++17 -O2 -Ilib/GyroCore tools/duty_bench.cpp -o /tmp/duty_bench
+//   /tmp/duty_bench [--count 20000000] [--bits 16] [--json 文件]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "DutyKernel.h"
+
+const int PULSE_POOL = 4096;   // 预先生成的脉宽（循环使用，避免被编译器常量折叠）
+
+struct Options {
+  uint32_t count = 20000000;
+  int bits = 16;
+  const char* jsonPath = nullptr;
+};
+
+// 防止运行时除法的除数被常量传播
+volatile uint32_t runtimeDutyMax = 0;
+volatile uint32_t runtimePeriod = 0;
+static volatile uint32_t sink;
+
+template <typename Fn>
+static double nsPerConversion(const std::vector<int>& pulses, uint32_t count, Fn fn) {
+  uint32_t acc = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < count; n++) acc += fn(pulses[n % PULSE_POOL]);
+  auto end = std::chrono::steady_clock::now();
+  sink = acc;
+  return std::chrono::duration<double, std::nano>(end - start).count() / count;
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) opt.count = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--bits") == 0 && i + 1 < argc) opt.bits = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) opt.jsonPath = argv[++i];
+    else {
+      fprintf(stderr, "用法: %s [--count N] [--bits 8..16] [--json 文件]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (opt.count == 0) opt.count = 1;
+
+  DutyKernel kernel(opt.bits, PWM_PERIOD_US);
+  DutyKernel legacyKernel(12, PWM_PERIOD_US);
+  runtimeDutyMax = kernel.dutyMax();
+  runtimePeriod = kernel.periodUs();
+
+  // 舵机脉宽范围内的伪随机序列（LCG）
+  std::vector<int> pulses(PULSE_POOL);
+  uint32_t state = 1;
+  for (int& p : pulses) {
+    state = state * 1664525u + 1013904223u;
+    p = 500 + (int)((state >> 8) % 2001);
+  }
+
+  // 逐值校验：全部脉宽
+  uint32_t mismatches = 0;
+  for (int p = 0; p <= (int)PWM_PERIOD_US; p++) {
+    if (legacyKernel.duty(p) != (uint32_t)(p * 4095) / 20000) mismatches++;
+    if (kernel.duty(p) != (uint32_t)((uint64_t)p * runtimeDutyMax / runtimePeriod)) mismatches++;
+  }
+
+  double constantNs = nsPerConversion(pulses, opt.count, [](int p) { return (uint32_t)(p * 4095) / 20000; });
+  // 除数在循环外读一次，循环内是普通寄存器除法
+  const uint32_t dutyMax = runtimeDutyMax;
+  const uint32_t period = runtimePeriod;
+  double runtimeNs = nsPerConversion(pulses, opt.count, [=](int p) { return (uint32_t)p * dutyMax / period; });
+  double kernelNs = nsPerConversion(pulses, opt.count, [&](int p) { return kernel.duty(p); });
+
+  printf("占空比换算（%u次，%d位，ns/次），逐值不一致：%u\n", opt.count, kernel.bits(), mismatches);
+  printf("%-16s %10.2f\n", "常量除法(12位)", constantNs);
+  printf("%-16s %10.2f\n", "运行时除法", runtimeNs);
+  printf("%-16s %10.2f\n", "DutyKernel", kernelNs);
+
+  if (opt.jsonPath) {
+    FILE* f = fopen(opt.jsonPath, "w");
+    if (!f) {
+      fprintf(stderr, "无法写入 %s\n", opt.jsonPath);
+      return 1;
+    }
+    fprintf(f, "{\"count\":%u,\"bits\":%d,\"mismatches\":%u,\"constantNs\":%.3f,\"runtimeNs\":%.3f,\"kernelNs\":%.3f}\n",
+            opt.count, kernel.bits(), mismatches, constantNs, runtimeNs, kernelNs);
+    fclose(f);
+  }
+  return mismatches == 0 ? 0 : 2;
+}
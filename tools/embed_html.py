@@ -0,0 +1,66 @@
+"""把工程目录下的 index.html 压缩为gzip并生成 include/index_html_gz.h（PROGMEM数组 + 强ETag）。
+
+两个工程共用仓库根目录的 src/main.cpp，各自的控制页面按工程生成到工程的 include/ 目录
+（PlatformIO默认的头文件目录）。PlatformIO 中作为 pre 脚本自动运行（extra_scripts = pre:../tools/embed_html.py），
+也可以单独运行：python tools/embed_html.py <工程目录>
+内容未变化时不改写头文件，避免触发重新编译。
+"""
+import gzip
+import hashlib
+import os
+import sys
+
+HTML_NAME = "index.html"
+HEADER_NAME = os.path.join("include", "index_html_gz.h")
+
+
+def render_header(blob, etag, source_size):
+    lines = [
+        "#pragma once",
+        "// 由 tools/embed_html.py 根据 %s 生成，请勿手工修改" % HTML_NAME,
+        "// 原始 %d 字节，gzip后 %d 字节" % (source_size, len(blob)),
+        "#include <Arduino.h>",
+        "",
+        'const char INDEX_HTML_ETAG[] = "\\"%s\\"";' % etag,
+        "const size_t INDEX_HTML_GZ_LEN = %d;" % len(blob),
+        "const uint8_t INDEX_HTML_GZ[] PROGMEM = {",
+    ]
+    for i in range(0, len(blob), 16):
+        lines.append("  " + ", ".join("0x%02x" % b for b in blob[i:i + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines) + "\n"
+
+
+def embed(project_dir):
+    html_path = os.path.join(project_dir, HTML_NAME)
+    header_path = os.path.join(project_dir, HEADER_NAME)
+    with open(html_path, "rb") as f:
+        source = f.read()
+
+    # mtime固定为0，相同的HTML总是得到相同的压缩结果和ETag
+    blob = gzip.compress(source, compresslevel=9, mtime=0)
+    etag = hashlib.sha256(blob).hexdigest()[:16]
+    header = render_header(blob, etag, len(source))
+
+    old = None
+    if os.path.exists(header_path):
+        with open(header_path, "r", encoding="utf-8") as f:
+            old = f.read()
+    if old != header:
+        os.makedirs(os.path.dirname(header_path), exist_ok=True)
+        with open(header_path, "w", encoding="utf-8", newline="\n") as f:
+            f.write(header)
+
+    print("[embed_html] %s: %d -> %d bytes gzip (%.0f%%), ETag %s" % (
+        HTML_NAME, len(source), len(blob), 100.0 * len(blob) / len(source), etag))
+
+
+try:
+    Import("env")  # noqa: F821  PlatformIO SCons环境
+except NameError:
+    env = None
+
+if env is not None:
+    embed(env["PROJECT_DIR"])
+elif __name__ == "__main__":
+    embed(sys.argv[1] if len(sys.argv) > 1 else os.getcwd())
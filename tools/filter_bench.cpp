@@ -0,0 +1,200 @@
+// ===================== 运动平滑：延迟与抖动的取舍 =====================
+// 主机侧运行固件的定点滤波器（lib/GyroCore/MotionFilter.h），按控制环节拍（默认50Hz）输入合成的目标脉宽，
+// 对每组滤波配置给出一行：
+//   - 抖动：静止目标（1500us）叠加高斯噪声（默认σ=3us，约0.5°×5.55us/°）时，输出相对1500us的RMS，
+//     以及每秒改变占空比的节拍数（舵机实际收到的细小抖动）；
+//   - 延迟：无噪声0.5Hz正弦（±300us）下输出相对输入的互相关时延（抛物线插值到亚节拍）；
+//   - 阶跃：+400us阶跃后输出达到90%所需时间。
+// 扫描直通、EMA的alpha和One Euro的(minCutoff, beta)，可另加每节拍限速，输出即延迟-抖动曲线。
+//
+// 编译运行（仓库根目录）：
+//   g++ -std=gnu++17 -O2 -Ilib/GyroCore tools/filter_bench.cpp -o /tmp/filter_bench
+//   /tmp/filter_bench [--rate 50] [--noise 3] [--slew 0] [--seed 1] [--json 文件]
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "MotionFilter.h"
+
+struct Options {
+  double rateHz = 50;          // 控制环节拍频率（与PWM帧对齐）
+  double noiseUs = 3;          // 静止段输入噪声标准差（us）
+  int slewLimit = 0;           // 每节拍限速（us），0为不限
+  uint32_t seed = 1;
+  const char* jsonPath = nullptr;
+};
+
+// xorshift32：确定性，便于复现
+class Rng {
+ public:
+  explicit Rng(uint32_t seed) : state_(seed ? seed : 1) {}
+  double uniform() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 17;
+    state_ ^= state_ << 5;
+    return ((state_ >> 8) + 0.5) * (1.0 / 16777216.0);
+  }
+  double gaussian() { return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform()); }
+
+ private:
+  uint32_t state_;
+};
+
+struct Row {
+  char name[40];
+  FilterConfig cfg;
+  double jitterUs;
+  double changesPerS;
+  double latencyMs;
+  double rise90Ms;
+};
+
+static std::vector<int> run(const FilterConfig& cfg, uint32_t periodUs, const std::vector<int>& input) {
+  MotionFilter filter;
+  filter.configure(cfg, periodUs);
+  std::vector<int> output(input.size());
+  for (size_t i = 0; i < input.size(); i++) output[i] = filter.update(input[i]);
+  return output;
+}
+
+static void measure(Row& row, const Options& opt) {
+  const uint32_t periodUs = (uint32_t)(1e6 / opt.rateHz + 0.5);
+  const double tickMs = periodUs / 1000.0;
+  const int warmup = (int)(opt.rateHz * 1);
+  const int ticks = (int)(opt.rateHz * 10);
+
+  // 抖动：同一随机序列对每组配置都相同
+  Rng rng(opt.seed);
+  std::vector<int> still(warmup + ticks);
+  for (int& v : still) v = 1500 + (int)lround(rng.gaussian() * opt.noiseUs);
+  std::vector<int> out = run(row.cfg, periodUs, still);
+  double sum = 0;
+  int changes = 0;
+  for (int i = warmup; i < warmup + ticks; i++) {
+    sum += (out[i] - 1500.0) * (out[i] - 1500.0);
+    if (out[i] != out[i - 1]) changes++;
+  }
+  row.jitterUs = sqrt(sum / ticks);
+  row.changesPerS = changes / 10.0;
+
+  // 延迟：从中位开始的正弦，跳过前2s的建立过程
+  const int skip = (int)(opt.rateHz * 2);
+  std::vector<int> sine(skip + ticks);
+  for (size_t i = 0; i < sine.size(); i++) {
+    sine[i] = 1500 + (int)lround(300 * sin(2 * M_PI * 0.5 * i / opt.rateHz));
+  }
+  out = run(row.cfg, periodUs, sine);
+  const int maxLag = (int)(opt.rateHz / 2);
+  const int window = (int)(opt.rateHz * 8);   // 整4个周期，直通时互相关在0处取最大
+  // 下标0对应时延-1个节拍，使亚节拍的时延也能在峰值两侧插值
+  std::vector<double> corr(maxLag + 2);
+  int best = 0;
+  for (int k = 0; k < (int)corr.size(); k++) {
+    double c = 0;
+    for (int i = skip; i < skip + window; i++) c += (sine[i] - 1500.0) * (out[i + k - 1] - 1500.0);
+    corr[k] = c;
+    if (c > corr[best]) best = k;
+  }
+  double frac = 0;
+  if (best > 0 && best + 1 < (int)corr.size()) {
+    double denom = corr[best - 1] - 2 * corr[best] + corr[best + 1];
+    if (denom != 0) frac = 0.5 * (corr[best - 1] - corr[best + 1]) / denom;
+  }
+  row.latencyMs = (best - 1 + frac) * tickMs;
+
+  // 阶跃：+400us，输出首次达到1860us的节拍
+  std::vector<int> step(warmup + ticks, 1900);
+  for (int i = 0; i < warmup; i++) step[i] = 1500;
+  out = run(row.cfg, periodUs, step);
+  row.rise90Ms = -1;
+  for (int i = warmup; i < warmup + ticks; i++) {
+    if (out[i] >= 1860) {
+      row.rise90Ms = (i - warmup) * tickMs;
+      break;
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!value) {
+      fprintf(stderr, "用法: %s [--rate Hz] [--noise us] [--slew us] [--seed N] [--json 文件]\n", argv[0]);
+      return 1;
+    }
+    if (strcmp(arg, "--rate") == 0) opt.rateHz = atof(value);
+    else if (strcmp(arg, "--noise") == 0) opt.noiseUs = atof(value);
+    else if (strcmp(arg, "--slew") == 0) opt.slewLimit = atoi(value);
+    else if (strcmp(arg, "--seed") == 0) opt.seed = (uint32_t)strtoul(value, nullptr, 10);
+    else if (strcmp(arg, "--json") == 0) opt.jsonPath = value;
+    else {
+      fprintf(stderr, "未知参数 %s\n", arg);
+      return 1;
+    }
+    i++;
+  }
+  if (opt.rateHz <= 0) {
+    fprintf(stderr, "--rate 须大于0\n");
+    return 1;
+  }
+
+  std::vector<Row> rows;
+  auto add = [&](const char* name, int mode, float alpha, float minCutoff, float beta) {
+    Row row;
+    snprintf(row.name, sizeof(row.name), "%s", name);
+    row.cfg = defaultFilterConfig();
+    row.cfg.mode = mode;
+    row.cfg.alpha = alpha;
+    row.cfg.minCutoff = minCutoff;
+    row.cfg.beta = beta;
+    row.cfg.slewLimit = opt.slewLimit;
+    rows.push_back(row);
+  };
+  add("none", FILTER_NONE, 0, 0, 0);
+  const float alphas[] = { 0.8f, 0.6f, 0.4f, 0.2f, 0.1f };
+  for (float a : alphas) {
+    char name[40];
+    snprintf(name, sizeof(name), "ema a=%.1f", a);
+    add(name, FILTER_EMA, a, 0, 0);
+  }
+  const float cutoffs[] = { 4.0f, 1.0f, 0.5f };
+  const float betas[] = { 0.0f, 0.002f, 0.01f };
+  for (float fc : cutoffs) {
+    for (float b : betas) {
+      char name[40];
+      snprintf(name, sizeof(name), "1euro fc=%.1f b=%.3f", fc, b);
+      add(name, FILTER_ONE_EURO, 0, fc, b);
+    }
+  }
+
+  printf("节拍%.0fHz，静止噪声σ=%.1fus，限速%dus/节拍\n", opt.rateHz, opt.noiseUs, opt.slewLimit);
+  printf("%-22s %10s %12s %10s %10s\n", "配置", "抖动(us)", "变化(次/s)", "延迟(ms)", "阶跃90%(ms)");
+  for (Row& row : rows) {
+    measure(row, opt);
+    printf("%-22s %10.2f %12.1f %10.1f %10.0f\n", row.name, row.jitterUs, row.changesPerS, row.latencyMs,
+           row.rise90Ms);
+  }
+
+  if (opt.jsonPath) {
+    FILE* f = fopen(opt.jsonPath, "w");
+    if (!f) {
+      fprintf(stderr, "无法写入 %s\n", opt.jsonPath);
+      return 1;
+    }
+    fprintf(f, "{\"rateHz\":%.1f,\"noiseUs\":%.2f,\"slewLimit\":%d,\"rows\":[", opt.rateHz, opt.noiseUs,
+            opt.slewLimit);
+    for (size_t i = 0; i < rows.size(); i++) {
+      const Row& r = rows[i];
+      fprintf(f, "%s{\"name\":\"%s\",\"jitterUs\":%.3f,\"changesPerS\":%.1f,\"latencyMs\":%.2f,\"rise90Ms\":%.1f}",
+              i ? "," : "", r.name, r.jitterUs, r.changesPerS, r.latencyMs, r.rise90Ms);
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+  }
+  return 0;
+}
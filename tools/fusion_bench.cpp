@@ -0,0 +1,523 @@
+// ===================== 姿态融合：精度与每样本耗时 =====================
+// 主机侧验证固件的定点Mahony滤波（lib/GyroCore/QuaternionFilter.h）。按给定的角速度剖面积分出真实姿态，
+// 生成带零偏、噪声和量化的陀螺/加速度样本（与IMU批量帧同单位：0.1°/s、mm/s²），分三部分输出：
+//   - 漂移：先静止、再绕各轴转动（含偏航整圈和竖直姿态）、最后长时间静止，比较定点滤波、
+//     同参数的双精度Mahony与真实姿态的相对旋转误差和倾角误差；
+//   - 跳变：手持姿态（航向170°、前倾45°）归零后小幅摆动，统计相邻输出帧的最大角度变化，
+//     对比原有路径（deviceorientation欧拉角逐轴减偏移并限幅±180°）与四元数空间归零后的融合输出；
+//   - 耗时：反复运行update()，输出每样本纳秒数，x86上另给出TSC计数（设备上的周期数见telemetry_stats的fusion字段）。
+//
+// 编译运行（仓库根目录）：
+//   g++ -std=gnu++17 -O2 -Ilib/GyroCore tools/fusion_bench.cpp -o /tmp/fusion_bench
+//   /tmp/fusion_bench [--rate 60] [--bias 0.5,-0.3,0.8] [--gyro-noise 0.1] [--accel-noise 0.05]
+//                     [--bench 2000000] [--seed 1] [--json 文件]
+// 角速度单位为°/s，加速度噪声单位为m/s²。
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "QuaternionFilter.h"
+
+struct Options {
+  double rateHz = 60;                       // 样本频率（devicemotion通常60Hz）
+  double biasDps[3] = { 0.5, -0.3, 0.8 };   // 陀螺零偏（°/s）
+  double gyroNoiseDps = 0.1;                // 陀螺噪声标准差（°/s）
+  double accelNoise = 0.05;                 // 加速度噪声标准差（m/s²）
+  uint32_t benchSamples = 2000000;
+  uint32_t seed = 1;
+  const char* jsonPath = nullptr;
+};
+
+const double DEG = M_PI / 180.0;
+const double GRAVITY = 9.80665;
+
+// xorshift32：确定性，便于复现
+class Rng {
+ public:
+  explicit Rng(uint32_t seed) : state_(seed ? seed : 1) {}
+  double uniform() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 17;
+    state_ ^= state_ << 5;
+    return ((state_ >> 8) + 0.5) * (1.0 / 16777216.0);
+  }
+  double gaussian() { return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform()); }
+
+ private:
+  uint32_t state_;
+};
+
+struct Quat {
+  double w = 1, x = 0, y = 0, z = 0;
+};
+
+static Quat multiply(const Quat& a, const Quat& b) {
+  Quat r;
+  r.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+  r.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+  r.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+  r.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+  return r;
+}
+
+static Quat conjugate(const Quat& q) {
+  Quat r = { q.w, -q.x, -q.y, -q.z };
+  return r;
+}
+
+static Quat axisAngle(double ax, double ay, double az, double angle) {
+  Quat q = { cos(angle / 2), ax * sin(angle / 2), ay * sin(angle / 2), az * sin(angle / 2) };
+  return q;
+}
+
+static Quat fromQ30(const QuatQ30& q) {
+  const double s = 1.0 / FUSION_ONE_Q30;
+  Quat r = { q.w * s, q.x * s, q.y * s, q.z * s };
+  return r;
+}
+
+// 两个姿态之间的旋转角（°）
+static double angleBetween(const Quat& a, const Quat& b) {
+  double dot = fabs(a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z);
+  return 2.0 * acos(dot > 1.0 ? 1.0 : dot) / DEG;
+}
+
+// 机体坐标系中的重力方向（“上”）
+static void gravityInBody(const Quat& q, double* v) {
+  v[0] = 2 * (q.x * q.z - q.w * q.y);
+  v[1] = 2 * (q.w * q.x + q.y * q.z);
+  v[2] = q.w * q.w - q.x * q.x - q.y * q.y + q.z * q.z;
+}
+
+// 倾角误差（°）：两姿态下重力方向的夹角，与偏航无关
+static double tiltError(const Quat& a, const Quat& b) {
+  double va[3], vb[3];
+  gravityInBody(a, va);
+  gravityInBody(b, vb);
+  double dot = va[0] * vb[0] + va[1] * vb[1] + va[2] * vb[2];
+  return acos(dot > 1.0 ? 1.0 : (dot < -1.0 ? -1.0 : dot)) / DEG;
+}
+
+// Z-X'-Y''欧拉角（°），俯仰±180°、横滚±90°，与deviceorientation和QuaternionFilter的约定一致
+static void eulerZxy(const Quat& q, double* out) {
+  double sinPitch = 2 * (q.y * q.z + q.w * q.x);
+  sinPitch = sinPitch > 1 ? 1 : (sinPitch < -1 ? -1 : sinPitch);
+  double pitch = asin(sinPitch), roll, yaw;
+  if (fabs(sinPitch) > 0.99999) {
+    roll = 0;
+    yaw = atan2(2 * (q.x * q.y + q.w * q.z), 1 - 2 * (q.y * q.y + q.z * q.z));
+  } else {
+    roll = atan2(-2 * (q.x * q.z - q.w * q.y), 1 - 2 * (q.x * q.x + q.y * q.y));
+    yaw = atan2(-2 * (q.x * q.y - q.w * q.z), 1 - 2 * (q.x * q.x + q.z * q.z));
+  }
+  if (roll > M_PI / 2 || roll < -M_PI / 2) {
+    roll += roll > 0 ? -M_PI : M_PI;
+    pitch = (pitch >= 0 ? M_PI : -M_PI) - pitch;
+    yaw += yaw > 0 ? -M_PI : M_PI;
+  }
+  out[0] = pitch / DEG;
+  out[1] = roll / DEG;
+  out[2] = yaw / DEG;
+}
+
+// 双精度Mahony（与定点版同一算法和参数，含静止零偏跟踪），作为定点误差的参照
+class ReferenceMahony {
+ public:
+  explicit ReferenceMahony(const FusionConfig& cfg) : cfg_(cfg) {}
+
+  void update(const double* gyroRad, const double* accel, double dt) {
+    double norm = sqrt(accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2]);
+    bool valid = norm >= cfg_.minAccelMm / 1000.0 && norm <= cfg_.maxAccelMm / 1000.0;
+    double a[3] = { accel[0] / norm, accel[1] / norm, accel[2] / norm };
+    if (!initialized_) {
+      if (!valid) return;
+      double pitch = atan2(a[1], sqrt(a[0] * a[0] + a[2] * a[2]));
+      double roll = atan2(-a[0], a[2]);
+      q_ = multiply(axisAngle(1, 0, 0, pitch), axisAngle(0, 1, 0, roll));
+      initialized_ = true;
+      return;
+    }
+    double rate[3];
+    bool still = true;
+    for (int i = 0; i < 3; i++) {
+      rate[i] = gyroRad[i];
+      if (fabs(rate[i] - bias_[i]) > cfg_.stillRateDecideg * 0.1 * DEG) still = false;
+    }
+    if (still && valid) {
+      if (stillCount_ < cfg_.stillSamples) stillCount_++;
+      else {
+        for (int i = 0; i < 3; i++) bias_[i] += (rate[i] - bias_[i]) / (1 << cfg_.biasShift);
+      }
+    } else {
+      stillCount_ = 0;
+    }
+    for (int i = 0; i < 3; i++) rate[i] -= bias_[i];
+    if (valid) {
+      double v[3];
+      gravityInBody(q_, v);
+      double e[3] = { a[1] * v[2] - a[2] * v[1], a[2] * v[0] - a[0] * v[2], a[0] * v[1] - a[1] * v[0] };
+      double limit = cfg_.integralLimitQ24 / 16777216.0;
+      for (int i = 0; i < 3; i++) {
+        integral_[i] += cfg_.kiQ16 / 65536.0 * e[i] * dt;
+        integral_[i] = integral_[i] > limit ? limit : (integral_[i] < -limit ? -limit : integral_[i]);
+        rate[i] += cfg_.kpQ16 / 65536.0 * e[i] + integral_[i];
+      }
+    }
+    Quat h = { 0, rate[0] * dt / 2, rate[1] * dt / 2, rate[2] * dt / 2 };
+    Quat d = multiply(q_, h);
+    q_.w += d.w;
+    q_.x += d.x;
+    q_.y += d.y;
+    q_.z += d.z;
+    double n = sqrt(q_.w * q_.w + q_.x * q_.x + q_.y * q_.y + q_.z * q_.z);
+    q_.w /= n;
+    q_.x /= n;
+    q_.y /= n;
+    q_.z /= n;
+  }
+
+  const Quat& quaternion() const { return q_; }
+
+ private:
+  FusionConfig cfg_;
+  Quat q_;
+  double integral_[3] = { 0, 0, 0 };
+  double bias_[3] = { 0, 0, 0 };
+  uint16_t stillCount_ = 0;
+  bool initialized_ = false;
+};
+
+// 传感器模型：真实机体角速度/姿态 -> 量化后的样本（0.1°/s、mm/s²）
+class SensorModel {
+ public:
+  SensorModel(const Options& opt, Rng& rng) : opt_(opt), rng_(rng) {}
+
+  void sample(const Quat& truth, const double* bodyRateRad, int16_t* gyro, int16_t* accel) {
+    double up[3];
+    gravityInBody(truth, up);
+    for (int i = 0; i < 3; i++) {
+      double dps = bodyRateRad[i] / DEG + opt_.biasDps[i] + opt_.gyroNoiseDps * rng_.gaussian();
+      gyro[i] = clamp16(lround(dps * 10.0));
+      double a = up[i] * GRAVITY + opt_.accelNoise * rng_.gaussian();
+      accel[i] = clamp16(lround(a * 1000.0));
+    }
+  }
+
+ private:
+  static int16_t clamp16(long v) { return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v)); }
+
+  const Options& opt_;
+  Rng& rng_;
+};
+
+// 漂移剖面：机体角速度（rad/s）
+static void driftProfile(double t, double* rate) {
+  rate[0] = rate[1] = rate[2] = 0;
+  if (t >= 2 && t < 6) rate[2] = 90 * DEG;            // 偏航整圈（跨±180°）
+  else if (t >= 8 && t < 9) rate[0] = 90 * DEG;       // 俯仰到竖直
+  else if (t >= 10 && t < 11) rate[2] = 90 * DEG;     // 竖直姿态下绕机体z转动
+  else if (t >= 11 && t < 12) rate[0] = -90 * DEG;
+  else if (t >= 12 && t < 16) rate[1] = 60 * DEG * M_PI * cos(M_PI * (t - 12));  // 横滚±60°
+  else if (t >= 16 && t < 20) {
+    rate[0] = 40 * DEG * 2 * M_PI * 0.3 * cos(2 * M_PI * 0.3 * (t - 16));
+    rate[1] = 30 * DEG * 2 * M_PI * 0.5 * cos(2 * M_PI * 0.5 * (t - 16));
+    rate[2] = 50 * DEG * 2 * M_PI * 0.2 * cos(2 * M_PI * 0.2 * (t - 16));
+  }
+}
+
+// 手持轨迹：基准姿态（航向170°、前倾45°）之上按Z-X'-Y''叠加各轴摆动，t<2s静止
+static Quat handheldPose(double t) {
+  Quat base = multiply(axisAngle(0, 0, 1, 170 * DEG), axisAngle(1, 0, 0, 45 * DEG));
+  double s = t < 2 ? 0 : t - 2;
+  double yaw = 40 * DEG * sin(2 * M_PI * 0.4 * s);
+  double pitch = 35 * DEG * sin(2 * M_PI * 0.3 * s);
+  double roll = 25 * DEG * sin(2 * M_PI * 0.5 * s);
+  return multiply(base, multiply(axisAngle(0, 0, 1, yaw), multiply(axisAngle(1, 0, 0, pitch), axisAngle(0, 1, 0, roll))));
+}
+
+// 两个姿态之间的平均机体角速度（rad/s）
+static void bodyRate(const Quat& from, const Quat& to, double dt, double* rate) {
+  Quat d = multiply(conjugate(from), to);
+  if (d.w < 0) d = { -d.w, -d.x, -d.y, -d.z };
+  double n = sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+  double k = n > 1e-12 ? 2.0 * atan2(n, d.w) / n / dt : 2.0 / dt;
+  rate[0] = d.x * k;
+  rate[1] = d.y * k;
+  rate[2] = d.z * k;
+}
+
+// 真实姿态积分一个样本周期（细分步长，按旋转向量精确积分）
+static Quat advance(Quat q, double t, double dt, void (*profile)(double, double*)) {
+  const int steps = 8;
+  for (int k = 0; k < steps; k++) {
+    double rate[3];
+    profile(t + (k + 0.5) * dt / steps, rate);
+    double mag = sqrt(rate[0] * rate[0] + rate[1] * rate[1] + rate[2] * rate[2]);
+    if (mag > 0) q = multiply(q, axisAngle(rate[0] / mag, rate[1] / mag, rate[2] / mag, mag * dt / steps));
+  }
+  return q;
+}
+
+struct DriftResult {
+  double fixedMean = 0, fixedMax = 0, fixedFinal = 0;   // 相对旋转误差（°）
+  double floatMean = 0, floatMax = 0, floatFinal = 0;
+  double tiltMax = 0;                                   // 定点倾角误差（°，收敛后）
+  double fixedVsFloatMax = 0;                           // 定点与双精度结果之差（°）
+  double fixedTailDrift = 0;                            // 末尾静止10秒内定点姿态的变化（°，零偏已跟踪后）
+};
+
+static DriftResult runDrift(const Options& opt) {
+  Rng rng(opt.seed);
+  SensorModel sensor(opt, rng);
+  QuaternionFilter fused;
+  ReferenceMahony reference(defaultFusionConfig());
+  const double dt = 1.0 / opt.rateHz;
+  const uint32_t dtUs = (uint32_t)lround(dt * 1e6);
+  const double seconds = 40;
+
+  DriftResult r;
+  Quat truth, truthRef;
+  uint32_t counted = 0;
+  bool referenced = false, tailMarked = false;
+  Quat tailStart;
+  for (double t = 0; t < seconds; t += dt) {
+    double rate[3];
+    driftProfile(t, rate);
+    int16_t gyro[3], accel[3];
+    sensor.sample(truth, rate, gyro, accel);
+    fused.update(gyro, accel, dtUs);
+    double gyroRad[3], accelMs[3];
+    for (int i = 0; i < 3; i++) {
+      gyroRad[i] = gyro[i] * 0.1 * DEG;
+      accelMs[i] = accel[i] / 1000.0;
+    }
+    reference.update(gyroRad, accelMs, dt);
+    if (!referenced && fused.initialized()) {
+      truthRef = truth;
+      referenced = true;
+    }
+    truth = advance(truth, t, dt, driftProfile);
+    if (!referenced || t < 1.0) continue;
+
+    // 误差按相对参考姿态比较（偏航初值不可观测，固件也只输出相对量）；update()已积分到本周期末，对应advance后的真值
+    Quat relTruth = multiply(conjugate(truthRef), truth);
+    Quat relFixed = multiply(conjugate(fromQ30(fused.reference())), fromQ30(fused.quaternion()));
+    Quat relFloat = multiply(conjugate(fromQ30(fused.reference())), reference.quaternion());
+    double eFixed = angleBetween(relFixed, relTruth);
+    double eFloat = angleBetween(relFloat, relTruth);
+    r.fixedMean += eFixed;
+    r.floatMean += eFloat;
+    if (eFixed > r.fixedMax) r.fixedMax = eFixed;
+    if (eFloat > r.floatMax) r.floatMax = eFloat;
+    r.fixedFinal = eFixed;
+    r.floatFinal = eFloat;
+    double diff = angleBetween(fromQ30(fused.quaternion()), reference.quaternion());
+    if (diff > r.fixedVsFloatMax) r.fixedVsFloatMax = diff;
+    double tilt = tiltError(fromQ30(fused.quaternion()), truth);
+    if (t > 3.0 && tilt > r.tiltMax) r.tiltMax = tilt;
+    if (!tailMarked && t >= seconds - 10) {
+      tailStart = fromQ30(fused.quaternion());
+      tailMarked = true;
+    }
+    counted++;
+  }
+  r.fixedTailDrift = angleBetween(tailStart, fromQ30(fused.quaternion()));
+  if (counted) {
+    r.fixedMean /= counted;
+    r.floatMean /= counted;
+  }
+  return r;
+}
+
+struct JumpResult {
+  double eulerMaxStep = 0, fusedMaxStep = 0;   // 相邻输出帧的最大变化（°，三轴取大）
+  uint32_t eulerJumps = 0, fusedJumps = 0;     // 变化超过30°的帧数
+  double fusedMaxError = 0;                    // 融合输出与真实相对欧拉角之差（°）
+  uint32_t frames = 0;
+};
+
+static JumpResult runJumps(const Options& opt) {
+  Rng rng(opt.seed + 1);
+  SensorModel sensor(opt, rng);
+  QuaternionFilter fused;
+  const double dt = 1.0 / opt.rateHz;
+  const uint32_t dtUs = (uint32_t)lround(dt * 1e6);
+  const double resetAt = 1.5, seconds = 30;
+
+  Quat truthRef;
+  double offset[3] = { 0, 0, 0 }, lastEuler[3] = { 0, 0, 0 }, lastFused[3] = { 0, 0, 0 };
+  bool reset = false, primed = false;
+  JumpResult r;
+  for (double t = 0; t < seconds; t += dt) {
+    // 样本为[t, t+dt]内的平均角速度，update()之后的估计对应t+dt时刻的姿态
+    Quat from = handheldPose(t), truth = handheldPose(t + dt);
+    double rate[3];
+    bodyRate(from, truth, dt, rate);
+    int16_t gyro[3], accel[3];
+    sensor.sample(from, rate, gyro, accel);
+    fused.update(gyro, accel, dtUs);
+
+    double absolute[3];
+    eulerZxy(truth, absolute);
+    if (!reset && t >= resetAt) {
+      // 两条路径同时归零：原路径记下逐轴偏移，融合路径在四元数空间设参考
+      for (int i = 0; i < 3; i++) offset[i] = absolute[i];
+      fused.setReference();
+      truthRef = truth;
+      reset = true;
+    }
+    if (!reset) continue;
+
+    double euler[3], fusedDeg[3], truthRel[3];
+    int32_t centi[3];
+    fused.relativeEulerCenti(centi);
+    eulerZxy(multiply(conjugate(truthRef), truth), truthRel);
+    for (int i = 0; i < 3; i++) {
+      euler[i] = absolute[i] - offset[i];
+      euler[i] = euler[i] > 180 ? 180 : (euler[i] < -180 ? -180 : euler[i]);
+      fusedDeg[i] = centi[i] / 100.0;
+    }
+    if (primed) {
+      double eulerStep = 0, fusedStep = 0;
+      for (int i = 0; i < 3; i++) {
+        eulerStep = fmax(eulerStep, fabs(euler[i] - lastEuler[i]));
+        fusedStep = fmax(fusedStep, fabs(fusedDeg[i] - lastFused[i]));
+        double err = fabs(fusedDeg[i] - truthRel[i]);
+        if (err > 180) err = 360 - err;
+        if (err > r.fusedMaxError) r.fusedMaxError = err;
+      }
+      r.eulerMaxStep = fmax(r.eulerMaxStep, eulerStep);
+      r.fusedMaxStep = fmax(r.fusedMaxStep, fusedStep);
+      if (eulerStep > 30) r.eulerJumps++;
+      if (fusedStep > 30) r.fusedJumps++;
+      r.frames++;
+    }
+    for (int i = 0; i < 3; i++) {
+      lastEuler[i] = euler[i];
+      lastFused[i] = fusedDeg[i];
+    }
+    primed = true;
+  }
+  return r;
+}
+
+struct BenchResult {
+  double nsPerSample = 0;
+  double ticksPerSample = 0;   // x86 TSC计数（其他平台为0）
+};
+
+static BenchResult runBench(const Options& opt) {
+  // 预先生成一段循环使用的样本，计时只覆盖update()
+  Rng rng(opt.seed + 2);
+  const int pool = 4096;
+  std::vector<int16_t> gyro(pool * 3), accel(pool * 3);
+  for (int n = 0; n < pool; n++) {
+    for (int i = 0; i < 3; i++) {
+      gyro[n * 3 + i] = (int16_t)lround(rng.gaussian() * 500);
+      accel[n * 3 + i] = (int16_t)lround((i == 2 ? GRAVITY : 0) * 1000 + rng.gaussian() * 500);
+    }
+  }
+  QuaternionFilter fused;
+  const uint32_t dtUs = (uint32_t)lround(1e6 / opt.rateHz);
+  auto start = std::chrono::steady_clock::now();
+#if defined(__x86_64__) || defined(__i386__)
+  uint64_t tsc = __rdtsc();
+#endif
+  for (uint32_t n = 0; n < opt.benchSamples; n++) {
+    int k = n & (pool - 1);
+    fused.update(&gyro[k * 3], &accel[k * 3], dtUs);
+  }
+  BenchResult r;
+#if defined(__x86_64__) || defined(__i386__)
+  r.ticksPerSample = (double)(__rdtsc() - tsc) / opt.benchSamples;
+#endif
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  r.nsPerSample = std::chrono::duration<double, std::nano>(elapsed).count() / opt.benchSamples;
+  // 防止优化掉整个循环
+  if (fused.quaternion().w == 12345) printf("\n");
+  return r;
+}
+
+static bool parseTriple(const char* text, double* out) {
+  return sscanf(text, "%lf,%lf,%lf", &out[0], &out[1], &out[2]) == 3;
+}
+
+static bool parseArgs(int argc, char** argv, Options& opt) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!value) return false;
+    if (strcmp(arg, "--rate") == 0) opt.rateHz = atof(value);
+    else if (strcmp(arg, "--bias") == 0) {
+      if (!parseTriple(value, opt.biasDps)) return false;
+    } else if (strcmp(arg, "--gyro-noise") == 0) opt.gyroNoiseDps = atof(value);
+    else if (strcmp(arg, "--accel-noise") == 0) opt.accelNoise = atof(value);
+    else if (strcmp(arg, "--bench") == 0) opt.benchSamples = (uint32_t)strtoul(value, nullptr, 10);
+    else if (strcmp(arg, "--seed") == 0) opt.seed = (uint32_t)strtoul(value, nullptr, 10);
+    else if (strcmp(arg, "--json") == 0) opt.jsonPath = value;
+    else return false;
+    i++;
+  }
+  return opt.rateHz >= 10 && opt.rateHz <= 1000 && opt.benchSamples > 0;
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parseArgs(argc, argv, opt)) {
+    fprintf(stderr, "用法: %s [--rate Hz] [--bias x,y,z] [--gyro-noise dps] [--accel-noise m/s2] "
+                    "[--bench N] [--seed N] [--json 文件]\n", argv[0]);
+    return 2;
+  }
+
+  printf("# 样本%.0fHz 零偏%.2f/%.2f/%.2f°/s 陀螺噪声%.2f°/s 加速度噪声%.2fm/s²\n", opt.rateHz, opt.biasDps[0],
+         opt.biasDps[1], opt.biasDps[2], opt.gyroNoiseDps, opt.accelNoise);
+
+  DriftResult drift = runDrift(opt);
+  printf("\n[漂移] 相对旋转误差（°）\n");
+  printf("%-8s %9s %9s %9s\n", "filter", "mean", "max", "final");
+  printf("%-8s %9.2f %9.2f %9.2f\n", "fixed", drift.fixedMean, drift.fixedMax, drift.fixedFinal);
+  printf("%-8s %9.2f %9.2f %9.2f\n", "double", drift.floatMean, drift.floatMax, drift.floatFinal);
+  printf("定点倾角误差最大 %.2f°，定点与双精度最大相差 %.3f°，末尾静止10秒漂移 %.2f°\n", drift.tiltMax,
+         drift.fixedVsFloatMax, drift.fixedTailDrift);
+
+  JumpResult jumps = runJumps(opt);
+  printf("\n[跳变] 手持姿态（航向170°、前倾45°）归零后摆动，%u帧\n", jumps.frames);
+  printf("%-8s %12s %12s\n", "path", "max_step", "jumps>30");
+  printf("%-8s %12.1f %12u\n", "euler", jumps.eulerMaxStep, jumps.eulerJumps);
+  printf("%-8s %12.1f %12u\n", "fused", jumps.fusedMaxStep, jumps.fusedJumps);
+  printf("融合输出与真实相对角最大相差 %.2f°\n", jumps.fusedMaxError);
+
+  BenchResult bench = runBench(opt);
+  printf("\n[耗时] %u个样本：%.1f ns/样本", opt.benchSamples, bench.nsPerSample);
+  if (bench.ticksPerSample > 0) printf("，%.0f TSC/样本", bench.ticksPerSample);
+  printf("\n");
+
+  if (opt.jsonPath) {
+    FILE* f = fopen(opt.jsonPath, "w");
+    if (!f) {
+      fprintf(stderr, "无法写入 %s\n", opt.jsonPath);
+      return 1;
+    }
+    fprintf(f,
+            "{\"tool\":\"fusion_bench\",\"rate_hz\":%.1f,"
+            "\"drift\":{\"fixed_mean\":%.3f,\"fixed_max\":%.3f,\"fixed_final\":%.3f,\"double_mean\":%.3f,"
+            "\"double_max\":%.3f,\"double_final\":%.3f,\"tilt_max\":%.3f,\"fixed_vs_double_max\":%.4f,\"tail_drift\":%.3f},"
+            "\"jumps\":{\"frames\":%u,\"euler_max_step\":%.2f,\"euler_jumps\":%u,\"fused_max_step\":%.2f,"
+            "\"fused_jumps\":%u,\"fused_max_error\":%.3f},"
+            "\"bench\":{\"samples\":%u,\"ns_per_sample\":%.2f,\"tsc_per_sample\":%.1f}}\n",
+            opt.rateHz, drift.fixedMean, drift.fixedMax, drift.fixedFinal, drift.floatMean, drift.floatMax,
+            drift.floatFinal, drift.tiltMax, drift.fixedVsFloatMax, drift.fixedTailDrift, jumps.frames, jumps.eulerMaxStep,
+            jumps.eulerJumps, jumps.fusedMaxStep, jumps.fusedJumps, jumps.fusedMaxError, opt.benchSamples,
+            bench.nsPerSample, bench.ticksPerSample);
+    fclose(f);
+  }
+  return 0;
+}
@@ -0,0 +1,158 @@
+// ===================== JSON解析：原有解析与单遍扫描的耗时 =====================
+// 主机侧对比V1两种JSON解析的每条消息耗时：原有strstr/extractFloat解析（sim/tests/LegacyJsonParser.h，
+// 基线版本摘出，String换成std::string）与现在的jsonScanFields/decodeGyroText。消息取自sim/traces
+// 中的V1姿态与配置消息，按类别分别计时；两者结果是否一致由 sim/tests/test_json_scan.cpp 检查。
+// 原有姿态解析每个字段都要substring，设备上的Arduino String还会分配堆内存，主机上std::string的
+// 短字符串优化免掉了这部分，因此这里的差距是设备上的下限。
+//
+// 编译运行（仓库根目录）：
+//   g++ -std=gnu++17 -O2 -Ilib/GyroCore -Isim/tests tools/json_bench.cpp lib/GyroCore/JsonScan.cpp -o /tmp/json_bench
+//   /tmp/json_bench [--traces sim/traces] [--rounds 20000] [--json 文件]
+
+#include <dirent.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "GyroText.h"
+#include "JsonScan.h"
+#include "LegacyJsonParser.h"
+
+// 与src/main.cpp角度固件中CONFIG_FIELDS的对应项相同
+#define BENCH_FIELD(parent, key, type, member) \
+  { parent, jsonKeyHash(key), type, (uint16_t)offsetof(LegacyConfig, member) }
+#define BENCH_CHANNEL(name) \
+  BENCH_FIELD(jsonKeyHash(#name), "rate", JSON_FIELD_FLOAT, name.rate), \
+  BENCH_FIELD(jsonKeyHash(#name), "minPulse", JSON_FIELD_INT, name.minPulse), \
+  BENCH_FIELD(jsonKeyHash(#name), "maxPulse", JSON_FIELD_INT, name.maxPulse)
+
+static const JsonField CONFIG_FIELDS[] = {
+  BENCH_FIELD(JSON_ROOT, "controlEnabled", JSON_FIELD_FLAG, controlEnabled),
+  BENCH_FIELD(JSON_ROOT, "operationLocked", JSON_FIELD_FLAG, operationLocked),
+  BENCH_CHANNEL(pitch),
+  BENCH_CHANNEL(roll),
+  BENCH_CHANNEL(yaw),
+};
+
+struct Options {
+  std::string traces = "sim/traces";
+  int rounds = 20000;
+  const char* jsonPath = nullptr;
+};
+
+struct Result {
+  const char* name;
+  size_t messages;
+  double legacyNs;
+  double scanNs;
+};
+
+static volatile int32_t sink;
+
+static void loadMessages(const std::string& dir, std::vector<std::string>& gyro, std::vector<std::string>& config) {
+  DIR* d = opendir(dir.c_str());
+  if (!d) return;
+  while (dirent* entry = readdir(d)) {
+    size_t n = strlen(entry->d_name);
+    if (n < 6 || strcmp(entry->d_name + n - 6, ".trace") != 0) continue;
+    FILE* f = fopen((dir + "/" + entry->d_name).c_str(), "r");
+    if (!f) continue;
+    char line[4096];
+    while (fgets(line, sizeof(line), f)) {
+      char* text = strstr(line, " text {");
+      if (line[0] == '#' || !text) continue;
+      std::string message(text + 6);
+      while (!message.empty() && (message.back() == '\n' || message.back() == '\r')) message.pop_back();
+      int kind = legacyClassify(message);
+      if (kind == 1) config.push_back(message);
+      if (kind == 2) gyro.push_back(message);
+    }
+    fclose(f);
+  }
+  closedir(d);
+}
+
+template <typename Fn>
+static double nsPerMessage(const std::vector<std::string>& messages, int rounds, Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) {
+    for (const std::string& message : messages) fn(message);
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return elapsed / ((double)rounds * messages.size());
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--traces") == 0 && i + 1 < argc) opt.traces = argv[++i];
+    else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) opt.rounds = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) opt.jsonPath = argv[++i];
+    else {
+      fprintf(stderr, "用法: %s [--traces 目录] [--rounds N] [--json 文件]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  std::vector<std::string> gyro;
+  std::vector<std::string> config;
+  loadMessages(opt.traces, gyro, config);
+  if (gyro.empty() || config.empty()) {
+    fprintf(stderr, "%s 中没有V1姿态/配置消息\n", opt.traces.c_str());
+    return 1;
+  }
+  // 配置消息只有几条，按姿态消息的轮数补足计时长度
+  int configRounds = opt.rounds * (int)(gyro.size() / config.size() > 0 ? gyro.size() / config.size() : 1);
+
+  Result results[2];
+  results[0].name = "gyro";
+  results[0].messages = gyro.size();
+  results[0].legacyNs = nsPerMessage(gyro, opt.rounds, [](const std::string& m) {
+    LegacyGyro g;
+    legacyParseGyro(m, g);
+    sink = degreesToCenti(g.pitch) + degreesToCenti(g.roll) + degreesToCenti(g.yaw) + g.enabled;
+  });
+  results[0].scanNs = nsPerMessage(gyro, opt.rounds, [](const std::string& m) {
+    GyroFrame frame;
+    decodeGyroText((const uint8_t*)m.data(), m.size(), frame);
+    sink = frame.value[0] + frame.value[1] + frame.value[2] + frame.flags;
+  });
+
+  results[1].name = "config";
+  results[1].messages = config.size();
+  results[1].legacyNs = nsPerMessage(config, configRounds, [](const std::string& m) {
+    LegacyConfig c = {};
+    legacyParseConfigData(m, c);
+    sink = c.pitch.minPulse + c.yaw.maxPulse + (int32_t)c.roll.rate + c.controlEnabled;
+  });
+  results[1].scanNs = nsPerMessage(config, configRounds, [](const std::string& m) {
+    LegacyConfig c = {};
+    jsonScanFields((const uint8_t*)m.data(), m.size(), CONFIG_FIELDS, sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]),
+                   &c);
+    sink = c.pitch.minPulse + c.yaw.maxPulse + (int32_t)c.roll.rate + c.controlEnabled;
+  });
+
+  printf("%-8s %8s %14s %14s %8s\n", "消息", "条数", "原有(ns/条)", "扫描(ns/条)", "倍数");
+  for (const Result& r : results) {
+    printf("%-8s %8zu %14.1f %14.1f %8.2f\n", r.name, r.messages, r.legacyNs, r.scanNs, r.legacyNs / r.scanNs);
+  }
+
+  if (opt.jsonPath) {
+    FILE* f = fopen(opt.jsonPath, "w");
+    if (!f) {
+      fprintf(stderr, "无法写入 %s\n", opt.jsonPath);
+      return 1;
+    }
+    fprintf(f, "{\"rounds\":%d,\"results\":[", opt.rounds);
+    for (int i = 0; i < 2; i++) {
+      fprintf(f, "%s{\"kind\":\"%s\",\"messages\":%zu,\"legacyNs\":%.1f,\"scanNs\":%.1f}", i ? "," : "",
+              results[i].name, results[i].messages, results[i].legacyNs, results[i].scanNs);
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+  }
+  return 0;
+}
@@ -0,0 +1,466 @@
+"""主机侧压测工具：对端口81的WebSocket控制通道发起K个客户端并发压测。
+
+目标可以是真机（连上ESP32热点后 --host 192.168.4.1），也可以是主机仿真的实时模式：
+    .pio/build/native/program --listen 8081        （或直接用g++编译的仿真程序）
+    python3 tools/loadgen.py --host 127.0.0.1 --port 8081 --format v1-bin --clients 2 --rate 100 --duration 10
+
+每个客户端按设定频率发送姿态/脉宽帧（可选混入配置帧），统计：
+  - 指令 -> 遥测往返时延：V1固件在遥测中回显最近生效的帧序号（"seq"），从发送该帧到
+    收到携带该序号（或更新序号）的遥测即为一次往返；被更新帧合并掉的序号不计入。
+    V2固件没有遥测，改为定时发送 reset_mapping 探针，按 "Mapping Reset ACK" 回执计时
+    （只覆盖网络侧路径，结果中 rtt_source 为 "ack"）。
+  - 持续吞吐：发送帧率、生效帧率（遥测确认的序号数）、遥测帧率、回压/租约拒绝次数。
+--udp-port 时姿态/脉宽帧改走UDP控制通道（需 -D UDP_CONTROL=1 固件，仅二进制格式），WebSocket仍负责
+遥测和探针，可与同参数的WebSocket结果对比；固件同一时刻只跟随一个UDP发送端，多客户端时其余计为其他发送端。
+结果以JSON输出（stdout或 --out 文件），--compare 与上一次结果逐项对比，便于评估固件改动。
+
+只用标准库（asyncio + 最小WebSocket客户端），不需要安装依赖。
+帧格式在 FORMATS 中注册，新增二进制格式只需添加一个编码函数。
+"""
+import argparse
+import asyncio
+import base64
+import hashlib
+import json
+import math
+import os
+import socket
+import struct
+import sys
+import time
+
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+SCHEMA_VERSION = 1
+SEQ_PENDING_LIMIT_S = 5.0   # 超过该时间仍未被遥测确认的序号丢弃
+
+
+# ===================== 最小WebSocket客户端 =====================
+class WsClosed(Exception):
+    pass
+
+
+class WsClient:
+    def __init__(self, reader, writer):
+        self.reader = reader
+        self.writer = writer
+
+    @classmethod
+    async def connect(cls, host, port, path, timeout):
+        reader, writer = await asyncio.wait_for(asyncio.open_connection(host, port), timeout)
+        key = base64.b64encode(os.urandom(16)).decode()
+        request = (
+            "GET %s HTTP/1.1\r\n"
+            "Host: %s:%d\r\n"
+            "Upgrade: websocket\r\n"
+            "Connection: Upgrade\r\n"
+            "Sec-WebSocket-Key: %s\r\n"
+            "Sec-WebSocket-Version: 13\r\n\r\n" % (path, host, port, key))
+        writer.write(request.encode())
+        await writer.drain()
+        response = await asyncio.wait_for(reader.readuntil(b"\r\n\r\n"), timeout)
+        expected = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+        lines = response.decode(errors="replace").split("\r\n")
+        if " 101 " not in lines[0] + " ":
+            raise ConnectionError("握手失败: %s" % lines[0])
+        accept = [l.split(":", 1)[1].strip() for l in lines if l.lower().startswith("sec-websocket-accept:")]
+        if accept and accept[0] != expected:
+            raise ConnectionError("Sec-WebSocket-Accept不匹配")
+        return cls(reader, writer)
+
+    def send(self, payload, binary):
+        # 客户端帧必须掩码
+        data = payload if isinstance(payload, bytes) else payload.encode()
+        header = bytearray([0x80 | (0x2 if binary else 0x1)])
+        if len(data) < 126:
+            header.append(0x80 | len(data))
+        elif len(data) <= 0xFFFF:
+            header.append(0x80 | 126)
+            header += struct.pack(">H", len(data))
+        else:
+            header.append(0x80 | 127)
+            header += struct.pack(">Q", len(data))
+        mask = os.urandom(4)
+        masked = bytes(b ^ mask[i & 3] for i, b in enumerate(data))
+        self.writer.write(bytes(header) + mask + masked)
+
+    async def drain(self):
+        await self.writer.drain()
+
+    async def recv(self):
+        """返回 (是否二进制, 载荷)；自动回复ping，收到close抛出WsClosed"""
+        while True:
+            try:
+                head = await self.reader.readexactly(2)
+            except asyncio.IncompleteReadError:
+                raise WsClosed()
+            opcode = head[0] & 0x0F
+            length = head[1] & 0x7F
+            if length == 126:
+                length = struct.unpack(">H", await self.reader.readexactly(2))[0]
+            elif length == 127:
+                length = struct.unpack(">Q", await self.reader.readexactly(8))[0]
+            mask = await self.reader.readexactly(4) if head[1] & 0x80 else None
+            payload = await self.reader.readexactly(length)
+            if mask:
+                payload = bytes(b ^ mask[i & 3] for i, b in enumerate(payload))
+            if opcode == 0x8:
+                raise WsClosed()
+            if opcode == 0x9:
+                self.writer.write(bytes([0x8A, 0x80 | len(payload)]) + b"\0\0\0\0" + payload)
+                continue
+            if opcode in (0x1, 0x2):
+                return opcode == 0x2, payload
+
+    def close(self):
+        try:
+            self.writer.write(bytes([0x88, 0x80]) + b"\0\0\0\0")
+            self.writer.close()
+        except Exception:
+            pass
+
+
+# ===================== 帧格式 =====================
+# 编码函数：(序号, 时刻s, 客户端号) -> (载荷, 是否二进制)
+V2_PINS = (12, 13, 14)
+
+
+def motion(t, client, axis):
+    """平滑扫动：各轴周期不同，保证每帧映射结果都有变化"""
+    period = (2.0, 2.6, 3.4)[axis]
+    return math.sin(2 * math.pi * t / period + client * 0.7 + axis)
+
+
+def encode_v1_json(seq, t, client):
+    angles = [round(30.0 * motion(t, client, a), 2) for a in range(3)]
+    text = '{"pitch":%.2f,"roll":%.2f,"yaw":%.2f,"enabled":1,"seq":%d}' % (angles[0], angles[1], angles[2], seq)
+    return text, False
+
+
+def encode_v1_bin(seq, t, client):
+    # GyroFrame v2：姿态角帧，携带发送时刻与启用状态（格式见 lib/GyroCore/GyroFrame.h）
+    centi = [int(round(3000.0 * motion(t, client, a))) for a in range(3)]
+    flags = 0x04 | 0x02 | 0x01
+    frame = struct.pack("<BBBBHhhhbbbBI", 0x47, 2, 1, flags, seq, centi[0], centi[1], centi[2],
+                        -1, -1, -1, 0, int(t * 1000) & 0xFFFFFFFF)
+    return frame, True
+
+
+def encode_v2_json(seq, t, client):
+    pulse = [int(1500 + 500 * motion(t, client, a)) for a in range(3)]
+    text = '{"P-PIN":%d,"P-PWM":%d,"R-PIN":%d,"R-PWM":%d,"Y-PIN":%d,"Y-PWM":%d}' % (
+        V2_PINS[0], pulse[0], V2_PINS[1], pulse[1], V2_PINS[2], pulse[2])
+    return text, False
+
+
+def encode_v2_bin(seq, t, client):
+    pulse = [int(1500 + 500 * motion(t, client, a)) for a in range(3)]
+    frame = struct.pack("<BBBBHhhhbbbB", 0x47, 1, 2, 0, seq, pulse[0], pulse[1], pulse[2],
+                        V2_PINS[0], V2_PINS[1], V2_PINS[2], 0)
+    return frame, True
+
+
+def config_v1(client):
+    ch = {"rate": 10, "minPulse": 500, "maxPulse": 2500}
+    return json.dumps({"controlEnabled": 1, "operationLocked": 0, "pitch": ch, "roll": ch, "yaw": ch},
+                      separators=(",", ":"))
+
+
+def config_v2(client):
+    return '{"P-FILTER":0,"R-FILTER":0,"Y-FILTER":0}'
+
+
+# 名称 -> (帧编码, 配置帧, 往返计时方式)
+FORMATS = {
+    "v1-json": (encode_v1_json, config_v1, "seq"),
+    "v1-bin": (encode_v1_bin, config_v1, "seq"),
+    "v2-json": (encode_v2_json, config_v2, "ack"),
+    "v2-bin": (encode_v2_bin, config_v2, "ack"),
+}
+
+
+# ===================== 统计 =====================
+def percentiles(samples):
+    if not samples:
+        return {"count": 0}
+    s = sorted(samples)
+
+    def rank(p):
+        return round(s[min(len(s) - 1, max(0, int(math.ceil(p * len(s))) - 1))], 3)
+
+    return {"count": len(s), "mean": round(sum(s) / len(s), 3), "p50": rank(0.50), "p90": rank(0.90),
+            "p99": rank(0.99), "max": round(s[-1], 3)}
+
+
+class ClientRun:
+    def __init__(self, index, clients, args):
+        self.index = index
+        self.args = args
+        self.encode, self.config, self.rtt_source = FORMATS[args.format]
+        # 各客户端的序号交错递增（n*K + 客户端号），单个客户端的序号始终单调（固件按序号丢弃乱序帧），
+        # 遥测回显的序号按各自的待确认表归属到发送者
+        self.clients = clients
+        self.sent = 0
+        self.config_sent = 0
+        self.applied = 0
+        self.superseded = 0
+        self.telemetry = 0
+        self.backpressure_on = 0
+        self.backpressure_off = 0
+        self.busy = 0
+        self.errors = []
+        self.rtt_ms = []
+        self.pending = {}        # 序号 -> 发送时刻
+        self.probes = []         # 未回执的探针发送时刻（FIFO）
+        self.interval = 1.0 / args.rate
+        self.connected = False
+
+    def next_seq(self):
+        return (self.sent * self.clients + self.index + 1) & 0xFFFF
+
+    def on_text(self, text, now):
+        if text.startswith("{"):
+            try:
+                msg = json.loads(text)
+            except ValueError:
+                return
+            if "backpressure" in msg:
+                if msg["backpressure"]:
+                    self.backpressure_on += 1
+                    if self.args.obey_backpressure and msg.get("suggestHz"):
+                        self.interval = max(self.interval, 1.0 / msg["suggestHz"])
+                else:
+                    self.backpressure_off += 1
+                    if self.args.obey_backpressure:
+                        self.interval = 1.0 / self.args.rate
+                return
+            if "telemetry" in msg:
+                return
+            self.telemetry += 1
+            seq = msg.get("seq")
+            if seq is not None:
+                self.ack_seq(seq, now)
+        elif text == "Mapping Reset ACK" and self.probes:
+            self.rtt_ms.append((now - self.probes.pop(0)) * 1000.0)
+        elif text == "Controller busy":
+            self.busy += 1
+
+    def ack_seq(self, seq, now):
+        sent = self.pending.pop(seq, None)
+        if sent is None:
+            return
+        self.applied += 1
+        self.rtt_ms.append((now - sent) * 1000.0)
+        # 比它早的序号已被合并，不再等待
+        stale = [s for s, t in self.pending.items() if t < sent]
+        for s in stale:
+            del self.pending[s]
+        self.superseded += len(stale)
+
+    async def run(self, start, stop):
+        args = self.args
+        path = args.path
+        try:
+            ws = await WsClient.connect(args.host, args.port, path, args.timeout)
+        except Exception as e:  # 连接失败计入结果，不中断其他客户端
+            self.errors.append("connect: %s" % e)
+            return
+        self.connected = True
+        loop = asyncio.get_running_loop()
+        udp = None
+        if args.udp_port:
+            udp = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            udp.setblocking(False)
+            udp_target = (args.host, args.udp_port)
+
+        async def reader():
+            try:
+                while True:
+                    binary, payload = await ws.recv()
+                    if not binary:
+                        self.on_text(payload.decode(errors="replace"), loop.time())
+            except WsClosed:
+                if loop.time() < stop:
+                    self.errors.append("closed by server")
+            except Exception as e:
+                self.errors.append("recv: %s" % e)
+
+        reader_task = asyncio.ensure_future(reader())
+        next_send = max(loop.time(), start)
+        next_config = next_send + (1.0 / args.config_hz if args.config_hz > 0 else float("inf"))
+        probe_hz = args.probe_hz if self.rtt_source == "ack" else 0
+        next_probe = next_send + (1.0 / probe_hz if probe_hz > 0 else float("inf"))
+        try:
+            while not reader_task.done():
+                now = loop.time()
+                if now >= stop:
+                    break
+                due = min(next_send, next_config, next_probe, stop)
+                if due > now:
+                    await asyncio.sleep(due - now)
+                    continue
+                if now >= next_send:
+                    seq = self.next_seq()
+                    payload, binary = self.encode(seq, now - start, self.index)
+                    if udp is not None:
+                        try:
+                            udp.sendto(payload, udp_target)
+                        except (BlockingIOError, OSError):
+                            pass  # 发送缓冲满即丢帧，与UDP语义一致
+                    else:
+                        ws.send(payload, binary)
+                    self.pending[seq] = now
+                    self.sent += 1
+                    # 落后超过一个周期时不补发，避免突发
+                    next_send = max(next_send + self.interval, now)
+                if now >= next_config:
+                    ws.send(self.config(self.index), False)
+                    self.config_sent += 1
+                    next_config += 1.0 / args.config_hz
+                if now >= next_probe:
+                    ws.send("reset_mapping", False)
+                    self.probes.append(now)
+                    next_probe += 1.0 / probe_hz
+                await ws.drain()
+                limit = now - SEQ_PENDING_LIMIT_S
+                if len(self.pending) > 4096:
+                    self.pending = {s: t for s, t in self.pending.items() if t >= limit}
+            # 留出时间接收最后的遥测
+            await asyncio.sleep(args.settle)
+        except Exception as e:
+            self.errors.append("send: %s" % e)
+        finally:
+            reader_task.cancel()
+            ws.close()
+            if udp is not None:
+                udp.close()
+
+    def result(self, duration):
+        return {
+            "client": self.index,
+            "connected": self.connected,
+            "sent": self.sent,
+            "config_sent": self.config_sent,
+            "send_rate_hz": round(self.sent / duration, 2),
+            "applied": self.applied,
+            "applied_rate_hz": round(self.applied / duration, 2),
+            "superseded": self.superseded,
+            "telemetry_frames": self.telemetry,
+            "backpressure_on": self.backpressure_on,
+            "backpressure_off": self.backpressure_off,
+            "busy": self.busy,
+            "rtt_ms": percentiles(self.rtt_ms),
+            "errors": self.errors,
+        }
+
+
+async def run_all(args):
+    loop = asyncio.get_running_loop()
+    runs = [ClientRun(i, args.clients, args) for i in range(args.clients)]
+    start = loop.time() + 0.2 + args.clients * args.stagger
+    stop = start + args.duration
+    started_wall = time.strftime("%Y-%m-%dT%H:%M:%S")
+
+    async def launch(run):
+        await asyncio.sleep(run.index * args.stagger)
+        await run.run(start, stop)
+
+    await asyncio.gather(*(launch(r) for r in runs))
+    duration = args.duration
+    all_rtt = [x for r in runs for x in r.rtt_ms]
+    sent = sum(r.sent for r in runs)
+    applied = sum(r.applied for r in runs)
+    summary = {
+        "sent": sent,
+        "send_rate_hz": round(sent / duration, 2),
+        "applied": applied,
+        "applied_rate_hz": round(applied / duration, 2),
+        "superseded": sum(r.superseded for r in runs),
+        "telemetry_frames": sum(r.telemetry for r in runs),
+        "telemetry_rate_hz": round(sum(r.telemetry for r in runs) / duration, 2),
+        "backpressure_on": sum(r.backpressure_on for r in runs),
+        "backpressure_off": sum(r.backpressure_off for r in runs),
+        "busy": sum(r.busy for r in runs),
+        "connected": sum(1 for r in runs if r.connected),
+        "errors": sum(len(r.errors) for r in runs),
+        "rtt_ms": percentiles(all_rtt),
+    }
+    return {
+        "tool": "loadgen",
+        "schema": SCHEMA_VERSION,
+        "label": args.label,
+        "started": started_wall,
+        "target": "ws://%s:%d%s" % (args.host, args.port, args.path),
+        "format": args.format,
+        "transport": "udp:%d" % args.udp_port if args.udp_port else "ws",
+        "rtt_source": FORMATS[args.format][2],
+        "clients": args.clients,
+        "rate_hz": args.rate,
+        "config_hz": args.config_hz,
+        "duration_s": duration,
+        "summary": summary,
+        "per_client": [r.result(duration) for r in runs],
+    }
+
+
+def compare(base, current):
+    """逐项对比summary中的数值字段（含rtt_ms分位数），输出到stderr"""
+    def flatten(d, prefix=""):
+        out = {}
+        for k, v in d.items():
+            if isinstance(v, dict):
+                out.update(flatten(v, prefix + k + "."))
+            elif isinstance(v, (int, float)) and not isinstance(v, bool):
+                out[prefix + k] = v
+        return out
+
+    a = flatten(base.get("summary", {}))
+    b = flatten(current.get("summary", {}))
+    sys.stderr.write("%-28s %12s %12s %9s\n" % ("metric", "base", "current", "change"))
+    for key in sorted(set(a) | set(b)):
+        va, vb = a.get(key), b.get(key)
+        change = ""
+        if isinstance(va, (int, float)) and isinstance(vb, (int, float)) and va:
+            change = "%+.1f%%" % (100.0 * (vb - va) / va)
+        sys.stderr.write("%-28s %12s %12s %9s\n" % (key, va, vb, change))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="WebSocket控制通道压测（K客户端，JSON结果）")
+    parser.add_argument("--host", default="192.168.4.1")
+    parser.add_argument("--port", type=int, default=81)
+    parser.add_argument("--path", default="/?rate=50", help="连接URL（V1按?rate=协商遥测频率）")
+    parser.add_argument("--format", choices=sorted(FORMATS), default="v1-bin")
+    parser.add_argument("--udp-port", type=int, default=0, help="帧改走UDP控制通道（如4210，仅二进制格式）")
+    parser.add_argument("--clients", type=int, default=1)
+    parser.add_argument("--rate", type=float, default=50.0, help="每客户端发送频率（Hz）")
+    parser.add_argument("--config-hz", type=float, default=0.0, help="每客户端配置帧频率（0为不发送）")
+    parser.add_argument("--probe-hz", type=float, default=4.0, help="V2回执探针频率")
+    parser.add_argument("--duration", type=float, default=10.0, help="压测时长（s）")
+    parser.add_argument("--settle", type=float, default=0.3, help="停止发送后继续接收的时间（s）")
+    parser.add_argument("--stagger", type=float, default=0.05, help="客户端依次连接的间隔（s）")
+    parser.add_argument("--timeout", type=float, default=5.0)
+    parser.add_argument("--obey-backpressure", action="store_true", help="按固件回压建议降低发送频率")
+    parser.add_argument("--label", default="", help="写入结果的标签（如固件版本）")
+    parser.add_argument("--out", help="结果写入文件（默认stdout）")
+    parser.add_argument("--compare", help="与之前的结果文件逐项对比（输出到stderr）")
+    args = parser.parse_args()
+    if args.clients < 1 or args.rate <= 0 or args.duration <= 0:
+        parser.error("clients/rate/duration必须为正")
+    if args.udp_port and not args.format.endswith("-bin"):
+        parser.error("--udp-port 只支持二进制格式")
+
+    result = asyncio.run(run_all(args))
+    text = json.dumps(result, indent=2, ensure_ascii=False)
+    if args.out:
+        with open(args.out, "w", encoding="utf-8") as f:
+            f.write(text + "\n")
+    else:
+        print(text)
+    if args.compare:
+        with open(args.compare, "r", encoding="utf-8") as f:
+            compare(json.load(f), result)
+    return 0 if result["summary"]["connected"] == args.clients else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,71 @@
+// ===================== 二进制日志解码 =====================
+// 把 EVENT_LOG_BINARY=1 固件的串口输出还原成文本。串口上原始事件记录（0xFF 'L' + 32字节事件）
+// 与普通文本行（启动信息、周期统计）交错，这里逐字节扫描：记录按固件同一张格式表
+// （lib/GyroCore/EventLog.cpp）格式化，其余字节原样输出；截断或损坏的记录计数后跳过。
+//
+// 编译运行（仓库根目录）：
+//   g++ -std=gnu++17 -O2 -Ilib/GyroCore tools/logdecode.cpp lib/GyroCore/EventLog.cpp -o /tmp/logdecode
+//   stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > serial.bin   # 串口原始抓取
+//   /tmp/logdecode serial.bin          # 或从标准输入读：cat serial.bin | /tmp/logdecode
+// 结束时在stderr输出记录数、丢失事件数和无效记录数。
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "EventLog.h"
+
+int main(int argc, char** argv) {
+  if (argc > 2 || (argc == 2 && argv[1][0] == '-' && argv[1][1] != '\0')) {
+    fprintf(stderr, "用法: %s [串口抓取文件]（省略或为-时读标准输入）\n", argv[0]);
+    return 1;
+  }
+  FILE* in = stdin;
+  if (argc == 2 && strcmp(argv[1], "-") != 0) {
+    in = fopen(argv[1], "rb");
+    if (!in) {
+      fprintf(stderr, "无法读取 %s\n", argv[1]);
+      return 1;
+    }
+  }
+
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+    data.insert(data.end(), chunk, chunk + n);
+  }
+  if (in != stdin) fclose(in);
+
+  uint32_t records = 0;
+  uint32_t lost = 0;
+  uint32_t invalid = 0;
+  char line[LOG_LINE_MAX + 1];
+  size_t i = 0;
+  while (i < data.size()) {
+    if (data[i] != LOG_RECORD_SYNC[0]) {
+      fputc(data[i++], stdout);
+      continue;
+    }
+    if (i + LOG_RECORD_SIZE > data.size() || data[i + 1] != LOG_RECORD_SYNC[1]) {
+      // 截断在抓取末尾，或不是记录前缀：丢弃这个字节（0xFF不会出现在文本中）
+      invalid++;
+      i++;
+      continue;
+    }
+    LogEvent event;
+    memcpy(&event, &data[i + 2], sizeof(event));
+    size_t length = formatLogEvent(event, line, sizeof(line));
+    if (length == 0) {
+      invalid++;
+      i++;
+      continue;
+    }
+    fwrite(line, 1, length, stdout);
+    records++;
+    if (event.id == LOG_EVENTS_LOST) lost += (uint32_t)event.args[0];
+    i += LOG_RECORD_SIZE;
+  }
+  fprintf(stderr, "记录:%u 丢失事件:%u 无效:%u\n", records, lost, invalid);
+  return 0;
+}
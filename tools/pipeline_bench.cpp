@@ -0,0 +1,341 @@
+// ===================== 控制流水线：各编译期特化的每帧耗时 =====================
+// 主机侧基准测试，逐帧运行固件的完整热路径 ControlPipeline<输入, 映射, 输出级>（lib/GyroCore/ControlPipeline.h）：
+// 消息解码与分派 -> 映射 -> 输出级（滤波、占空比、跳过未变化写入），对每种组合分别测量：
+//   - 输入/映射：V1二进制姿态帧、V1 JSON姿态消息（AngleInput，按顶层键分类）经通道表映射（ChannelTableMapping）；
+//     V2二进制脉宽帧（PulseInput）的脉宽原样成为通道0~2的目标（ClientPulseMapping）；
+//   - 滤波：SmoothingFilter（每通道EMA）或DirectFilter（-D SERVO_SMOOTHING=0）；
+//   - 通道数：3路（-D SERVO_OUTPUT_CHANNELS=3）或16路。
+// 每种组合另跑一遍“运行时分派”的旧写法：消息类型逐个试解码（JSON用strstr找键名再解码），
+// 通道数、是否滤波、是否绑定都在节拍内判断。两者的占空比写入序列校验和必须一致，只比较耗时。
+// 写入函数为计数器，不含ledcWrite本身的开销。
+//
+// 编译运行（仓库根目录）：
+//   g++ -std=gnu++17 -O2 -Ilib/GyroCore tools/pipeline_bench.cpp lib/GyroCore/JsonScan.cpp -o /tmp/pipeline_bench
+//   /tmp/pipeline_bench [--frames 2000000] [--json 文件]
+// 设备上的对应数字见 esp32dev_metrics 环境下 /metrics 的 parse/map/pwm 阶段直方图。
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "ControlPipeline.h"
+
+const int FRAME_POOL = 1024;   // 预先编码的消息（循环使用，避免被编译器常量折叠）
+
+struct Options {
+  uint32_t frames = 2000000;
+  const char* jsonPath = nullptr;
+};
+
+// 计数写入：累积校验和，代替ledcWrite
+struct CountingWriter {
+  static uint64_t checksum;
+  static uint32_t writes;
+  static void write(int channel, uint32_t duty) {
+    checksum = checksum * 31 + (uint64_t)channel * 65537 + duty;
+    writes++;
+  }
+  static void reset() {
+    checksum = 0;
+    writes = 0;
+  }
+};
+uint64_t CountingWriter::checksum = 0;
+uint32_t CountingWriter::writes = 0;
+
+// 防止运行时分派的参数被常量传播
+volatile int runtimeChannels = 0;
+volatile bool runtimeSmoothing = false;
+
+FilterConfig benchFilter() {
+  FilterConfig cfg = defaultFilterConfig();
+  cfg.mode = FILTER_EMA;
+  cfg.alpha = 0.3f;
+  return cfg;
+}
+
+// 一组输入消息；文本消息末尾多存一个'\0'（WebSocket库的文本payload也是如此），不计入长度
+struct Feed {
+  bool text;
+  std::vector<std::vector<uint8_t> > messages;
+};
+
+// 输入帧：V1为三轴姿态（0.01°），V2为三个通道的脉宽（us）
+GyroFrame makeFrame(uint8_t kind, int i) {
+  GyroFrame frame;
+  memset(&frame, 0, sizeof(frame));
+  frame.kind = kind;
+  frame.flags = GYRO_FLAG_TIMESTAMP;
+  frame.seq = (uint16_t)i;
+  frame.timeMs = (uint32_t)i * 20;
+  for (int a = 0; a < GYRO_FRAME_AXES; a++) {
+    double phase = i * 0.05 + a * 1.3;
+    if (kind == GYRO_FRAME_ANGLE) {
+      frame.value[a] = (int16_t)lround(sin(phase) * 4000);   // ±40°
+      frame.pin[a] = GYRO_PIN_NONE;
+    } else {
+      frame.value[a] = (int16_t)lround(1500 + sin(phase) * 600);
+      frame.pin[a] = (int8_t)(12 + a);
+    }
+  }
+  return frame;
+}
+
+Feed buildBinaryFeed(uint8_t kind) {
+  Feed feed;
+  feed.text = false;
+  for (int i = 0; i < FRAME_POOL; i++) {
+    GyroFrame frame = makeFrame(kind, i);
+    std::vector<uint8_t> bytes(GYRO_FRAME_SIZE);
+    bytes.resize(encodeGyroFrame(frame, bytes.data()));
+    feed.messages.push_back(bytes);
+  }
+  return feed;
+}
+
+// 与V1网页的JSON姿态消息格式相同
+Feed buildTextFeed() {
+  Feed feed;
+  feed.text = true;
+  for (int i = 0; i < FRAME_POOL; i++) {
+    GyroFrame frame = makeFrame(GYRO_FRAME_ANGLE, i);
+    char text[128];
+    int n = snprintf(text, sizeof(text), "{\"pitch\":%.2f,\"roll\":%.2f,\"yaw\":%.2f,\"enabled\":1,\"seq\":%d}",
+                     frame.value[0] / 100.0, frame.value[1] / 100.0, frame.value[2] / 100.0, i);
+    feed.messages.push_back(std::vector<uint8_t>(text, text + n + 1));
+  }
+  return feed;
+}
+
+// 映射段：解码后的帧 -> 各通道目标脉宽（两种写法共用，只比较分派与输出级）
+struct AngleStage {
+  static const ControlInputKind KIND = CONTROL_INPUT_ANGLE;
+  ChannelConfig channels[MAX_SERVO_CHANNELS];
+  void init(int count) {
+    for (int i = 0; i < count; i++) {
+      channels[i] = defaultChannelConfig(i, i % INPUT_AXES);
+    }
+  }
+  void map(const GyroFrame& frame, int count, int* pulse) {
+    int32_t axisCenti[INPUT_AXES] = { frame.value[0], frame.value[1], frame.value[2] };
+    ChannelTableMapping::map(channels, count, axisCenti, true);
+    for (int i = 0; i < count; i++) pulse[i] = channels[i].pulseWidth;
+  }
+};
+
+struct PulseStage {
+  static const ControlInputKind KIND = CONTROL_INPUT_PULSE;
+  struct Command {
+    int8_t pin[MAX_SERVO_CHANNELS];
+    int16_t pulseUs[MAX_SERVO_CHANNELS];
+  };
+  void init(int) {}
+  void map(const GyroFrame& frame, int count, int* pulse) {
+    Command cmd;
+    for (int i = 0; i < MAX_SERVO_CHANNELS; i++) cmd.pin[i] = GYRO_PIN_NONE;
+    ClientPulseMapping::map(frame, cmd);
+    for (int i = 0; i < count; i++) {
+      if (cmd.pin[i] != GYRO_PIN_NONE) pulse[i] = cmd.pulseUs[i];
+    }
+  }
+};
+
+// 旧写法的分派：逐个试解码，JSON先用strstr按键名判断（与原V1回调相同）
+ControlInputKind runtimeDispatch(const std::vector<uint8_t>& message, bool text, GyroFrame& frame, ImuBatch& batch) {
+  if (text) {
+    const char* s = (const char*)message.data();
+    size_t length = message.size() - 1;
+    if (s[0] != '{') return CONTROL_INPUT_NONE;
+    if (strstr(s, "controlEnabled") && !strstr(s, "enabled")) return CONTROL_INPUT_CONFIG;
+    if (strstr(s, "pitch") && strstr(s, "roll") && strstr(s, "yaw")) {
+      decodeGyroText(message.data(), length, frame);
+      return CONTROL_INPUT_ANGLE;
+    }
+    return CONTROL_INPUT_NONE;
+  }
+  if (decodeGyroFrame(message.data(), message.size(), frame)) {
+    return frame.kind == GYRO_FRAME_ANGLE ? CONTROL_INPUT_ANGLE : CONTROL_INPUT_PULSE;
+  }
+  return decodeImuBatch(message.data(), message.size(), batch) ? CONTROL_INPUT_IMU_BATCH : CONTROL_INPUT_NONE;
+}
+
+// 旧写法的输出：节拍内判断通道数、是否绑定、是否滤波
+struct RuntimeOutput {
+  MotionFilter filters[MAX_SERVO_CHANNELS];
+  bool attached[MAX_SERVO_CHANNELS];
+  DutyKernel kernel;
+  DutyCache<MAX_SERVO_CHANNELS> cache;
+  RuntimeOutput() : kernel(16, PWM_PERIOD_US) {}
+  void write(const int* pulse) {
+    int count = runtimeChannels;
+    bool smoothing = runtimeSmoothing;
+    for (int i = 0; i < count; i++) {
+      if (!attached[i]) continue;
+      int p = smoothing ? filters[i].update(pulse[i]) : pulse[i];
+      uint32_t duty = kernel.duty(p);
+      if (cache.update(i, duty)) CountingWriter::write(i, duty);
+    }
+  }
+};
+
+struct Result {
+  std::string input;
+  bool smoothing;
+  int channels;
+  double compiledNs;
+  double runtimeNs;
+  uint32_t writes;
+  bool match;
+};
+
+template <typename Pipeline, typename Stage>
+double runCompiled(const Options& opt, const Feed& feed, uint64_t& checksum, uint32_t& writes) {
+  static Pipeline pipeline(16, PWM_PERIOD_US);
+  pipeline = Pipeline(16, PWM_PERIOD_US);
+  Stage stage;
+  stage.init(Pipeline::channels);
+  FilterConfig cfg = benchFilter();
+  for (int i = 0; i < Pipeline::channels; i++) {
+    pipeline.output().attach(i, true);
+    pipeline.output().configure(i, cfg, PWM_PERIOD_US);
+  }
+  int pulse[MAX_SERVO_CHANNELS];
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) pulse[i] = SERVO_CENTER_PULSE;
+  CountingWriter::reset();
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < opt.frames; n++) {
+    const std::vector<uint8_t>& message = feed.messages[n % FRAME_POOL];
+    typename Pipeline::Message input;
+    ControlInputKind kind = feed.text ? Pipeline::decodeText(message.data(), message.size() - 1, input)
+                                      : Pipeline::decodeBinary(message.data(), message.size(), input);
+    if (kind == Stage::KIND) {
+      stage.map(input.frame, Pipeline::channels, pulse);
+      pipeline.output().write(pulse);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  checksum = CountingWriter::checksum;
+  writes = CountingWriter::writes;
+  return std::chrono::duration<double, std::nano>(end - start).count() / opt.frames;
+}
+
+template <typename Stage>
+double runRuntime(const Options& opt, const Feed& feed, int channels, bool smoothing, uint64_t& checksum) {
+  static RuntimeOutput output;
+  output = RuntimeOutput();
+  Stage stage;
+  stage.init(channels);
+  FilterConfig cfg = benchFilter();
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) {
+    output.attached[i] = i < channels;
+    output.filters[i].configure(cfg, PWM_PERIOD_US);
+  }
+  runtimeChannels = channels;
+  runtimeSmoothing = smoothing;
+  int pulse[MAX_SERVO_CHANNELS];
+  for (int i = 0; i < MAX_SERVO_CHANNELS; i++) pulse[i] = SERVO_CENTER_PULSE;
+  CountingWriter::reset();
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < opt.frames; n++) {
+    GyroFrame frame;
+    ImuBatch batch;
+    if (runtimeDispatch(feed.messages[n % FRAME_POOL], feed.text, frame, batch) == Stage::KIND) {
+      stage.map(frame, runtimeChannels, pulse);
+      output.write(pulse);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  checksum = CountingWriter::checksum;
+  return std::chrono::duration<double, std::nano>(end - start).count() / opt.frames;
+}
+
+template <typename Input, typename Mapping, typename Stage, int CHANNELS, bool SMOOTHING>
+Result measure(const char* input, const Options& opt, const Feed& feed) {
+  typedef ServoOutput<CHANNELS, ServoFilterFor<CHANNELS, SMOOTHING>, CountingWriter> Output;
+  typedef ControlPipeline<Input, Mapping, Output> Pipeline;
+  Result r;
+  r.input = input;
+  r.smoothing = SMOOTHING;
+  r.channels = CHANNELS;
+  uint64_t compiledSum = 0;
+  uint64_t runtimeSum = 0;
+  r.compiledNs = runCompiled<Pipeline, Stage>(opt, feed, compiledSum, r.writes);
+  r.runtimeNs = runRuntime<Stage>(opt, feed, CHANNELS, SMOOTHING, runtimeSum);
+  r.match = compiledSum == runtimeSum && r.writes > 0;
+  return r;
+}
+
+// 一种输入/映射在四种输出级特化下各测一次
+template <typename Input, typename Mapping, typename Stage>
+void measureAll(const char* input, const Options& opt, const Feed& feed, std::vector<Result>& results) {
+  results.push_back(measure<Input, Mapping, Stage, 3, true>(input, opt, feed));
+  results.push_back(measure<Input, Mapping, Stage, 3, false>(input, opt, feed));
+  results.push_back(measure<Input, Mapping, Stage, 16, true>(input, opt, feed));
+  results.push_back(measure<Input, Mapping, Stage, 16, false>(input, opt, feed));
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (!strcmp(arg, "--frames") && value) {
+      opt.frames = (uint32_t)strtoul(value, nullptr, 10);
+      i++;
+    } else if (!strcmp(arg, "--json") && value) {
+      opt.jsonPath = value;
+      i++;
+    } else {
+      fprintf(stderr, "用法: %s [--frames N] [--json 文件]\n", argv[0]);
+      return false;
+    }
+  }
+  if (opt.frames == 0) opt.frames = 1;
+  return true;
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parseArgs(argc, argv, opt)) return 1;
+
+  Feed angleFrames = buildBinaryFeed(GYRO_FRAME_ANGLE);
+  Feed angleTexts = buildTextFeed();
+  Feed pulseFrames = buildBinaryFeed(GYRO_FRAME_PULSE);
+
+  std::vector<Result> results;
+  measureAll<AngleInput, ChannelTableMapping, AngleStage>("V1姿态帧+通道表", opt, angleFrames, results);
+  measureAll<AngleInput, ChannelTableMapping, AngleStage>("V1 JSON姿态+通道表", opt, angleTexts, results);
+  measureAll<PulseInput, ClientPulseMapping, PulseStage>("V2脉宽帧", opt, pulseFrames, results);
+
+  printf("每帧耗时（%u帧，ns/帧）：\n", opt.frames);
+  printf("%-24s %-6s %4s %10s %10s %8s %10s %6s\n", "输入/映射", "滤波", "通道", "编译期", "运行时", "加速", "写入", "一致");
+  bool allMatch = true;
+  for (const Result& r : results) {
+    printf("%-24s %-6s %4d %10.1f %10.1f %7.2fx %10u %6s\n", r.input.c_str(), r.smoothing ? "EMA" : "直通",
+           r.channels, r.compiledNs, r.runtimeNs, r.compiledNs > 0 ? r.runtimeNs / r.compiledNs : 0.0, r.writes,
+           r.match ? "是" : "否");
+    allMatch = allMatch && r.match;
+  }
+
+  if (opt.jsonPath) {
+    FILE* f = fopen(opt.jsonPath, "w");
+    if (!f) {
+      fprintf(stderr, "无法写入 %s\n", opt.jsonPath);
+      return 1;
+    }
+    fprintf(f, "{\"frames\":%u,\"results\":[", opt.frames);
+    for (size_t i = 0; i < results.size(); i++) {
+      const Result& r = results[i];
+      fprintf(f, "%s{\"input\":\"%s\",\"smoothing\":%s,\"channels\":%d,\"compiledNs\":%.2f,\"runtimeNs\":%.2f,"
+                 "\"writes\":%u,\"match\":%s}",
+              i ? "," : "", r.input.c_str(), r.smoothing ? "true" : "false", r.channels, r.compiledNs, r.runtimeNs,
+              r.writes, r.match ? "true" : "false");
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+  }
+  return allMatch ? 0 : 2;
+}
@@ -0,0 +1,254 @@
+// ===================== 延迟补偿：录制日志上的跟踪误差 =====================
+// 主机侧回放sim/traces中带时间戳的V1姿态帧（版本2二进制帧），按固件控制侧的时序运行 lib/GyroCore/MotionPredictor.h：
+//   - 控制环每个节拍（默认20ms）只取最近到达的一帧（入口合并），开启预测时先observe()，
+//     接受后外推到下一个节拍；乱序/过期帧不改变输出。关闭预测时直接使用最近到达帧的角度；
+//   - 真值：客户端发送的样本按客户端时刻线性插值。客户端时钟与本机时钟的差取
+//     min(到达时刻 - 发送时刻) - 最小单向延迟（--base-delay，与日志生成时的假设一致）；
+//   - 误差：每个节拍写出的目标在保持期间 [T, T+节拍) 内逐毫秒与真值比较，给出各轴RMS与最大值（°）。
+// 只统计收到第一帧之后、最后一帧之前的时段；没有带时间戳姿态帧的日志跳过。
+//
+// 编译运行（仓库根目录）：
+//   g++ -std=gnu++17 -O2 -Ilib/GyroCore tools/predict_bench.cpp -o /tmp/predict_bench
+//   /tmp/predict_bench [--tick-ms 20] [--base-delay 5] [--json 文件] [日志 ...]（默认 sim/traces/v1_predict.trace）
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "GyroFrame.h"
+#include "MotionPredictor.h"
+
+// 与src/main.cpp角度固件的PREDICT_*常量相同
+const uint32_t BENCH_BASE_DELAY_US = 5000;
+const uint32_t BENCH_MAX_HORIZON_US = 60000;
+const uint32_t BENCH_STALE_US = 150000;
+
+struct Options {
+  double tickMs = 20;
+  double baseDelayMs = 5;
+  const char* jsonPath = nullptr;
+  std::vector<std::string> traces;
+};
+
+struct Sample {
+  uint32_t arrivalUs;
+  uint16_t seq;
+  uint32_t clientMs;
+  int32_t angle[PREDICT_AXES];
+};
+
+struct Result {
+  std::string trace;
+  size_t frames;
+  double rmsHold;      // 关闭预测，pitch
+  double rmsPredict;   // 开启预测，pitch
+  double maxHold;
+  double maxPredict;
+  uint32_t outOfOrder;
+  uint32_t stale;
+};
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static bool loadTrace(const std::string& path, std::vector<Sample>& samples) {
+  FILE* f = fopen(path.c_str(), "r");
+  if (!f) return false;
+  char line[4096];
+  while (fgets(line, sizeof(line), f)) {
+    double timeMs;
+    int client;
+    char kind[16];
+    char hex[1024];
+    if (line[0] == '#' || sscanf(line, "%lf %d %15s %1023s", &timeMs, &client, kind, hex) != 4) continue;
+    if (strcmp(kind, "bin") != 0 && strcmp(kind, "udp") != 0) continue;
+    uint8_t payload[512];
+    size_t n = 0;
+    for (size_t i = 0; hex[i] && hex[i + 1] && n < sizeof(payload); i += 2) {
+      int hi = hexValue(hex[i]);
+      int lo = hexValue(hex[i + 1]);
+      if (hi < 0 || lo < 0) break;
+      payload[n++] = (uint8_t)(hi << 4 | lo);
+    }
+    GyroFrame frame;
+    if (!decodeGyroFrame(payload, n, frame) || frame.kind != GYRO_FRAME_ANGLE) continue;
+    if ((frame.flags & GYRO_FLAG_TIMESTAMP) == 0) continue;
+    Sample s;
+    s.arrivalUs = (uint32_t)llround(timeMs * 1000);
+    s.seq = frame.seq;
+    s.clientMs = frame.timeMs;
+    for (int a = 0; a < PREDICT_AXES; a++) s.angle[a] = frame.value[a];
+    samples.push_back(s);
+  }
+  fclose(f);
+  return true;
+}
+
+// 真值：按客户端时刻排序、去重后的样本（0.01°），在clientUs处线性插值
+class Truth {
+ public:
+  explicit Truth(const std::vector<Sample>& samples) {
+    for (const Sample& s : samples) {
+      bool seen = false;
+      for (const Sample& t : points_) seen = seen || t.clientMs == s.clientMs;
+      if (!seen) points_.push_back(s);
+    }
+    for (size_t i = 1; i < points_.size(); i++) {
+      for (size_t j = i; j > 0 && points_[j - 1].clientMs > points_[j].clientMs; j--) std::swap(points_[j - 1], points_[j]);
+    }
+  }
+
+  bool covers(double clientUs) const {
+    return !points_.empty() && clientUs >= points_.front().clientMs * 1000.0 && clientUs <= points_.back().clientMs * 1000.0;
+  }
+
+  double at(int axis, double clientUs) const {
+    size_t i = 1;
+    while (i + 1 < points_.size() && points_[i].clientMs * 1000.0 < clientUs) i++;
+    const Sample& a = points_[i - 1];
+    const Sample& b = points_[i];
+    double span = (b.clientMs - a.clientMs) * 1000.0;
+    double f = span > 0 ? (clientUs - a.clientMs * 1000.0) / span : 0;
+    double delta = b.angle[axis] - a.angle[axis];
+    if (delta > PREDICT_WRAP_CENTI / 2) delta -= PREDICT_WRAP_CENTI;
+    if (delta < -PREDICT_WRAP_CENTI / 2) delta += PREDICT_WRAP_CENTI;
+    return a.angle[axis] + f * delta;
+  }
+
+ private:
+  std::vector<Sample> points_;
+};
+
+static double wrapCenti(double v) {
+  while (v > PREDICT_WRAP_CENTI / 2) v -= PREDICT_WRAP_CENTI;
+  while (v < -PREDICT_WRAP_CENTI / 2) v += PREDICT_WRAP_CENTI;
+  return v;
+}
+
+// 按固件时序回放：返回pitch（轴0）的RMS与最大误差（°）
+static void replay(const std::vector<Sample>& samples, const Truth& truth, double clockShiftUs, uint32_t tickUs,
+                   bool predict, double& rms, double& maxError, MotionPredictor& predictor) {
+  PredictorConfig cfg = defaultPredictorConfig();
+  cfg.baseDelayUs = BENCH_BASE_DELAY_US;
+  cfg.maxHorizonUs = BENCH_MAX_HORIZON_US;
+  cfg.staleUs = BENCH_STALE_US;
+  predictor.configure(cfg);
+
+  uint32_t firstUs = samples.front().arrivalUs;
+  uint32_t lastUs = samples.back().arrivalUs;
+  size_t next = 0;
+  bool hasTarget = false;
+  int32_t target[PREDICT_AXES] = { 0, 0, 0 };
+  double sum = 0;
+  uint32_t count = 0;
+  maxError = 0;
+  for (uint32_t tick = (firstUs / tickUs + 1) * tickUs; tick <= lastUs; tick += tickUs) {
+    // 节拍之间到达的帧只保留最后一帧
+    const Sample* latest = nullptr;
+    while (next < samples.size() && samples[next].arrivalUs <= tick) latest = &samples[next++];
+    if (latest) {
+      if (!predict) {
+        memcpy(target, latest->angle, sizeof(target));
+        hasTarget = true;
+      } else if (predictor.observe(latest->seq, latest->clientMs, latest->arrivalUs, latest->angle) == PREDICT_ACCEPTED) {
+        predictor.predict(tick + tickUs, target);
+        hasTarget = true;
+      }
+    }
+    if (!hasTarget) continue;
+    for (uint32_t t = tick; t < tick + tickUs; t += 1000) {
+      double clientUs = t + clockShiftUs;
+      if (!truth.covers(clientUs)) continue;
+      double error = fabs(wrapCenti(target[0] - truth.at(0, clientUs))) / 100.0;
+      sum += error * error;
+      count++;
+      if (error > maxError) maxError = error;
+    }
+  }
+  rms = count ? sqrt(sum / count) : 0;
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--tick-ms") == 0 && i + 1 < argc) opt.tickMs = atof(argv[++i]);
+    else if (strcmp(argv[i], "--base-delay") == 0 && i + 1 < argc) opt.baseDelayMs = atof(argv[++i]);
+    else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) opt.jsonPath = argv[++i];
+    else if (argv[i][0] == '-') {
+      fprintf(stderr, "用法: %s [--tick-ms 20] [--base-delay 5] [--json 文件] [日志 ...]\n", argv[0]);
+      return 1;
+    } else {
+      opt.traces.push_back(argv[i]);
+    }
+  }
+  if (opt.traces.empty()) opt.traces.push_back("sim/traces/v1_predict.trace");
+  if (opt.tickMs <= 0) {
+    fprintf(stderr, "--tick-ms 须大于0\n");
+    return 1;
+  }
+  const uint32_t tickUs = (uint32_t)llround(opt.tickMs * 1000);
+
+  std::vector<Result> results;
+  for (const std::string& path : opt.traces) {
+    std::vector<Sample> samples;
+    if (!loadTrace(path, samples)) {
+      fprintf(stderr, "无法读取 %s\n", path.c_str());
+      return 1;
+    }
+    if (samples.size() < 2) {
+      printf("%s: 没有带时间戳的姿态帧，跳过\n", path.c_str());
+      continue;
+    }
+    // 客户端时刻 = 本机时刻 + clockShiftUs
+    double minOffsetUs = 1e300;
+    for (const Sample& s : samples) {
+      double offset = (double)s.arrivalUs - s.clientMs * 1000.0;
+      if (offset < minOffsetUs) minOffsetUs = offset;
+    }
+    double clockShiftUs = -(minOffsetUs - opt.baseDelayMs * 1000);
+
+    Truth truth(samples);
+    MotionPredictor predictor;
+    Result r;
+    r.trace = path;
+    r.frames = samples.size();
+    replay(samples, truth, clockShiftUs, tickUs, false, r.rmsHold, r.maxHold, predictor);
+    replay(samples, truth, clockShiftUs, tickUs, true, r.rmsPredict, r.maxPredict, predictor);
+    r.outOfOrder = predictor.outOfOrder();
+    r.stale = predictor.stale();
+    results.push_back(r);
+  }
+
+  printf("节拍%.0fms，最小单向延迟%.1fms，pitch跟踪误差（°）\n", opt.tickMs, opt.baseDelayMs);
+  printf("%-32s %6s %10s %10s %10s %10s %6s %6s\n", "日志", "帧数", "直接RMS", "预测RMS", "直接最大", "预测最大", "乱序", "过期");
+  for (const Result& r : results) {
+    printf("%-32s %6zu %10.2f %10.2f %10.2f %10.2f %6u %6u\n", r.trace.c_str(), r.frames, r.rmsHold, r.rmsPredict,
+           r.maxHold, r.maxPredict, r.outOfOrder, r.stale);
+  }
+
+  if (opt.jsonPath) {
+    FILE* f = fopen(opt.jsonPath, "w");
+    if (!f) {
+      fprintf(stderr, "无法写入 %s\n", opt.jsonPath);
+      return 1;
+    }
+    fprintf(f, "{\"tickMs\":%.1f,\"baseDelayMs\":%.2f,\"traces\":[", opt.tickMs, opt.baseDelayMs);
+    for (size_t i = 0; i < results.size(); i++) {
+      const Result& r = results[i];
+      fprintf(f, "%s{\"trace\":\"%s\",\"frames\":%zu,\"rmsHold\":%.3f,\"rmsPredict\":%.3f,\"maxHold\":%.3f,"
+                 "\"maxPredict\":%.3f,\"outOfOrder\":%u,\"stale\":%u}",
+              i ? "," : "", r.trace.c_str(), r.frames, r.rmsHold, r.rmsPredict, r.maxHold, r.maxPredict, r.outOfOrder,
+              r.stale);
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+  }
+  return 0;
+}
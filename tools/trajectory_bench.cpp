@@ -0,0 +1,177 @@
+// ===================== 关键帧轨迹：插值耗时与精度 =====================
+// 主机侧微基准，对 lib/GyroCore/Trajectory.h 计时（先与双精度参考比较精度，再计时）：
+//   - 载入：load()一条16关键帧的轨迹（校验时刻递增并复制）；
+//   - 采样：三种曲线各自按单调递增的时刻逐次sample()（控制环的用法，每次只从上次所在段向后查找），
+//     时刻步长默认20ms（一个控制节拍），每条轨迹从头采到末帧之后；
+//   - 精度：同一批轨迹逐毫秒采样，与 a + (b - a) * ease(τ) 的双精度结果比较最大误差（us）。
+// 控制环每个节拍每条运行中的轨迹只采样一次，设备上的实际耗时以 /metrics 的控制环直方图为准。
+//
+// 编译运行（仓库根目录）：
+//   g++ -std=gnu++17 -O2 -Ilib/GyroCore tools/trajectory_bench.cpp -o /tmp/trajectory_bench
+//   /tmp/trajectory_bench [--rounds 2000] [--step-ms 20] [--json 文件]
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "Trajectory.h"
+
+const int TRAJECTORY_POOL = 64;   // 预先生成的轨迹（循环使用）
+const double MAX_ERROR_US = 0.55; // 与 sim/tests/test_trajectory.cpp 的上限相同
+
+struct Options {
+  uint32_t rounds = 2000;
+  uint32_t stepMs = 20;
+  const char* jsonPath = nullptr;
+};
+
+struct Keys {
+  TrajectoryKey key[TRAJECTORY_MAX_KEYS];
+};
+
+class Rng {
+ public:
+  uint32_t next() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 17;
+    state_ ^= state_ << 5;
+    return state_;
+  }
+
+ private:
+  uint32_t state_ = 2463534242u;
+};
+
+static volatile int32_t sink;
+
+static double referenceEase(uint8_t mode, double t) {
+  switch (mode) {
+    case TRAJ_CUBIC: return t * t * (3 - 2 * t);
+    case TRAJ_MIN_JERK: return t * t * t * (10 - 15 * t + 6 * t * t);
+    default: return t;
+  }
+}
+
+static double referenceSample(const TrajectoryKey* keys, uint8_t mode, uint32_t elapsedMs) {
+  const int last = TRAJECTORY_MAX_KEYS - 1;
+  if (elapsedMs <= keys[0].timeMs) return keys[0].pulseUs;
+  if (elapsedMs >= keys[last].timeMs) return keys[last].pulseUs;
+  int k = 0;
+  while (elapsedMs >= keys[k + 1].timeMs) k++;
+  double tau = (double)(elapsedMs - keys[k].timeMs) / (keys[k + 1].timeMs - keys[k].timeMs);
+  return keys[k].pulseUs + (keys[k + 1].pulseUs - keys[k].pulseUs) * referenceEase(mode, tau);
+}
+
+// 舵机范围内的16关键帧轨迹，段长50~1000ms
+static std::vector<Keys> makePool(Rng& rng) {
+  std::vector<Keys> pool(TRAJECTORY_POOL);
+  for (Keys& k : pool) {
+    uint32_t t = 0;
+    for (int i = 0; i < TRAJECTORY_MAX_KEYS; i++) {
+      k.key[i].timeMs = t;
+      k.key[i].pulseUs = 500 + (int32_t)(rng.next() % 2001);
+      t += 50 + rng.next() % 951;
+    }
+  }
+  return pool;
+}
+
+static double maxErrorUs(const std::vector<Keys>& pool, uint8_t mode) {
+  double maxError = 0;
+  Trajectory trajectory;
+  for (const Keys& k : pool) {
+    trajectory.load(k.key, TRAJECTORY_MAX_KEYS, mode);
+    for (uint32_t t = 0; t <= trajectory.durationMs(); t++) {
+      double error = fabs(trajectory.sample(t) - referenceSample(k.key, mode, t));
+      if (error > maxError) maxError = error;
+    }
+  }
+  return maxError;
+}
+
+static double nsPerLoad(const std::vector<Keys>& pool, uint32_t rounds) {
+  Trajectory trajectory;
+  int32_t acc = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < rounds; n++) {
+    acc += trajectory.load(pool[n % TRAJECTORY_POOL].key, TRAJECTORY_MAX_KEYS, (uint8_t)(n % 3));
+    acc += trajectory.finalPulse();
+  }
+  auto end = std::chrono::steady_clock::now();
+  sink = acc;
+  return std::chrono::duration<double, std::nano>(end - start).count() / rounds;
+}
+
+static double nsPerSample(const std::vector<Keys>& pool, uint32_t rounds, uint32_t stepMs, uint8_t mode,
+                          uint64_t& samples) {
+  std::vector<Trajectory> trajectories(TRAJECTORY_POOL);
+  for (int i = 0; i < TRAJECTORY_POOL; i++) trajectories[i].load(pool[i].key, TRAJECTORY_MAX_KEYS, mode);
+  int32_t acc = 0;
+  samples = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < rounds; n++) {
+    Trajectory& trajectory = trajectories[n % TRAJECTORY_POOL];
+    uint32_t end = trajectory.durationMs() + stepMs;
+    for (uint32_t t = 0; t <= end; t += stepMs) {
+      acc += trajectory.sample(t);
+      samples++;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  sink = acc;
+  return std::chrono::duration<double, std::nano>(end - start).count() / samples;
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) opt.rounds = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--step-ms") == 0 && i + 1 < argc) opt.stepMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) opt.jsonPath = argv[++i];
+    else {
+      fprintf(stderr, "用法: %s [--rounds N] [--step-ms 20] [--json 文件]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (opt.rounds == 0) opt.rounds = 1;
+  if (opt.stepMs == 0) opt.stepMs = 1;
+
+  Rng rng;
+  std::vector<Keys> pool = makePool(rng);
+  static const char* const names[] = { "线性", "三次", "最小加加速度" };
+
+  double errors[3];
+  double sampleNs[3];
+  uint64_t samples[3];
+  bool accurate = true;
+  for (uint8_t mode = TRAJ_LINEAR; mode <= TRAJ_MIN_JERK; mode++) {
+    errors[mode] = maxErrorUs(pool, mode);
+    if (errors[mode] > MAX_ERROR_US) accurate = false;
+    sampleNs[mode] = nsPerSample(pool, opt.rounds, opt.stepMs, mode, samples[mode]);
+  }
+  double loadNs = nsPerLoad(pool, opt.rounds * 100);
+
+  printf("关键帧轨迹（16关键帧，%u条轨迹，采样步长%ums）\n", opt.rounds, opt.stepMs);
+  printf("%-20s %10.1f ns\n", "load()", loadNs);
+  printf("%-20s %12s %14s\n", "曲线", "ns/采样", "最大误差(us)");
+  for (int mode = 0; mode < 3; mode++) printf("%-20s %12.2f %14.3f\n", names[mode], sampleNs[mode], errors[mode]);
+
+  if (opt.jsonPath) {
+    FILE* f = fopen(opt.jsonPath, "w");
+    if (!f) {
+      fprintf(stderr, "无法写入 %s\n", opt.jsonPath);
+      return 1;
+    }
+    fprintf(f, "{\"rounds\":%u,\"stepMs\":%u,\"loadNs\":%.2f,\"modes\":[", opt.rounds, opt.stepMs, loadNs);
+    for (int mode = 0; mode < 3; mode++) {
+      fprintf(f, "%s{\"mode\":%d,\"samples\":%llu,\"sampleNs\":%.3f,\"maxErrorUs\":%.3f}", mode ? "," : "", mode,
+              (unsigned long long)samples[mode], sampleNs[mode], errors[mode]);
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+  }
+  return accurate ? 0 : 2;
+}
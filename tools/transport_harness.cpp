@@ -0,0 +1,269 @@
+// ===================== 传输对比：TCP队头阻塞 vs UDP丢弃迟到帧 =====================
+// 主机侧离散事件模型，比较两种传输下舵机目标的“陈旧度”（控制节拍时刻 - 当前目标帧的产生时刻）。
+// 发送端按固定频率产生帧，链路按设定的丢包率、抖动和乱序投递：
+//   - TCP：按序交付。丢失的段先靠快速重传（其后第3个段到达引发的重复ACK），否则按RTO指数退避重传；
+//     空洞补上之前，后面已到达的帧都不能交付（队头阻塞），补上后一次性交付并被最新帧合并。
+//   - UDP：到达即交付，丢失的帧不补；经过固件同一个SequenceGate，迟到/重复的帧被丢弃。
+// 两条路径都进入固件的LatestSlot，控制节拍取最新帧，与main.cpp的入口队列一致。
+//
+// 编译运行（仓库根目录）：
+//   g++ -std=gnu++17 -O2 -Ilib/GyroCore tools/transport_harness.cpp -o /tmp/transport_harness
+//   /tmp/transport_harness [--loss 0,1,2,5,10,20] [--rate 100] [--tick 50] [--delay-ms 3] [--jitter-ms 4]
+//                          [--reorder 2] [--rto-ms 200] [--seconds 60] [--seed 1] [--json 文件]
+// 丢包率和乱序率单位为%；陈旧度的分辨率为一个发送周期。
+// 结果表输出到stdout，--json 另存为JSON，便于和固件改动前后对比。
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "IngressQueue.h"
+#include "SequenceGate.h"
+
+struct Options {
+  std::vector<double> lossPercent{ 0, 1, 2, 5, 10, 20 };
+  double rateHz = 100;          // 发送频率
+  double tickHz = 50;           // 控制节拍（与固件CONTROL_HZ一致）
+  double delayMs = 3;           // 单向基础时延
+  double jitterMs = 4;          // 单向抖动（均匀分布）
+  double reorderPercent = 2;    // 额外延迟一个发送周期以上的比例（UDP表现为乱序）
+  double rtoMs = 200;           // TCP最小重传超时
+  double seconds = 60;
+  uint32_t seed = 1;
+  const char* jsonPath = nullptr;
+};
+
+struct Frame {
+  uint16_t seq = 0;
+  uint64_t bornUs = 0;
+};
+
+struct Delivery {
+  uint64_t atUs;
+  Frame frame;
+  bool operator<(const Delivery& other) const { return atUs < other.atUs; }
+};
+
+struct Stats {
+  double mean = 0, p50 = 0, p99 = 0, max = 0;
+  uint32_t applied = 0;         // 控制节拍上生效的不同帧数
+  uint32_t dropped = 0;         // UDP：闸门丢弃的迟到帧；TCP：重传次数
+};
+
+// xorshift32：确定性，便于复现
+class Rng {
+ public:
+  explicit Rng(uint32_t seed) : state_(seed ? seed : 1) {}
+  double uniform() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 17;
+    state_ ^= state_ << 5;
+    return (state_ >> 8) * (1.0 / 16777216.0);
+  }
+  bool chance(double percent) { return uniform() * 100.0 < percent; }
+
+ private:
+  uint32_t state_;
+};
+
+// 一次传输的单向时延（含抖动和乱序附加延迟）
+static uint64_t linkDelayUs(const Options& opt, Rng& rng) {
+  double ms = opt.delayMs + rng.uniform() * opt.jitterMs;
+  if (rng.chance(opt.reorderPercent)) ms += (1.0 + rng.uniform() * 2.0) * 1000.0 / opt.rateHz;
+  return (uint64_t)(ms * 1000.0);
+}
+
+static std::vector<Delivery> simulateUdp(const Options& opt, double lossPercent, Rng& rng, Stats& stats) {
+  const uint64_t periodUs = (uint64_t)(1e6 / opt.rateHz);
+  const uint32_t frames = (uint32_t)(opt.seconds * opt.rateHz);
+  std::vector<Delivery> arrivals;
+  for (uint32_t i = 0; i < frames; i++) {
+    Frame f;
+    f.seq = (uint16_t)(i + 1);
+    f.bornUs = i * periodUs;
+    if (rng.chance(lossPercent)) continue;
+    arrivals.push_back({ f.bornUs + linkDelayUs(opt, rng), f });
+  }
+  std::stable_sort(arrivals.begin(), arrivals.end());
+
+  SequenceGate gate(500);
+  std::vector<Delivery> accepted;
+  for (const Delivery& d : arrivals) {
+    if (gate.admit(1, 1, d.frame.seq, (uint32_t)(d.atUs / 1000)) == UDP_ACCEPTED) accepted.push_back(d);
+  }
+  stats.dropped = gate.late();
+  return accepted;
+}
+
+static std::vector<Delivery> simulateTcp(const Options& opt, double lossPercent, Rng& rng, Stats& stats) {
+  const uint64_t periodUs = (uint64_t)(1e6 / opt.rateHz);
+  const uint32_t frames = (uint32_t)(opt.seconds * opt.rateHz);
+  const uint64_t rttUs = (uint64_t)(2 * (opt.delayMs + opt.jitterMs / 2) * 1000.0);
+  const uint64_t rtoUs = std::max((uint64_t)(opt.rtoMs * 1000.0), 2 * rttUs);
+
+  // 每个段第一次尝试的到达时刻（丢失为0），用于判断快速重传
+  std::vector<uint64_t> firstArrival(frames, 0);
+  std::vector<bool> firstLost(frames, false);
+  for (uint32_t i = 0; i < frames; i++) {
+    firstLost[i] = rng.chance(lossPercent);
+    if (!firstLost[i]) firstArrival[i] = i * periodUs + linkDelayUs(opt, rng);
+  }
+
+  std::vector<Delivery> deliveries;
+  uint64_t inOrderUs = 0;  // 前一段的交付时刻（按序交付）
+  uint32_t retransmits = 0;
+  for (uint32_t i = 0; i < frames; i++) {
+    Frame f;
+    f.seq = (uint16_t)(i + 1);
+    f.bornUs = i * periodUs;
+    uint64_t arrival = firstArrival[i];
+    if (firstLost[i]) {
+      // 快速重传：其后第3个成功到达的段触发重复ACK，ACK回到发送端再重传
+      uint64_t retryAt = 0;
+      int later = 0;
+      for (uint32_t j = i + 1; j < frames && later < 3; j++) {
+        if (!firstLost[j]) {
+          later++;
+          if (later == 3) retryAt = firstArrival[j] + rttUs / 2;
+        }
+      }
+      uint64_t backoff = rtoUs;
+      if (retryAt == 0) retryAt = f.bornUs + backoff;
+      for (;;) {
+        retransmits++;
+        if (!rng.chance(lossPercent)) {
+          arrival = retryAt + linkDelayUs(opt, rng);
+          break;
+        }
+        retryAt += backoff;
+        backoff *= 2;
+      }
+    }
+    inOrderUs = std::max(inOrderUs, arrival);
+    deliveries.push_back({ inOrderUs, f });
+  }
+  stats.dropped = retransmits;
+  return deliveries;
+}
+
+// 控制节拍上的陈旧度：每个节拍先取走之前到达的最新帧，再记录当前目标的年龄
+static void measure(const Options& opt, const std::vector<Delivery>& deliveries, Stats& stats) {
+  const uint64_t tickUs = (uint64_t)(1e6 / opt.tickHz);
+  const uint64_t endUs = (uint64_t)(opt.seconds * 1e6);
+  const uint64_t warmupUs = 1000000;
+  LatestSlot<Frame> slot;
+  std::vector<double> ages;
+  size_t next = 0;
+  bool haveTarget = false;
+  Frame target;
+  uint16_t lastApplied = 0;
+  for (uint64_t t = 0; t < endUs; t += tickUs) {
+    while (next < deliveries.size() && deliveries[next].atUs <= t) slot.publish(deliveries[next++].frame);
+    Frame latest;
+    if (slot.take(latest)) {
+      target = latest;
+      haveTarget = true;
+    }
+    if (!haveTarget || t < warmupUs) continue;
+    if (target.seq != lastApplied) {
+      stats.applied++;
+      lastApplied = target.seq;
+    }
+    ages.push_back((t - target.bornUs) / 1000.0);
+  }
+  if (ages.empty()) return;
+  double sum = 0;
+  for (double a : ages) sum += a;
+  std::sort(ages.begin(), ages.end());
+  stats.mean = sum / ages.size();
+  stats.p50 = ages[(size_t)(0.50 * (ages.size() - 1))];
+  stats.p99 = ages[(size_t)(0.99 * (ages.size() - 1))];
+  stats.max = ages.back();
+}
+
+static std::vector<double> parseList(const char* text) {
+  std::vector<double> values;
+  std::string s(text);
+  size_t pos = 0;
+  while (pos <= s.size()) {
+    size_t comma = s.find(',', pos);
+    if (comma == std::string::npos) comma = s.size();
+    if (comma > pos) values.push_back(atof(s.substr(pos, comma - pos).c_str()));
+    pos = comma + 1;
+  }
+  return values;
+}
+
+static bool parseArgs(int argc, char** argv, Options& opt) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!value) return false;
+    if (strcmp(arg, "--loss") == 0) opt.lossPercent = parseList(value);
+    else if (strcmp(arg, "--rate") == 0) opt.rateHz = atof(value);
+    else if (strcmp(arg, "--tick") == 0) opt.tickHz = atof(value);
+    else if (strcmp(arg, "--delay-ms") == 0) opt.delayMs = atof(value);
+    else if (strcmp(arg, "--jitter-ms") == 0) opt.jitterMs = atof(value);
+    else if (strcmp(arg, "--reorder") == 0) opt.reorderPercent = atof(value);
+    else if (strcmp(arg, "--rto-ms") == 0) opt.rtoMs = atof(value);
+    else if (strcmp(arg, "--seconds") == 0) opt.seconds = atof(value);
+    else if (strcmp(arg, "--seed") == 0) opt.seed = (uint32_t)strtoul(value, nullptr, 10);
+    else if (strcmp(arg, "--json") == 0) opt.jsonPath = value;
+    else return false;
+    i++;
+  }
+  return opt.rateHz > 0 && opt.tickHz > 0 && opt.seconds > 1 && !opt.lossPercent.empty();
+}
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!parseArgs(argc, argv, opt)) {
+    fprintf(stderr, "用法: %s [--loss 0,1,5] [--rate Hz] [--tick Hz] [--delay-ms N] [--jitter-ms N] "
+                    "[--reorder %%] [--rto-ms N] [--seconds N] [--seed N] [--json 文件]\n", argv[0]);
+    return 2;
+  }
+
+  printf("# 发送%.0fHz 节拍%.0fHz 时延%.1fms 抖动%.1fms 乱序%.1f%% RTO%.0fms 时长%.0fs\n",
+         opt.rateHz, opt.tickHz, opt.delayMs, opt.jitterMs, opt.reorderPercent, opt.rtoMs, opt.seconds);
+  printf("%-7s %-4s %9s %9s %9s %9s %8s %8s\n", "loss%", "path", "mean_ms", "p50_ms", "p99_ms", "max_ms",
+         "applied", "dropped");
+
+  std::string json = "{\"tool\":\"transport_harness\",\"results\":[";
+  for (size_t n = 0; n < opt.lossPercent.size(); n++) {
+    double loss = opt.lossPercent[n];
+    Stats tcp, udp;
+    // 两条路径用相同种子，链路条件可比
+    Rng tcpRng(opt.seed + (uint32_t)n), udpRng(opt.seed + (uint32_t)n);
+    measure(opt, simulateTcp(opt, loss, tcpRng, tcp), tcp);
+    measure(opt, simulateUdp(opt, loss, udpRng, udp), udp);
+
+    const Stats* rows[2] = { &tcp, &udp };
+    const char* names[2] = { "tcp", "udp" };
+    for (int k = 0; k < 2; k++) {
+      const Stats& s = *rows[k];
+      printf("%-7.1f %-4s %9.1f %9.1f %9.1f %9.1f %8u %8u\n", loss, names[k], s.mean, s.p50, s.p99, s.max,
+             s.applied, s.dropped);
+      char item[256];
+      snprintf(item, sizeof(item),
+               "%s{\"loss\":%.2f,\"path\":\"%s\",\"mean_ms\":%.2f,\"p50_ms\":%.2f,\"p99_ms\":%.2f,\"max_ms\":%.2f,"
+               "\"applied\":%u,\"dropped\":%u}",
+               (n == 0 && k == 0) ? "" : ",", loss, names[k], s.mean, s.p50, s.p99, s.max, s.applied, s.dropped);
+      json += item;
+    }
+  }
+  json += "]}";
+
+  if (opt.jsonPath) {
+    FILE* f = fopen(opt.jsonPath, "w");
+    if (!f) {
+      fprintf(stderr, "无法写入 %s\n", opt.jsonPath);
+      return 1;
+    }
+    fprintf(f, "%s\n", json.c_str());
+    fclose(f);
+  }
+  return 0;
+}